@@ -2658,10 +2658,7 @@ void EditorComponent::Update(float dt)
 		{
 			scene.Entity_Serialize(archive, seri, x);
 		}
-		for (auto& x : translator.selectedEntitiesNonRecursive)
-		{
-			scene.Entity_Remove(x);
-		}
+		scene.Entity_RemoveBatch(translator.selectedEntitiesNonRecursive);
 
 		ClearSelected();
 
@@ -4738,11 +4735,160 @@ void EditorComponent::RecordEntity(wi::Archive& archive, const wi::vector<wi::ec
 	}
 }
 
+static constexpr uint32_t HISTORY_KEYFRAME_INTERVAL = 16; // max length of delta chains, this limits the decompression work of one undo step
+static constexpr int HISTORY_COMPRESSION_LEVEL = 3;
+wi::Archive& EditorComponent::GetHistoryArchive(EditorScene& editorscene, size_t index)
+{
+	EditorScene::HistoryEntry& entry = *editorscene.history[index];
+	wi::jobsystem::Wait(entry.ctx);
+	entry.ApplyKeyframe();
+	if (entry.archive == nullptr)
+	{
+		const uint8_t* ref_data = nullptr;
+		size_t ref_size = 0;
+		if (entry.chain > 0)
+		{
+			ref_data = GetHistoryArchive(editorscene, index - 1).GetData();
+			ref_size = editorscene.history[index - 1]->size;
+		}
+		wi::helper::DecompressDelta(entry.compressed.data(), entry.compressed.size(), ref_data, ref_size, entry.decompressed);
+		entry.archive = std::make_unique<wi::Archive>(entry.decompressed.data(), entry.decompressed.size());
+	}
+	return *entry.archive;
+}
+void EditorComponent::CompressHistoryEntry(EditorScene& editorscene, size_t index)
+{
+	EditorScene::HistoryEntry& entry = *editorscene.history[index];
+	wi::jobsystem::Wait(entry.ctx);
+	if (entry.archive == nullptr)
+		return;
+	if (!entry.archive->IsReadMode())
+	{
+		entry.size = entry.archive->GetPos();
+	}
+
+	// The previous entry is the reference, so data that didn't change since then (eg. unmodified terrain/voxel/texture regions) compresses to almost nothing:
+	const uint8_t* ref_data = nullptr;
+	size_t ref_size = 0;
+	entry.chain = 0;
+	if (index > 0 && editorscene.history[index - 1]->chain + 1 < HISTORY_KEYFRAME_INTERVAL)
+	{
+		ref_data = GetHistoryArchive(editorscene, index - 1).GetData();
+		ref_size = editorscene.history[index - 1]->size;
+		entry.chain = editorscene.history[index - 1]->chain + 1;
+	}
+
+	entry.compression_started = true;
+	entry.compressed.clear();
+	entry.ctx.priority = wi::jobsystem::Priority::Low;
+	wi::jobsystem::Execute(entry.ctx, [&entry, ref_data, ref_size](wi::jobsystem::JobArgs args) {
+		wi::helper::CompressDelta(entry.archive->GetData(), entry.size, ref_data, ref_size, entry.compressed, HISTORY_COMPRESSION_LEVEL);
+	});
+}
+void EditorComponent::TrimHistory(EditorScene& editorscene)
+{
+	auto& history = editorscene.history;
+	auto resident_size = [&](size_t index) -> size_t {
+		const EditorScene::HistoryEntry& entry = *history[index];
+		return entry.archive == nullptr ? 0 : entry.archive->GetSize();
+	};
+
+	// Uncompressed data is released from the entries that are furthest away from the current position:
+	size_t resident_memory = 0;
+	for (size_t i = 0; i < history.size(); ++i)
+	{
+		history[i]->ApplyKeyframe();
+		resident_memory += resident_size(i);
+	}
+	const size_t resident_budget = history_memory_budget / 4;
+	if (resident_memory > resident_budget)
+	{
+		wi::vector<size_t> candidates;
+		for (size_t i = 0; i + 1 < history.size(); ++i)
+		{
+			const EditorScene::HistoryEntry& entry = *history[i];
+			if (entry.archive == nullptr || !entry.compression_started || wi::jobsystem::IsBusy(entry.ctx) || entry.compressed.empty())
+				continue;
+			if (wi::jobsystem::IsBusy(history[i + 1]->ctx))
+				continue; // the next entry is being compressed with this as reference
+			if (int(i) == editorscene.historyPos || int(i) == editorscene.historyPos + 1)
+				continue; // next undo and redo targets
+			candidates.push_back(i);
+		}
+		std::sort(candidates.begin(), candidates.end(), [&](size_t a, size_t b) {
+			return std::abs(int(a) - editorscene.historyPos) > std::abs(int(b) - editorscene.historyPos);
+		});
+		for (size_t i : candidates)
+		{
+			if (resident_memory <= resident_budget)
+				break;
+			EditorScene::HistoryEntry& entry = *history[i];
+			resident_memory -= resident_size(i);
+			entry.archive.reset();
+			entry.decompressed.clear();
+			entry.decompressed.shrink_to_fit();
+		}
+	}
+
+	// The oldest entries are removed while the whole history is over budget:
+	size_t memory = resident_memory;
+	for (auto& entry : history)
+	{
+		memory += entry->compressed.size();
+	}
+	while (memory > history_memory_budget && history.size() > 1 && editorscene.historyPos >= 0)
+	{
+		if (wi::jobsystem::IsBusy(history[0]->ctx) || wi::jobsystem::IsBusy(history[1]->ctx))
+			break; // the UI thread doesn't wait for compression, the rest is trimmed by a later call
+		std::shared_ptr<EditorScene::HistoryEntry> removed = std::move(history[0]);
+		history.erase(history.begin());
+		editorscene.historyPos--;
+		memory -= (removed->archive == nullptr ? 0 : removed->archive->GetSize()) + removed->compressed.size();
+
+		EditorScene::HistoryEntry& next = *history[0];
+		if (next.chain > 0)
+		{
+			// The next entry becomes the first, so it is turned into a keyframe and the chains that depend on it get shorter:
+			const uint32_t chain = next.chain;
+			for (size_t i = 0; i < history.size() && history[i]->chain >= chain; ++i)
+			{
+				history[i]->chain -= chain;
+			}
+			// The recompression is done in the background, the removed entry is kept alive by the job because it is the reference for decompression:
+			next.ctx.priority = wi::jobsystem::Priority::Low;
+			wi::jobsystem::Execute(next.ctx, [&next, removed](wi::jobsystem::JobArgs args) {
+				wi::vector<uint8_t> ref;
+				const uint8_t* ref_data = nullptr;
+				if (removed->archive != nullptr)
+				{
+					ref_data = removed->archive->GetData();
+				}
+				else
+				{
+					wi::helper::DecompressDelta(removed->compressed.data(), removed->compressed.size(), nullptr, 0, ref);
+					ref_data = ref.data();
+				}
+				wi::vector<uint8_t> data;
+				const uint8_t* next_data = nullptr;
+				if (next.archive != nullptr)
+				{
+					next_data = next.archive->GetData();
+				}
+				else
+				{
+					wi::helper::DecompressDelta(next.compressed.data(), next.compressed.size(), ref_data, removed->size, data);
+					next_data = data.data();
+				}
+				wi::helper::CompressDelta(next_data, next.size, nullptr, 0, next.keyframe, HISTORY_COMPRESSION_LEVEL);
+			});
+		}
+	}
+}
 void EditorComponent::ResetHistory()
 {
 	EditorScene& editorscene = GetCurrentEditorScene();
 	editorscene.historyPos = -1;
-	editorscene.history.clear();
+	editorscene.ClearHistory();
 	editorscene.has_unsaved_changes = false;
 }
 wi::Archive& EditorComponent::AdvanceHistory(const bool scene_unchanged)
@@ -4755,8 +4901,18 @@ wi::Archive& EditorComponent::AdvanceHistory(const bool scene_unchanged)
 		editorscene.history.pop_back();
 	}
 
-	editorscene.history.emplace_back();
-	editorscene.history.back().SetReadModeAndResetPos(false);
+	// The previous entry is complete, it is compressed in the background while the new one is recorded:
+	if (!editorscene.history.empty() && !editorscene.history.back()->compression_started)
+	{
+		CompressHistoryEntry(editorscene, editorscene.history.size() - 1);
+	}
+
+	editorscene.history.push_back(std::make_unique<EditorScene::HistoryEntry>());
+	EditorScene::HistoryEntry& entry = *editorscene.history.back();
+	entry.archive = std::make_unique<wi::Archive>();
+	entry.archive->SetReadModeAndResetPos(false);
+
+	TrimHistory(editorscene);
 
 	if (!scene_unchanged)
 	{
@@ -4764,7 +4920,7 @@ wi::Archive& EditorComponent::AdvanceHistory(const bool scene_unchanged)
 		RefreshSceneList();
 	}
 
-	return editorscene.history.back();
+	return *entry.archive;
 }
 void EditorComponent::ConsumeHistoryOperation(bool undo)
 {
@@ -4779,7 +4935,11 @@ void EditorComponent::ConsumeHistoryOperation(bool undo)
 
 		Scene& scene = GetCurrentScene();
 
-		wi::Archive& archive = editorscene.history[editorscene.historyPos];
+		wi::Archive& archive = GetHistoryArchive(editorscene, editorscene.historyPos);
+		if (!archive.IsReadMode())
+		{
+			editorscene.history[editorscene.historyPos]->size = archive.GetPos();
+		}
 		archive.SetReadModeAndResetPos(true);
 
 		int temp;
@@ -4958,10 +5118,7 @@ void EditorComponent::ConsumeHistoryOperation(bool undo)
 				}
 				else
 				{
-					for (size_t i = 0; i < deletedEntities.size(); ++i)
-					{
-						scene.Entity_Remove(deletedEntities[i]);
-					}
+					scene.Entity_RemoveBatch(deletedEntities);
 				}
 
 			}
@@ -5019,6 +5176,8 @@ void EditorComponent::ConsumeHistoryOperation(bool undo)
 			editorscene.historyPos--;
 		}
 
+		TrimHistory(editorscene);
+
 		scene.Update(0);
 	}
 
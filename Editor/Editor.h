@@ -177,6 +177,9 @@ public:
 	wi::Archive& AdvanceHistory(bool scene_unchanged = false);
 	void ConsumeHistoryOperation(bool undo);
 
+	// The memory of the undo history of a scene is kept under this budget by removing the oldest entries
+	size_t history_memory_budget = 1024ull * 1024ull * 1024ull;
+
 	wi::vector<std::string> recentFilenames;
 	size_t maxRecentFilenames = 10;
 	wi::vector<std::string> recentFolders;
@@ -207,11 +210,43 @@ public:
 		wi::scene::CameraComponent camera;
 		wi::scene::TransformComponent camera_transform;
 		wi::scene::TransformComponent camera_target;
-		wi::vector<wi::Archive> history;
+		// History entries are recorded uncompressed, then they are delta compressed against the previous entry in the background
+		//	The uncompressed data is only kept for the recently used entries, older ones are decompressed on demand
+		struct HistoryEntry
+		{
+			std::unique_ptr<wi::Archive> archive; // uncompressed data, can be empty if only the compressed data is available
+			wi::vector<uint8_t> decompressed; // the memory of archive when it was decompressed
+			wi::vector<uint8_t> compressed;
+			size_t size = 0; // uncompressed size
+			uint32_t chain = 0; // number of previous entries that are required for decompression, 0 for keyframes
+			bool compression_started = false;
+			wi::vector<uint8_t> keyframe; // recompressed without reference in the background when the previous entry is removed, it replaces compressed when the job is finished
+			wi::jobsystem::context ctx;
+			void ApplyKeyframe()
+			{
+				if (!keyframe.empty() && !wi::jobsystem::IsBusy(ctx))
+				{
+					compressed = std::move(keyframe);
+					keyframe.clear();
+				}
+			}
+			~HistoryEntry() { wi::jobsystem::Wait(ctx); }
+		};
+		wi::vector<std::unique_ptr<HistoryEntry>> history;
+		// All compression jobs are finished before the entries are destroyed, because the job of an entry reads the previous entry
+		void ClearHistory()
+		{
+			for (auto& entry : history)
+			{
+				wi::jobsystem::Wait(entry->ctx);
+			}
+			history.clear();
+		}
 		int historyPos = -1;
 		bool has_unsaved_changes = false;
 		wi::gui::Button tabSelectButton;
 		wi::gui::Button tabCloseButton;
+		~EditorScene() { ClearHistory(); }
 	};
 	wi::vector<std::unique_ptr<EditorScene>> scenes;
 	int current_scene = 0;
@@ -219,6 +254,10 @@ public:
 	const EditorScene& GetCurrentEditorScene() const { return *scenes[current_scene].get(); }
 	wi::scene::Scene& GetCurrentScene() { return scenes[current_scene].get()->scene; }
 	const wi::scene::Scene& GetCurrentScene() const { return scenes[current_scene].get()->scene; }
+
+	wi::Archive& GetHistoryArchive(EditorScene& editorscene, size_t index);
+	void CompressHistoryEntry(EditorScene& editorscene, size_t index);
+	void TrimHistory(EditorScene& editorscene);
 	void SetCurrentScene(int index);
 	void RefreshSceneList();
 	void NewScene();
@@ -40,6 +40,19 @@ void GeneralWindow::Create(EditorComponent* _editor)
 	masterVolumeSlider.SetValue(wi::audio::GetVolume());
 	AddWidget(&masterVolumeSlider);
 
+	undoMemorySlider.Create(64, 8192, 1024, 8192 - 64, "Undo memory (MB): ");
+	undoMemorySlider.SetTooltip("The undo history of a scene is compressed and kept under this memory budget, the oldest entries will be removed above it.");
+	if (editor->main->config.GetSection("options").Has("undo_memory"))
+	{
+		editor->history_memory_budget = size_t(editor->main->config.GetSection("options").GetInt("undo_memory")) * 1024ull * 1024ull;
+	}
+	undoMemorySlider.OnSlide([=](wi::gui::EventArgs args) {
+		editor->history_memory_budget = size_t(args.iValue) * 1024ull * 1024ull;
+		editor->main->config.GetSection("options").Set("undo_memory", args.iValue);
+	});
+	undoMemorySlider.SetValue(float(editor->history_memory_budget / (1024ull * 1024ull)));
+	AddWidget(&undoMemorySlider);
+
 	physicsDebugCheckBox.Create("Physics visualizer: ");
 	physicsDebugCheckBox.SetTooltip("Visualize the physics world");
 	physicsDebugCheckBox.OnClick([=](wi::gui::EventArgs args) {
@@ -1455,6 +1468,7 @@ void GeneralWindow::ResizeLayout()
 	layout.add_right(versionCheckBox, fpsCheckBox, otherinfoCheckBox);
 
 	layout.add(masterVolumeSlider);
+	layout.add(undoMemorySlider);
 
 	layout.add(saveModeComboBox);
 
@@ -11,6 +11,7 @@ public:
 	wi::gui::CheckBox fpsCheckBox;
 	wi::gui::CheckBox otherinfoCheckBox;
 	wi::gui::Slider masterVolumeSlider;
+	wi::gui::Slider undoMemorySlider;
 	wi::gui::ComboBox themeCombo;
 	wi::gui::Button themeEditorButton;
 	wi::gui::ComboBox saveModeComboBox;
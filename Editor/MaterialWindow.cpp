@@ -568,10 +568,9 @@ void MaterialWindow::Create(EditorComponent* _editor)
 		wi::scene::Scene& scene = editor->GetCurrentScene();
 		for (auto& x : editor->translator.selected)
 		{
-			NameComponent* name = scene.names.GetComponent(x.entity);
-			if (name == nullptr)
+			if (!scene.names.Contains(x.entity))
 				continue;
-			*name = args.sValue;
+			scene.Entity_SetName(x.entity, args.sValue);
 
 			editor->componentsWnd.RefreshEntityTree();
 		}
@@ -38,12 +38,7 @@ void NameWindow::Create(EditorComponent* _editor)
 		wi::scene::Scene& scene = editor->GetCurrentScene();
 		for (auto& x : editor->translator.selected)
 		{
-			NameComponent* name = scene.names.GetComponent(x.entity);
-			if (name == nullptr)
-			{
-				name = &editor->GetCurrentScene().names.Create(x.entity);
-			}
-			name->name = args.sValue;
+			scene.Entity_SetName(x.entity, args.sValue);
 		}
 		editor->componentsWnd.RefreshEntityTree();
 	});
@@ -275,6 +275,9 @@ void SoundWindow::Create(EditorComponent* _editor)
 
 void WaveGraph::Render(const wi::Canvas& canvas, wi::graphics::CommandList cmd) const
 {
+	// The wave is drawn with custom pipeline states, the batched GUI draws before it must be submitted first:
+	wi::image::FlushBatch(cmd);
+
 	GraphicsDevice* device = wi::graphics::GetDevice();
 	device->EventBegin("Sound Wave", cmd);
 
@@ -297,7 +300,7 @@ void WaveGraph::Render(const wi::Canvas& canvas, wi::graphics::CommandList cmd)
 	XMFLOAT4 base_color = font.params.color;
 	base_color.w = 1;
 
-	if (sound == nullptr || !sound->soundResource.IsValid())
+	if (sound == nullptr || !sound->soundResource.IsValid() || wi::audio::IsStreaming(&sound->soundResource.GetSound()))
 	{
 		// Vertices for straight line:
 		Vertex vert;
@@ -696,8 +696,8 @@ void Example_ImGuiRenderer::Update(float dt)
 			for (int i = 0; i < size; i++)
 			{
 				Entity e = scene.objects.GetEntity(i);
+				if (scene.names.GetComponent(e)->name.empty()) scene.Entity_SetName(e, std::to_string(e));
 				NameComponent& name = *scene.names.GetComponent(e);
-				if (name.name.empty()) name.name = std::to_string(e);
 
 				bool is_selected = false;
 				if (highlight_entity == e) is_selected = true;;
@@ -27,6 +27,10 @@ enum TEST_TYPE
 	INVERSEKINEMATICSTEST,
 	INSTANCESTEST,
 	CONTAINERPERF,
+	SORTPERF,
+	CHARACTERPERF,
+	INSTANTIATEPERF,
+	PHYSICSSTATEPERF,
 };
 
 // Controller Test UI Data, info down below will be using Xbox Controller as reference
@@ -159,6 +163,10 @@ void TestsRenderer::Load()
 	testSelector.AddItem("Inverse Kinematics", INVERSEKINEMATICSTEST);
 	testSelector.AddItem("65k Instances", INSTANCESTEST);
 	testSelector.AddItem("Container perf", CONTAINERPERF);
+	testSelector.AddItem("Sort perf", SORTPERF);
+	testSelector.AddItem("Character collision perf", CHARACTERPERF);
+	testSelector.AddItem("Instantiate perf", INSTANTIATEPERF);
+	testSelector.AddItem("Physics state perf", PHYSICSSTATEPERF);
 	testSelector.SetMaxVisibleItemCount(10);
 	testSelector.OnSelect([=](wi::gui::EventArgs args) {
 
@@ -419,6 +427,22 @@ void TestsRenderer::Load()
 			ContainerTest();
 			break;
 
+		case SORTPERF:
+			SortTest();
+			break;
+
+		case CHARACTERPERF:
+			CharacterCollisionTest();
+			break;
+
+		case INSTANTIATEPERF:
+			InstantiateTest();
+			break;
+
+		case PHYSICSSTATEPERF:
+			PhysicsStateTest();
+			break;
+
 		default:
 			assert(0);
 			break;
@@ -1257,3 +1281,503 @@ void TestsRenderer::ContainerTest()
 	font.params.size = 24;
 	this->AddFont(&font);
 }
+void TestsRenderer::SortTest()
+{
+	wi::Timer timer;
+
+	using wi::renderer::RenderBatch;
+
+	std::string ss = "Render queue sort test (best of 5 runs):\n";
+
+	auto measure = [&](const char* name, const wi::vector<RenderBatch>& input, bool transparent) {
+		auto get_key = [transparent](const RenderBatch& batch) {
+			return transparent ? ~batch.GetSortKeyTransparent() : batch.GetSortKeyOpaque();
+		};
+
+		// The radix sort is stable, so its result must be the same as std::stable_sort element by element, even for equal keys:
+		wi::vector<RenderBatch> reference = input;
+		if (transparent)
+		{
+			std::stable_sort(reference.begin(), reference.end(), std::greater<RenderBatch>());
+		}
+		else
+		{
+			std::stable_sort(reference.begin(), reference.end(), std::less<RenderBatch>());
+		}
+		bool correct = true;
+		auto check = [&](const RenderBatch* sorted, const wi::vector<RenderBatch>& std_sorted) {
+			for (size_t i = 0; i < reference.size(); ++i)
+			{
+				// std::sort is not stable, only the keys are compared with it:
+				correct &= get_key(sorted[i]) == get_key(std_sorted[i]);
+				correct &= std::memcmp(&sorted[i], &reference[i], sizeof(RenderBatch)) == 0;
+			}
+		};
+
+		wi::vector<RenderBatch> batches;
+		wi::vector<RenderBatch> std_sorted;
+		wi::vector<RenderBatch> temp(input.size());
+		double best_std = std::numeric_limits<double>::max();
+		double best_radix = std::numeric_limits<double>::max();
+		double best_parallel = std::numeric_limits<double>::max();
+		double best_sorted = std::numeric_limits<double>::max();
+		for (int run = 0; run < 5; ++run)
+		{
+			std_sorted = input;
+			timer.record();
+			if (transparent)
+			{
+				std::sort(std_sorted.begin(), std_sorted.end(), std::greater<RenderBatch>());
+			}
+			else
+			{
+				std::sort(std_sorted.begin(), std_sorted.end(), std::less<RenderBatch>());
+			}
+			best_std = std::min(best_std, timer.elapsed_milliseconds());
+
+			batches = input;
+			timer.record();
+			RenderBatch* sorted = wi::radixsort::Sort(batches.data(), temp.data(), batches.size(), get_key);
+			best_radix = std::min(best_radix, timer.elapsed_milliseconds());
+			check(sorted, std_sorted);
+
+			batches = input;
+			timer.record();
+			sorted = wi::radixsort::SortParallel(batches.data(), temp.data(), batches.size(), get_key);
+			best_parallel = std::min(best_parallel, timer.elapsed_milliseconds());
+			check(sorted, std_sorted);
+
+			// Sorting the result again measures the already sorted detection (same as an unchanged frame):
+			if (sorted != batches.data())
+			{
+				std::swap(batches, temp);
+			}
+			timer.record();
+			sorted = wi::radixsort::SortParallel(batches.data(), temp.data(), batches.size(), get_key);
+			best_sorted = std::min(best_sorted, timer.elapsed_milliseconds());
+			check(sorted, std_sorted);
+		}
+		assert(correct);
+		ss += "\n" + std::string(name) + " (" + std::to_string(input.size()) + " batches):\n";
+		ss += "\tstd::sort: " + std::to_string(best_std) + " ms\n";
+		ss += "\twi::radixsort::Sort: " + std::to_string(best_radix) + " ms\n";
+		ss += "\twi::radixsort::SortParallel: " + std::to_string(best_parallel) + " ms\n";
+		ss += "\talready sorted input: " + std::to_string(best_sorted) + " ms\n";
+		ss += std::string("\tresult: ") + (correct ? "same as std::sort" : "MISMATCH") + "\n";
+	};
+
+	wi::random::RNG rng;
+	for (uint32_t count : { 10000u, 100000u })
+	{
+		// Main camera opaque: many instances of a few hundred meshes, with varying distances and few pipeline bits
+		wi::vector<RenderBatch> opaque(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			opaque[i].Create(rng.next_uint(0u, 500u), i, rng.next_float(0.1f, 1000.0f), rng.next_uint(0u, 10u) == 0 ? rng.next_uint(1u, 8u) : 0);
+		}
+		measure("Opaque", opaque, false);
+
+		// Shadow: distances are not used, so most of the key bytes are the same and those passes are skipped
+		wi::vector<RenderBatch> shadow = opaque;
+		for (RenderBatch& batch : shadow)
+		{
+			batch.distance = 0;
+			batch.camera_mask = uint8_t(1u << rng.next_uint(0u, 4u));
+		}
+		measure("Shadow", shadow, false);
+
+		// Transparent: back to front by distance first
+		measure("Transparent", opaque, true);
+
+		// Random keys from small ranges, so most of them are equal to others:
+		wi::vector<RenderBatch> duplicates(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			duplicates[i].Create(rng.next_uint(0u, 16u), i, float(rng.next_uint(0u, 8u)), rng.next_uint(0u, 4u));
+		}
+		measure("Duplicate keys opaque", duplicates, false);
+		measure("Duplicate keys transparent", duplicates, true);
+	}
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::CharacterCollisionTest()
+{
+	wi::Timer timer;
+
+	std::string ss = "Character to character collision broadphase test:\n";
+
+	wi::random::RNG rng;
+	for (uint32_t count : { 100u, 1000u, 10000u })
+	{
+		// Characters are crowded in a square with about 4 square meters per character, like a town square:
+		const float extent = std::sqrt(float(count) * 4.0f) * 0.5f;
+		wi::vector<wi::primitive::Capsule> capsules(count);
+		wi::vector<wi::primitive::Capsule> moved(count);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const XMFLOAT3 base = XMFLOAT3(rng.next_float(-extent, extent), rng.next_float(0, 0.2f), rng.next_float(-extent, extent));
+			const float height = rng.next_float(1.6f, 1.9f);
+			const float radius = rng.next_float(0.3f, 0.5f);
+			capsules[i] = wi::primitive::Capsule(base, XMFLOAT3(base.x, base.y + height, base.z), radius);
+
+			// The tested capsules are the same characters after a small movement step:
+			moved[i] = capsules[i];
+			const XMFLOAT3 step = XMFLOAT3(rng.next_float(-0.1f, 0.1f), 0, rng.next_float(-0.1f, 0.1f));
+			moved[i].base = XMFLOAT3(moved[i].base.x + step.x, moved[i].base.y, moved[i].base.z + step.z);
+			moved[i].tip = XMFLOAT3(moved[i].tip.x + step.x, moved[i].tip.y, moved[i].tip.z + step.z);
+		}
+
+		struct Hit
+		{
+			int index = -1;
+			XMFLOAT3 normal = {};
+			float depth = 0;
+		};
+		wi::vector<Hit> hits_bruteforce(count);
+		wi::vector<Hit> hits_grid(count);
+
+		// Previous method: every character is tested against every other character, first hit is used
+		timer.record();
+		for (uint32_t j = 0; j < count; ++j)
+		{
+			XMFLOAT3 position, normal;
+			float depth = 0;
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				if (i == j)
+					continue;
+				if (moved[j].intersects(capsules[i], position, normal, depth))
+				{
+					hits_bruteforce[j] = { int(i), normal, depth };
+					break;
+				}
+			}
+		}
+		const double time_bruteforce = timer.elapsed_milliseconds();
+
+		// Spatial hash, same as in Scene::RunCharacterUpdateSystem():
+		timer.record();
+		wi::scene::Scene::CapsuleGrid grid;
+		grid.Build(capsules);
+		const double time_build = timer.elapsed_milliseconds();
+		timer.record();
+		wi::vector<uint32_t> candidates;
+		for (uint32_t j = 0; j < count; ++j)
+		{
+			XMFLOAT3 position, normal;
+			float depth = 0;
+			grid.Query(moved[j].getAABB(), candidates);
+			for (uint32_t i : candidates)
+			{
+				if (i == j)
+					continue;
+				if (moved[j].intersects(capsules[i], position, normal, depth))
+				{
+					hits_grid[j] = { int(i), normal, depth };
+					break;
+				}
+			}
+		}
+		const double time_query = timer.elapsed_milliseconds();
+
+		uint32_t hit_count = 0;
+		uint32_t mismatch_count = 0;
+		for (uint32_t j = 0; j < count; ++j)
+		{
+			const Hit& a = hits_bruteforce[j];
+			const Hit& b = hits_grid[j];
+			hit_count += a.index >= 0 ? 1 : 0;
+			if (a.index != b.index || a.depth != b.depth || a.normal.x != b.normal.x || a.normal.y != b.normal.y || a.normal.z != b.normal.z)
+			{
+				mismatch_count++;
+			}
+		}
+
+		ss += "\n" + std::to_string(count) + " characters (" + std::to_string(hit_count) + " colliding):\n";
+		ss += "\tall pairs: " + std::to_string(time_bruteforce) + " ms\n";
+		ss += "\tspatial hash build: " + std::to_string(time_build) + " ms, query: " + std::to_string(time_query) + " ms\n";
+		ss += "\tresults matching: " + std::string(mismatch_count == 0 ? "yes" : ("no, " + std::to_string(mismatch_count) + " differences")) + "\n";
+	}
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::InstantiateTest()
+{
+	wi::Timer timer;
+
+	std::string ss = "Prefab instantiation test:\n";
+
+	wi::scene::Scene prefab;
+	wi::scene::LoadModel(prefab, CONTENT_DIR "models/teapot.wiscene");
+
+	// The entities of one copy, identified by the names along their hierarchy path below the root of the copy:
+	struct CopyEntity
+	{
+		std::string path;
+		Entity entity = INVALID_ENTITY;
+		XMFLOAT4X4 world;
+	};
+	auto gather_copy = [](const Scene& scene, Entity root) {
+		wi::vector<CopyEntity> copy;
+		for (size_t i = 0; i < scene.transforms.GetCount(); ++i)
+		{
+			CopyEntity item;
+			item.entity = scene.transforms.GetEntity(i);
+			item.world = scene.transforms[i].world;
+			Entity current = item.entity;
+			while (current != root)
+			{
+				const HierarchyComponent* hier = scene.hierarchy.GetComponent(current);
+				if (hier == nullptr)
+					break;
+				const NameComponent* name = scene.names.GetComponent(current);
+				item.path = "/" + (name == nullptr ? std::string() : name->name) + item.path;
+				current = hier->parentID;
+			}
+			if (current == root)
+			{
+				copy.push_back(item);
+			}
+		}
+		// Entities with the same path are told apart by their position:
+		std::sort(copy.begin(), copy.end(), [](const CopyEntity& a, const CopyEntity& b) {
+			if (a.path != b.path)
+				return a.path < b.path;
+			return std::tie(a.world._41, a.world._42, a.world._43) < std::tie(b.world._41, b.world._42, b.world._43);
+		});
+		return copy;
+	};
+	auto matrix_equal = [](const XMFLOAT4X4& a, const XMFLOAT4X4& b) {
+		for (int r = 0; r < 4; ++r)
+		{
+			for (int c = 0; c < 4; ++c)
+			{
+				if (std::abs(a.m[r][c] - b.m[r][c]) > 0.001f)
+					return false;
+			}
+		}
+		return true;
+	};
+	auto entity_equal = [&](const Scene& scene_a, const CopyEntity& a, const Scene& scene_b, const CopyEntity& b) {
+		if (a.path != b.path || !matrix_equal(a.world, b.world))
+			return false;
+		const TransformComponent& transform_a = *scene_a.transforms.GetComponent(a.entity);
+		const TransformComponent& transform_b = *scene_b.transforms.GetComponent(b.entity);
+		XMFLOAT4X4 local_a, local_b;
+		XMStoreFloat4x4(&local_a, transform_a.GetLocalMatrix());
+		XMStoreFloat4x4(&local_b, transform_b.GetLocalMatrix());
+		if (!matrix_equal(local_a, local_b))
+			return false;
+		const LayerComponent* layer_a = scene_a.layers.GetComponent(a.entity);
+		const LayerComponent* layer_b = scene_b.layers.GetComponent(b.entity);
+		if ((layer_a == nullptr) != (layer_b == nullptr) || (layer_a != nullptr && layer_a->layerMask != layer_b->layerMask))
+			return false;
+		if (scene_a.lights.Contains(a.entity) != scene_b.lights.Contains(b.entity))
+			return false;
+		if (scene_a.rigidbodies.Contains(a.entity) != scene_b.rigidbodies.Contains(b.entity))
+			return false;
+		const ObjectComponent* object_a = scene_a.objects.GetComponent(a.entity);
+		const ObjectComponent* object_b = scene_b.objects.GetComponent(b.entity);
+		if ((object_a == nullptr) != (object_b == nullptr))
+			return false;
+		if (object_a != nullptr)
+		{
+			if (std::memcmp(&object_a->color, &object_b->color, sizeof(object_a->color)) != 0 || object_a->filterMask != object_b->filterMask)
+				return false;
+			const MeshComponent* mesh_a = scene_a.meshes.GetComponent(object_a->meshID);
+			const MeshComponent* mesh_b = scene_b.meshes.GetComponent(object_b->meshID);
+			if ((mesh_a == nullptr) != (mesh_b == nullptr))
+				return false;
+			if (mesh_a != nullptr)
+			{
+				if (mesh_a->vertex_positions.size() != mesh_b->vertex_positions.size() || mesh_a->indices != mesh_b->indices || mesh_a->subsets.size() != mesh_b->subsets.size())
+					return false;
+				for (size_t i = 0; i < mesh_a->subsets.size(); ++i)
+				{
+					const MaterialComponent* material_a = scene_a.materials.GetComponent(mesh_a->subsets[i].materialID);
+					const MaterialComponent* material_b = scene_b.materials.GetComponent(mesh_b->subsets[i].materialID);
+					if ((material_a == nullptr) != (material_b == nullptr))
+						return false;
+					if (material_a != nullptr && std::memcmp(&material_a->baseColor, &material_b->baseColor, sizeof(material_a->baseColor)) != 0)
+						return false;
+				}
+			}
+		}
+		return true;
+	};
+
+	wi::random::RNG rng;
+	for (uint32_t count : { 10u, 100u, 1000u })
+	{
+		wi::vector<XMFLOAT4X4> matrices(count);
+		for (auto& matrix : matrices)
+		{
+			XMStoreFloat4x4(&matrix, XMMatrixTranslation(rng.next_float(-100, 100), 0, rng.next_float(-100, 100)));
+		}
+
+		// Previous method: every copy is serialized into a temporary scene and merged
+		wi::scene::Scene scene_serialized;
+		wi::vector<Entity> roots_serialized;
+		timer.record();
+		for (auto& matrix : matrices)
+		{
+			roots_serialized.push_back(scene_serialized.InstantiateSerialized(prefab, true, matrix));
+		}
+		const double time_serialized = timer.elapsed_milliseconds();
+
+		// Direct copy of components, all copies at once:
+		wi::scene::Scene scene_batch;
+		timer.record();
+		const wi::vector<Entity> roots_batch = scene_batch.InstantiateBatch(prefab, matrices, true);
+		const double time_batch = timer.elapsed_milliseconds();
+
+		// Every copy must have the same hierarchy, transforms and components with both methods:
+		uint32_t matching = 0;
+		for (size_t i = 0; i < roots_serialized.size() && i < roots_batch.size(); ++i)
+		{
+			const wi::vector<CopyEntity> copy_serialized = gather_copy(scene_serialized, roots_serialized[i]);
+			const wi::vector<CopyEntity> copy_batch = gather_copy(scene_batch, roots_batch[i]);
+			bool equal = copy_serialized.size() == copy_batch.size();
+			for (size_t j = 0; equal && j < copy_serialized.size(); ++j)
+			{
+				equal = entity_equal(scene_serialized, copy_serialized[j], scene_batch, copy_batch[j]);
+			}
+			matching += equal ? 1 : 0;
+		}
+		assert(matching == count);
+
+		const bool cloneable = prefab.prefab_clone_table != nullptr && prefab.prefab_clone_table->cloneable;
+		ss += "\n" + std::to_string(count) + " copies:\n";
+		ss += "\tserialized: " + std::to_string(time_serialized) + " ms\n";
+		ss += "\tbatch: " + std::to_string(time_batch) + " ms" + (cloneable ? "" : " (not cloneable, serialized fallback)") + "\n";
+		ss += "\tobjects: " + std::to_string(scene_serialized.objects.GetCount()) + " / " + std::to_string(scene_batch.objects.GetCount()) + "\n";
+		ss += "\tmatching copies: " + std::to_string(matching) + " / " + std::to_string(count) + "\n";
+	}
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
+void TestsRenderer::PhysicsStateTest()
+{
+	wi::Timer timer;
+
+	std::string ss = "Physics state snapshot test:\n";
+
+	const uint32_t count = 10000;
+	const uint32_t frames = 60;
+
+	// Boxes are stacked in 400 columns of 25 on a static ground, with a random sideways offset per box,
+	//	so some columns topple and keep moving while the others settle and go to sleep:
+	wi::scene::Scene scene;
+	{
+		Entity entity = CreateEntity();
+		scene.transforms.Create(entity);
+		RigidBodyPhysicsComponent& rigidbody = scene.rigidbodies.Create(entity);
+		rigidbody.shape = RigidBodyPhysicsComponent::BOX;
+		rigidbody.box.halfextents = XMFLOAT3(200, 1, 200);
+		rigidbody.mass = 0;
+	}
+	wi::random::RNG rng;
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		Entity entity = CreateEntity();
+		TransformComponent& transform = scene.transforms.Create(entity);
+		const uint32_t column = i % 400;
+		const uint32_t level = i / 400;
+		transform.Translate(XMFLOAT3(float(column % 20) * 3 - 30 + rng.next_float(-0.2f, 0.2f), 2 + float(level) * 1.1f, float(column / 20) * 3 - 30));
+		transform.UpdateTransform();
+		RigidBodyPhysicsComponent& rigidbody = scene.rigidbodies.Create(entity);
+		rigidbody.shape = RigidBodyPhysicsComponent::BOX;
+		rigidbody.box.halfextents = XMFLOAT3(0.5f, 0.5f, 0.5f);
+	}
+
+	const bool deterministic = wi::physics::IsDeterministicEnabled();
+	wi::physics::SetDeterministicEnabled(true);
+
+	wi::jobsystem::context ctx;
+	timer.record();
+	wi::physics::RunPhysicsUpdateSystem(ctx, scene, 1.0f / 60.0f); // creation of bodies
+	const double time_create = timer.elapsed_milliseconds();
+
+	wi::physics::StateHistory history;
+	history.Init(frames);
+
+	double time_save = 0;
+	double time_record = 0;
+	size_t state_size = 0;
+	wi::vector<uint8_t> state;
+	for (uint32_t frame = 0; frame < frames; ++frame)
+	{
+		wi::physics::RunPhysicsUpdateSystem(ctx, scene, 1.0f / 60.0f);
+
+		timer.record();
+		wi::physics::SaveState(scene, state);
+		time_save += timer.elapsed_milliseconds();
+		state_size = state.size();
+
+		timer.record();
+		history.Record(scene, frame);
+		time_record += timer.elapsed_milliseconds();
+	}
+
+	// Restore the first frame and resimulate, the result must be the same as the recorded last frame:
+	wi::vector<uint8_t> expected;
+	history.GetState(frames - 1, expected);
+
+	timer.record();
+	const bool restored = history.Rewind(scene, 0);
+	const double time_rewind = timer.elapsed_milliseconds();
+
+	for (uint32_t frame = 1; frame < frames; ++frame)
+	{
+		wi::physics::RunPhysicsUpdateSystem(ctx, scene, 1.0f / 60.0f);
+	}
+	wi::physics::SaveState(scene, state);
+	const bool repeatable = restored && state == expected;
+
+	timer.record();
+	wi::physics::RestoreState(scene, state);
+	const double time_restore = timer.elapsed_milliseconds();
+
+	wi::physics::SetDeterministicEnabled(deterministic);
+
+	ss += "\n" + std::to_string(count) + " rigid bodies, " + std::to_string(frames) + " frames:\n";
+	ss += "\tcreation: " + std::to_string(time_create) + " ms\n";
+	ss += "\tsnapshot size: " + std::to_string(state_size / 1024) + " KB\n";
+	ss += "\tsave: " + std::to_string(time_save / frames) + " ms\n";
+	ss += "\trestore: " + std::to_string(time_restore) + " ms\n";
+	ss += "\thistory record: " + std::to_string(time_record / frames) + " ms\n";
+	ss += "\thistory memory: " + std::to_string(history.GetMemorySize() / 1024) + " KB (full snapshots: " + std::to_string(state_size * frames / 1024) + " KB)\n";
+	ss += "\trewind " + std::to_string(frames - 1) + " frames: " + std::to_string(time_rewind) + " ms\n";
+	ss += std::string("\tresimulation: ") + (repeatable ? "repeatable" : "NOT repeatable") + "\n";
+
+	static wi::SpriteFont font;
+	font = wi::SpriteFont(ss);
+	font.params.posX = GetLogicalWidth() / 2;
+	font.params.posY = GetLogicalHeight() / 2;
+	font.params.h_align = wi::font::WIFALIGN_CENTER;
+	font.params.v_align = wi::font::WIFALIGN_CENTER;
+	font.params.size = 20;
+	this->AddFont(&font);
+}
@@ -15,6 +15,10 @@ public:
 	void RunSpriteTest();
 	void RunNetworkTest();
 	void ContainerTest();
+	void SortTest();
+	void CharacterCollisionTest();
+	void InstantiateTest();
+	void PhysicsStateTest();
 };
 
 class Tests : public wi::Application
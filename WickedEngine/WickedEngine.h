@@ -59,11 +59,13 @@
 #include "wiArguments.h"
 #include "wiGPUBVH.h"
 #include "wiGPUSortLib.h"
+#include "wiRadixSort.h"
 #include "wiJobSystem.h"
 #include "wiNetwork.h"
 #include "wiOSC.h"
 #include "wiEventHandler.h"
 #include "wiShaderCompiler.h"
+#include "wiTextureCooker.h"
 #include "wiCanvas.h"
 #include "wiUnorderedMap.h"
 #include "wiUnorderedSet.h"
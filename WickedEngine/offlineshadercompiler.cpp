@@ -5,6 +5,7 @@
 #include <mutex>
 #include <string>
 #include <cstdlib>
+#include <cstring>
 
 std::mutex locker;
 struct ShaderEntry
@@ -381,6 +382,7 @@ int main(int argc, char* argv[])
 	std::cout << "\tdisable_optimization : \tShaders will be compiled without optimizations\n";
 	std::cout << "\tstrip_reflection : \tReflection will be stripped from shader binary to reduce file size\n";
 	std::cout << "\tshaderdump : \t\tShaders will be saved to wiShaderDump.h C++ header file (can be combined with \"rebuild\")\n";
+	std::cout << "\tnocache : \t\tThe shader cache (shaders/cache/) will not be used, every outdated shader will be compiled\n";
 	std::cout << "Command arguments used: ";
 
 	wi::arguments::Parse(argc, argv);
@@ -423,6 +425,15 @@ int main(int argc, char* argv[])
 		std::cout << "rebuild ";
 	}
 
+	if (wi::arguments::HasArgument("nocache"))
+	{
+		std::cout << "nocache ";
+	}
+	else
+	{
+		wi::shadercompiler::SetCacheDirectory("shaders/cache/");
+	}
+
 	if (wi::arguments::HasArgument("disable_optimization"))
 	{
 		compile_flags |= wi::shadercompiler::Flags::DISABLE_OPTIMIZATION;
@@ -631,12 +642,21 @@ int main(int argc, char* argv[])
 
 	std::cout << "[Wicked Engine Offline Shader Compiler] Finished in " << std::setprecision(4) << timer.elapsed_seconds() << " seconds with " << errors << " errors\n";
 
+	if (!wi::shadercompiler::GetCacheDirectory().empty())
+	{
+		const wi::shadercompiler::CacheStatistics statistics = wi::shadercompiler::GetCacheStatistics();
+		std::cout << "[Wicked Engine Offline Shader Compiler] Shader cache: " << statistics.hits << " hits, " << statistics.misses << " misses (" << statistics.shared << " shared binaries)\n";
+	}
+
 	if (shaderdump_enabled)
 	{
 		std::cout << "[Wicked Engine Offline Shader Compiler] Creating ShaderDump...\n";
 		timer.record();
 		size_t total_raw = 0;
 		size_t total_compressed = 0;
+		size_t total_shared = 0;
+		wi::unordered_map<std::string, std::string> symbols; // shader name -> array name
+		wi::unordered_map<size_t, wi::vector<std::pair<const wi::shadercompiler::CompilerOutput*, std::string>>> written; // hash -> written shaders with array names
 		std::string ss;
 		ss += "namespace wiShaderDump {\n";
 		for (auto& x : results)
@@ -644,6 +664,22 @@ int main(int argc, char* argv[])
 			auto& name = x.first;
 			auto& output = x.second;
 
+			// Permutations that compiled to the same binary refer to the same array:
+			auto& candidates = written[wi::helper::HashByteData(output.shaderdata, output.shadersize)];
+			bool shared = false;
+			for (auto& candidate : candidates)
+			{
+				if (candidate.first->shadersize == output.shadersize && std::memcmp(candidate.first->shaderdata, output.shaderdata, output.shadersize) == 0)
+				{
+					symbols[name] = candidate.second;
+					total_shared++;
+					shared = true;
+					break;
+				}
+			}
+			if (shared)
+				continue;
+
 			wi::vector<uint8_t> compressed;
 			bool success = wi::helper::Compress(output.shaderdata, output.shadersize, compressed, 9);
 			if (success) {
@@ -666,18 +702,16 @@ int main(int argc, char* argv[])
 				ss += std::to_string((uint32_t)compressed[i]) + ",";
 			}
 			ss += "};\n";
+			symbols[name] = name_repl;
+			candidates.push_back(std::make_pair(&output, name_repl));
 		}
-		std::cout << "[Wicked Engine Offline Shader Compiler] Compressed shaders: " << total_raw << " -> " << total_compressed << " (" << std::setprecision(3) << (100. * total_compressed / total_raw) << "%)" << std::endl;
+		std::cout << "[Wicked Engine Offline Shader Compiler] Compressed shaders: " << total_raw << " -> " << total_compressed << " (" << std::setprecision(3) << (100. * total_compressed / total_raw) << "%), " << total_shared << " shared" << std::endl;
 		ss += "struct ShaderDumpEntry{const uint8_t* data; size_t size;};\n";
 		ss += "static const wi::unordered_map<std::string, ShaderDumpEntry> shaderdump = {\n";
-		for (auto& x : results)
+		for (auto& x : symbols)
 		{
 			auto& name = x.first;
-
-			std::string name_repl = name;
-			std::replace(name_repl.begin(), name_repl.end(), '/', '_');
-			std::replace(name_repl.begin(), name_repl.end(), '.', '_');
-			std::replace(name_repl.begin(), name_repl.end(), '-', '_');
+			auto& name_repl = x.second;
 			ss += "{\"" + name + "\", {" + name_repl + ",sizeof(" + name_repl + ")}},\n";
 		}
 		ss += "};\n"; // map end
@@ -5,6 +5,7 @@
 static const uint FONT_FLAG_SDF_RENDERING = 1u << 0u;
 static const uint FONT_FLAG_OUTPUT_COLOR_SPACE_HDR10_ST2084 = 1u << 1u;
 static const uint FONT_FLAG_OUTPUT_COLOR_SPACE_LINEAR = 1u << 2u;
+static const uint FONT_FLAG_INSTANCED = 1u << 3u; // buffer_offset refers to uint2 instances of (FontConstants offset, glyph offset) in buffer_index
 
 struct FontVertex
 {
@@ -19,6 +19,7 @@ enum IMAGE_FLAGS
 	IMAGE_FLAG_GRADIENT_LINEAR = 1u << 12u,
 	IMAGE_FLAG_GRADIENT_LINEAR_REFLECTED = 1u << 13u,
 	IMAGE_FLAG_GRADIENT_CIRCULAR = 1u << 14u,
+	IMAGE_FLAG_INSTANCED = 1u << 15u, // the constant buffer only refers to an array of ImageConstants in buffer_index/buffer_offset, indexed by instanceID
 };
 
 struct alignas(16) ImageConstants
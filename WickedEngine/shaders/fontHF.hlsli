@@ -0,0 +1,47 @@
+#ifndef WI_FONT_HF
+#define WI_FONT_HF
+#include "globals.hlsli"
+#include "ShaderInterop_Font.h"
+
+struct VertextoPixel
+{
+	float4 pos : SV_Position;
+	float2 uv : TEXCOORD0;
+	float2 bary : TEXCOORD1;
+	nointerpolation uint constants_offset : TEXCOORD2;
+};
+
+inline bool IsFontInstanced()
+{
+	return ((font.softness_bolden_hdrscaling.y >> 16u) & FONT_FLAG_INSTANCED) != 0;
+}
+
+// In instanced mode the FontConstants of every text are stored in the buffer of the font constant buffer
+//	The layout is the same as the constant buffer (column major transform)
+FontConstants GetFont(uint constants_offset)
+{
+	[branch]
+	if (IsFontInstanced())
+	{
+		ByteAddressBuffer buffer = bindless_buffers[descriptor_index(font.buffer_index)];
+		const uint4 header = buffer.Load4(constants_offset);
+		FontConstants ret;
+		ret.buffer_index = int(header.x);
+		ret.buffer_offset = header.y;
+		ret.texture_index = int(header.z);
+		ret.padding0 = int(header.w);
+		const uint4 color_softness = buffer.Load4(constants_offset + 16);
+		ret.color = color_softness.xy;
+		ret.softness_bolden_hdrscaling = color_softness.zw;
+		ret.transform = transpose(float4x4(
+			asfloat(buffer.Load4(constants_offset + 32)),
+			asfloat(buffer.Load4(constants_offset + 48)),
+			asfloat(buffer.Load4(constants_offset + 64)),
+			asfloat(buffer.Load4(constants_offset + 80))
+		));
+		return ret;
+	}
+	return font;
+}
+
+#endif // WI_FONT_HF
@@ -1,24 +1,18 @@
-#include "globals.hlsli"
-#include "ShaderInterop_Font.h"
-
-struct VertextoPixel
-{
-	float4 pos : SV_Position;
-	float2 uv : TEXCOORD0;
-	float2 bary : TEXCOORD1;
-};
+#include "fontHF.hlsli"
 
 float4 main(VertextoPixel input) : SV_TARGET
 {
-	Texture2D<half4> tex = bindless_textures_half4[descriptor_index(font.texture_index)];
+	FontConstants fnt = GetFont(input.constants_offset);
+
+	Texture2D<half4> tex = bindless_textures_half4[descriptor_index(fnt.texture_index)];
 	half value = tex.SampleLevel(sampler_linear_clamp, input.uv, 0).r;
-	half4 color = unpack_half4(font.color);
+	half4 color = unpack_half4(fnt.color);
 	
-	const half3 softness_bolden_hdrscaling = unpack_half3(font.softness_bolden_hdrscaling);
+	const half3 softness_bolden_hdrscaling = unpack_half3(fnt.softness_bolden_hdrscaling);
 	const half softness = softness_bolden_hdrscaling.x;
 	const half bolden = softness_bolden_hdrscaling.y;
 	const half hdr_scaling = softness_bolden_hdrscaling.z;
-	const min16uint flags = font.softness_bolden_hdrscaling.y >> 16u;
+	const min16uint flags = fnt.softness_bolden_hdrscaling.y >> 16u;
 
 	[branch]
 	if (flags & FONT_FLAG_SDF_RENDERING)
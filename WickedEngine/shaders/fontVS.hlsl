@@ -1,20 +1,30 @@
-#include "globals.hlsli"
-#include "ShaderInterop_Font.h"
-
-struct VertextoPixel
-{
-	float4 pos : SV_Position;
-	float2 uv : TEXCOORD0;
-	float2 bary : TEXCOORD1;
-};
+#include "fontHF.hlsli"
 
 VertextoPixel main(uint vertexID : SV_VertexID, uint instanceID : SV_InstanceID)
 {
-	uint vID = instanceID * 4 + vertexID;
-	FontVertex vertex = bindless_buffers[descriptor_index(font.buffer_index)].Load<FontVertex>(font.buffer_offset + vID * sizeof(FontVertex));
+	ByteAddressBuffer buffer = bindless_buffers[descriptor_index(font.buffer_index)];
+	uint constants_offset = 0;
+	uint vertex_offset = 0;
+
+	[branch]
+	if (IsFontInstanced())
+	{
+		// Batched texts: every instance refers to its text constants and its glyph quad
+		const uint2 instance = buffer.Load2(font.buffer_offset + instanceID * sizeof(uint2));
+		constants_offset = instance.x;
+		vertex_offset = instance.y + vertexID * sizeof(FontVertex);
+	}
+	else
+	{
+		vertex_offset = font.buffer_offset + (instanceID * 4 + vertexID) * sizeof(FontVertex);
+	}
+
+	FontConstants fnt = GetFont(constants_offset);
+	FontVertex vertex = buffer.Load<FontVertex>(vertex_offset);
 
 	VertextoPixel Out;
-	Out.pos = mul(font.transform, float4(asfloat(vertex.pos), 0, 1));
+	Out.pos = mul(fnt.transform, float4(asfloat(vertex.pos), 0, 1));
+	Out.constants_offset = constants_offset;
 	Out.uv = vertex.uv;
 	switch (vertexID)
 	{
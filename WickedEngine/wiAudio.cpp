@@ -3,11 +3,15 @@
 #include "wiHelper.h"
 #include "wiTimer.h"
 #include "wiVector.h"
+#include "wiJobSystem.h"
 
 #define STB_VORBIS_HEADER_ONLY
 #include "Utility/stb_vorbis.c"
 
 #include <sstream>
+#include <atomic>
+#include <algorithm>
+#include <mutex>
 
 template<typename T>
 static constexpr T AlignTo(T value, T alignment)
@@ -15,6 +19,185 @@ static constexpr T AlignTo(T value, T alignment)
 	return ((value + alignment - T(1)) / alignment) * alignment;
 }
 
+// Virtual voice management that is common for all audio backends:
+namespace wi::audio
+{
+	static uint32_t max_real_voices = 64;
+	static std::atomic<uint32_t> real_voice_count{ 0 }; // real voices of virtualizable sound instances
+	static constexpr float VOICE_AUDIBILITY_THRESHOLD = 0.001f; // -60 dB, below this the instance is always virtual
+	static constexpr float VOICE_HYSTERESIS = 1.1f; // score multiplier of real voices, avoids swapping voices that are about equally important
+
+	void SetMaxRealVoices(uint32_t count)
+	{
+		max_real_voices = count;
+	}
+	uint32_t GetMaxRealVoices()
+	{
+		return max_real_voices;
+	}
+	uint32_t GetRealVoiceCount()
+	{
+		return real_voice_count.load();
+	}
+
+	// Approximates the volume of a sound instance at the listener like the default inverse distance curve of 3D audio
+	static float ComputeAudibility(float volume, const SoundInstance3D* instance3D)
+	{
+		if (instance3D == nullptr)
+			return volume;
+		const float distance = wi::math::Distance(instance3D->listenerPos, instance3D->emitterPos) - instance3D->emitterRadius;
+		return volume / std::max(1.0f, distance);
+	}
+
+	struct VoiceCandidate
+	{
+		size_t index = 0; // index of the sound instance in the UpdateVoices() input
+		float score = 0;
+	};
+	// Sorts the candidates by importance and returns how many of them can have real voices
+	static size_t SelectRealVoices(wi::vector<VoiceCandidate>& candidates)
+	{
+		std::sort(candidates.begin(), candidates.end(), [](const VoiceCandidate& a, const VoiceCandidate& b) {
+			return a.score > b.score;
+		});
+		return std::min(candidates.size(), size_t(max_real_voices));
+	}
+
+	// Returns the sample position in a sound buffer after position samples were played, taking the loop region into account
+	template<typename BUFFER>
+	static double WrapSamplePosition(double position, const BUFFER& buffer, uint32_t total_samples, bool looped)
+	{
+		if (!looped)
+			return std::min(position, double(total_samples));
+		const double loop_begin = double(buffer.LoopBegin);
+		const double loop_length = buffer.LoopLength > 0 ? double(buffer.LoopLength) : double(total_samples) - loop_begin;
+		if (loop_length <= 0 || position < loop_begin + loop_length)
+			return position;
+		return loop_begin + std::fmod(position - loop_begin, loop_length);
+	}
+
+	static constexpr uint32_t STREAM_BUFFER_COUNT = 4;
+	static constexpr uint32_t STREAM_BUFFER_SAMPLES = 4096; // per channel
+
+	// Incremental Ogg Vorbis decoder of a streaming sound instance
+	//	The decoding is done on the streaming job thread into a ring of buffers that are submitted to the source voice one by one
+	struct StreamDecoder
+	{
+		stb_vorbis* vorbis = nullptr;
+		uint32_t channels = 0;
+		uint32_t begin = 0;			// first sample of the instance in the sound
+		uint32_t total_samples = 0;	// number of samples in the instance
+		uint32_t loop_begin = 0;	// relative to begin
+		uint32_t loop_end = 0;		// relative to begin
+		std::atomic<bool> looped{ false };
+		uint32_t cursor = 0;		// next sample to decode, relative to begin
+		std::atomic<bool> finished{ false };	// the end of the stream was decoded
+		bool active = false;		// the source voice accepts buffers
+		std::mutex locker;			// protects the decoder state and the source voice while a buffer is decoded and submitted
+		wi::jobsystem::context ctx;
+		wi::vector<short> buffers[STREAM_BUFFER_COUNT];
+
+		~StreamDecoder()
+		{
+			if (vorbis != nullptr)
+			{
+				stb_vorbis_close(vorbis);
+			}
+		}
+
+		bool Open(const uint8_t* data, size_t size)
+		{
+			int error = 0;
+			vorbis = stb_vorbis_open_memory(data, (int)size, &error, nullptr);
+			if (vorbis == nullptr)
+				return false;
+			channels = (uint32_t)stb_vorbis_get_info(vorbis).channels;
+			for (auto& buffer : buffers)
+			{
+				buffer.resize(STREAM_BUFFER_SAMPLES * channels);
+			}
+			ctx.priority = wi::jobsystem::Priority::Streaming;
+			return true;
+		}
+
+		void Seek(uint32_t position)
+		{
+			cursor = std::min(position, total_samples);
+			finished = false;
+			stb_vorbis_seek(vorbis, begin + cursor);
+		}
+
+		// Decodes the next part of the stream into a buffer, the loop region is repeated while looped is set
+		//	returns the number of decoded samples per channel
+		uint32_t Decode(uint32_t buffer_index)
+		{
+			short* dst = buffers[buffer_index].data();
+			uint32_t decoded = 0;
+			while (decoded < STREAM_BUFFER_SAMPLES && !finished)
+			{
+				const bool loop = looped.load() && loop_end > loop_begin;
+				const uint32_t end = loop ? loop_end : total_samples;
+				if (cursor >= end)
+				{
+					if (loop)
+					{
+						Seek(loop_begin);
+						continue;
+					}
+					finished = true;
+					break;
+				}
+				const uint32_t count = std::min(STREAM_BUFFER_SAMPLES - decoded, end - cursor);
+				const int result = stb_vorbis_get_samples_short_interleaved(vorbis, (int)channels, dst + decoded * channels, int(count * channels));
+				if (result <= 0)
+				{
+					finished = true; // end of file, or the stream is shorter than reported
+					break;
+				}
+				decoded += (uint32_t)result;
+				cursor += (uint32_t)result;
+			}
+			if (!finished && !looped.load() && cursor >= total_samples)
+			{
+				finished = true; // so that the last buffer can be marked as the end of stream
+			}
+			return decoded;
+		}
+	};
+
+	// Reads the format of an Ogg Vorbis sound without decoding it
+	static bool GetVorbisInfo(const uint8_t* data, size_t size, int& channels, int& sample_rate, uint32_t& sample_count)
+	{
+		int error = 0;
+		stb_vorbis* vorbis = stb_vorbis_open_memory(data, (int)size, &error, nullptr);
+		if (vorbis == nullptr)
+			return false;
+		const stb_vorbis_info info = stb_vorbis_get_info(vorbis);
+		channels = info.channels;
+		sample_rate = (int)info.sample_rate;
+		sample_count = stb_vorbis_stream_length_in_samples(vorbis);
+		stb_vorbis_close(vorbis);
+		return true;
+	}
+
+	float GetSoundDuration(const uint8_t* data, size_t size)
+	{
+		if (data == nullptr || size < 12)
+			return 0;
+		if (memcmp(data, "OggS", 4) == 0)
+		{
+			int channels = 0;
+			int sample_rate = 0;
+			uint32_t sample_count = 0;
+			if (GetVorbisInfo(data, size, channels, sample_rate, sample_count) && sample_rate > 0)
+			{
+				return float(double(sample_count) / double(sample_rate));
+			}
+		}
+		return 0;
+	}
+}
+
 #ifdef _WIN32
 
 #include <wrl/client.h> // ComPtr
@@ -217,8 +400,14 @@ namespace wi::audio
 	{
 		std::shared_ptr<AudioInternal> audio;
 		WAVEFORMATEX wfx = {};
-		wi::vector<uint8_t> audioData;
+		wi::vector<uint8_t> audioData; // PCM data, or the whole Ogg file when streaming
+		bool streaming = false;
+		uint32_t stream_samples = 0;
 	};
+	struct SoundInstanceInternal;
+	void ReleaseSourceVoice(SoundInstanceInternal* instanceinternal);
+	void SubmitStreamBuffer(SoundInstanceInternal* instanceinternal, uint32_t buffer_index);
+	void RefillStreamBufferAsync(SoundInstanceInternal* instanceinternal, uint32_t buffer_index);
 	struct SoundInstanceInternal : public IXAudio2VoiceCallback
 	{
 		std::shared_ptr<AudioInternal> audio;
@@ -230,10 +419,23 @@ namespace wi::audio
 		XAUDIO2_BUFFER buffer = {};
 		bool ended = true;
 
+		// Virtual voice state, the source voice is only created when the instance is real:
+		SUBMIX_TYPE type = SUBMIX_TYPE_SOUNDEFFECT;
+		bool reverb = false;
+		bool virtualizable = false;
+		bool playing = false;
+		bool stopped = true;
+		bool loop_exited = false;
+		float volume = 1;
+		uint32_t total_samples = 0;
+		double position = 0; // sample position of a virtual instance, or the position where the source voice started playing from
+		wi::Timer timer; // advances the position of a playing virtual instance
+		std::unique_ptr<StreamDecoder> stream; // only for streaming sounds
+
 		~SoundInstanceInternal()
 		{
-			sourceVoice->Stop();
-			sourceVoice->DestroyVoice();
+			stopped = true;
+			ReleaseSourceVoice(this);
 		}
 
 		// Called just before this voice's processing pass begins.
@@ -263,6 +465,11 @@ namespace wi::audio
 		// The buffer can now be reused or destroyed.
 		STDMETHOD_(void, OnBufferEnd) (THIS_ void* pBufferContext)
 		{
+			if (stream != nullptr && pBufferContext != nullptr)
+			{
+				// A stream buffer was consumed, it will be refilled with the continuation of the stream:
+				RefillStreamBufferAsync(this, uint32_t(uintptr_t(pBufferContext) - 1));
+			}
 		}
 
 		// Called when this voice has just reached the end position of a loop.
@@ -288,6 +495,154 @@ namespace wi::audio
 		return static_cast<SoundInstanceInternal*>(param->internal_state.get());
 	}
 
+	// Returns the current sample position of the playback in the buffer, for both real and virtual instances
+	double GetPlaybackPosition(SoundInstanceInternal* instanceinternal)
+	{
+		const bool looped = instanceinternal->buffer.LoopCount > 0 && !instanceinternal->loop_exited;
+		if (instanceinternal->sourceVoice != nullptr)
+		{
+			XAUDIO2_VOICE_STATE state = {};
+			instanceinternal->sourceVoice->GetState(&state, 0);
+			if (state.BuffersQueued == 0 && (instanceinternal->stream == nullptr || instanceinternal->stream->finished))
+				return double(instanceinternal->total_samples); // ended
+			return WrapSamplePosition(instanceinternal->position + double(state.SamplesPlayed), instanceinternal->buffer, instanceinternal->total_samples, looped);
+		}
+		if (instanceinternal->playing)
+		{
+			instanceinternal->position += instanceinternal->timer.record_elapsed_seconds() * instanceinternal->soundinternal->wfx.nSamplesPerSec;
+		}
+		instanceinternal->position = WrapSamplePosition(instanceinternal->position, instanceinternal->buffer, instanceinternal->total_samples, looped);
+		return instanceinternal->position;
+	}
+	// Creates the source voice of a sound instance, the playback continues from the position of the instance
+	bool CreateSourceVoice(SoundInstanceInternal* instanceinternal)
+	{
+		SoundInternal* soundinternal = instanceinternal->soundinternal.get();
+
+		XAUDIO2_SEND_DESCRIPTOR SFXSend[] = {
+			{ XAUDIO2_SEND_USEFILTER, instanceinternal->audio->submixVoices[instanceinternal->type] },
+			{ XAUDIO2_SEND_USEFILTER, instanceinternal->audio->reverbSubmix }, // this should be last to enable/disable reverb simply
+		};
+		XAUDIO2_VOICE_SENDS SFXSendList = {
+			(instanceinternal->reverb && instanceinternal->audio->reverbSubmix != nullptr) ? (uint32_t)arraysize(SFXSend) : 1,
+			SFXSend
+		};
+
+		HRESULT hr = xaudio_check(instanceinternal->audio->audioEngine->CreateSourceVoice(&instanceinternal->sourceVoice, &soundinternal->wfx,
+			0, XAUDIO2_DEFAULT_FREQ_RATIO, instanceinternal, &SFXSendList, NULL));
+
+		if (FAILED(hr))
+		{
+			instanceinternal->sourceVoice = nullptr;
+			return false;
+		}
+		if (instanceinternal->virtualizable)
+		{
+			real_voice_count.fetch_add(1);
+		}
+
+		instanceinternal->sourceVoice->GetVoiceDetails(&instanceinternal->voiceDetails);
+
+		instanceinternal->outputMatrix.resize(size_t(instanceinternal->voiceDetails.InputChannels) * size_t(instanceinternal->audio->masteringVoiceDetails.InputChannels));
+		instanceinternal->channelAzimuths.resize(instanceinternal->voiceDetails.InputChannels);
+		for (size_t i = 0; i < instanceinternal->channelAzimuths.size(); ++i)
+		{
+			instanceinternal->channelAzimuths[i] = X3DAUDIO_2PI * float(i) / float(instanceinternal->channelAzimuths.size());
+		}
+
+		const uint32_t play_begin = std::min(uint32_t(instanceinternal->position), instanceinternal->total_samples - 1);
+		if (instanceinternal->stream != nullptr)
+		{
+			// The stream is decoded from the playback position, the first buffer is decoded immediately, the others on the streaming thread:
+			StreamDecoder& stream = *instanceinternal->stream;
+			stream.looped = instanceinternal->buffer.LoopCount > 0 && !instanceinternal->loop_exited;
+			stream.Seek(play_begin);
+			stream.active = true;
+			SubmitStreamBuffer(instanceinternal, 0);
+			for (uint32_t i = 1; i < STREAM_BUFFER_COUNT; ++i)
+			{
+				RefillStreamBufferAsync(instanceinternal, i);
+			}
+		}
+		else
+		{
+			XAUDIO2_BUFFER buffer = instanceinternal->buffer;
+			buffer.PlayBegin = play_begin;
+			if (instanceinternal->loop_exited)
+			{
+				buffer.LoopBegin = 0;
+				buffer.LoopLength = 0;
+				buffer.LoopCount = 0;
+			}
+			hr = xaudio_check(instanceinternal->sourceVoice->SubmitSourceBuffer(&buffer));
+
+			if (FAILED(hr))
+			{
+				ReleaseSourceVoice(instanceinternal);
+				return false;
+			}
+		}
+		instanceinternal->position = play_begin;
+
+		xaudio_check(instanceinternal->sourceVoice->SetVolume(instanceinternal->volume));
+		if (instanceinternal->playing)
+		{
+			xaudio_check(instanceinternal->sourceVoice->Start());
+		}
+		return true;
+	}
+	// Destroys the source voice of a sound instance, the instance becomes virtual and keeps the playback position
+	void ReleaseSourceVoice(SoundInstanceInternal* instanceinternal)
+	{
+		if (instanceinternal->sourceVoice == nullptr)
+			return;
+		if (!instanceinternal->stopped)
+		{
+			instanceinternal->position = GetPlaybackPosition(instanceinternal);
+		}
+		instanceinternal->timer.record();
+		if (instanceinternal->stream != nullptr)
+		{
+			// Pending stream jobs must not submit to the voice anymore:
+			std::scoped_lock lck(instanceinternal->stream->locker);
+			instanceinternal->stream->active = false;
+		}
+		instanceinternal->sourceVoice->Stop();
+		instanceinternal->sourceVoice->DestroyVoice(); // no more voice callbacks after this
+		instanceinternal->sourceVoice = nullptr;
+		if (instanceinternal->stream != nullptr)
+		{
+			wi::jobsystem::Wait(instanceinternal->stream->ctx);
+		}
+		if (instanceinternal->virtualizable)
+		{
+			real_voice_count.fetch_sub(1);
+		}
+	}
+	// Decodes the next part of a streaming sound into one of the stream buffers and submits it to the source voice
+	void SubmitStreamBuffer(SoundInstanceInternal* instanceinternal, uint32_t buffer_index)
+	{
+		StreamDecoder& stream = *instanceinternal->stream;
+		std::scoped_lock lck(stream.locker);
+		if (!stream.active || stream.finished)
+			return;
+		const uint32_t samples = stream.Decode(buffer_index);
+		if (samples == 0)
+			return;
+		XAUDIO2_BUFFER buffer = {};
+		buffer.pAudioData = (const BYTE*)stream.buffers[buffer_index].data();
+		buffer.AudioBytes = samples * stream.channels * sizeof(short);
+		buffer.Flags = stream.finished ? XAUDIO2_END_OF_STREAM : 0;
+		buffer.pContext = (void*)uintptr_t(buffer_index + 1); // nullptr is reserved for non-stream buffers
+		xaudio_check(instanceinternal->sourceVoice->SubmitSourceBuffer(&buffer));
+	}
+	void RefillStreamBufferAsync(SoundInstanceInternal* instanceinternal, uint32_t buffer_index)
+	{
+		wi::jobsystem::Execute(instanceinternal->stream->ctx, [instanceinternal, buffer_index](wi::jobsystem::JobArgs args) {
+			SubmitStreamBuffer(instanceinternal, buffer_index);
+		});
+	}
+
 	bool FindChunk(const uint8_t* data, DWORD fourcc, DWORD& dwChunkSize, DWORD& dwChunkDataPosition)
 	{
 		size_t pos = 0;
@@ -338,7 +693,7 @@ namespace wi::audio
 
 	}
 
-	bool CreateSound(const std::string& filename, Sound* sound)
+	bool CreateSound(const std::string& filename, Sound* sound, bool streaming)
 	{
 		wi::vector<uint8_t> filedata;
 		bool success = wi::helper::FileRead(filename, filedata);
@@ -346,9 +701,9 @@ namespace wi::audio
 		{
 			return false;
 		}
-		return CreateSound(filedata.data(), filedata.size(), sound);
+		return CreateSound(filedata.data(), filedata.size(), sound, streaming);
 	}
-	bool CreateSound(const uint8_t* data, size_t size, Sound* sound)
+	bool CreateSound(const uint8_t* data, size_t size, Sound* sound, bool streaming)
 	{
 		if (audio_internal == nullptr || !audio_internal->IsValid())
 			return false;
@@ -397,12 +752,33 @@ namespace wi::audio
 			// Ogg decoder:
 			int channels = 0;
 			int sample_rate = 0;
-			short* output = nullptr;
-			int samples = stb_vorbis_decode_memory(data, (int)size, &channels, &sample_rate, &output);
-			if (samples < 0)
+			if (streaming)
 			{
-				assert(0);
-				return false;
+				// Only the stream info is read now, the sound instances will decode the file incrementally while playing:
+				if (!GetVorbisInfo(data, size, channels, sample_rate, soundinternal->stream_samples))
+				{
+					assert(0);
+					return false;
+				}
+				soundinternal->streaming = true;
+				soundinternal->audioData.resize(size);
+				memcpy(soundinternal->audioData.data(), data, size);
+			}
+			else
+			{
+				short* output = nullptr;
+				int samples = stb_vorbis_decode_memory(data, (int)size, &channels, &sample_rate, &output);
+				if (samples < 0)
+				{
+					assert(0);
+					return false;
+				}
+
+				size_t output_size = size_t(samples * channels) * sizeof(short);
+				soundinternal->audioData.resize(output_size);
+				memcpy(soundinternal->audioData.data(), output, output_size);
+
+				free(output);
 			}
 
 			// WAVEFORMATEX: https://docs.microsoft.com/en-us/previous-versions/dd757713(v=vs.85)?redirectedfrom=MSDN
@@ -412,12 +788,6 @@ namespace wi::audio
 			soundinternal->wfx.wBitsPerSample = sizeof(short) * 8;
 			soundinternal->wfx.nBlockAlign = (WORD)channels * sizeof(short); // is this right?
 			soundinternal->wfx.nAvgBytesPerSec = soundinternal->wfx.nSamplesPerSec * soundinternal->wfx.nBlockAlign;
-
-			size_t output_size = size_t(samples * channels) * sizeof(short);
-			soundinternal->audioData.resize(output_size);
-			memcpy(soundinternal->audioData.data(), output, output_size);
-
-			free(output);
 		}
 
 		return true;
@@ -428,43 +798,19 @@ namespace wi::audio
 			return false;
 		if (sound == nullptr || !sound->IsValid())
 			return false;
-		HRESULT hr;
 		const auto& soundinternal = std::static_pointer_cast<SoundInternal>(sound->internal_state);
 		std::shared_ptr<SoundInstanceInternal> instanceinternal = std::make_shared<SoundInstanceInternal>();
 		instance->internal_state = instanceinternal;
 
 		instanceinternal->audio = audio_internal;
 		instanceinternal->soundinternal = soundinternal;
-
-		XAUDIO2_SEND_DESCRIPTOR SFXSend[] = {
-			{ XAUDIO2_SEND_USEFILTER, instanceinternal->audio->submixVoices[instance->type] },
-			{ XAUDIO2_SEND_USEFILTER, instanceinternal->audio->reverbSubmix }, // this should be last to enable/disable reverb simply
-		};
-		XAUDIO2_VOICE_SENDS SFXSendList = {
-			(instance->IsEnableReverb() && instanceinternal->audio->reverbSubmix != nullptr) ? (uint32_t)arraysize(SFXSend) : 1,
-			SFXSend
-		};
-
-		hr = xaudio_check(instanceinternal->audio->audioEngine->CreateSourceVoice(&instanceinternal->sourceVoice, &soundinternal->wfx,
-			0, XAUDIO2_DEFAULT_FREQ_RATIO, instanceinternal.get(), &SFXSendList, NULL));
-
-		if (FAILED(hr))
-		{
-			return false;
-		}
-
-		instanceinternal->sourceVoice->GetVoiceDetails(&instanceinternal->voiceDetails);
-		
-		instanceinternal->outputMatrix.resize(size_t(instanceinternal->voiceDetails.InputChannels) * size_t(instanceinternal->audio->masteringVoiceDetails.InputChannels));
-		instanceinternal->channelAzimuths.resize(instanceinternal->voiceDetails.InputChannels);
-		for (size_t i = 0; i < instanceinternal->channelAzimuths.size(); ++i)
-		{
-			instanceinternal->channelAzimuths[i] = X3DAUDIO_2PI * float(i) / float(instanceinternal->channelAzimuths.size());
-		}
+		instanceinternal->type = instance->type;
+		instanceinternal->reverb = instance->IsEnableReverb();
+		instanceinternal->virtualizable = instance->IsVirtualizable();
 
 		const uint32_t bytes_per_second = soundinternal->wfx.nSamplesPerSec * soundinternal->wfx.nChannels * sizeof(short);
 		instanceinternal->buffer.pAudioData = soundinternal->audioData.data();
-		instanceinternal->buffer.AudioBytes = (uint32_t)soundinternal->audioData.size();
+		instanceinternal->buffer.AudioBytes = soundinternal->streaming ? uint32_t(soundinternal->stream_samples * soundinternal->wfx.nChannels * sizeof(short)) : (uint32_t)soundinternal->audioData.size();
 		if (instance->begin > 0)
 		{
 			const uint32_t bytes_from_beginning = AlignTo(std::min(instanceinternal->buffer.AudioBytes, uint32_t(instance->begin * bytes_per_second)), 4u);
@@ -486,21 +832,51 @@ namespace wi::audio
 
 		instanceinternal->buffer.Flags = XAUDIO2_END_OF_STREAM;
 		instanceinternal->buffer.LoopCount = instance->IsLooped() ? XAUDIO2_LOOP_INFINITE : 0;
+		instanceinternal->total_samples = instanceinternal->buffer.AudioBytes / (soundinternal->wfx.nChannels * sizeof(short));
 
-		hr = xaudio_check(instanceinternal->sourceVoice->SubmitSourceBuffer(&instanceinternal->buffer));
-
-		if (FAILED(hr))
+		if (soundinternal->streaming)
 		{
-			return false;
+			// The buffer only describes the playback region, the audio data comes from the stream decoder:
+			instanceinternal->stream = std::make_unique<StreamDecoder>();
+			StreamDecoder& stream = *instanceinternal->stream;
+			if (!stream.Open(soundinternal->audioData.data(), soundinternal->audioData.size()))
+			{
+				assert(0);
+				return false;
+			}
+			stream.begin = uint32_t((instanceinternal->buffer.pAudioData - soundinternal->audioData.data()) / (soundinternal->wfx.nChannels * sizeof(short)));
+			stream.total_samples = instanceinternal->total_samples;
+			stream.loop_begin = instanceinternal->buffer.LoopBegin;
+			stream.loop_end = instanceinternal->buffer.LoopLength > 0 ? (instanceinternal->buffer.LoopBegin + instanceinternal->buffer.LoopLength) : instanceinternal->total_samples;
+			instanceinternal->buffer.pAudioData = nullptr;
 		}
 
-		return true;
+		if (instanceinternal->virtualizable)
+			return true; // the source voice is created when the instance becomes real
+
+		return CreateSourceVoice(instanceinternal.get());
 	}
 	void Play(SoundInstance* instance)
 	{
 		if (instance != nullptr && instance->IsValid())
 		{
 			auto instanceinternal = to_internal(instance);
+			const bool started = !instanceinternal->playing;
+			if (started)
+			{
+				instanceinternal->playing = true;
+				instanceinternal->stopped = false;
+				instanceinternal->timer.record();
+			}
+			if (instanceinternal->sourceVoice == nullptr)
+			{
+				// Virtual instance only gets a real voice here when it starts and there is budget, otherwise UpdateVoices() decides:
+				if (started && (!instanceinternal->virtualizable || real_voice_count.load() < max_real_voices) && GetPlaybackPosition(instanceinternal) < instanceinternal->total_samples)
+				{
+					CreateSourceVoice(instanceinternal);
+				}
+				return;
+			}
 			xaudio_check(instanceinternal->sourceVoice->Start());
 
 		}
@@ -510,6 +886,13 @@ namespace wi::audio
 		if (instance != nullptr && instance->IsValid())
 		{
 			auto instanceinternal = to_internal(instance);
+			if (instanceinternal->sourceVoice == nullptr)
+			{
+				GetPlaybackPosition(instanceinternal); // advance the virtual position until now
+				instanceinternal->playing = false;
+				return;
+			}
+			instanceinternal->playing = false;
 			xaudio_check(instanceinternal->sourceVoice->Stop()); // preserves cursor position
 
 		}
@@ -519,6 +902,17 @@ namespace wi::audio
 		if (instance != nullptr && instance->IsValid())
 		{
 			auto instanceinternal = to_internal(instance);
+			instanceinternal->playing = false;
+			instanceinternal->stopped = true;
+			instanceinternal->loop_exited = false;
+			instanceinternal->position = 0;
+			if (instanceinternal->sourceVoice == nullptr)
+				return;
+			if (instanceinternal->stream != nullptr)
+			{
+				ReleaseSourceVoice(instanceinternal); // the stream will be restarted by Play()
+				return;
+			}
 			xaudio_check(instanceinternal->sourceVoice->Stop()); // preserves cursor position
 
 			xaudio_check(instanceinternal->sourceVoice->FlushSourceBuffers()); // reset submitted audio buffer
@@ -542,6 +936,7 @@ namespace wi::audio
 		else
 		{
 			auto instanceinternal = to_internal(instance);
+			instanceinternal->volume = volume;
 			if (instanceinternal->sourceVoice != nullptr)
 				xaudio_check(instanceinternal->sourceVoice->SetVolume(volume));
 		}
@@ -559,6 +954,8 @@ namespace wi::audio
 			auto instanceinternal = to_internal(instance);
 			if(instanceinternal->sourceVoice != nullptr)
 				instanceinternal->sourceVoice->GetVolume(&volume);
+			else
+				volume = instanceinternal->volume;
 		}
 		return volume;
 	}
@@ -569,6 +966,17 @@ namespace wi::audio
 			auto instanceinternal = to_internal(instance);
 			if (instanceinternal->buffer.LoopCount == 0)
 				return;
+			if (instanceinternal->sourceVoice == nullptr)
+			{
+				GetPlaybackPosition(instanceinternal); // advance the virtual position with looping until now
+				instanceinternal->loop_exited = true;
+				return;
+			}
+			if (instanceinternal->stream != nullptr)
+			{
+				instanceinternal->stream->looped = false; // the decoder continues after the loop region
+				return;
+			}
 			xaudio_check(instanceinternal->sourceVoice->ExitLoop());
 
 			if (instanceinternal->ended)
@@ -583,6 +991,8 @@ namespace wi::audio
 		if (instance != nullptr && instance->IsValid())
 		{
 			auto instanceinternal = to_internal(instance);
+			if (instanceinternal->sourceVoice == nullptr || instanceinternal->stream != nullptr)
+				return instanceinternal->stopped || GetPlaybackPosition(instanceinternal) >= instanceinternal->total_samples;
 			return instanceinternal->ended;
 		}
 		return false;
@@ -595,9 +1005,12 @@ namespace wi::audio
 		{
 			auto soundinternal = to_internal(sound);
 			info.channel_count = soundinternal->wfx.nChannels;
-			info.samples = (const short*)soundinternal->audioData.data();
-			info.sample_count = soundinternal->audioData.size() / (info.channel_count * sizeof(short));
 			info.sample_rate = soundinternal->wfx.nSamplesPerSec;
+			if (!soundinternal->streaming)
+			{
+				info.samples = (const short*)soundinternal->audioData.data();
+				info.sample_count = soundinternal->audioData.size() / (info.channel_count * sizeof(short));
+			}
 		}
 		return info;
 	}
@@ -606,10 +1019,11 @@ namespace wi::audio
 		if (instance != nullptr && instance->IsValid())
 		{
 			auto instanceinternal = to_internal(instance);
+			if (instanceinternal->sourceVoice == nullptr)
+				return uint64_t(GetPlaybackPosition(instanceinternal));
 			XAUDIO2_VOICE_STATE state = {};
-			if (instanceinternal->sourceVoice != nullptr)
-				instanceinternal->sourceVoice->GetState(&state, 0);
-			return state.SamplesPlayed;
+			instanceinternal->sourceVoice->GetState(&state, 0);
+			return uint64_t(instanceinternal->position) + state.SamplesPlayed; // the voice could have been started from a later position
 		}
 		return 0ull;
 	}
@@ -631,6 +1045,8 @@ namespace wi::audio
 		if (instance != nullptr && instance->IsValid())
 		{
 			auto instanceinternal = to_internal(instance);
+			if (instanceinternal->sourceVoice == nullptr)
+				return; // virtual
 
 			X3DAUDIO_LISTENER listener = {};
 			listener.Position = instance3D.listenerPos;
@@ -694,6 +1110,86 @@ namespace wi::audio
 		}
 	}
 
+	void Seek(SoundInstance* instance, float seconds)
+	{
+		if (instance != nullptr && instance->IsValid())
+		{
+			auto instanceinternal = to_internal(instance);
+			if (instanceinternal->total_samples == 0)
+				return;
+			// The voice is recreated from the new position, just like when a virtual instance becomes real:
+			const bool real = instanceinternal->sourceVoice != nullptr;
+			ReleaseSourceVoice(instanceinternal);
+			instanceinternal->position = std::min(double(std::max(0.0f, seconds)) * instanceinternal->soundinternal->wfx.nSamplesPerSec, double(instanceinternal->total_samples - 1));
+			instanceinternal->timer.record();
+			if (real)
+			{
+				CreateSourceVoice(instanceinternal);
+			}
+		}
+	}
+	bool IsStreaming(const Sound* sound)
+	{
+		return sound != nullptr && sound->IsValid() && to_internal(sound)->streaming;
+	}
+
+	void UpdateVoices(SoundInstance* const* instances, const SoundInstance3D* const* instances3D, size_t count)
+	{
+		wi::vector<VoiceCandidate> candidates;
+		candidates.reserve(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			SoundInstance* instance = instances[i];
+			if (instance == nullptr || !instance->IsValid())
+				continue;
+			auto instanceinternal = to_internal(instance);
+			if (!instanceinternal->virtualizable)
+				continue;
+			const float audibility = ComputeAudibility(instanceinternal->volume, instances3D == nullptr ? nullptr : instances3D[i]);
+			if (!instanceinternal->playing || audibility < VOICE_AUDIBILITY_THRESHOLD || GetPlaybackPosition(instanceinternal) >= instanceinternal->total_samples)
+			{
+				ReleaseSourceVoice(instanceinternal);
+				continue;
+			}
+			VoiceCandidate& candidate = candidates.emplace_back();
+			candidate.index = i;
+			candidate.score = audibility * instance->priority * (instanceinternal->sourceVoice != nullptr ? VOICE_HYSTERESIS : 1.0f);
+		}
+
+		const size_t real_count = SelectRealVoices(candidates);
+		for (size_t i = real_count; i < candidates.size(); ++i)
+		{
+			ReleaseSourceVoice(to_internal(instances[candidates[i].index]));
+		}
+		for (size_t i = 0; i < real_count; ++i)
+		{
+			auto instanceinternal = to_internal(instances[candidates[i].index]);
+			if (instanceinternal->sourceVoice == nullptr && real_voice_count.load() < max_real_voices)
+			{
+				CreateSourceVoice(instanceinternal);
+			}
+		}
+
+		if (instances3D != nullptr)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (instances3D[i] != nullptr)
+				{
+					Update3D(instances[i], *instances3D[i]);
+				}
+			}
+		}
+	}
+	bool IsVirtual(const SoundInstance* instance)
+	{
+		if (instance != nullptr && instance->IsValid())
+		{
+			return to_internal(instance)->sourceVoice == nullptr;
+		}
+		return false;
+	}
+
 	void SetReverb(REVERB_PRESET preset)
 	{
 		XAUDIO2FX_REVERB_PARAMETERS native;
@@ -889,8 +1385,26 @@ namespace wi::audio
 	struct SoundInternal{
 		std::shared_ptr<AudioInternal> audio;
 		FAudioWaveFormatEx wfx = {};
-		wi::vector<uint8_t> audioData;
+		wi::vector<uint8_t> audioData; // PCM data, or the whole Ogg file when streaming
+		bool streaming = false;
+		uint32_t stream_samples = 0;
 	};
+	struct SoundInstanceInternal;
+	void ReleaseSourceVoice(SoundInstanceInternal* instanceinternal);
+	void SubmitStreamBuffer(SoundInstanceInternal* instanceinternal, uint32_t buffer_index);
+	void RefillStreamBufferAsync(SoundInstanceInternal* instanceinternal, uint32_t buffer_index);
+	struct StreamCallback : public FAudioVoiceCallback
+	{
+		SoundInstanceInternal* instance = nullptr;
+	};
+	static void FAUDIOCALL OnStreamBufferEnd(FAudioVoiceCallback* callback, void* pBufferContext)
+	{
+		if (pBufferContext != nullptr)
+		{
+			// A stream buffer was consumed, it will be refilled with the continuation of the stream:
+			RefillStreamBufferAsync(static_cast<StreamCallback*>(callback)->instance, uint32_t(uintptr_t(pBufferContext) - 1));
+		}
+	}
 	struct SoundInstanceInternal{
 		std::shared_ptr<AudioInternal> audio;
 		std::shared_ptr<SoundInternal> soundinternal;
@@ -901,9 +1415,23 @@ namespace wi::audio
 		FAudioBuffer buffer = {};
 		bool ended = true;
 
+		// Virtual voice state, the source voice is only created when the instance is real:
+		SUBMIX_TYPE type = SUBMIX_TYPE_SOUNDEFFECT;
+		bool reverb = false;
+		bool virtualizable = false;
+		bool playing = false;
+		bool stopped = true;
+		bool loop_exited = false;
+		float volume = 1;
+		uint32_t total_samples = 0;
+		double position = 0; // sample position of a virtual instance, or the position where the source voice started playing from
+		wi::Timer timer; // advances the position of a playing virtual instance
+		std::unique_ptr<StreamDecoder> stream; // only for streaming sounds
+		StreamCallback stream_callback = {};
+
 		~SoundInstanceInternal(){
-			FAudioSourceVoice_Stop(sourceVoice, 0, FAUDIO_COMMIT_NOW);
-			FAudioVoice_DestroyVoice(sourceVoice);
+			stopped = true;
+			ReleaseSourceVoice(this);
 		}
 	};
 
@@ -916,6 +1444,154 @@ namespace wi::audio
 		return static_cast<SoundInstanceInternal*>(param->internal_state.get());
 	}
 
+	// Returns the current sample position of the playback in the buffer, for both real and virtual instances
+	double GetPlaybackPosition(SoundInstanceInternal* instanceinternal)
+	{
+		const bool looped = instanceinternal->buffer.LoopCount > 0 && !instanceinternal->loop_exited;
+		if (instanceinternal->sourceVoice != nullptr)
+		{
+			FAudioVoiceState state = {};
+			FAudioSourceVoice_GetState(instanceinternal->sourceVoice, &state, 0);
+			if (state.BuffersQueued == 0 && (instanceinternal->stream == nullptr || instanceinternal->stream->finished))
+				return double(instanceinternal->total_samples); // ended
+			return WrapSamplePosition(instanceinternal->position + double(state.SamplesPlayed), instanceinternal->buffer, instanceinternal->total_samples, looped);
+		}
+		if (instanceinternal->playing)
+		{
+			instanceinternal->position += instanceinternal->timer.record_elapsed_seconds() * instanceinternal->soundinternal->wfx.nSamplesPerSec;
+		}
+		instanceinternal->position = WrapSamplePosition(instanceinternal->position, instanceinternal->buffer, instanceinternal->total_samples, looped);
+		return instanceinternal->position;
+	}
+	// Creates the source voice of a sound instance, the playback continues from the position of the instance
+	bool CreateSourceVoice(SoundInstanceInternal* instanceinternal)
+	{
+		SoundInternal* soundinternal = instanceinternal->soundinternal.get();
+
+		FAudioSendDescriptor SFXSend[] = {
+			{ FAUDIO_SEND_USEFILTER, instanceinternal->audio->submixVoices[instanceinternal->type] },
+			{ FAUDIO_SEND_USEFILTER, instanceinternal->audio->reverbSubmix }, // this should be last to enable/disable reverb simply
+		};
+
+		FAudioVoiceSends SFXSendList = {
+			instanceinternal->reverb ? (uint32_t)arraysize(SFXSend) : 1,
+			SFXSend
+		};
+
+		FAudioVoiceCallback* callback = instanceinternal->stream != nullptr ? &instanceinternal->stream_callback : NULL;
+		uint32_t res = FAudio_CreateSourceVoice(instanceinternal->audio->audioEngine, &instanceinternal->sourceVoice, &soundinternal->wfx,
+			0, FAUDIO_DEFAULT_FREQ_RATIO, callback, &SFXSendList, NULL);
+		if(res != 0){
+			assert(0);
+			instanceinternal->sourceVoice = nullptr;
+			return false;
+		}
+		if (instanceinternal->virtualizable)
+		{
+			real_voice_count.fetch_add(1);
+		}
+
+		FAudioVoice_GetVoiceDetails(instanceinternal->sourceVoice, &instanceinternal->voiceDetails);
+		instanceinternal->outputMatrix.resize(size_t(instanceinternal->voiceDetails.InputChannels) * size_t(instanceinternal->audio->masteringVoiceDetails.InputChannels));
+		instanceinternal->channelAzimuths.resize(instanceinternal->voiceDetails.InputChannels);
+		for (size_t i = 0; i < instanceinternal->channelAzimuths.size(); ++i)
+		{
+			instanceinternal->channelAzimuths[i] = F3DAUDIO_2PI * float(i) / float(instanceinternal->channelAzimuths.size());
+		}
+
+		const uint32_t play_begin = std::min(uint32_t(instanceinternal->position), instanceinternal->total_samples - 1);
+		if (instanceinternal->stream != nullptr)
+		{
+			// The stream is decoded from the playback position, the first buffer is decoded immediately, the others on the streaming thread:
+			StreamDecoder& stream = *instanceinternal->stream;
+			stream.looped = instanceinternal->buffer.LoopCount > 0 && !instanceinternal->loop_exited;
+			stream.Seek(play_begin);
+			stream.active = true;
+			SubmitStreamBuffer(instanceinternal, 0);
+			for (uint32_t i = 1; i < STREAM_BUFFER_COUNT; ++i)
+			{
+				RefillStreamBufferAsync(instanceinternal, i);
+			}
+		}
+		else
+		{
+			FAudioBuffer buffer = instanceinternal->buffer;
+			buffer.PlayBegin = play_begin;
+			if (instanceinternal->loop_exited)
+			{
+				buffer.LoopBegin = 0;
+				buffer.LoopLength = 0;
+				buffer.LoopCount = 0;
+			}
+			res = FAudioSourceVoice_SubmitSourceBuffer(instanceinternal->sourceVoice, &buffer, nullptr);
+			if(res != 0){
+				assert(0);
+				ReleaseSourceVoice(instanceinternal);
+				return false;
+			}
+		}
+		instanceinternal->position = play_begin;
+
+		FAudioVoice_SetVolume(instanceinternal->sourceVoice, instanceinternal->volume, FAUDIO_COMMIT_NOW);
+		if (instanceinternal->playing)
+		{
+			FAudioSourceVoice_Start(instanceinternal->sourceVoice, 0, FAUDIO_COMMIT_NOW);
+		}
+		return true;
+	}
+	// Destroys the source voice of a sound instance, the instance becomes virtual and keeps the playback position
+	void ReleaseSourceVoice(SoundInstanceInternal* instanceinternal)
+	{
+		if (instanceinternal->sourceVoice == nullptr)
+			return;
+		if (!instanceinternal->stopped)
+		{
+			instanceinternal->position = GetPlaybackPosition(instanceinternal);
+		}
+		instanceinternal->timer.record();
+		if (instanceinternal->stream != nullptr)
+		{
+			// Pending stream jobs must not submit to the voice anymore:
+			std::scoped_lock lck(instanceinternal->stream->locker);
+			instanceinternal->stream->active = false;
+		}
+		FAudioSourceVoice_Stop(instanceinternal->sourceVoice, 0, FAUDIO_COMMIT_NOW);
+		FAudioVoice_DestroyVoice(instanceinternal->sourceVoice); // no more voice callbacks after this
+		instanceinternal->sourceVoice = nullptr;
+		if (instanceinternal->stream != nullptr)
+		{
+			wi::jobsystem::Wait(instanceinternal->stream->ctx);
+		}
+		if (instanceinternal->virtualizable)
+		{
+			real_voice_count.fetch_sub(1);
+		}
+	}
+	// Decodes the next part of a streaming sound into one of the stream buffers and submits it to the source voice
+	void SubmitStreamBuffer(SoundInstanceInternal* instanceinternal, uint32_t buffer_index)
+	{
+		StreamDecoder& stream = *instanceinternal->stream;
+		std::scoped_lock lck(stream.locker);
+		if (!stream.active || stream.finished)
+			return;
+		const uint32_t samples = stream.Decode(buffer_index);
+		if (samples == 0)
+			return;
+		FAudioBuffer buffer = {};
+		buffer.pAudioData = (const uint8_t*)stream.buffers[buffer_index].data();
+		buffer.AudioBytes = samples * stream.channels * sizeof(short);
+		buffer.Flags = stream.finished ? FAUDIO_END_OF_STREAM : 0;
+		buffer.pContext = (void*)uintptr_t(buffer_index + 1); // nullptr is reserved for non-stream buffers
+		uint32_t res = FAudioSourceVoice_SubmitSourceBuffer(instanceinternal->sourceVoice, &buffer, nullptr);
+		assert(res == 0);
+	}
+	void RefillStreamBufferAsync(SoundInstanceInternal* instanceinternal, uint32_t buffer_index)
+	{
+		wi::jobsystem::Execute(instanceinternal->stream->ctx, [instanceinternal, buffer_index](wi::jobsystem::JobArgs args) {
+			SubmitStreamBuffer(instanceinternal, buffer_index);
+		});
+	}
+
 	bool FindChunk(const uint8_t* data, uint32_t fourcc, uint32_t& dwChunkSize, uint32_t& dwChunkDataPosition)
 	{
 		size_t pos = 0;
@@ -966,16 +1642,16 @@ namespace wi::audio
 
 	}
 
-	bool CreateSound(const std::string& filename, Sound* sound) { 
+	bool CreateSound(const std::string& filename, Sound* sound, bool streaming) { 
 		wi::vector<uint8_t> filedata;
 		bool success = wi::helper::FileRead(filename, filedata);
 		if (!success)
 		{
 			return false;
 		}
-		return CreateSound(filedata.data(), filedata.size(), sound);
+		return CreateSound(filedata.data(), filedata.size(), sound, streaming);
 	}
-	bool CreateSound(const uint8_t* data, size_t size, Sound* sound)
+	bool CreateSound(const uint8_t* data, size_t size, Sound* sound, bool streaming)
 	{
 		if (audio_internal == nullptr || !audio_internal->IsValid())
 			return false;
@@ -1024,12 +1700,33 @@ namespace wi::audio
 			// Ogg decoder:
 			int channels = 0;
 			int sample_rate = 0;
-			short* output = nullptr;
-			int samples = stb_vorbis_decode_memory(data, (int)size, &channels, &sample_rate, &output);
-			if (samples < 0)
+			if (streaming)
 			{
-				assert(0);
-				return false;
+				// Only the stream info is read now, the sound instances will decode the file incrementally while playing:
+				if (!GetVorbisInfo(data, size, channels, sample_rate, soundinternal->stream_samples))
+				{
+					assert(0);
+					return false;
+				}
+				soundinternal->streaming = true;
+				soundinternal->audioData.resize(size);
+				memcpy(soundinternal->audioData.data(), data, size);
+			}
+			else
+			{
+				short* output = nullptr;
+				int samples = stb_vorbis_decode_memory(data, (int)size, &channels, &sample_rate, &output);
+				if (samples < 0)
+				{
+					assert(0);
+					return false;
+				}
+
+				size_t output_size = size_t(samples * channels) * sizeof(short);
+				soundinternal->audioData.resize(output_size);
+				memcpy(soundinternal->audioData.data(), output, output_size);
+
+				free(output);
 			}
 
 			// WAVEFORMATEX: https://docs.microsoft.com/en-us/previous-versions/dd757713(v=vs.85)?redirectedfrom=MSDN
@@ -1039,12 +1736,6 @@ namespace wi::audio
 			soundinternal->wfx.wBitsPerSample = sizeof(short) * 8;
 			soundinternal->wfx.nBlockAlign = (uint16_t)channels * sizeof(short); // is this right?
 			soundinternal->wfx.nAvgBytesPerSec = soundinternal->wfx.nSamplesPerSec * soundinternal->wfx.nBlockAlign;
-
-			size_t output_size = size_t(samples * channels) * sizeof(short);
-			soundinternal->audioData.resize(output_size);
-			memcpy(soundinternal->audioData.data(), output, output_size);
-
-			free(output);
 		}
 
 		return true;
@@ -1055,42 +1746,19 @@ namespace wi::audio
 			return false;
 		if (sound == nullptr || !sound->IsValid())
 			return false;
-		uint32_t res;
 		const auto& soundinternal = std::static_pointer_cast<SoundInternal>(sound->internal_state);
 		std::shared_ptr<SoundInstanceInternal> instanceinternal = std::make_shared<SoundInstanceInternal>();
 		instance->internal_state = instanceinternal;
 
 		instanceinternal->audio = audio_internal;
 		instanceinternal->soundinternal = soundinternal;
-
-		FAudioSendDescriptor SFXSend[] = {
-			{ FAUDIO_SEND_USEFILTER, instanceinternal->audio->submixVoices[instance->type] },
-			{ FAUDIO_SEND_USEFILTER, instanceinternal->audio->reverbSubmix }, // this should be last to enable/disable reverb simply
-		};
-
-		FAudioVoiceSends SFXSendList = {
-			instance->IsEnableReverb() ? (uint32_t)arraysize(SFXSend) : 1,
-			SFXSend
-		};
-		
-		res = FAudio_CreateSourceVoice(instanceinternal->audio->audioEngine, &instanceinternal->sourceVoice, &soundinternal->wfx,
-			0, FAUDIO_DEFAULT_FREQ_RATIO, NULL, &SFXSendList, NULL);
-		if(res != 0){
-			assert(0);
-			return false;
-		}
-
-		FAudioVoice_GetVoiceDetails(instanceinternal->sourceVoice, &instanceinternal->voiceDetails);
-		instanceinternal->outputMatrix.resize(size_t(instanceinternal->voiceDetails.InputChannels) * size_t(instanceinternal->audio->masteringVoiceDetails.InputChannels));
-		instanceinternal->channelAzimuths.resize(instanceinternal->voiceDetails.InputChannels);
-		for (size_t i = 0; i < instanceinternal->channelAzimuths.size(); ++i)
-		{
-			instanceinternal->channelAzimuths[i] = F3DAUDIO_2PI * float(i) / float(instanceinternal->channelAzimuths.size());
-		}
+		instanceinternal->type = instance->type;
+		instanceinternal->reverb = instance->IsEnableReverb();
+		instanceinternal->virtualizable = instance->IsVirtualizable();
 
 		const uint32_t bytes_per_second = soundinternal->wfx.nSamplesPerSec * soundinternal->wfx.nChannels * sizeof(short);
 		instanceinternal->buffer.pAudioData = soundinternal->audioData.data();
-		instanceinternal->buffer.AudioBytes = (uint32_t)soundinternal->audioData.size();
+		instanceinternal->buffer.AudioBytes = soundinternal->streaming ? uint32_t(soundinternal->stream_samples * soundinternal->wfx.nChannels * sizeof(short)) : (uint32_t)soundinternal->audioData.size();
 		if (instance->begin > 0)
 		{
 			const uint32_t bytes_from_beginning = AlignTo(std::min(instanceinternal->buffer.AudioBytes, uint32_t(instance->begin * bytes_per_second)), 4u);
@@ -1112,19 +1780,52 @@ namespace wi::audio
 
 		instanceinternal->buffer.Flags = FAUDIO_END_OF_STREAM;
 		instanceinternal->buffer.LoopCount = instance->IsLooped() ? FAUDIO_LOOP_INFINITE : 0;
+		instanceinternal->total_samples = instanceinternal->buffer.AudioBytes / (soundinternal->wfx.nChannels * sizeof(short));
 
-		res = FAudioSourceVoice_SubmitSourceBuffer(instanceinternal->sourceVoice, &(instanceinternal->buffer), nullptr);
-		if(res != 0){
-			assert(0);
-			return false;
+		if (soundinternal->streaming)
+		{
+			// The buffer only describes the playback region, the audio data comes from the stream decoder:
+			instanceinternal->stream = std::make_unique<StreamDecoder>();
+			StreamDecoder& stream = *instanceinternal->stream;
+			if (!stream.Open(soundinternal->audioData.data(), soundinternal->audioData.size()))
+			{
+				assert(0);
+				return false;
+			}
+			stream.begin = uint32_t((instanceinternal->buffer.pAudioData - soundinternal->audioData.data()) / (soundinternal->wfx.nChannels * sizeof(short)));
+			stream.total_samples = instanceinternal->total_samples;
+			stream.loop_begin = instanceinternal->buffer.LoopBegin;
+			stream.loop_end = instanceinternal->buffer.LoopLength > 0 ? (instanceinternal->buffer.LoopBegin + instanceinternal->buffer.LoopLength) : instanceinternal->total_samples;
+			instanceinternal->buffer.pAudioData = nullptr;
+			instanceinternal->stream_callback.OnBufferEnd = OnStreamBufferEnd;
+			instanceinternal->stream_callback.instance = instanceinternal.get();
 		}
 
-		return true;
+		if (instanceinternal->virtualizable)
+			return true; // the source voice is created when the instance becomes real
+
+		return CreateSourceVoice(instanceinternal.get());
 	}
 
 	void Play(SoundInstance* instance) {
 		if (instance != nullptr && instance->IsValid()){
 			auto instanceinternal = to_internal(instance);
+			const bool started = !instanceinternal->playing;
+			if (started)
+			{
+				instanceinternal->playing = true;
+				instanceinternal->stopped = false;
+				instanceinternal->timer.record();
+			}
+			if (instanceinternal->sourceVoice == nullptr)
+			{
+				// Virtual instance only gets a real voice here when it starts and there is budget, otherwise UpdateVoices() decides:
+				if (started && (!instanceinternal->virtualizable || real_voice_count.load() < max_real_voices) && GetPlaybackPosition(instanceinternal) < instanceinternal->total_samples)
+				{
+					CreateSourceVoice(instanceinternal);
+				}
+				return;
+			}
 			uint32_t res = FAudioSourceVoice_Start(instanceinternal->sourceVoice, 0, FAUDIO_COMMIT_NOW);
 			assert(res == 0);
 		}
@@ -1132,6 +1833,13 @@ namespace wi::audio
 	void Pause(SoundInstance* instance) {
 		if (instance != nullptr && instance->IsValid()){
 			auto instanceinternal = to_internal(instance);
+			if (instanceinternal->sourceVoice == nullptr)
+			{
+				GetPlaybackPosition(instanceinternal); // advance the virtual position until now
+				instanceinternal->playing = false;
+				return;
+			}
+			instanceinternal->playing = false;
 			uint32_t res = FAudioSourceVoice_Stop(instanceinternal->sourceVoice, 0, FAUDIO_COMMIT_NOW); // preserves cursor position
 			assert(res == 0);
 		}
@@ -1139,6 +1847,17 @@ namespace wi::audio
 	void Stop(SoundInstance* instance) {
 		if (instance != nullptr && instance->IsValid()){
 			auto instanceinternal = to_internal(instance);
+			instanceinternal->playing = false;
+			instanceinternal->stopped = true;
+			instanceinternal->loop_exited = false;
+			instanceinternal->position = 0;
+			if (instanceinternal->sourceVoice == nullptr)
+				return;
+			if (instanceinternal->stream != nullptr)
+			{
+				ReleaseSourceVoice(instanceinternal); // the stream will be restarted by Play()
+				return;
+			}
 			uint32_t res = FAudioSourceVoice_Stop(instanceinternal->sourceVoice, 0, FAUDIO_COMMIT_NOW); // preserves cursor position
 			assert(res == 0);
 			res = FAudioSourceVoice_FlushSourceBuffers(instanceinternal->sourceVoice); // reset submitted audio buffer
@@ -1156,6 +1875,9 @@ namespace wi::audio
 		}
 		else {
 			auto instanceinternal = to_internal(instance);
+			instanceinternal->volume = volume;
+			if (instanceinternal->sourceVoice == nullptr)
+				return;
 			uint32_t res = FAudioVoice_SetVolume(instanceinternal->sourceVoice, volume, FAUDIO_COMMIT_NOW);
 			assert(res == 0);
 		}
@@ -1167,6 +1889,8 @@ namespace wi::audio
 		}
 		else {
 			auto instanceinternal = to_internal(instance);
+			if (instanceinternal->sourceVoice == nullptr)
+				return instanceinternal->volume;
 			FAudioVoice_GetVolume(instanceinternal->sourceVoice, &volume);
 		}
 		return volume;
@@ -1176,6 +1900,17 @@ namespace wi::audio
 			auto instanceinternal = to_internal(instance);
 			if (instanceinternal->buffer.LoopCount == 0)
 				return;
+			if (instanceinternal->sourceVoice == nullptr)
+			{
+				GetPlaybackPosition(instanceinternal); // advance the virtual position with looping until now
+				instanceinternal->loop_exited = true;
+				return;
+			}
+			if (instanceinternal->stream != nullptr)
+			{
+				instanceinternal->stream->looped = false; // the decoder continues after the loop region
+				return;
+			}
 			uint32_t res = FAudioSourceVoice_ExitLoop(instanceinternal->sourceVoice, FAUDIO_COMMIT_NOW);
 			assert(res == 0);
 			if (instanceinternal->ended)
@@ -1191,6 +1926,8 @@ namespace wi::audio
 		if (instance != nullptr && instance->IsValid())
 		{
 			auto instanceinternal = to_internal(instance);
+			if (instanceinternal->sourceVoice == nullptr || instanceinternal->stream != nullptr)
+				return instanceinternal->stopped || GetPlaybackPosition(instanceinternal) >= instanceinternal->total_samples;
 			return instanceinternal->ended;
 		}
 		return false;
@@ -1202,8 +1939,11 @@ namespace wi::audio
 		if (sound != nullptr && sound->IsValid())
 		{
 			auto soundinternal = to_internal(sound);
-			info.samples = (const short*)soundinternal->audioData.data();
-			info.sample_count = soundinternal->audioData.size() / sizeof(short);
+			if (!soundinternal->streaming)
+			{
+				info.samples = (const short*)soundinternal->audioData.data();
+				info.sample_count = soundinternal->audioData.size() / sizeof(short);
+			}
 			info.sample_rate = soundinternal->wfx.nSamplesPerSec;
 			info.channel_count = soundinternal->wfx.nChannels;
 		}
@@ -1214,9 +1954,11 @@ namespace wi::audio
 		if (instance != nullptr && instance->IsValid())
 		{
 			auto instanceinternal = to_internal(instance);
+			if (instanceinternal->sourceVoice == nullptr)
+				return uint64_t(GetPlaybackPosition(instanceinternal));
 			FAudioVoiceState state = {};
 			FAudioSourceVoice_GetState(instanceinternal->sourceVoice, &state, 0);
-			return state.SamplesPlayed;
+			return uint64_t(instanceinternal->position) + state.SamplesPlayed; // the voice could have been started from a later position
 		}
 		return 0ull;
 	}
@@ -1234,6 +1976,8 @@ namespace wi::audio
 	void Update3D(SoundInstance* instance, const SoundInstance3D& instance3D) {
 		if (instance != nullptr && instance->IsValid()){
 			auto instanceinternal = to_internal(instance);
+			if (instanceinternal->sourceVoice == nullptr)
+				return; // virtual
 			F3DAUDIO_LISTENER listener = {};
 			listener.Position = (F3DAUDIO_VECTOR){ instance3D.listenerPos.x, instance3D.listenerPos.y, instance3D.listenerPos.z };
 			listener.OrientFront = (F3DAUDIO_VECTOR){ instance3D.listenerFront.x, instance3D.listenerFront.y, instance3D.listenerFront.z };
@@ -1299,6 +2043,86 @@ namespace wi::audio
 		}
 	}
 
+	void Seek(SoundInstance* instance, float seconds)
+	{
+		if (instance != nullptr && instance->IsValid())
+		{
+			auto instanceinternal = to_internal(instance);
+			if (instanceinternal->total_samples == 0)
+				return;
+			// The voice is recreated from the new position, just like when a virtual instance becomes real:
+			const bool real = instanceinternal->sourceVoice != nullptr;
+			ReleaseSourceVoice(instanceinternal);
+			instanceinternal->position = std::min(double(std::max(0.0f, seconds)) * instanceinternal->soundinternal->wfx.nSamplesPerSec, double(instanceinternal->total_samples - 1));
+			instanceinternal->timer.record();
+			if (real)
+			{
+				CreateSourceVoice(instanceinternal);
+			}
+		}
+	}
+	bool IsStreaming(const Sound* sound)
+	{
+		return sound != nullptr && sound->IsValid() && to_internal(sound)->streaming;
+	}
+
+	void UpdateVoices(SoundInstance* const* instances, const SoundInstance3D* const* instances3D, size_t count)
+	{
+		wi::vector<VoiceCandidate> candidates;
+		candidates.reserve(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			SoundInstance* instance = instances[i];
+			if (instance == nullptr || !instance->IsValid())
+				continue;
+			auto instanceinternal = to_internal(instance);
+			if (!instanceinternal->virtualizable)
+				continue;
+			const float audibility = ComputeAudibility(instanceinternal->volume, instances3D == nullptr ? nullptr : instances3D[i]);
+			if (!instanceinternal->playing || audibility < VOICE_AUDIBILITY_THRESHOLD || GetPlaybackPosition(instanceinternal) >= instanceinternal->total_samples)
+			{
+				ReleaseSourceVoice(instanceinternal);
+				continue;
+			}
+			VoiceCandidate& candidate = candidates.emplace_back();
+			candidate.index = i;
+			candidate.score = audibility * instance->priority * (instanceinternal->sourceVoice != nullptr ? VOICE_HYSTERESIS : 1.0f);
+		}
+
+		const size_t real_count = SelectRealVoices(candidates);
+		for (size_t i = real_count; i < candidates.size(); ++i)
+		{
+			ReleaseSourceVoice(to_internal(instances[candidates[i].index]));
+		}
+		for (size_t i = 0; i < real_count; ++i)
+		{
+			auto instanceinternal = to_internal(instances[candidates[i].index]);
+			if (instanceinternal->sourceVoice == nullptr && real_voice_count.load() < max_real_voices)
+			{
+				CreateSourceVoice(instanceinternal);
+			}
+		}
+
+		if (instances3D != nullptr)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				if (instances3D[i] != nullptr)
+				{
+					Update3D(instances[i], *instances3D[i]);
+				}
+			}
+		}
+	}
+	bool IsVirtual(const SoundInstance* instance)
+	{
+		if (instance != nullptr && instance->IsValid())
+		{
+			return to_internal(instance)->sourceVoice == nullptr;
+		}
+		return false;
+	}
+
 	void SetReverb(REVERB_PRESET preset) {
 		FAudioFXReverbParameters native;
 		ReverbConvertI3DL2ToNative(&reverbPresets[preset], &native);
@@ -1315,8 +2139,8 @@ namespace wi::audio
 {
 	void Initialize() {}
 
-	bool CreateSound(const std::string& filename, Sound* sound) { return false; }
-	bool CreateSound(const uint8_t* data, size_t size, Sound* sound) { return false; }
+	bool CreateSound(const std::string& filename, Sound* sound, bool streaming) { return false; }
+	bool CreateSound(const uint8_t* data, size_t size, Sound* sound, bool streaming) { return false; }
 	bool CreateSoundInstance(const Sound* sound, SoundInstance* instance) { return false; }
 
 	void Play(SoundInstance* instance) {}
@@ -1334,6 +2158,10 @@ namespace wi::audio
 	float GetSubmixVolume(SUBMIX_TYPE type) { return 0; }
 
 	void Update3D(SoundInstance* instance, const SoundInstance3D& instance3D) {}
+	void Seek(SoundInstance* instance, float seconds) {}
+	bool IsStreaming(const Sound* sound) { return false; }
+	void UpdateVoices(SoundInstance* const* instances, const SoundInstance3D* const* instances3D, size_t count) {}
+	bool IsVirtual(const SoundInstance* instance) { return false; }
 
 	void SetReverb(REVERB_PRESET preset) {}
 }
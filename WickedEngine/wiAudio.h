@@ -50,18 +50,32 @@ namespace wi::audio
 			EMPTY = 0,
 			ENABLE_REVERB = 1 << 0,
 			LOOPED = 1 << 1,
+			VIRTUALIZABLE = 1 << 2,
 		};
 		uint32_t _flags = EMPTY;
 
+		// The priority can be changed at any time, it is used for choosing which virtualizable instances get real voices
+		float priority = 1;
+
 		inline void SetEnableReverb(bool value = true) { if (value) { _flags |= ENABLE_REVERB; } else { _flags &= ~ENABLE_REVERB; } }
 		inline bool IsEnableReverb() const { return _flags & ENABLE_REVERB; }
 		inline void SetLooped(bool value = true) { if (value) { _flags |= LOOPED; } else { _flags &= ~LOOPED; } }
 		inline bool IsLooped() const { return _flags & LOOPED; }
+		// Virtualizable sound instances only have a real voice while they are among the most audible playing instances (see UpdateVoices())
+		//	Otherwise they are virtual: their playback position is still advancing, but they don't use a voice and they are not mixed
+		inline void SetVirtualizable(bool value = true) { if (value) { _flags |= VIRTUALIZABLE; } else { _flags &= ~VIRTUALIZABLE; } }
+		inline bool IsVirtualizable() const { return _flags & VIRTUALIZABLE; }
 	};
 
-	bool CreateSound(const std::string& filename, Sound* sound);
-	bool CreateSound(const uint8_t* data, size_t size, Sound* sound);
+	// streaming	: Ogg Vorbis sounds will not be decoded at creation, but incrementally by each sound instance while playing
+	//	This saves memory and loading time for long sounds (like music), but the sound samples won't be accessible with GetSampleInfo()
+	bool CreateSound(const std::string& filename, Sound* sound, bool streaming = false);
+	bool CreateSound(const uint8_t* data, size_t size, Sound* sound, bool streaming = false);
 	bool CreateSoundInstance(const Sound* sound, SoundInstance* instance);
+	// Returns true if the sound was created with streaming
+	bool IsStreaming(const Sound* sound);
+	// Returns the duration of a sound file in seconds without decoding it (currently only supported for Ogg Vorbis, otherwise returns 0)
+	float GetSoundDuration(const uint8_t* data, size_t size);
 
 	void Play(SoundInstance* instance);
 	void Pause(SoundInstance* instance);
@@ -70,10 +84,12 @@ namespace wi::audio
 	float GetVolume(const SoundInstance* instance = nullptr);
 	void ExitLoop(SoundInstance* instance);
 	bool IsEnded(SoundInstance* instance);
+	// Moves the playback position of a sound instance, relative to the instance begin time
+	void Seek(SoundInstance* instance, float seconds);
 
 	struct SampleInfo
 	{
-		const short* samples = nullptr;	// array of samples in the sound
+		const short* samples = nullptr;	// array of samples in the sound (nullptr for streaming sounds)
 		size_t sample_count = 0;	// number of samples in the sound
 		int sample_rate = 0;	// number of samples per second
 		uint32_t channel_count = 1;	// number of channels in the samples array (1: mono, 2:stereo, etc.)
@@ -101,6 +117,20 @@ namespace wi::audio
 	// Call this every frame the listener or the sound instance 3D orientation changes
 	void Update3D(SoundInstance* instance, const SoundInstance3D& instance3D);
 
+	// Updates many sound instances at once and chooses which virtualizable instances have real voices:
+	//	instances3D	: optional array of 3D parameters for each instance, an element can be nullptr for instances without 3D effect
+	//	The playing virtualizable instances are scored by their volume, distance attenuation and priority, the inaudible ones are always virtual
+	//	The instances that switch between real and virtual voices keep their playback position
+	//	The 3D effect is only computed for instances that have real voices
+	void UpdateVoices(SoundInstance* const* instances, const SoundInstance3D* const* instances3D, size_t count);
+	// Sets the maximum number of real voices that virtualizable sound instances can use at the same time (default: 64)
+	void SetMaxRealVoices(uint32_t count);
+	uint32_t GetMaxRealVoices();
+	// Returns the number of real voices that are currently used by virtualizable sound instances
+	uint32_t GetRealVoiceCount();
+	// Returns true if the sound instance is virtual, so it doesn't have a real voice currently
+	bool IsVirtual(const SoundInstance* instance);
+
 	// Reverb effects can be used for 3D sound instances globally
 	enum REVERB_PRESET
 	{
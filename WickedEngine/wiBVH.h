@@ -61,9 +61,9 @@ namespace wi
 			if (aabb_count != leaf_count)
 				return;
 
-			for (uint32_t i = node_count - 1; i > 0; --i)
+			for (uint32_t i = node_count; i > 0; --i)
 			{
-				Node& node = nodes[i];
+				Node& node = nodes[i - 1];
 				node.aabb = wi::primitive::AABB();
 				if (node.isLeaf())
 				{
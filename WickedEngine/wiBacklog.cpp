@@ -15,6 +15,10 @@
 #include <deque>
 #include <limits>
 #include <iostream>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <cstring>
 
 using namespace wi::graphics;
 using namespace std::chrono_literals;
@@ -44,14 +48,263 @@ namespace wi::backlog
 	std::deque<LogEntry> history;
 	std::mutex historyLock;
 
+	// Posted messages are written into a lock-free multi-producer ring buffer of fixed size records
+	//	The ring is constant initialized, so messages can be posted even before the internal state is constructed
+	//	The record sequences are stored relative to their slot index, this way zero is a valid initial state
+	struct LogRing
+	{
+		static constexpr uint64_t CAPACITY = 2048; // must be power of two
+		static constexpr size_t TEXT_CAPACITY = 496;
+		struct Record
+		{
+			std::atomic<uint64_t> sequence{ 0 };
+			LogLevel level = LogLevel::Default;
+			uint32_t length = 0;
+			std::string* long_text = nullptr; // texts that don't fit into the record are allocated
+			char text[TEXT_CAPACITY] = {};
+		};
+		Record records[CAPACITY];
+		std::atomic<uint64_t> enqueue_pos{ 0 };
+		std::atomic<uint32_t> dropped{ 0 }; // messages that didn't fit into the full ring
+
+		// Producer side, safe to call from any thread concurrently
+		bool enqueue(const char* input, LogLevel level)
+		{
+			uint64_t pos = enqueue_pos.load(std::memory_order_relaxed);
+			Record* record = nullptr;
+			for (;;)
+			{
+				const uint64_t index = pos & (CAPACITY - 1);
+				record = &records[index];
+				const uint64_t sequence = record->sequence.load(std::memory_order_acquire) + index;
+				const int64_t diff = int64_t(sequence) - int64_t(pos);
+				if (diff == 0)
+				{
+					if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						break;
+				}
+				else if (diff < 0)
+				{
+					dropped.fetch_add(1, std::memory_order_relaxed);
+					return false; // full
+				}
+				else
+				{
+					pos = enqueue_pos.load(std::memory_order_relaxed);
+				}
+			}
+
+			const size_t length = strlen(input);
+			record->level = level;
+			if (length <= TEXT_CAPACITY)
+			{
+				std::memcpy(record->text, input, length);
+				record->length = (uint32_t)length;
+				record->long_text = nullptr;
+			}
+			else
+			{
+				record->length = 0;
+				record->long_text = new std::string(input, length);
+			}
+			record->sequence.store(pos + 1 - (pos & (CAPACITY - 1)), std::memory_order_release);
+			return true;
+		}
+	} ring;
+
 	struct InternalState
 	{
 		// These must have common lifetime and destruction order, so keep them together in a struct:
 		std::deque<LogEntry> entries;
 		std::mutex entriesLock;
 
+		// Consumer state, ring records are consumed by the writer thread or by any thread that needs the up to date log, under drainLock
+		//	Formatting, duplicate collapsing, rate limiting, debug output and log file writing are all done on the consumer side
+		uint64_t dequeue_pos = 0;
+		static constexpr uint32_t RATE_LIMIT_PER_SECOND = 1000;
+		static constexpr size_t LOGFILE_SIZE_LIMIT = 16ull * 1024ull * 1024ull;
+		std::mutex drainLock;
+		std::string last_text;
+		LogLevel last_level = LogLevel::None;
+		uint32_t repeat_count = 0;
+		std::chrono::steady_clock::time_point repeat_start;
+		std::chrono::steady_clock::time_point rate_window_start;
+		uint32_t rate_window_count = 0;
+		uint32_t suppressed = 0;
+		std::string file_pending;
+		size_t file_size = 0;
+		bool file_created = false;
+		std::mutex fileLock;
+
+		// Writer thread:
+		std::thread writer;
+		std::atomic_bool alive{ true };
+		std::mutex wakeLock;
+		std::condition_variable wakeCondition;
+
+		InternalState()
+		{
+			rate_window_start = std::chrono::steady_clock::now();
+			writer = std::thread([this] {
+				while (alive.load(std::memory_order_acquire))
+				{
+					{
+						std::unique_lock<std::mutex> lck(wakeLock);
+						wakeCondition.wait_for(lck, 16ms);
+					}
+					drain(false);
+					writeLogfile();
+				}
+			});
+		}
+
+		// Consumer side, drainLock must be held
+		void emit(LogLevel level, const char* text, size_t length)
+		{
+			std::string str;
+			str.reserve(length + 11);
+			switch (level)
+			{
+			default:
+			case LogLevel::Default:
+				break;
+			case LogLevel::Warning:
+				str = "[Warning] ";
+				break;
+			case LogLevel::Error:
+				str = "[Error] ";
+				break;
+			}
+			str.append(text, length);
+			str += '\n';
+
+			switch (level)
+			{
+			default:
+			case LogLevel::Default:
+				wi::helper::DebugOut(str, wi::helper::DebugLevel::Normal);
+				break;
+			case LogLevel::Warning:
+				wi::helper::DebugOut(str, wi::helper::DebugLevel::Warning);
+				break;
+			case LogLevel::Error:
+				wi::helper::DebugOut(str, wi::helper::DebugLevel::Error);
+				break;
+			}
+
+			file_pending += str;
+
+			LogEntry entry;
+			entry.text = std::move(str);
+			entry.level = level;
+			std::scoped_lock lck(entriesLock);
+			entries.push_back(std::move(entry));
+			if (entries.size() > deletefromline)
+			{
+				entries.pop_front();
+			}
+		}
+		void emit_repeats()
+		{
+			if (repeat_count > 0)
+			{
+				const std::string text = "(previous message repeated " + std::to_string(repeat_count) + " times)";
+				emit(last_level, text.c_str(), text.length());
+				repeat_count = 0;
+			}
+		}
+		void emit_suppressed()
+		{
+			if (suppressed > 0)
+			{
+				const std::string summary = std::to_string(suppressed) + " log messages were suppressed by rate limiting";
+				emit(LogLevel::Warning, summary.c_str(), summary.length());
+				suppressed = 0;
+			}
+		}
+		// Starts a new rate limiting window if the current one expired, the summary of the expired window is written
+		void update_rate_window(std::chrono::steady_clock::time_point now)
+		{
+			if (now - rate_window_start >= 1s)
+			{
+				rate_window_start = now;
+				rate_window_count = 0;
+				emit_suppressed();
+			}
+		}
+		void emit_limited(LogLevel level, const char* text, size_t length)
+		{
+			update_rate_window(std::chrono::steady_clock::now());
+			if (rate_window_count >= RATE_LIMIT_PER_SECOND)
+			{
+				suppressed++;
+				return;
+			}
+			rate_window_count++;
+			emit(level, text, length);
+		}
+		void drain(bool force)
+		{
+			std::scoped_lock lck(drainLock);
+			for (;;)
+			{
+				const uint64_t index = dequeue_pos & (LogRing::CAPACITY - 1);
+				LogRing::Record& record = ring.records[index];
+				if (record.sequence.load(std::memory_order_acquire) + index != dequeue_pos + 1)
+					break;
+
+				const char* text = record.long_text == nullptr ? record.text : record.long_text->c_str();
+				const size_t length = record.long_text == nullptr ? record.length : record.long_text->length();
+
+				// Consecutive duplicates are collapsed into a single message and a repeat count:
+				if (record.level == last_level && length == last_text.length() && std::memcmp(text, last_text.data(), length) == 0)
+				{
+					if (repeat_count == 0)
+					{
+						repeat_start = std::chrono::steady_clock::now();
+					}
+					repeat_count++;
+				}
+				else
+				{
+					emit_repeats();
+					last_text.assign(text, length);
+					last_level = record.level;
+					emit_limited(record.level, text, length);
+				}
+
+				if (record.long_text != nullptr)
+				{
+					delete record.long_text;
+					record.long_text = nullptr;
+				}
+				record.sequence.store(dequeue_pos + LogRing::CAPACITY - index, std::memory_order_release);
+				dequeue_pos++;
+			}
+
+			// A long series of repeats is reported periodically:
+			const auto now = std::chrono::steady_clock::now();
+			if (repeat_count > 0 && (force || now - repeat_start >= 1s))
+			{
+				emit_repeats();
+			}
+			// The suppressed messages are reported when the window expires even if no more messages arrive, or when flushing:
+			update_rate_window(now);
+			if (force)
+			{
+				emit_suppressed();
+			}
+			const uint32_t dropped_count = ring.dropped.exchange(0, std::memory_order_relaxed);
+			if (dropped_count > 0)
+			{
+				const std::string text = std::to_string(dropped_count) + " log messages were dropped because the log buffer was full";
+				emit(LogLevel::Warning, text.c_str(), text.length());
+			}
+		}
+
 		std::string getText()
 		{
+			drain(false);
 			std::scoped_lock lck(entriesLock);
 			std::string retval;
 			_forEachLogEntry_unsafe([&](auto&& entry) {retval += entry.text;});
@@ -64,20 +317,54 @@ namespace wi::backlog
 				cb(entry);
 			}
 		}
+		// Appends the new messages to the log file, rotating the log file when it gets too large
 		void writeLogfile()
 		{
 			static const std::string filename = wi::helper::GetCurrentPath() + "/log.txt";
-			std::string text = getText();
-			static std::mutex writelocker;
-			std::scoped_lock lck(writelocker); // to not write the logfile from multiple threads
-			wi::helper::FileWrite(filename, (const uint8_t*)text.c_str(), text.length());
+			static const std::string filename_prev = wi::helper::GetCurrentPath() + "/log_prev.txt";
+			std::string text;
+			{
+				std::scoped_lock lck(drainLock);
+				std::swap(text, file_pending);
+			}
+			if (text.empty())
+				return;
+			std::scoped_lock lck(fileLock); // to not write the logfile from multiple threads
+			if (file_created && file_size + text.length() > LOGFILE_SIZE_LIMIT)
+			{
+				wi::helper::FileCopy(filename, filename_prev);
+				file_created = false;
+			}
+			if (file_created)
+			{
+				wi::helper::FileAppend(filename, (const uint8_t*)text.c_str(), text.length());
+				file_size += text.length();
+			}
+			else
+			{
+				// The log file is started from scratch in every session:
+				wi::helper::FileWrite(filename, (const uint8_t*)text.c_str(), text.length());
+				file_size = text.length();
+				file_created = true;
+			}
+		}
+		void flush()
+		{
+			drain(true);
+			writeLogfile();
 		}
 
 		~InternalState()
 		{
-			// The object will automatically write out the backlog to the temp folder when it's destroyed
+			// The object will automatically write out the backlog when it's destroyed
 			//	Should happen on application exit
-			writeLogfile();
+			alive.store(false, std::memory_order_release);
+			wakeCondition.notify_one();
+			if (writer.joinable())
+			{
+				writer.join();
+			}
+			flush();
 		}
 	} internal_state;
 
@@ -312,6 +599,7 @@ namespace wi::backlog
 
 		static std::deque<LogEntry> entriesCopy;
 
+		internal_state.drain(false);
 		internal_state.entriesLock.lock();
 		// Force copy because drawing text while locking is not safe because an error inside might try to lock again!
 		entriesCopy = internal_state.entries;
@@ -341,6 +629,10 @@ namespace wi::backlog
 	{
 		return internal_state.getText();
 	}
+	void flush()
+	{
+		internal_state.flush();
+	}
 	// You generally don't want to use this. See notes in header
 	void _forEachLogEntry_unsafe(std::function<void(const LogEntry&)> cb)
 	{
@@ -348,6 +640,7 @@ namespace wi::backlog
 	}
 	void clear()
 	{
+		internal_state.drain(false);
 		std::scoped_lock lck(internal_state.entriesLock);
 		internal_state.entries.clear();
 		scroll = 0;
@@ -359,55 +652,17 @@ namespace wi::backlog
 			return;
 		}
 
-		std::string str;
-		switch (level)
-		{
-		default:
-		case LogLevel::Default:
-			str = "";
-			break;
-		case LogLevel::Warning:
-			str = "[Warning] ";
-			break;
-		case LogLevel::Error:
-			str = "[Error] ";
-			break;
-		}
-		str += input;
-		str += '\n';
-		LogEntry entry;
-		entry.text = str;
-		entry.level = level;
-
-		internal_state.entriesLock.lock();
-		internal_state.entries.push_back(entry);
-		if (internal_state.entries.size() > deletefromline)
-		{
-			internal_state.entries.pop_front();
-		}
-		internal_state.entriesLock.unlock();
+		// Only the raw text is stored here, everything else is done by the writer thread:
+		ring.enqueue(input, level);
 
 		refitscroll = true;
-
-		switch (level)
-		{
-		default:
-		case LogLevel::Default:
-			wi::helper::DebugOut(str, wi::helper::DebugLevel::Normal);
-			break;
-		case LogLevel::Warning:
-			wi::helper::DebugOut(str, wi::helper::DebugLevel::Warning);
-			break;
-		case LogLevel::Error:
-			wi::helper::DebugOut(str, wi::helper::DebugLevel::Error);
-			break;
-		}
-
 		unseen = std::max(unseen, level);
 
 		if (level >= LogLevel::Error)
 		{
-			internal_state.writeLogfile();  // will lock mutex
+			// Errors are written to the log file on the calling thread, so they are on disk even if the application crashes right after:
+			internal_state.drain(false);
+			internal_state.writeLogfile();
 		}
 	}
 
@@ -41,8 +41,14 @@ namespace wi::backlog
 
 	std::string getText();
 	void clear();
+	// Posts a message to the backlog, it can be called from any thread
+	//	The message is only queued here, it will be written to the backlog, debug output and log file by a background thread
+	//	Except for LogLevel::Error messages, which are written to the log file before this returns (unless they are collapsed or rate limited)
+	//	Consecutive duplicate messages are collapsed, and the messages are rate limited
 	void post(const char* input, LogLevel level = LogLevel::Default);
 	void post(const std::string& input, LogLevel level = LogLevel::Default);
+	// Waits until all posted messages are written to the log file
+	void flush();
 
 	void historyPrev();
 	void historyNext();
@@ -9,9 +9,13 @@
 
 #include <cstdint>
 #include <cassert>
+#include <algorithm>
 #include <atomic>
 #include <memory>
 #include <string>
+#include <array>
+#include <tuple>
+#include <utility>
 
 // Entity-Component System
 namespace wi::ecs
@@ -30,6 +34,34 @@ namespace wi::ecs
 		return next.fetch_add(1);
 	}
 
+	// Global version counter for change tracking in ComponentManager
+	//	Components that are marked as changed store the current version
+	inline std::atomic<uint64_t>& ChangeVersionCounter()
+	{
+		static std::atomic<uint64_t> version{ 1 };
+		return version;
+	}
+	// Returns the current change tracking version
+	inline uint64_t GetChangeVersion()
+	{
+		return ChangeVersionCounter().load(std::memory_order_relaxed);
+	}
+	// Advance the change tracking version, returns the version that was current before advancing
+	//	The returned value can be given later as the "since" parameter of ComponentManager::ForEachChanged()
+	//	to get every component that was changed after this point
+	inline uint64_t AdvanceChangeVersion()
+	{
+		return ChangeVersionCounter().fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// Returns a unique version for a structural modification of a ComponentManager
+	//	It is unique across all managers, so a recreated manager can't be mistaken for an older one
+	inline uint64_t NextStructureVersion()
+	{
+		static std::atomic<uint64_t> version{ 1 };
+		return version.fetch_add(1, std::memory_order_relaxed);
+	}
+
 	class ComponentLibrary;
 	struct EntitySerializer
 	{
@@ -124,12 +156,14 @@ namespace wi::ecs
 		virtual void Component_Serialize(Entity entity, wi::Archive& archive, EntitySerializer& seri) = 0;
 		virtual void Remove(Entity entity) = 0;
 		virtual void Remove_KeepSorted(Entity entity) = 0;
+		virtual void Remove_Batch(const wi::vector<Entity>& entities, bool keep_sorted) = 0;
 		virtual void MoveItem(size_t index_from, size_t index_to) = 0;
 		virtual bool Contains(Entity entity) const = 0;
 		virtual size_t GetIndex(Entity entity) const = 0;
 		virtual size_t GetCount() const = 0;
 		virtual Entity GetEntity(size_t index) const = 0;
 		virtual const wi::vector<Entity>& GetEntityArray() const = 0;
+		virtual uint64_t GetStructureVersion() const = 0;
 	};
 
 	// The ComponentManager is a container that stores components and matches them with entities
@@ -144,6 +178,7 @@ namespace wi::ecs
 		ComponentManager(size_t reservedCount = 0)
 		{
 			Reserve(reservedCount);
+			structure_version = NextStructureVersion();
 		}
 
 		inline void Reserve(size_t count)
@@ -159,6 +194,12 @@ namespace wi::ecs
 			components.clear();
 			entities.clear();
 			lookup.clear();
+			versions.clear();
+			structure_version = NextStructureVersion();
+			if (change_tracking)
+			{
+				removed_version = GetChangeVersion();
+			}
 		}
 
 		// Perform deep copy of all the contents of "other" into this
@@ -175,6 +216,8 @@ namespace wi::ecs
 				lookup[entity] = components.size();
 				components.push_back(other.components[i]);
 			}
+			ResizeVersions();
+			structure_version = NextStructureVersion();
 		}
 
 		// Merge in an other component manager of the same type to this.
@@ -194,6 +237,8 @@ namespace wi::ecs
 				lookup[entity] = components.size();
 				components.push_back(std::move(other.components[i]));
 			}
+			ResizeVersions();
+			structure_version = NextStructureVersion();
 
 			other.Clear();
 		}
@@ -233,6 +278,8 @@ namespace wi::ecs
 					entities[prev_count + i] = entity;
 					lookup[entity] = prev_count + i;
 				}
+				ResizeVersions();
+				structure_version = NextStructureVersion();
 			}
 			else
 			{
@@ -298,6 +345,14 @@ namespace wi::ecs
 			// Also push corresponding entity:
 			entities.push_back(entity);
 
+			structure_version = NextStructureVersion();
+
+			// New components are reported as changed:
+			if (change_tracking)
+			{
+				versions.push_back(GetChangeVersion());
+			}
+
 			return components.back();
 		}
 
@@ -319,12 +374,25 @@ namespace wi::ecs
 
 					// Update the lookup table:
 					lookup[entities[index]] = index;
+
+					if (change_tracking)
+					{
+						versions[index] = versions.back();
+					}
 				}
 
 				// Shrink the container:
 				components.pop_back();
 				entities.pop_back();
 				lookup.erase(entity);
+
+				if (change_tracking)
+				{
+					versions.pop_back();
+					removed_version = GetChangeVersion();
+				}
+
+				structure_version = NextStructureVersion();
 			}
 		}
 
@@ -357,9 +425,80 @@ namespace wi::ecs
 				components.pop_back();
 				entities.pop_back();
 				lookup.erase(entity);
+
+				if (change_tracking)
+				{
+					versions.erase(versions.begin() + index);
+					removed_version = GetChangeVersion();
+				}
+
+				structure_version = NextStructureVersion();
 			}
 		}
 
+		// Remove the components of multiple entities if they exist
+		//	keep_sorted	: if true, the ordering is kept by compacting the remaining components in a single pass from the first removed one
+		//					otherwise the removed components are swapped out with the last ones like with Remove()
+		inline void Remove_Batch(const wi::vector<Entity>& remove_entities, bool keep_sorted)
+		{
+			if (lookup.empty())
+				return;
+
+			if (!keep_sorted)
+			{
+				for (Entity entity : remove_entities)
+				{
+					Remove(entity);
+				}
+				return;
+			}
+
+			wi::vector<size_t> removed_indices;
+			for (Entity entity : remove_entities)
+			{
+				auto it = lookup.find(entity);
+				if (it != lookup.end())
+				{
+					removed_indices.push_back(it->second);
+					lookup.erase(it);
+				}
+			}
+			if (removed_indices.empty())
+				return;
+			std::sort(removed_indices.begin(), removed_indices.end());
+
+			// Every component that is after the first removed one is moved left by the number of removed components before it:
+			size_t write = removed_indices.front();
+			size_t next_removed = 0;
+			for (size_t read = removed_indices.front(); read < components.size(); ++read)
+			{
+				if (next_removed < removed_indices.size() && removed_indices[next_removed] == read)
+				{
+					next_removed++;
+					continue;
+				}
+				components[write] = std::move(components[read]);
+				entities[write] = entities[read];
+				lookup[entities[write]] = write;
+				if (change_tracking)
+				{
+					versions[write] = versions[read];
+				}
+				write++;
+			}
+
+			// Shrink the container:
+			components.erase(components.begin() + write, components.end());
+			entities.erase(entities.begin() + write, entities.end());
+			if (change_tracking)
+			{
+				versions.erase(versions.begin() + write, versions.end());
+				removed_version = GetChangeVersion();
+			}
+
+			structure_version = NextStructureVersion();
+		}
+
 		// Place an entity-component to the specified index position while keeping the ordering intact
 		inline void MoveItem(size_t index_from, size_t index_to)
 		{
@@ -388,6 +527,22 @@ namespace wi::ecs
 			components[index_to] = std::move(component);
 			entities[index_to] = entity;
 			lookup[entity] = index_to;
+
+			if (change_tracking)
+			{
+				const uint64_t version = versions[index_from];
+				if (index_from < index_to)
+				{
+					std::move(versions.begin() + index_from + 1, versions.begin() + index_to + 1, versions.begin() + index_from);
+				}
+				else
+				{
+					std::move_backward(versions.begin() + index_to, versions.begin() + index_from, versions.begin() + index_from + 1);
+				}
+				versions[index_to] = version;
+			}
+
+			structure_version = NextStructureVersion();
 		}
 
 		// Check if a component exists for a given entity or not
@@ -458,6 +613,69 @@ namespace wi::ecs
 		// Returns the tightly packed [read only] component array
 		inline const wi::vector<Component>& GetComponentArray() const { return components; }
 
+		// Returns the version of the last structural modification (Create, Remove, MoveItem, etc.)
+		//	Component indices are stable until this changes
+		inline uint64_t GetStructureVersion() const { return structure_version; }
+
+		// Change tracking is opt-in, when enabled every component stores the version of its last modification
+		//	Enabling it reports every existing component as changed
+		inline void SetChangeTrackingEnabled(bool value)
+		{
+			change_tracking = value;
+			versions.clear();
+			ResizeVersions();
+		}
+		inline bool IsChangeTrackingEnabled() const { return change_tracking; }
+
+		// Mark a component as modified at the current change version
+		//	Thread safe for different indices
+		inline void MarkChanged(size_t index)
+		{
+			if (change_tracking)
+			{
+				versions[index] = GetChangeVersion();
+			}
+		}
+
+		// Directly index a specific [read/write] component and mark it as changed
+		//	0 <= index < GetCount()
+		inline Component& GetMutable(size_t index)
+		{
+			MarkChanged(index);
+			return components[index];
+		}
+
+		// Retrieve a [read/write] component specified by an entity and mark it as changed (if it exists, otherwise nullptr)
+		inline Component* GetComponentMutable(Entity entity)
+		{
+			const size_t index = GetIndex(entity);
+			if (index == ~0ull)
+				return nullptr;
+			MarkChanged(index);
+			return &components[index];
+		}
+
+		// Returns the version of the last modification of a component, or 0 if change tracking is disabled
+		inline uint64_t GetChangedVersion(size_t index) const { return change_tracking ? versions[index] : 0; }
+
+		// Returns the version of the last removal, removed components can't be reported so they need to be handled separately by the user
+		inline uint64_t GetRemovedVersion() const { return removed_version; }
+
+		// Iterate every component that was modified after the version "since"
+		//	func: void(size_t index)
+		//	If change tracking is disabled, every component is reported
+		template<typename F>
+		inline void ForEachChanged(uint64_t since, F func) const
+		{
+			for (size_t i = 0; i < components.size(); ++i)
+			{
+				if (!change_tracking || versions[i] > since)
+				{
+					func(i);
+				}
+			}
+		}
+
 	private:
 		// This is a linear array of alive components
 		wi::vector<Component> components;
@@ -465,11 +683,93 @@ namespace wi::ecs
 		wi::vector<Entity> entities;
 		// This is a lookup table for entities
 		wi::unordered_map<Entity, size_t> lookup;
+		// This is a linear array of the last modification versions corresponding to each alive component (only when change tracking is enabled)
+		wi::vector<uint64_t> versions;
+		uint64_t removed_version = 0;
+		uint64_t structure_version = 0;
+		bool change_tracking = false;
+
+		// Components that were added without version are reported as changed
+		inline void ResizeVersions()
+		{
+			if (change_tracking)
+			{
+				versions.resize(components.size(), GetChangeVersion());
+			}
+		}
 
 		// Disallow this to be copied by mistake
 		ComponentManager(const ComponentManager&) = delete;
 	};
 
+	// The ComponentJoin caches the indices of the matching components in other managers for every entry of a primary manager
+	//	This allows a system to iterate the primary manager and reach the other components of the same entity with direct indexing instead of hash lookups
+	//	The indices are only rebuilt when one of the managers was structurally modified (Create, Remove, MoveItem, etc.)
+	//	The entries are in the same order as the primary manager, so wi::jobsystem::Dispatch can be used over GetCount() directly
+	template<typename Primary, typename... Others>
+	class ComponentJoin
+	{
+	public:
+		static constexpr size_t OTHER_COUNT = sizeof...(Others);
+		static constexpr uint32_t INVALID_INDEX = ~0u;
+
+		// Bind the managers and rebuild the indices if anything changed since the last Update()
+		//	This must be called before iterating, and it is not thread safe
+		inline void Update(ComponentManager<Primary>& primary_manager, ComponentManager<Others>&... other_managers)
+		{
+			const std::array<uint64_t, OTHER_COUNT + 1> versions = { primary_manager.GetStructureVersion(), other_managers.GetStructureVersion()... };
+			const std::tuple<ComponentManager<Others>*...> managers = { &other_managers... };
+			if (primary == &primary_manager && others == managers && structure_versions == versions)
+				return;
+
+			primary = &primary_manager;
+			others = managers;
+			structure_versions = versions;
+
+			indices.resize(primary->GetCount());
+			wi::jobsystem::context ctx;
+			wi::jobsystem::Dispatch(ctx, (uint32_t)indices.size(), 256, [&](wi::jobsystem::JobArgs args) {
+				Build(indices[args.jobIndex], primary->GetEntity(args.jobIndex), std::index_sequence_for<Others...>{});
+			});
+			wi::jobsystem::Wait(ctx);
+		}
+
+		// Returns the number of entries, this is the same as the primary manager's count
+		inline size_t GetCount() const { return indices.size(); }
+
+		// Returns the entity of an entry
+		inline Entity GetEntity(size_t index) const { return primary->GetEntity(index); }
+
+		// Returns the primary component of an entry
+		inline Primary& GetPrimary(size_t index) const { return (*primary)[index]; }
+
+		// Returns the index of the matching component in the I-th other manager, or INVALID_INDEX if the entity doesn't have it
+		template<size_t I>
+		inline uint32_t GetIndex(size_t index) const { return indices[index][I]; }
+
+		// Returns the matching component in the I-th other manager, or nullptr if the entity doesn't have it
+		template<size_t I>
+		inline std::tuple_element_t<I, std::tuple<Others...>>* GetComponent(size_t index) const
+		{
+			const uint32_t other_index = indices[index][I];
+			if (other_index == INVALID_INDEX)
+				return nullptr;
+			return &(*std::get<I>(others))[other_index];
+		}
+
+	private:
+		ComponentManager<Primary>* primary = nullptr;
+		std::tuple<ComponentManager<Others>*...> others = {};
+		std::array<uint64_t, OTHER_COUNT + 1> structure_versions = {};
+		wi::vector<std::array<uint32_t, OTHER_COUNT>> indices;
+
+		template<size_t... I>
+		inline void Build(std::array<uint32_t, OTHER_COUNT>& row, Entity entity, std::index_sequence<I...>) const
+		{
+			((row[I] = (uint32_t)std::get<I>(others)->GetIndex(entity)), ...);
+		}
+	};
+
 	// This is the class to store all component managers,
 	// this is useful for bulk operation of all attached components within an entity
 	class ComponentLibrary
@@ -14,12 +14,14 @@
 #include "wiUnorderedSet.h"
 #include "wiVector.h"
 #include "wiMath.h"
+#include "wiImage.h"
 
 #include "Utility/liberation_sans.h"
 #include "Utility/stb_truetype.h"
 
 #include <fstream>
 #include <mutex>
+#include <atomic>
 
 using namespace wi::enums;
 using namespace wi::graphics;
@@ -275,6 +277,103 @@ namespace wi::font
 			std::memcpy(vertexList_GPU, vertexList.data(), sizeof(FontVertex) * vertexList.size());
 		}
 
+		static std::atomic<uint32_t> statistics_text_count{ 0 };
+		static std::atomic<uint32_t> statistics_draw_call_count{ 0 };
+
+		// Texts recorded into the wi::image batch of the current thread:
+		static uint32_t batch_renderer = ~0u;
+		struct BatchText
+		{
+			FontConstants constants;
+			uint32_t vertex_offset;
+			uint32_t quad_count;
+		};
+		static thread_local wi::vector<BatchText> batch_texts;
+		static thread_local wi::vector<FontVertex> batch_vertices;
+
+		void SubmitBatchTexts(const uint32_t* items, uint32_t count, uint32_t key, CommandList cmd)
+		{
+			GraphicsDevice* device = wi::graphics::GetDevice();
+
+			uint32_t quad_count = 0;
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				quad_count += batch_texts[items[i]].quad_count;
+			}
+
+			// Layout: FontConstants of every text | glyph vertices | per glyph instances
+			const size_t constants_size = sizeof(FontConstants) * count;
+			const size_t vertices_size = sizeof(FontVertex) * 4 * quad_count;
+			const size_t instances_size = sizeof(uint2) * quad_count;
+			GraphicsDevice::GPUAllocation mem = device->AllocateGPU(constants_size + vertices_size + instances_size, cmd);
+			if (!mem.IsValid())
+				return;
+			FontConstants* constants = (FontConstants*)mem.data;
+			FontVertex* vertices = (FontVertex*)((uint8_t*)mem.data + constants_size);
+			uint2* instances = (uint2*)((uint8_t*)mem.data + constants_size + vertices_size);
+
+			uint32_t quad = 0;
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const BatchText& text = batch_texts[items[i]];
+				std::memcpy(constants + i, &text.constants, sizeof(FontConstants));
+				std::memcpy(vertices + quad * 4, batch_vertices.data() + text.vertex_offset, sizeof(FontVertex) * 4 * text.quad_count);
+				for (uint32_t j = 0; j < text.quad_count; ++j)
+				{
+					uint2 instance;
+					instance.x = uint32_t(mem.offset + sizeof(FontConstants) * i);
+					instance.y = uint32_t(mem.offset + constants_size + sizeof(FontVertex) * 4 * (quad + j));
+					std::memcpy(instances + quad + j, &instance, sizeof(instance));
+				}
+				quad += text.quad_count;
+			}
+
+			FontConstants font = {};
+			font.buffer_index = device->GetDescriptorIndex(&mem.buffer, SubresourceType::SRV);
+			font.buffer_offset = uint32_t(mem.offset + constants_size + vertices_size);
+			font.texture_index = -1;
+			font.softness_bolden_hdrscaling.y = FONT_FLAG_INSTANCED << 16u;
+
+			device->BindPipelineState(&PSO[key], cmd);
+			device->BindDynamicConstantBuffer(font, CBSLOT_FONT, cmd);
+			device->DrawInstanced(4, quad_count, 0, 0, cmd);
+			statistics_draw_call_count.fetch_add(1, std::memory_order_relaxed);
+		}
+		void ResetBatchTexts()
+		{
+			batch_texts.clear();
+			batch_vertices.clear();
+		}
+
+		// Projects the local rectangle (left, top, right, bottom) of the text with the transform into clip space
+		XMFLOAT4 ComputeBatchBounds(const XMFLOAT4& rect, const XMFLOAT4X4& transform)
+		{
+			const XMMATRIX M = XMLoadFloat4x4(&transform);
+			const XMVECTOR corners[] = {
+				XMVector3Transform(XMVectorSet(rect.x, rect.y, 0, 1), M),
+				XMVector3Transform(XMVectorSet(rect.z, rect.y, 0, 1), M),
+				XMVector3Transform(XMVectorSet(rect.x, rect.w, 0, 1), M),
+				XMVector3Transform(XMVectorSet(rect.z, rect.w, 0, 1), M),
+			};
+			XMFLOAT4 bounds = XMFLOAT4(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+			for (const XMVECTOR& corner : corners)
+			{
+				const float w = XMVectorGetW(corner);
+				if (w <= 0)
+				{
+					// crossing the camera plane, the projected bounds are not reliable:
+					return XMFLOAT4(-FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX);
+				}
+				const float x = XMVectorGetX(corner) / w;
+				const float y = XMVectorGetY(corner) / w;
+				bounds.x = std::min(bounds.x, x);
+				bounds.y = std::min(bounds.y, y);
+				bounds.z = std::max(bounds.z, x);
+				bounds.w = std::max(bounds.w, y);
+			}
+			return bounds;
+		}
+
 	}
 	using namespace font_internal;
 
@@ -307,6 +406,14 @@ namespace wi::font
 			AddFontStyle("Liberation Sans", data.data(), data.size(), true);
 		}
 
+		if (batch_renderer == ~0u)
+		{
+			wi::image::BatchRenderer renderer;
+			renderer.submit = SubmitBatchTexts;
+			renderer.reset = ResetBatchTexts;
+			batch_renderer = wi::image::RegisterBatchRenderer(renderer);
+		}
+
 		RasterizerState rs;
 		rs.fill_mode = FillMode::SOLID;
 		rs.cull_mode = CullMode::NONE;
@@ -573,25 +680,70 @@ namespace wi::font
 		if (status.quadCount > 0)
 		{
 			GraphicsDevice* device = wi::graphics::GetDevice();
-			GraphicsDevice::GPUAllocation mem = device->AllocateGPU(sizeof(FontVertex) * status.quadCount * 4, cmd);
-			if (!mem.IsValid())
-			{
-				return status.cursor;
-			}
-			CommitText(mem.data);
+			const bool batched = wi::image::IsBatching(cmd);
+
+			statistics_text_count.fetch_add(1, std::memory_order_relaxed);
 
 			FontConstants font = {};
-			font.buffer_index = device->GetDescriptorIndex(&mem.buffer, SubresourceType::SRV);
-			font.buffer_offset = (uint32_t)mem.offset;
 			font.texture_index = device->GetDescriptorIndex(&texture, SubresourceType::SRV);
-			if (font.buffer_index < 0 || font.texture_index < 0)
+			if (font.texture_index < 0)
 			{
 				return status.cursor;
 			}
 
-			device->EventBegin("Font", cmd);
+			uint32_t batch_vertex_offset = 0;
+			XMFLOAT4 batch_rect = XMFLOAT4(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+			if (batched)
+			{
+				// The glyphs are shared by the shadow and base texts, they are written to GPU when the batch is submitted:
+				batch_vertex_offset = (uint32_t)batch_vertices.size();
+				batch_vertices.insert(batch_vertices.end(), vertexList.begin(), vertexList.begin() + status.quadCount * 4);
+				for (uint32_t i = 0; i < status.quadCount * 4; ++i)
+				{
+					const FontVertex& vertex = vertexList[i];
+					batch_rect.x = std::min(batch_rect.x, vertex.pos.x);
+					batch_rect.y = std::min(batch_rect.y, vertex.pos.y);
+					batch_rect.z = std::max(batch_rect.z, vertex.pos.x);
+					batch_rect.w = std::max(batch_rect.w, vertex.pos.y);
+				}
+			}
+			else
+			{
+				GraphicsDevice::GPUAllocation mem = device->AllocateGPU(sizeof(FontVertex) * status.quadCount * 4, cmd);
+				if (!mem.IsValid())
+				{
+					return status.cursor;
+				}
+				CommitText(mem.data);
+
+				font.buffer_index = device->GetDescriptorIndex(&mem.buffer, SubresourceType::SRV);
+				font.buffer_offset = (uint32_t)mem.offset;
+				if (font.buffer_index < 0)
+				{
+					return status.cursor;
+				}
+
+				device->EventBegin("Font", cmd);
+
+				device->BindPipelineState(&PSO[params.isDepthTestEnabled()], cmd);
+			}
 
-			device->BindPipelineState(&PSO[params.isDepthTestEnabled()], cmd);
+			auto submit = [&]() {
+				if (batched)
+				{
+					BatchText& text = batch_texts.emplace_back();
+					text.constants = font;
+					text.vertex_offset = batch_vertex_offset;
+					text.quad_count = status.quadCount;
+					wi::image::RecordBatchItem(batch_renderer, params.isDepthTestEnabled() ? DEPTH_TEST_ON : DEPTH_TEST_OFF, uint32_t(batch_texts.size() - 1), ComputeBatchBounds(batch_rect, font.transform));
+				}
+				else
+				{
+					device->BindDynamicConstantBuffer(font, CBSLOT_FONT, cmd);
+					device->DrawInstanced(4, status.quadCount, 0, 0, cmd);
+					statistics_draw_call_count.fetch_add(1, std::memory_order_relaxed);
+				}
+			};
 
 			using namespace wi::math;
 			XMFLOAT4 color = XMFLOAT4(1, 1, 1, 1);
@@ -664,9 +816,7 @@ namespace wi::font
 				softness = params.shadow_softness * 0.5f;
 				font.softness_bolden_hdrscaling = pack_half3(softness, bolden, hdr_scaling);
 				font.softness_bolden_hdrscaling.y |= flags << 16u;
-				device->BindDynamicConstantBuffer(font, CBSLOT_FONT, cmd);
-
-				device->DrawInstanced(4, status.quadCount, 0, 0, cmd);
+				submit();
 			}
 
 			// font base render:
@@ -680,11 +830,12 @@ namespace wi::font
 			softness = params.softness * 0.5f;
 			font.softness_bolden_hdrscaling = pack_half3(softness, bolden, hdr_scaling);
 			font.softness_bolden_hdrscaling.y |= flags << 16u;
-			device->BindDynamicConstantBuffer(font, CBSLOT_FONT, cmd);
+			submit();
 
-			device->DrawInstanced(4, status.quadCount, 0, 0, cmd);
-
-			device->EventEnd(cmd);
+			if (!batched)
+			{
+				device->EventEnd(cmd);
+			}
 		}
 
 		return status.cursor;
@@ -695,6 +846,20 @@ namespace wi::font
 		canvas = current_canvas;
 	}
 
+	Statistics GetStatistics()
+	{
+		Statistics statistics;
+		statistics.text_count = statistics_text_count.load();
+		statistics.draw_call_count = statistics_draw_call_count.load();
+		return statistics;
+	}
+
+	void ResetStatistics()
+	{
+		statistics_text_count.store(0);
+		statistics_draw_call_count.store(0);
+	}
+
 	Cursor Draw(const char* text, size_t text_length, const Params& params, CommandList cmd)
 	{
 		return Draw_internal(text, text_length, params, cmd);
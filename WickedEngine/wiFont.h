@@ -158,6 +158,15 @@ namespace wi::font
 
 	// Set canvas for the CommandList to handle DPI-aware font rendering on the current thread
 	void SetCanvas(const wi::Canvas& current_canvas);
+	struct Statistics
+	{
+		uint32_t text_count = 0; // number of Draw() calls that produced glyphs
+		uint32_t draw_call_count = 0; // number of draw calls submitted to the GPU by the font renderer
+	};
+	// Returns the statistics accumulated since the last ResetStatistics()
+	Statistics GetStatistics();
+	void ResetStatistics();
+
 	// Call once per frame to update font atlas texture
 	//	upscaling : this should be the DPI upscaling factor, otherwise there will be no upscaling. Upscaling will cause glyphs to be cached at higher resolution.
 	void UpdateAtlas(float upscaling = 1.0f);
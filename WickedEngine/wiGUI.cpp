@@ -57,6 +57,18 @@ namespace wi::gui
 	static bool scroll_allowed = true;
 	static bool typing_active = false;
 
+	// GUI rendering is batched by wi::image, and every scissor change has to flush the batch
+	//	Widgets mostly apply the same scissor as their parent, so the redundant changes are skipped:
+	static thread_local Rect bound_scissor = { -1, -1, -1, -1 };
+	static void BindScissor(const Rect& scissor, CommandList cmd)
+	{
+		if (scissor.left == bound_scissor.left && scissor.top == bound_scissor.top && scissor.right == bound_scissor.right && scissor.bottom == bound_scissor.bottom)
+			return;
+		wi::image::FlushBatch(cmd);
+		bound_scissor = scissor;
+		wi::graphics::GetDevice()->BindScissorRects(1, &scissor, cmd);
+	}
+
 	void GUI::Update(const wi::Canvas& canvas, float dt)
 	{
 		if (!visible || wi::backlog::isActive())
@@ -139,20 +151,24 @@ namespace wi::gui
 		GraphicsDevice* device = wi::graphics::GetDevice();
 
 		device->EventBegin("GUI", cmd);
+		wi::image::BeginBatch(cmd);
+		bound_scissor = { -1, -1, -1, -1 };
+
 		// Rendering is back to front:
 		for (size_t i = 0; i < widgets.size(); ++i)
 		{
 			const Widget* widget = widgets[widgets.size() - i - 1];
-			device->BindScissorRects(1, &scissorRect, cmd);
+			BindScissor(scissorRect, cmd);
 			widget->Render(canvas, cmd);
 		}
 
-		device->BindScissorRects(1, &scissorRect, cmd);
+		BindScissor(scissorRect, cmd);
 		for (auto& x : widgets)
 		{
 			x->RenderTooltip(canvas, cmd);
 		}
 
+		wi::image::EndBatch(cmd);
 		device->EventEnd(cmd);
 
 		wi::profiler::EndRange(range_cpu);
@@ -296,19 +312,7 @@ namespace wi::gui
 			state = IDLE;
 		}
 
-		UpdateTransform();
-
-		if (parent != nullptr)
-		{
-			this->UpdateTransform_Parented(*parent);
-		}
-
-		XMVECTOR S, R, T;
-		XMMatrixDecompose(&S, &R, &T, XMLoadFloat4x4(&world));
-		XMStoreFloat3(&translation, T);
-		XMStoreFloat3(&scale, S);
-
-		scale = wi::math::Max(scale, XMFLOAT3(0.001f, 0.001f, 0.001f));
+		UpdateLayout();
 
 		scissorRect.bottom = (int32_t)std::ceil(translation.y + scale.y);
 		scissorRect.left = (int32_t)std::floor(translation.x);
@@ -351,6 +355,49 @@ namespace wi::gui
 		font.Update(dt);
 		angular_highlight_timer += dt;
 	}
+	void Widget::UpdateLayout()
+	{
+		UpdateTransform();
+
+		if (parent != nullptr)
+		{
+			this->UpdateTransform_Parented(*parent);
+		}
+
+		// Most widgets don't move from frame to frame, so the decompose is skipped if neither the world matrix
+		//	nor the outputs were modified since the last layout (some widgets write translation and scale directly):
+		if (
+			std::memcmp(&layout_world, &world, sizeof(world)) == 0 &&
+			std::memcmp(&layout_translation, &translation, sizeof(translation)) == 0 &&
+			std::memcmp(&layout_scale, &scale, sizeof(scale)) == 0
+			)
+		{
+			return;
+		}
+
+		XMVECTOR S, R, T;
+		XMMatrixDecompose(&S, &R, &T, XMLoadFloat4x4(&world));
+		XMStoreFloat3(&translation, T);
+		XMStoreFloat3(&scale, S);
+
+		scale = wi::math::Max(scale, XMFLOAT3(0.001f, 0.001f, 0.001f));
+
+		layout_world = world;
+		layout_translation = translation;
+		layout_scale = scale;
+	}
+	bool Widget::IsCulled(const Rect& clip) const
+	{
+		if (!IsVisible() || GetState() != IDLE || tooltipTimer > 0)
+		{
+			return false;
+		}
+		// Only vertical culling, because texts can be placed to the left and right of widgets:
+		const float margin = std::max(shadow, angular_highlight_width) + 2;
+		return
+			translation.y + scale.y + margin < float(clip.top) ||
+			translation.y - margin > float(clip.bottom);
+	}
 	void Widget::Render(const wi::Canvas& canvas, wi::graphics::CommandList cmd) const
 	{
 		if (!IsVisible())
@@ -769,13 +816,12 @@ namespace wi::gui
 			scissor.top = scissor.bottom;
 		}
 
-		GraphicsDevice* device = wi::graphics::GetDevice();
 		float scale = canvas.GetDPIScaling();
 		scissor.bottom = int32_t((float)scissor.bottom * scale);
 		scissor.top = int32_t((float)scissor.top * scale);
 		scissor.left = int32_t((float)scissor.left * scale);
 		scissor.right = int32_t((float)scissor.right * scale);
-		device->BindScissorRects(1, &scissor, cmd);
+		BindScissor(scissor, cmd);
 	}
 	Hitbox2D Widget::GetPointerHitbox(bool constrained) const
 	{
@@ -2946,6 +2992,7 @@ namespace wi::gui
 
 			// control-arrow-triangle
 			{
+				wi::image::FlushBatch(cmd);
 				device->BindPipelineState(&gui_internal().PSO_colored, cmd);
 
 				MiscCB cb;
@@ -3778,12 +3825,25 @@ namespace wi::gui
 		for (size_t i = 0; i < widgets.size(); ++i)
 		{
 			Widget* widget = widgets[i]; // re index in loop, because widgets can be realloced while updating!
-			widget->force_disable = force_disable;
-			widget->Update(canvas, dt);
-			widget->force_disable = false;
-			if (widget->GetState() > FOCUS)
+
+			// Idle widgets that are scrolled out of view are not updated, only their layout is kept up to date
+			//	Windows are always updated, because derived windows can have custom update logic:
+			bool culled = false;
+			if (widget->parent == &scrollable_area && dynamic_cast<Window*>(widget) == nullptr)
 			{
-				force_disable = true;
+				widget->UpdateLayout();
+				culled = widget->IsCulled(scrollable_area.scissorRect);
+			}
+
+			if (!culled)
+			{
+				widget->force_disable = force_disable;
+				widget->Update(canvas, dt);
+				widget->force_disable = false;
+				if (widget->GetState() > FOCUS)
+				{
+					force_disable = true;
+				}
 			}
 
 			if (widget->priority_change)
@@ -4108,14 +4168,12 @@ namespace wi::gui
 		for (size_t i = 0; i < widgets.size(); ++i)
 		{
 			const Widget* widget = widgets[widgets.size() - i - 1];
-			if (widget->parent == nullptr)
+			const Rect& clip = widget->parent == nullptr ? scissorRect : widget->parent->scissorRect;
+			if (widget->IsCulled(clip))
 			{
-				ApplyScissor(canvas, scissorRect, cmd);
-			}
-			else
-			{
-				ApplyScissor(canvas, widget->parent->scissorRect, cmd);
+				continue;
 			}
+			ApplyScissor(canvas, clip, cmd);
 			widget->Render(canvas, cmd);
 		}
 
@@ -4986,6 +5044,7 @@ namespace wi::gui
 
 		const XMMATRIX Projection = canvas.GetProjection();
 
+		wi::image::FlushBatch(cmd);
 		device->BindPipelineState(&gui_internal().PSO_colored, cmd);
 
 		ApplyScissor(canvas, scissorRect, cmd);
@@ -5294,6 +5353,40 @@ namespace wi::gui
 			return true;
 		return false;
 	}
+	const wi::vector<int>& TreeList::GetVisibleItems() const
+	{
+		if (visible_items_dirty)
+		{
+			visible_items_dirty = false;
+			visible_items.clear();
+			int parent_level = 0;
+			bool parent_open = true;
+			for (int i = 0; i < (int)items.size(); ++i)
+			{
+				const Item& item = items[i];
+				if (!parent_open && item.level > parent_level)
+				{
+					continue;
+				}
+				parent_open = item.open;
+				parent_level = item.level;
+				visible_items.push_back(i);
+			}
+		}
+		return visible_items;
+	}
+	void TreeList::GetVisibleRange(int& first, int& last) const
+	{
+		// Items are placed uniformly, so the range that intersects the list area can be computed directly
+		//	instead of testing every item (one row of slack on both ends, exact tests are done by the caller):
+		const int count = (int)GetVisibleItems().size();
+		const Hitbox2D itemlist_box = GetHitbox_ListArea();
+		const float base = translation.y + GetItemOffset(1);
+		const float top = (itemlist_box.pos.y - base) / item_height();
+		const float bottom = (itemlist_box.pos.y + itemlist_box.siz.y - base) / item_height();
+		first = clamp((int)std::floor(top) - 1, 0, count);
+		last = clamp((int)std::ceil(bottom) + 1, first, count);
+	}
 	float TreeList::GetItemOffset(int index) const
 	{
 		return 2 + scrollbar.GetOffset() + index * item_height();
@@ -5488,27 +5581,18 @@ namespace wi::gui
 			// control-list
 			item_highlight = -1;
 			opener_highlight = -1;
-			int first_selected = -1;
 			if (scrollbar.GetState() == IDLE)
 			{
-				int i = -1;
-				int visible_count = 0;
-				int parent_level = 0;
-				bool parent_open = true;
-				for (Item& item : items)
+				// Only the items that are inside the list area are processed:
+				const wi::vector<int>& visible = GetVisibleItems();
+				int first = 0;
+				int last = 0;
+				GetVisibleRange(first, last);
+				for (int v = first; v < last; ++v)
 				{
-					i++;
-					if (item.selected && first_selected < 0)
-					{
-						first_selected = i;
-					}
-					if (!parent_open && item.level > parent_level)
-					{
-						continue;
-					}
-					visible_count++;
-					parent_open = item.open;
-					parent_level = item.level;
+					const int i = visible[v];
+					const int visible_count = v + 1;
+					Item& item = items[i];
 
 					Hitbox2D open_box = GetHitbox_ItemOpener(visible_count, item.level);
 					if (!open_box.intersects(itemlist_box))
@@ -5523,6 +5607,7 @@ namespace wi::gui
 						if (clicked)
 						{
 							item.open = !item.open;
+							visible_items_dirty = true;
 							Activate();
 						}
 					}
@@ -5552,6 +5637,15 @@ namespace wi::gui
 									}
 									else if (wi::input::Down(wi::input::KEYBOARD_BUTTON_LSHIFT) || wi::input::Down(wi::input::KEYBOARD_BUTTON_RSHIFT))
 									{
+										int first_selected = -1;
+										for (int j = 0; j < i; ++j)
+										{
+											if (items[j].selected)
+											{
+												first_selected = j;
+												break;
+											}
+										}
 										if (first_selected >= 0)
 										{
 											// shift: select range from first selected up to current:
@@ -5708,21 +5802,16 @@ namespace wi::gui
 		}
 		const XMMATRIX Projection = canvas.GetProjection();
 
-		// control-list
-		int i = -1;
-		int visible_count = 0;
-		int parent_level = 0;
-		bool parent_open = true;
-		for (const Item& item : items)
+		// control-list, only the items that are inside the list area are rendered:
+		const wi::vector<int>& visible = GetVisibleItems();
+		int first = 0;
+		int last = 0;
+		GetVisibleRange(first, last);
+		for (int v = first; v < last; ++v)
 		{
-			i++;
-			if (!parent_open && item.level > parent_level)
-			{
-				continue;
-			}
-			visible_count++;
-			parent_open = item.open;
-			parent_level = item.level;
+			const int i = visible[v];
+			const int visible_count = v + 1;
+			const Item& item = items[i];
 
 			Hitbox2D open_box = GetHitbox_ItemOpener(visible_count, item.level);
 			if (!open_box.intersects(itemlist_box))
@@ -5743,6 +5832,7 @@ namespace wi::gui
 			// opened flag triangle:
 			if(DoesItemHaveChildren(i))
 			{
+				wi::image::FlushBatch(cmd);
 				device->BindPipelineState(&gui_internal().PSO_colored, cmd);
 
 				MiscCB cb;
@@ -5793,6 +5883,7 @@ namespace wi::gui
 	void TreeList::AddItem(const Item& item)
 	{
 		items.push_back(item);
+		visible_items_dirty = true;
 	}
 	void TreeList::AddItem(const std::string& name)
 	{
@@ -5803,6 +5894,7 @@ namespace wi::gui
 	void TreeList::ClearItems()
 	{
 		items.clear();
+		visible_items_dirty = true;
 	}
 	void TreeList::ClearSelection()
 	{
@@ -5845,21 +5937,7 @@ namespace wi::gui
 	}
 	void TreeList::ComputeScrollbarLength()
 	{
-		float scroll_length = 0;
-		{
-			int parent_level = 0;
-			bool parent_open = true;
-			for (const Item& item : items)
-			{
-				if (!parent_open && item.level > parent_level)
-				{
-					continue;
-				}
-				parent_open = item.open;
-				parent_level = item.level;
-				scroll_length += item_height();
-			}
-		}
+		const float scroll_length = GetVisibleItems().size() * item_height();
 		scrollbar.SetListLength(scroll_length);
 		scrollbar.Update({}, 0);
 	}
@@ -5876,6 +5954,7 @@ namespace wi::gui
 			if (items[target - 1].level == target_level - 1)
 			{
 				items[target - 1].open = true;
+				visible_items_dirty = true;
 				target_level--;
 			}
 			target--;
@@ -5885,20 +5964,8 @@ namespace wi::gui
 		ComputeScrollbarLength();
 
 		// Count visible items before target:
-		int visible_count = 0;
-		int parent_level = 0;
-		bool parent_open = true;
-		for (int i = 0; i <= index; ++i)
-		{
-			auto& item = items[i];
-			if (!parent_open && item.level > parent_level)
-			{
-				continue;
-			}
-			visible_count++;
-			parent_open = item.open;
-			parent_level = item.level;
-		}
+		const wi::vector<int>& visible = GetVisibleItems();
+		const int visible_count = int(std::upper_bound(visible.begin(), visible.end(), index) - visible.begin());
 
 		// Set scrollbar offset:
 		float offset = visible_count * item_height();
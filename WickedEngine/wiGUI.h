@@ -287,6 +287,11 @@ namespace wi::gui
 		float left_text_width = 0;
 		float right_text_width = 0;
 
+		// Layout cache: the world matrix is only decomposed again when it changed
+		XMFLOAT4X4 layout_world = {};
+		XMFLOAT3 layout_translation = XMFLOAT3(0, 0, 0);
+		XMFLOAT3 layout_scale = XMFLOAT3(0, 0, 0);
+
 	public:
 		Widget();
 		virtual ~Widget() = default;
@@ -351,6 +356,11 @@ namespace wi::gui
 		void AttachTo(Widget* parent);
 		void Detach();
 
+		// Recomputes translation and scale from the transform hierarchy, only if it changed since the last time
+		void UpdateLayout();
+		// Returns true if the widget is idle and vertically outside of the clip rect, so its update and rendering can be skipped
+		bool IsCulled(const wi::graphics::Rect& clip) const;
+
 		virtual void Activate();
 		virtual void Deactivate();
 
@@ -1004,6 +1014,13 @@ namespace wi::gui
 
 		wi::vector<Item> items;
 
+		// Indices of items that are not hidden by a closed parent, rebuilt when items are added, removed, opened or closed
+		mutable wi::vector<int> visible_items;
+		mutable bool visible_items_dirty = true;
+		const wi::vector<int>& GetVisibleItems() const;
+		// Returns the range of visible_items that overlaps the list area: [first, last)
+		void GetVisibleRange(int& first, int& last) const;
+
 		float GetItemOffset(int index) const;
 		bool DoesItemHaveChildren(int index) const;
 
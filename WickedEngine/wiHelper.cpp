@@ -1281,6 +1281,24 @@ namespace wi::helper
 		return false;
 	}
 
+	bool FileAppend(const std::string& fileName, const uint8_t* data, size_t size)
+	{
+		if (size <= 0)
+		{
+			return false;
+		}
+
+		std::ofstream file(ToNativeString(fileName), std::ios::binary | std::ios::app);
+		if (file.is_open())
+		{
+			file.write((const char*)data, (std::streamsize)size);
+			file.close();
+			return true;
+		}
+
+		return false;
+	}
+
 	bool FileExists(const std::string& fileName)
 	{
 		bool exists = std::filesystem::exists(ToNativeString(fileName));
@@ -2077,6 +2095,47 @@ namespace wi::helper
 		return ZSTD_isError(res) == 0;
 	}
 
+	bool CompressDelta(const uint8_t* src_data, size_t src_size, const uint8_t* ref_data, size_t ref_size, wi::vector<uint8_t>& dst_data, int level)
+	{
+		// The reference is used as a zstd prefix, and the window is made large enough to cover both the reference and the source:
+		uint32_t window_log = 10;
+		while (window_log < 27 && (1ull << window_log) < ref_size + src_size)
+		{
+			window_log++;
+		}
+		ZSTD_CCtx* cctx = ZSTD_createCCtx();
+		ZSTD_CCtx_setParameter(cctx, ZSTD_c_compressionLevel, level);
+		ZSTD_CCtx_setParameter(cctx, ZSTD_c_windowLog, (int)window_log);
+		ZSTD_CCtx_setParameter(cctx, ZSTD_c_enableLongDistanceMatching, 1);
+		if (ref_data != nullptr && ref_size > 0)
+		{
+			ZSTD_CCtx_refPrefix(cctx, ref_data, ref_size);
+		}
+		dst_data.resize(ZSTD_compressBound(src_size));
+		size_t res = ZSTD_compress2(cctx, dst_data.data(), dst_data.size(), src_data, src_size);
+		ZSTD_freeCCtx(cctx);
+		if (ZSTD_isError(res))
+			return false;
+		dst_data.resize(res);
+		return true;
+	}
+
+	bool DecompressDelta(const uint8_t* src_data, size_t src_size, const uint8_t* ref_data, size_t ref_size, wi::vector<uint8_t>& dst_data)
+	{
+		size_t res = ZSTD_getFrameContentSize(src_data, src_size);
+		if (ZSTD_isError(res))
+			return false;
+		dst_data.resize(res);
+		ZSTD_DCtx* dctx = ZSTD_createDCtx();
+		if (ref_data != nullptr && ref_size > 0)
+		{
+			ZSTD_DCtx_refPrefix(dctx, ref_data, ref_size);
+		}
+		res = ZSTD_decompressDCtx(dctx, dst_data.data(), dst_data.size(), src_data, src_size);
+		ZSTD_freeDCtx(dctx);
+		return ZSTD_isError(res) == 0;
+	}
+
 	size_t HashByteData(const uint8_t* data, size_t size)
 	{
 		size_t hash = 0;
@@ -126,6 +126,9 @@ namespace wi::helper
 
 	bool FileWrite(const std::string& fileName, const uint8_t* data, size_t size);
 
+	// Appends data to the end of the file, the file is created if it doesn't exist
+	bool FileAppend(const std::string& fileName, const uint8_t* data, size_t size);
+
 	bool FileExists(const std::string& fileName);
 
 	bool DirectoryExists(const std::string& fileName);
@@ -230,6 +233,14 @@ namespace wi::helper
 	// Lossless decompression of byte array that was compressed with wi::helper::Compress()
 	bool Decompress(const uint8_t* src_data, size_t src_size, wi::vector<uint8_t>& dst_data);
 
+	// Lossless compression of byte array as a binary delta against a reference byte array
+	//	Content that is matching the reference (or repeating within the source) is stored as references, even if it was moved
+	//	The reference can be empty, the same reference must be used for decompression
+	bool CompressDelta(const uint8_t* src_data, size_t src_size, const uint8_t* ref_data, size_t ref_size, wi::vector<uint8_t>& dst_data, int level = 0);
+
+	// Lossless decompression of byte array that was compressed with wi::helper::CompressDelta()
+	bool DecompressDelta(const uint8_t* src_data, size_t src_size, const uint8_t* ref_data, size_t ref_size, wi::vector<uint8_t>& dst_data);
+
 	// Hash the contents of a file:
 	size_t HashByteData(const uint8_t* data, size_t size);
 
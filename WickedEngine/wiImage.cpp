@@ -8,6 +8,8 @@
 #include "wiTimer.h"
 #include "wiInput.h"
 
+#include <atomic>
+
 using namespace wi::enums;
 using namespace wi::graphics;
 
@@ -35,6 +37,241 @@ namespace wi::image
 	static thread_local Texture backgroundTexture;
 	static thread_local wi::Canvas canvas;
 
+	static std::atomic<uint32_t> statistics_image_count{ 0 };
+	static std::atomic<uint32_t> statistics_draw_call_count{ 0 };
+
+	namespace batch_internal
+	{
+		// How many runs of different state a recorded item can be moved back over to join a compatible run:
+		static constexpr size_t lookback = 16;
+		static constexpr uint32_t renderer_capacity = 8;
+		static constexpr uint32_t renderer_image = 0;
+
+		static BatchRenderer renderers[renderer_capacity];
+		static std::atomic<uint32_t> renderer_count{ 1 }; // renderer_image is always registered
+
+		struct Item
+		{
+			uint32_t renderer;
+			uint32_t key;
+			uint32_t item;
+			XMFLOAT4 bounds;
+		};
+		struct Run
+		{
+			uint32_t renderer;
+			uint32_t key;
+			uint32_t count;
+			uint32_t offset;
+			XMFLOAT4 bounds;
+		};
+		struct State
+		{
+			CommandList cmd;
+			bool active = false;
+			wi::vector<Item> items;
+			wi::vector<Run> runs;
+			wi::vector<uint32_t> item_runs;
+			wi::vector<uint32_t> sorted_items;
+		};
+		static thread_local State state;
+
+		struct Image
+		{
+			ImageConstants image;
+			float4 corners[4];
+		};
+		static thread_local wi::vector<Image> images;
+
+		constexpr bool overlaps(const XMFLOAT4& a, const XMFLOAT4& b)
+		{
+			// touching edges are considered overlapping to be conservative:
+			return a.x <= b.z && b.x <= a.z && a.y <= b.w && b.y <= a.w;
+		}
+		constexpr uint32_t encode_key(uint32_t blend, uint32_t stencilComp, uint32_t stencilRefMode, uint32_t depthTest, uint32_t stencilRef)
+		{
+			return (blend & 0xF) | ((stencilComp & 0xF) << 4u) | ((stencilRefMode & 0x3) << 8u) | ((depthTest & 0x1) << 10u) | ((stencilRef & 0xFF) << 16u);
+		}
+
+		void SubmitImages(const uint32_t* items, uint32_t count, uint32_t key, CommandList cmd)
+		{
+			GraphicsDevice* device = wi::graphics::GetDevice();
+
+			const size_t vb_size = sizeof(float4) * 4 * count;
+			GraphicsDevice::GPUAllocation mem = device->AllocateGPU(vb_size + sizeof(ImageConstants) * count, cmd);
+			if (!mem.IsValid())
+				return;
+			const int descriptor = device->GetDescriptorIndex(&mem.buffer, SubresourceType::SRV);
+			float4* vertices = (float4*)mem.data;
+			ImageConstants* constants = (ImageConstants*)((uint8_t*)mem.data + vb_size);
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				const Image& x = images[items[i]];
+				std::memcpy(vertices + i * 4, x.corners, sizeof(x.corners));
+				ImageConstants image = x.image;
+				image.buffer_index = descriptor;
+				image.buffer_offset = uint(mem.offset + sizeof(float4) * 4 * i);
+				std::memcpy(constants + i, &image, sizeof(image));
+			}
+
+			ImageConstants image = {};
+			image.flags = IMAGE_FLAG_INSTANCED;
+			image.buffer_index = descriptor;
+			image.buffer_offset = uint(mem.offset + vb_size);
+
+			const uint32_t blend = key & 0xF;
+			const uint32_t stencilComp = (key >> 4u) & 0xF;
+			const uint32_t stencilRefMode = (key >> 8u) & 0x3;
+			const uint32_t depthTest = (key >> 10u) & 0x1;
+			const uint32_t stencilRef = (key >> 16u) & 0xFF;
+
+			device->BindStencilRef(stencilRef, cmd);
+			device->BindPipelineState(&imagePSO[blend][stencilComp][stencilRefMode][depthTest][STRIP_ON], cmd);
+			device->BindDynamicConstantBuffer(image, CBSLOT_IMAGE, cmd);
+			device->DrawInstanced(4, count, 0, 0, cmd);
+			statistics_draw_call_count.fetch_add(1, std::memory_order_relaxed);
+		}
+		void ResetImages()
+		{
+			images.clear();
+		}
+	}
+
+	void BeginBatch(CommandList cmd)
+	{
+		using namespace batch_internal;
+		if (state.active)
+		{
+			EndBatch(state.cmd);
+		}
+		state.cmd = cmd;
+		state.active = true;
+	}
+
+	void FlushBatch(CommandList cmd)
+	{
+		using namespace batch_internal;
+		if (!IsBatching(cmd) || state.items.empty())
+			return;
+
+		// Assign every item to a run. An item can join an earlier run with the same state
+		//	if it doesn't overlap anything that was recorded in between:
+		state.runs.clear();
+		state.item_runs.resize(state.items.size());
+		for (size_t i = 0; i < state.items.size(); ++i)
+		{
+			const Item& item = state.items[i];
+			size_t target = state.runs.size();
+			for (size_t j = state.runs.size(); j > 0 && state.runs.size() - j < lookback; --j)
+			{
+				const Run& run = state.runs[j - 1];
+				if (run.renderer == item.renderer && run.key == item.key)
+				{
+					target = j - 1;
+					break;
+				}
+				if (overlaps(run.bounds, item.bounds))
+					break;
+			}
+			if (target == state.runs.size())
+			{
+				Run& run = state.runs.emplace_back();
+				run.renderer = item.renderer;
+				run.key = item.key;
+				run.count = 0;
+				run.offset = 0;
+				run.bounds = item.bounds;
+			}
+			Run& run = state.runs[target];
+			run.count++;
+			run.bounds.x = std::min(run.bounds.x, item.bounds.x);
+			run.bounds.y = std::min(run.bounds.y, item.bounds.y);
+			run.bounds.z = std::max(run.bounds.z, item.bounds.z);
+			run.bounds.w = std::max(run.bounds.w, item.bounds.w);
+			state.item_runs[i] = uint32_t(target);
+		}
+
+		// Gather the items of each run contiguously, keeping the recording order inside runs:
+		uint32_t offset = 0;
+		for (Run& run : state.runs)
+		{
+			run.offset = offset;
+			offset += run.count;
+			run.count = 0;
+		}
+		state.sorted_items.resize(state.items.size());
+		for (size_t i = 0; i < state.items.size(); ++i)
+		{
+			Run& run = state.runs[state.item_runs[i]];
+			state.sorted_items[run.offset + run.count++] = state.items[i].item;
+		}
+
+		for (const Run& run : state.runs)
+		{
+			renderers[run.renderer].submit(state.sorted_items.data() + run.offset, run.count, run.key, cmd);
+		}
+
+		state.items.clear();
+		const uint32_t count = renderer_count.load();
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (renderers[i].reset != nullptr)
+			{
+				renderers[i].reset();
+			}
+		}
+	}
+
+	void EndBatch(CommandList cmd)
+	{
+		using namespace batch_internal;
+		FlushBatch(cmd);
+		if (IsBatching(cmd))
+		{
+			state.active = false;
+			state.cmd = {};
+		}
+	}
+
+	bool IsBatching(CommandList cmd)
+	{
+		return batch_internal::state.active && batch_internal::state.cmd.internal_state == cmd.internal_state;
+	}
+
+	uint32_t RegisterBatchRenderer(const BatchRenderer& renderer)
+	{
+		using namespace batch_internal;
+		const uint32_t id = renderer_count.fetch_add(1);
+		assert(id < renderer_capacity);
+		renderers[id] = renderer;
+		return id;
+	}
+
+	void RecordBatchItem(uint32_t renderer, uint32_t key, uint32_t item, const XMFLOAT4& bounds)
+	{
+		using namespace batch_internal;
+		assert(state.active);
+		Item& x = state.items.emplace_back();
+		x.renderer = renderer;
+		x.key = key;
+		x.item = item;
+		x.bounds = bounds;
+	}
+
+	Statistics GetStatistics()
+	{
+		Statistics statistics;
+		statistics.image_count = statistics_image_count.load();
+		statistics.draw_call_count = statistics_draw_call_count.load();
+		return statistics;
+	}
+
+	void ResetStatistics()
+	{
+		statistics_image_count.store(0);
+		statistics_draw_call_count.store(0);
+	}
+
 	void SetBackground(const Texture& texture)
 	{
 		backgroundTexture = texture;
@@ -49,6 +286,16 @@ namespace wi::image
 	{
 		GraphicsDevice* device = wi::graphics::GetDevice();
 
+		statistics_image_count.fetch_add(1, std::memory_order_relaxed);
+
+		// Full screen and rounded images use their own geometry, these are not batched:
+		bool batched = IsBatching(cmd);
+		if (batched && (params.isFullScreenEnabled() || params.isCornerRoundingEnabled()))
+		{
+			FlushBatch(cmd);
+			batched = false;
+		}
+
 		const Sampler* sampler = &samplers[SAMPLER_LINEAR_CLAMP];
 
 		if (params.quality == QUALITY_NEAREST)
@@ -178,6 +425,7 @@ namespace wi::image
 
 		STRIP_MODE strip_mode = STRIP_ON;
 		uint32_t index_count = 0;
+		float4 corners[4] = {};
 
 		if (params.isFullScreenEnabled())
 		{
@@ -214,7 +462,6 @@ namespace wi::image
 			}
 
 			XMVECTOR V[4];
-			float4 corners[4];
 			for (int i = 0; i < arraysize(params.corners); ++i)
 			{
 				V[i] = XMVectorSet(params.corners[i].x - params.pivot.x, params.corners[i].y - params.pivot.y, 0, 1);
@@ -312,7 +559,7 @@ namespace wi::image
 				indices[ii++] = vi - 1;
 				indices[ii++] = 1;
 			}
-			else
+			else if (!batched)
 			{
 				// Non rounded image will simply use a 4 vertex triangle strip (simple quad)
 				GraphicsDevice::GPUAllocation mem = device->AllocateGPU(sizeof(float4) * 4, cmd);
@@ -392,13 +639,41 @@ namespace wi::image
 			image.gradient_uv_end = wi::math::pack_half2(params.gradient_uv_end);
 		}
 
-		device->EventBegin("Image", cmd);
-
 		uint32_t stencilRef = params.stencilRef;
 		if (params.stencilRefMode == STENCILREFMODE_USER)
 		{
 			stencilRef = wi::renderer::CombineStencilrefs(STENCILREF_EMPTY, (uint8_t)stencilRef);
 		}
+
+		if (batched)
+		{
+			// The vertices are written when the batch is submitted, the screen bounds are needed to keep the order of overlapping images:
+			XMFLOAT4 bounds = XMFLOAT4(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+			for (const float4& corner : corners)
+			{
+				if (corner.w <= 0)
+				{
+					// crossing the camera plane, the projected bounds are not reliable:
+					bounds = XMFLOAT4(-FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX);
+					break;
+				}
+				const float x = corner.x / corner.w;
+				const float y = corner.y / corner.w;
+				bounds.x = std::min(bounds.x, x);
+				bounds.y = std::min(bounds.y, y);
+				bounds.z = std::max(bounds.z, x);
+				bounds.w = std::max(bounds.w, y);
+			}
+			batch_internal::Image& x = batch_internal::images.emplace_back();
+			x.image = image;
+			std::memcpy(x.corners, corners, sizeof(corners));
+			const uint32_t key = batch_internal::encode_key(params.blendFlag, params.stencilComp, params.stencilRefMode, params.isDepthTestEnabled() ? 1 : 0, stencilRef);
+			RecordBatchItem(batch_internal::renderer_image, key, uint32_t(batch_internal::images.size() - 1), bounds);
+			return;
+		}
+
+		device->EventBegin("Image", cmd);
+
 		device->BindStencilRef(stencilRef, cmd);
 
 		device->BindPipelineState(&imagePSO[params.blendFlag][params.stencilComp][params.stencilRefMode][params.isDepthTestEnabled()][strip_mode], cmd);
@@ -423,6 +698,8 @@ namespace wi::image
 			}
 		}
 
+		statistics_draw_call_count.fetch_add(1, std::memory_order_relaxed);
+
 		device->EventEnd(cmd);
 	}
 
@@ -691,6 +968,9 @@ namespace wi::image
 		samplerDesc.max_anisotropy = 16;
 		device->CreateSampler(&samplerDesc, &samplers[SAMPLER_ANISO_MIRROR]);
 
+		batch_internal::renderers[batch_internal::renderer_image].submit = batch_internal::SubmitImages;
+		batch_internal::renderers[batch_internal::renderer_image].reset = batch_internal::ResetImages;
+
 		static wi::eventhandler::Handle handle = wi::eventhandler::Subscribe(wi::eventhandler::EVENT_RELOAD_SHADERS, [](uint64_t userdata) { LoadShaders(); });
 		LoadShaders();
 
@@ -250,6 +250,41 @@ namespace wi::image
 	// Draw the specified texture with the specified parameters
 	void Draw(const wi::graphics::Texture* texture, const Params& params, wi::graphics::CommandList cmd);
 
+	// Begin batching 2D draws (images and fonts) of the current thread into the command list
+	//	While batching, compatible draws are recorded and later submitted as instanced draws
+	//	A draw is only moved before other draws that it doesn't overlap on screen, so the result matches the unbatched draw order
+	//	Anything other than wi::image and wi::font that modifies the command list while batching (scissor, custom draws) must call FlushBatch() first
+	void BeginBatch(wi::graphics::CommandList cmd);
+	// Submit every recorded draw, but keep batching
+	void FlushBatch(wi::graphics::CommandList cmd);
+	// Submit every recorded draw and stop batching
+	void EndBatch(wi::graphics::CommandList cmd);
+	// Returns true if draws into the command list are being batched on the current thread
+	bool IsBatching(wi::graphics::CommandList cmd);
+
+	// Other 2D renderers can record their own draws into the batch with this interface:
+	struct BatchRenderer
+	{
+		// Submit the recorded items which share the same key, in recording order:
+		void(*submit)(const uint32_t* items, uint32_t count, uint32_t key, wi::graphics::CommandList cmd) = nullptr;
+		// Release the items recorded by the current thread after they were all submitted:
+		void(*reset)() = nullptr;
+	};
+	// Returns the renderer id that can be used with RecordBatchItem()
+	uint32_t RegisterBatchRenderer(const BatchRenderer& renderer);
+	// Record an item while batching. Items with matching renderer and key can be merged
+	//	bounds is the covered area in clip space (left, top, right, bottom), it is used to keep the draw order of overlapping items
+	void RecordBatchItem(uint32_t renderer, uint32_t key, uint32_t item, const XMFLOAT4& bounds);
+
+	struct Statistics
+	{
+		uint32_t image_count = 0; // number of Draw() calls
+		uint32_t draw_call_count = 0; // number of draw calls submitted to the GPU by the image renderer
+	};
+	// Returns the statistics accumulated since the last ResetStatistics()
+	Statistics GetStatistics();
+	void ResetStatistics();
+
 	// Initializes the image renderer
 	void Initialize();
 
@@ -100,6 +100,117 @@ namespace wi::noise
 			return result;
 		}
 
+		// 4-wide version of grad(), hash is expected in the low 8 bits of each lane
+		inline XMVECTOR XM_CALLCONV grad(__m128i hash, FXMVECTOR x, FXMVECTOR y, FXMVECTOR z) const
+		{
+			const __m128i h = _mm_and_si128(hash, _mm_set1_epi32(15));
+			const XMVECTOR h_lt8 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(8)));
+			const XMVECTOR h_lt4 = _mm_castsi128_ps(_mm_cmplt_epi32(h, _mm_set1_epi32(4)));
+			const XMVECTOR h_12_14 = _mm_castsi128_ps(_mm_or_si128(_mm_cmpeq_epi32(h, _mm_set1_epi32(12)), _mm_cmpeq_epi32(h, _mm_set1_epi32(14))));
+			const XMVECTOR u = XMVectorSelect(y, x, h_lt8);
+			const XMVECTOR v = XMVectorSelect(XMVectorSelect(z, x, h_12_14), y, h_lt4);
+			const XMVECTOR sign_u = _mm_and_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(h, _mm_set1_epi32(1)), _mm_set1_epi32(1))), g_XMNegativeZero);
+			const XMVECTOR sign_v = _mm_and_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(h, _mm_set1_epi32(2)), _mm_set1_epi32(2))), g_XMNegativeZero);
+			return XMVectorAdd(_mm_xor_ps(u, sign_u), _mm_xor_ps(v, sign_v));
+		}
+		inline XMVECTOR XM_CALLCONV fade(FXMVECTOR t) const
+		{
+			const XMVECTOR t3 = XMVectorMultiply(XMVectorMultiply(t, t), t);
+			return XMVectorMultiply(t3, XMVectorAdd(XMVectorMultiply(t, XMVectorSubtract(XMVectorMultiply(t, XMVectorReplicate(6)), XMVectorReplicate(15))), XMVectorReplicate(10)));
+		}
+		inline XMVECTOR XM_CALLCONV lerp(FXMVECTOR a, FXMVECTOR b, FXMVECTOR t) const
+		{
+			// Not using XMVectorLerp, because that can be fused multiply-add which would not match the scalar version
+			return XMVectorAdd(a, XMVectorMultiply(XMVectorSubtract(b, a), t));
+		}
+		// Computes noise for 4 points at once with the same operation order as the scalar compute(), so results match
+		//	returns noise in range [-1, 1]
+		inline XMVECTOR XM_CALLCONV compute(FXMVECTOR x, FXMVECTOR y, FXMVECTOR z) const
+		{
+			const XMVECTOR _x = XMVectorFloor(x);
+			const XMVECTOR _y = XMVectorFloor(y);
+			const XMVECTOR _z = XMVectorFloor(z);
+
+			alignas(16) int32_t ix[4];
+			alignas(16) int32_t iy[4];
+			alignas(16) int32_t iz[4];
+			_mm_store_si128((__m128i*)ix, _mm_and_si128(_mm_cvttps_epi32(_x), _mm_set1_epi32(255)));
+			_mm_store_si128((__m128i*)iy, _mm_and_si128(_mm_cvttps_epi32(_y), _mm_set1_epi32(255)));
+			_mm_store_si128((__m128i*)iz, _mm_and_si128(_mm_cvttps_epi32(_z), _mm_set1_epi32(255)));
+
+			const XMVECTOR fx = XMVectorSubtract(x, _x);
+			const XMVECTOR fy = XMVectorSubtract(y, _y);
+			const XMVECTOR fz = XMVectorSubtract(z, _z);
+
+			const XMVECTOR u = fade(fx);
+			const XMVECTOR v = fade(fy);
+			const XMVECTOR w = fade(fz);
+
+			// Permutation table lookups can't be vectorized without gather, these are done per lane:
+			alignas(16) int32_t h[8][4];
+			for (int i = 0; i < 4; ++i)
+			{
+				const uint8_t A = (state[ix[i] & 255] + iy[i]) & 255;
+				const uint8_t B = (state[(ix[i] + 1) & 255] + iy[i]) & 255;
+
+				const uint8_t AA = (state[A] + iz[i]) & 255;
+				const uint8_t AB = (state[(A + 1) & 255] + iz[i]) & 255;
+
+				const uint8_t BA = (state[B] + iz[i]) & 255;
+				const uint8_t BB = (state[(B + 1) & 255] + iz[i]) & 255;
+
+				h[0][i] = state[AA];
+				h[1][i] = state[BA];
+				h[2][i] = state[AB];
+				h[3][i] = state[BB];
+				h[4][i] = state[(AA + 1) & 255];
+				h[5][i] = state[(BA + 1) & 255];
+				h[6][i] = state[(AB + 1) & 255];
+				h[7][i] = state[(BB + 1) & 255];
+			}
+
+			const XMVECTOR one = XMVectorReplicate(1);
+			const XMVECTOR fx1 = XMVectorSubtract(fx, one);
+			const XMVECTOR fy1 = XMVectorSubtract(fy, one);
+			const XMVECTOR fz1 = XMVectorSubtract(fz, one);
+
+			const XMVECTOR p0 = grad(_mm_load_si128((const __m128i*)h[0]), fx, fy, fz);
+			const XMVECTOR p1 = grad(_mm_load_si128((const __m128i*)h[1]), fx1, fy, fz);
+			const XMVECTOR p2 = grad(_mm_load_si128((const __m128i*)h[2]), fx, fy1, fz);
+			const XMVECTOR p3 = grad(_mm_load_si128((const __m128i*)h[3]), fx1, fy1, fz);
+			const XMVECTOR p4 = grad(_mm_load_si128((const __m128i*)h[4]), fx, fy, fz1);
+			const XMVECTOR p5 = grad(_mm_load_si128((const __m128i*)h[5]), fx1, fy, fz1);
+			const XMVECTOR p6 = grad(_mm_load_si128((const __m128i*)h[6]), fx, fy1, fz1);
+			const XMVECTOR p7 = grad(_mm_load_si128((const __m128i*)h[7]), fx1, fy1, fz1);
+
+			const XMVECTOR q0 = lerp(p0, p1, u);
+			const XMVECTOR q1 = lerp(p2, p3, u);
+			const XMVECTOR q2 = lerp(p4, p5, u);
+			const XMVECTOR q3 = lerp(p6, p7, u);
+
+			const XMVECTOR r0 = lerp(q0, q1, v);
+			const XMVECTOR r1 = lerp(q2, q3, v);
+
+			return lerp(r0, r1, w);
+		}
+		// Computes noise for 4 points at once with the same operation order as the scalar compute(), so results match
+		//	returns noise in range [-1, 1]
+		inline XMVECTOR XM_CALLCONV compute(XMVECTOR x, XMVECTOR y, XMVECTOR z, int octaves, float persistence = 0.5f) const
+		{
+			XMVECTOR result = XMVectorZero();
+			float amplitude = 1;
+			const XMVECTOR two = XMVectorReplicate(2);
+			for (int i = 0; i < octaves; ++i)
+			{
+				result = XMVectorAdd(result, XMVectorMultiply(compute(x, y, z), XMVectorReplicate(amplitude)));
+				x = XMVectorMultiply(x, two);
+				y = XMVectorMultiply(y, two);
+				z = XMVectorMultiply(z, two);
+				amplitude *= persistence;
+			}
+			return result;
+		}
+
 		void Serialize(wi::Archive& archive)
 		{
 			if (archive.IsReadMode())
@@ -152,9 +263,9 @@ namespace wi::noise
 			vResult = XMVectorRound(vResult);
 			return FNMADD_COMPAT(vResult, g_XMTwoPi, Angles);
 		}
-		inline XMFLOAT2 sin(XMFLOAT2 p)
+		inline XMVECTOR XM_CALLCONV sin(FXMVECTOR V)
 		{
-			XMVECTOR P = XMLoadFloat2(&p);
+			XMVECTOR P = V;
 			//P = XMVectorSin(P);
 			{
 				// Force the value within the bounds of pi
@@ -193,8 +304,12 @@ namespace wi::noise
 
 				P = Result;
 			}
+			return P;
+		}
+		inline XMFLOAT2 sin(XMFLOAT2 p)
+		{
 			XMFLOAT2 ret;
-			XMStoreFloat2(&ret, P);
+			XMStoreFloat2(&ret, sin(XMLoadFloat2(&p)));
 			return ret;
 		}
 
@@ -207,11 +322,26 @@ namespace wi::noise
 			ret = sin(ret);
 			return fract(XMFLOAT2(ret.x * 18.5453f, ret.y * 18.5453f));
 		}
+		// 4-wide version of hash(), px and py contain the x and y coordinates of 4 points
+		inline void XM_CALLCONV hash(FXMVECTOR px, FXMVECTOR py, XMVECTOR& ox, XMVECTOR& oy)
+		{
+			XMVECTOR rx = XMVectorAdd(XMVectorMultiply(px, XMVectorReplicate(127.1f)), XMVectorMultiply(py, XMVectorReplicate(311.7f)));
+			XMVECTOR ry = XMVectorAdd(XMVectorMultiply(px, XMVectorReplicate(269.5f)), XMVectorMultiply(py, XMVectorReplicate(183.3f)));
+			rx = XMVectorMultiply(sin(rx), XMVectorReplicate(18.5453f));
+			ry = XMVectorMultiply(sin(ry), XMVectorReplicate(18.5453f));
+			ox = XMVectorSubtract(rx, XMVectorFloor(rx));
+			oy = XMVectorSubtract(ry, XMVectorFloor(ry));
+		}
 		struct Result
 		{
 			float distance = 0;
 			float cell_id = 0;
 		};
+		struct Result4
+		{
+			XMVECTOR distance;
+			XMVECTOR cell_id;
+		};
 		inline Result compute(float x, float y, float seed)
 		{
 			Result result;
@@ -243,5 +373,48 @@ namespace wi::noise
 
 			return result;
 		}
+		// Computes 4 points at once with the same operation order as the scalar compute(), so results match
+		inline Result4 XM_CALLCONV compute(FXMVECTOR x, FXMVECTOR y, float seed)
+		{
+			const XMVECTOR nx = XMVectorFloor(x);
+			const XMVECTOR ny = XMVectorFloor(y);
+			const XMVECTOR fx = XMVectorSubtract(x, nx);
+			const XMVECTOR fy = XMVectorSubtract(y, ny);
+			const XMVECTOR half = XMVectorReplicate(0.5f);
+
+			XMVECTOR mx = XMVectorReplicate(8);
+			XMVECTOR my = XMVectorZero();
+			XMVECTOR mz = XMVectorZero();
+			for (int j = -1; j <= 1; j++)
+			{
+				for (int i = -1; i <= 1; i++)
+				{
+					const XMVECTOR gx = XMVectorReplicate(float(i));
+					const XMVECTOR gy = XMVectorReplicate(float(j));
+					XMVECTOR ox, oy;
+					hash(XMVectorAdd(nx, gx), XMVectorAdd(ny, gy), ox, oy);
+
+					// std::sin is kept per lane to match the scalar version exactly:
+					XMFLOAT4A o_x, o_y;
+					XMStoreFloat4A(&o_x, ox);
+					XMStoreFloat4A(&o_y, oy);
+					const XMVECTOR sx = XMVectorSet(std::sin(seed * o_x.x), std::sin(seed * o_x.y), std::sin(seed * o_x.z), std::sin(seed * o_x.w));
+					const XMVECTOR sy = XMVectorSet(std::sin(seed * o_y.x), std::sin(seed * o_y.y), std::sin(seed * o_y.z), std::sin(seed * o_y.w));
+
+					const XMVECTOR rx = XMVectorAdd(XMVectorSubtract(gx, fx), XMVectorAdd(half, XMVectorMultiply(half, sx)));
+					const XMVECTOR ry = XMVectorAdd(XMVectorSubtract(gy, fy), XMVectorAdd(half, XMVectorMultiply(half, sy)));
+					const XMVECTOR d = XMVectorAdd(XMVectorMultiply(rx, rx), XMVectorMultiply(ry, ry));
+					const XMVECTOR closer = XMVectorLess(d, mx);
+					mx = XMVectorSelect(mx, d, closer);
+					my = XMVectorSelect(my, ox, closer);
+					mz = XMVectorSelect(mz, oy, closer);
+				}
+			}
+
+			Result4 result;
+			result.distance = XMVectorSqrt(mx);
+			result.cell_id = XMVectorAdd(my, mz);
+			return result;
+		}
 	};
 }
@@ -7,6 +7,7 @@
 #include "wiEventHandler.h"
 #include "wiTimer.h"
 #include "wiVector.h"
+#include "wiJobSystem.h"
 
 #include <algorithm>
 #include <mutex>
@@ -115,13 +116,16 @@ namespace wi
 			occlusionQueries[i] = -1;
 		}
 
-		GraphicsDevice* device = wi::graphics::GetDevice();
-
 		// Height map H(0)
 		int height_map_size = (params.dmap_dim + 4) * (params.dmap_dim + 1);
-		wi::vector<XMFLOAT2> h0_data(height_map_size);
-		wi::vector<float> omega_data(height_map_size);
+		h0_data.resize(height_map_size);
+		omega_data.resize(height_map_size);
 		initHeightMap(h0_data.data(), omega_data.data());
+		cpu = {};
+
+		GraphicsDevice* device = wi::graphics::GetDevice();
+		if (device == nullptr)
+			return; // headless, only the CPU simulation can be used
 
 		int hmap_dim = params.dmap_dim;
 		int input_full_size = (hmap_dim + 4) * (hmap_dim + 1);
@@ -212,6 +216,9 @@ namespace wi
 
 	XMFLOAT3 Ocean::GetDisplacedPosition(const XMFLOAT3& worldPosition) const
 	{
+		if (IsCPUSimulationValid())
+			return cpu.GetDisplacedPosition(worldPosition, params);
+
 		XMFLOAT3 ocean_pos = XMFLOAT3(worldPosition.x, params.waterHeight, worldPosition.z);
 		if (displacement_readback_valid[displacement_readback_index])
 		{
@@ -249,6 +256,257 @@ namespace wi
 		}
 		return ocean_pos;
 	}
+	void Ocean::GetDisplacedPositions(const XMFLOAT3* worldPositions, XMFLOAT3* results, size_t count) const
+	{
+		if (IsCPUSimulationValid())
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				results[i] = cpu.GetDisplacedPosition(worldPositions[i], params);
+			}
+			return;
+		}
+		for (size_t i = 0; i < count; ++i)
+		{
+			results[i] = GetDisplacedPosition(worldPositions[i]);
+		}
+	}
+
+	void Ocean::CPUSimulation::Resize(uint32_t dim)
+	{
+		this->dim = dim;
+		uint32_t log2dim = 0;
+		while ((1u << log2dim) < dim)
+		{
+			log2dim++;
+		}
+		bitreverse.resize(dim);
+		for (uint32_t i = 0; i < dim; ++i)
+		{
+			uint32_t r = 0;
+			for (uint32_t bit = 0; bit < log2dim; ++bit)
+			{
+				r |= ((i >> bit) & 1u) << (log2dim - 1 - bit);
+			}
+			bitreverse[i] = r;
+		}
+		twiddle_re.resize(dim);
+		twiddle_im.resize(dim);
+		for (uint32_t half = 1; half < dim; half *= 2)
+		{
+			for (uint32_t j = 0; j < half; ++j)
+			{
+				const double phase = -XM_PI * double(j) / double(half);
+				twiddle_re[half - 1 + j] = float(std::cos(phase));
+				twiddle_im[half - 1 + j] = float(std::sin(phase));
+			}
+		}
+		const size_t size = size_t(dim) * dim * 3;
+		data_re.resize(size);
+		data_im.resize(size);
+		temp_re.resize(size);
+		temp_im.resize(size);
+		displacement.resize(size_t(dim) * dim);
+		std::fill(displacement.begin(), displacement.end(), XMFLOAT4(0, 0, 0, 0));
+	}
+	void Ocean::CPUSimulation::FFT(float* re, float* im) const
+	{
+		for (uint32_t i = 0; i < dim; ++i)
+		{
+			const uint32_t j = bitreverse[i];
+			if (i < j)
+			{
+				std::swap(re[i], re[j]);
+				std::swap(im[i], im[j]);
+			}
+		}
+
+		// The first two stages are merged into radix-4 butterflies, the twiddle factors are 1 and -i:
+		for (uint32_t i = 0; i < dim; i += 4)
+		{
+			const float a0r = re[i + 0] + re[i + 1];
+			const float a0i = im[i + 0] + im[i + 1];
+			const float a1r = re[i + 0] - re[i + 1];
+			const float a1i = im[i + 0] - im[i + 1];
+			const float a2r = re[i + 2] + re[i + 3];
+			const float a2i = im[i + 2] + im[i + 3];
+			const float a3r = re[i + 2] - re[i + 3];
+			const float a3i = im[i + 2] - im[i + 3];
+			re[i + 0] = a0r + a2r;
+			im[i + 0] = a0i + a2i;
+			re[i + 2] = a0r - a2r;
+			im[i + 2] = a0i - a2i;
+			re[i + 1] = a1r + a3i;
+			im[i + 1] = a1i - a3r;
+			re[i + 3] = a1r - a3i;
+			im[i + 3] = a1i + a3r;
+		}
+
+		// The remaining stages have consecutive twiddle factors for every 4 butterflies, they are computed with SIMD:
+		for (uint32_t half = 4; half < dim; half *= 2)
+		{
+			const float* w_re = twiddle_re.data() + half - 1;
+			const float* w_im = twiddle_im.data() + half - 1;
+			for (uint32_t start = 0; start < dim; start += half * 2)
+			{
+				float* a_re = re + start;
+				float* a_im = im + start;
+				float* b_re = a_re + half;
+				float* b_im = a_im + half;
+				for (uint32_t j = 0; j < half; j += 4)
+				{
+					const XMVECTOR Wr = XMLoadFloat4((const XMFLOAT4*)(w_re + j));
+					const XMVECTOR Wi = XMLoadFloat4((const XMFLOAT4*)(w_im + j));
+					const XMVECTOR Ar = XMLoadFloat4((const XMFLOAT4*)(a_re + j));
+					const XMVECTOR Ai = XMLoadFloat4((const XMFLOAT4*)(a_im + j));
+					const XMVECTOR Br = XMLoadFloat4((const XMFLOAT4*)(b_re + j));
+					const XMVECTOR Bi = XMLoadFloat4((const XMFLOAT4*)(b_im + j));
+					const XMVECTOR Tr = XMVectorNegativeMultiplySubtract(Bi, Wi, XMVectorMultiply(Br, Wr));
+					const XMVECTOR Ti = XMVectorMultiplyAdd(Br, Wi, XMVectorMultiply(Bi, Wr));
+					XMStoreFloat4((XMFLOAT4*)(a_re + j), XMVectorAdd(Ar, Tr));
+					XMStoreFloat4((XMFLOAT4*)(a_im + j), XMVectorAdd(Ai, Ti));
+					XMStoreFloat4((XMFLOAT4*)(b_re + j), XMVectorSubtract(Ar, Tr));
+					XMStoreFloat4((XMFLOAT4*)(b_im + j), XMVectorSubtract(Ai, Ti));
+				}
+			}
+		}
+	}
+	XMFLOAT3 Ocean::CPUSimulation::GetDisplacedPosition(const XMFLOAT3& worldPosition, const OceanParameters& params) const
+	{
+		// Texel centers are at half texel offsets and the map is tiled, like when the GPU samples the displacement map:
+		const float patch_size_rcp = 1.0f / params.patch_length;
+		const float fx = worldPosition.x * patch_size_rcp * dim - 0.5f;
+		const float fy = worldPosition.z * patch_size_rcp * dim - 0.5f;
+		const float x0 = std::floor(fx);
+		const float y0 = std::floor(fy);
+		const uint32_t mask = dim - 1;
+		const uint32_t left = uint32_t(int(x0)) & mask;
+		const uint32_t right = (left + 1) & mask;
+		const uint32_t top = uint32_t(int(y0)) & mask;
+		const uint32_t bottom = (top + 1) & mask;
+		const XMVECTOR tl = XMLoadFloat4(&displacement[top * dim + left]);
+		const XMVECTOR tr = XMLoadFloat4(&displacement[top * dim + right]);
+		const XMVECTOR bl = XMLoadFloat4(&displacement[bottom * dim + left]);
+		const XMVECTOR br = XMLoadFloat4(&displacement[bottom * dim + right]);
+		const float tx = fx - x0;
+		const float ty = fy - y0;
+		XMFLOAT4 sampled;
+		XMStoreFloat4(&sampled, XMVectorLerp(XMVectorLerp(tl, tr, tx), XMVectorLerp(bl, br, tx), ty));
+		// xzy swizzle is on purpose, that's how the data is generated on GPU:
+		return XMFLOAT3(
+			worldPosition.x + sampled.x,
+			params.waterHeight + sampled.z,
+			worldPosition.z + sampled.y
+		);
+	}
+	void Ocean::UpdateDisplacementMapCPU(float time)
+	{
+		if (h0_data.empty())
+			return;
+		uint32_t dim = params.cpu_simulation_dim;
+		if (dim == 0 && !displacementMap.IsValid())
+		{
+			dim = 128; // there is no GPU simulation
+		}
+		if (dim == 0)
+		{
+			if (cpu.dim > 0)
+			{
+				cpu = {};
+			}
+			return;
+		}
+		dim = std::min(std::max(wi::math::GetNextPowerOfTwo(dim), 64u), 256u);
+		dim = std::min(dim, (uint32_t)params.dmap_dim);
+		if (cpu.dim != dim)
+		{
+			cpu.Resize(dim);
+		}
+
+		const uint32_t actual_dim = params.dmap_dim;
+		const uint32_t input_width = actual_dim + 4;
+		const uint32_t offset = actual_dim / 2 - dim / 2; // the CPU grid is the center (lowest frequencies) of the full spectrum
+		const uint32_t grid_size = dim * dim;
+		const float t = time * params.time_scale;
+		wi::jobsystem::context ctx;
+
+		// H(0) -> H(t), D(x, t), D(y, t), same as oceanSimulatorCS:
+		wi::jobsystem::Dispatch(ctx, dim, 8, [&](wi::jobsystem::JobArgs args) {
+			const uint32_t y = args.jobIndex;
+			for (uint32_t x = 0; x < dim; ++x)
+			{
+				const uint32_t gx = x + offset;
+				const uint32_t gy = y + offset;
+				const uint32_t in_index = gy * input_width + gx;
+				const uint32_t in_mindex = (actual_dim - gy) * input_width + (actual_dim - gx);
+				const XMFLOAT2 h0_k = h0_data[in_index];
+				const XMFLOAT2 h0_mk = h0_data[in_mindex];
+				const float sin_v = std::sin(omega_data[in_index] * t);
+				const float cos_v = std::cos(omega_data[in_index] * t);
+
+				XMFLOAT2 ht;
+				ht.x = (h0_k.x + h0_mk.x) * cos_v - (h0_k.y + h0_mk.y) * sin_v;
+				ht.y = (h0_k.x - h0_mk.x) * sin_v + (h0_k.y - h0_mk.y) * cos_v;
+
+				float kx = float(x) - dim * 0.5f;
+				float ky = float(y) - dim * 0.5f;
+				const float sqr_k = kx * kx + ky * ky;
+				const float rsqr_k = sqr_k > 1e-12f ? 1.0f / std::sqrt(sqr_k) : 0;
+				kx *= rsqr_k;
+				ky *= rsqr_k;
+
+				const uint32_t out_index = y * dim + x;
+				cpu.data_re[out_index] = ht.x;
+				cpu.data_im[out_index] = ht.y;
+				cpu.data_re[grid_size + out_index] = ht.y * kx;
+				cpu.data_im[grid_size + out_index] = -ht.x * kx;
+				cpu.data_re[grid_size * 2 + out_index] = ht.y * ky;
+				cpu.data_im[grid_size * 2 + out_index] = -ht.x * ky;
+			}
+		});
+		wi::jobsystem::Wait(ctx);
+
+		// 2D FFT: rows, transpose, rows again. The result is transposed, which is accounted for in the final pass
+		const uint32_t row_count = dim * 3;
+		auto fft_rows = [&](wi::jobsystem::JobArgs args) {
+			const size_t row_offset = size_t(args.jobIndex) * dim;
+			cpu.FFT(cpu.data_re.data() + row_offset, cpu.data_im.data() + row_offset);
+		};
+		wi::jobsystem::Dispatch(ctx, row_count, 16, fft_rows);
+		wi::jobsystem::Wait(ctx);
+
+		wi::jobsystem::Dispatch(ctx, row_count, 16, [&](wi::jobsystem::JobArgs args) {
+			const uint32_t grid_offset = (args.jobIndex / dim) * grid_size;
+			const uint32_t row = args.jobIndex % dim;
+			for (uint32_t column = 0; column < dim; ++column)
+			{
+				cpu.temp_re[grid_offset + column * dim + row] = cpu.data_re[grid_offset + row * dim + column];
+				cpu.temp_im[grid_offset + column * dim + row] = cpu.data_im[grid_offset + row * dim + column];
+			}
+		});
+		wi::jobsystem::Wait(ctx);
+		std::swap(cpu.data_re, cpu.temp_re);
+		std::swap(cpu.data_im, cpu.temp_im);
+
+		wi::jobsystem::Dispatch(ctx, row_count, 16, fft_rows);
+		wi::jobsystem::Wait(ctx);
+
+		// Same as oceanUpdateDisplacementMapCS:
+		wi::jobsystem::Dispatch(ctx, dim, 8, [&](wi::jobsystem::JobArgs args) {
+			const uint32_t y = args.jobIndex;
+			for (uint32_t x = 0; x < dim; ++x)
+			{
+				const uint32_t index = x * dim + y; // transposed
+				const float sign_correction = ((x + y) & 1) ? -1.0f : 1.0f;
+				XMFLOAT4& displacement = cpu.displacement[y * dim + x];
+				displacement.x = cpu.data_re[grid_size + index] * sign_correction * params.choppy_scale;
+				displacement.y = cpu.data_re[grid_size * 2 + index] * sign_correction * params.choppy_scale;
+				displacement.z = cpu.data_re[index] * sign_correction;
+				displacement.w = 1;
+			}
+		});
+		wi::jobsystem::Wait(ctx);
+	}
 
 	// Initialize the vector field.
 	// wlen_x: width of wave tile, in meters
@@ -330,7 +588,7 @@ namespace wi
 		return cb;
 	}
 
-	void Ocean::UpdateDisplacementMap(CommandList cmd) const
+	void Ocean::UpdateDisplacementMap(float time, CommandList cmd) const
 	{
 		GraphicsDevice* device = wi::graphics::GetDevice();
 
@@ -338,6 +596,7 @@ namespace wi
 
 		const uint2 dim = uint2(160 * params.surfaceDetail, 90 * params.surfaceDetail);
 		OceanCB cb = GetOceanCBAtDim(params, dim);
+		cb.xOceanTime = time;
 
 		device->Barrier(GPUBarrier::Buffer(&constantBuffer, ResourceState::CONSTANT_BUFFER, ResourceState::COPY_DST), cmd);
 		device->UpdateBuffer(&constantBuffer, &cb, cmd);
@@ -37,10 +37,18 @@ namespace wi
 			float waterHeight = 0.0f;
 			uint32_t surfaceDetail = 4;
 			float surfaceDisplacementTolerance = 2;
+
+			// Resolution of the CPU simulation, which is used by GetDisplacedPosition() without GPU readback latency
+			//	0 = disabled, otherwise power of 2 in the range [64, 256] and not more than dmap_dim
+			//	It simulates the lowest frequency waves of the same spectrum as the GPU simulation
+			//	If there is no graphics device (headless), the CPU simulation is always used with 128 resolution by default
+			uint32_t cpu_simulation_dim = 0;
 		};
 		void Create(const OceanParameters& params);
 
-		void UpdateDisplacementMap(wi::graphics::CommandList cmd) const;
+		// Updates the GPU simulation
+		//	time : simulation time in seconds, it must be the same that is given to UpdateDisplacementMapCPU()
+		void UpdateDisplacementMap(float time, wi::graphics::CommandList cmd) const;
 		void RenderForOcclusionTest(const wi::scene::CameraComponent& camera, wi::graphics::CommandList cmd) const;
 		void Render(const wi::scene::CameraComponent& camera, wi::graphics::CommandList cmd) const;
 
@@ -52,6 +60,13 @@ namespace wi
 		static void Initialize();
 
 		bool IsValid() const { return displacementMap.IsValid(); }
+		// The ocean can be created without the GPU resources when there is no graphics device
+		bool IsCreated() const { return !h0_data.empty(); }
+
+		// Updates the CPU simulation, it does nothing if the CPU simulation is not enabled (see OceanParameters::cpu_simulation_dim)
+		//	time : simulation time in seconds, it must be the same that is given to UpdateDisplacementMap()
+		void UpdateDisplacementMapCPU(float time);
+		bool IsCPUSimulationValid() const { return cpu.dim > 0; }
 
 		// occlusion result history bitfield (32 bit->32 frame history)
 		mutable uint32_t occlusionHistory = ~0u;
@@ -67,6 +82,8 @@ namespace wi
 
 		// Return the position at world space modified by the ocean displacement map
 		XMFLOAT3 GetDisplacedPosition(const XMFLOAT3& worldPosition) const;
+		// Same as GetDisplacedPosition(), for many positions at once (for example buoyancy points)
+		void GetDisplacedPositions(const XMFLOAT3* worldPositions, XMFLOAT3* results, size_t count) const;
 
 		OceanParameters params;
 
@@ -80,6 +97,29 @@ namespace wi
 
 		void initHeightMap(XMFLOAT2* out_h0, float* out_omega);
 
+		// CPU copies of H(0) and Omega, the CPU simulation uses them
+		wi::vector<XMFLOAT2> h0_data;
+		wi::vector<float> omega_data;
+
+		struct CPUSimulation
+		{
+			uint32_t dim = 0;
+			wi::vector<uint32_t> bitreverse;
+			wi::vector<float> twiddle_re; // twiddle factors of the butterfly stages, the stage of half size h starts at h - 1
+			wi::vector<float> twiddle_im;
+			// H(t), Dx(t) and Dy(t) in consecutive dim * dim grids, the real and imaginary parts are separated for SIMD
+			wi::vector<float> data_re;
+			wi::vector<float> data_im;
+			wi::vector<float> temp_re;
+			wi::vector<float> temp_im;
+			wi::vector<XMFLOAT4> displacement; // same layout as the GPU displacement map
+
+			void Resize(uint32_t dim);
+			// In-place forward FFT of one row, the same transform as the GPU wi::fftgenerator (exp(-i), not scaled)
+			void FFT(float* re, float* im) const;
+			XMFLOAT3 GetDisplacedPosition(const XMFLOAT3& worldPosition, const OceanParameters& params) const;
+		} cpu;
+
 
 		// Initial height field H(0) generated by Phillips spectrum & Gauss distribution.
 		wi::graphics::GPUBuffer buffer_Float2_H0;
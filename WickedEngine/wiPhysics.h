@@ -44,6 +44,106 @@ namespace wi::physics
 	void SetFrameRate(float value);
 	float GetFrameRate();
 
+	// Enable/disable sharing of collision shapes between rigid bodies (default = enabled)
+	//	Bodies with the same shape type, parameters, (quantized) scale and mesh geometry will use the same shape
+	//	Unused shapes are released from the cache automatically
+	void SetShapeCacheEnabled(bool value);
+	bool IsShapeCacheEnabled();
+
+	// Enable/disable writing cooked mesh shapes (convex hull, triangle mesh, height field) into the scene archive (default = disabled)
+	//	This increases the scene file size, but skips shape cooking when the scene is loaded
+	//	Cooked shapes are stored in Jolt's binary format, so they need to be saved again when the physics engine is updated
+	void SetShapeCacheSerializationEnabled(bool value);
+	bool IsShapeCacheSerializationEnabled();
+
+	// Remove all shapes from the shape cache (shapes will remain alive while they are used by rigid bodies)
+	void ClearShapeCache();
+
+	// Returns the number of shapes in the shape cache
+	size_t GetShapeCacheCount();
+
+	// Read/write the shape cache entries of the scene, this is called by Scene::Serialize()
+	void SerializeShapeCache(wi::scene::Scene& scene, wi::Archive& archive);
+
+	enum class StateFlags
+	{
+		NONE = 0,
+		BODIES = 1 << 0,		// rigid bodies, characters, ragdolls and soft bodies
+		CONTACTS = 1 << 1,		// contact cache, this is needed for exact resimulation
+		CONSTRAINTS = 1 << 2,	// constraints and vehicles
+		ALL = BODIES | CONTACTS | CONSTRAINTS,
+	};
+
+	// Save the simulation state of the scene's physics into a buffer (positions, velocities, activation state, etc.)
+	//	Configuration like mass, friction or shapes are not saved
+	//	Kinematic bodies follow their transforms, so those need to be restored by the caller
+	void SaveState(wi::scene::Scene& scene, wi::vector<uint8_t>& buffer, StateFlags flags = StateFlags::ALL);
+
+	// Restore the simulation state from a buffer that was written by SaveState()
+	//	The same physics bodies must exist that were existing when the state was saved
+	//	returns false if the state couldn't be restored
+	bool RestoreState(wi::scene::Scene& scene, const wi::vector<uint8_t>& buffer);
+
+	// Ring buffer of physics states for rollback and replays
+	//	Only the newest state is stored fully, older states are stored as compressed differences to the next one
+	class StateHistory
+	{
+	public:
+		// Set the maximum number of frames that are stored, this also clears the history
+		void Init(uint32_t capacity);
+		void Clear();
+
+		// Save the physics state of the scene for the frame
+		//	If the frame is not newer than the newest frame in the history, the newer frames are discarded first
+		void Record(wi::scene::Scene& scene, uint64_t frame, StateFlags flags = StateFlags::ALL);
+
+		// Reconstruct the state of the frame without modifying the history, it can be restored with RestoreState()
+		//	returns false if the frame is not in the history
+		bool GetState(uint64_t frame, wi::vector<uint8_t>& state) const;
+
+		// Restore the physics state of the frame and discard the newer frames
+		//	returns false if the frame is not in the history
+		bool Rewind(wi::scene::Scene& scene, uint64_t frame);
+
+		bool Contains(uint64_t frame) const;
+		uint64_t GetOldestFrame() const;
+		uint64_t GetNewestFrame() const;
+		uint32_t GetCount() const { return count; }
+		size_t GetMemorySize() const;
+
+	private:
+		struct Entry
+		{
+			uint64_t frame = 0;
+			size_t prev_size = 0; // size of the previous state
+			wi::vector<uint8_t> delta; // encoded difference of this state to the previous state
+		};
+		wi::vector<Entry> entries;
+		uint32_t first = 0;
+		uint32_t count = 0;
+		wi::vector<uint8_t> newest;
+		wi::vector<uint8_t> scratch;
+
+		Entry& GetEntry(uint32_t index) { return entries[(first + index) % entries.size()]; }
+		const Entry& GetEntry(uint32_t index) const { return entries[(first + index) % entries.size()]; }
+		int FindEntry(uint64_t frame) const;
+		void Decode(uint32_t index, wi::vector<uint8_t>& state) const;
+		void Truncate(uint32_t new_count);
+	};
+
+	// Enable/disable deterministic stepping (default = disabled)
+	//	When enabled, every RunPhysicsUpdateSystem() advances the simulation by exactly one fixed step (1 / GetFrameRate()) regardless of delta time
+	//	This makes resimulation from a restored state repeatable, for example for rollback networking
+	void SetDeterministicEnabled(bool value);
+	bool IsDeterministicEnabled();
+
+	// Enable/disable asynchronous simulation (default = disabled)
+	//	When enabled, the simulation step runs on worker threads after RunPhysicsUpdateSystem() returns, overlapping with rendering
+	//	The simulation results are visible in the scene one update later
+	//	Physics functions that access physics objects will wait for the running simulation step to finish
+	void SetAsyncSimulationEnabled(bool value);
+	bool IsAsyncSimulationEnabled();
+
 	// Update the physics state, run simulation, etc.
 	void RunPhysicsUpdateSystem(
 		wi::jobsystem::context& ctx,
@@ -249,3 +349,8 @@ namespace wi::physics
 		const wi::scene::MeshComponent* mesh = nullptr
 	);
 }
+
+template<>
+struct enable_bitmask_operators<wi::physics::StateFlags> {
+	static const bool enable = true;
+};
@@ -12,8 +12,11 @@
 #include <Jolt/Core/Factory.h>
 #include <Jolt/Core/TempAllocator.h>
 #include <Jolt/Core/JobSystemThreadPool.h>
+#include <Jolt/Core/StreamIn.h>
+#include <Jolt/Core/StreamOut.h>
 #include <Jolt/Physics/PhysicsSettings.h>
 #include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Physics/StateRecorder.h>
 #include <Jolt/Physics/Collision/Shape/BoxShape.h>
 #include <Jolt/Physics/Collision/Shape/SphereShape.h>
 #include <Jolt/Physics/Collision/Shape/CapsuleShape.h>
@@ -53,6 +56,8 @@
 #endif // JPH_DEBUG_RENDERER
 
 #include <thread>
+#include <mutex>
+#include <cstring>
 
 // Disable common warnings triggered by Jolt, you can use JPH_SUPPRESS_WARNING_PUSH / JPH_SUPPRESS_WARNING_POP to store and restore the warning state
 JPH_SUPPRESS_WARNINGS
@@ -89,6 +94,8 @@ namespace wi::physics
 		int softbodyIterationCount = 6;
 		float TIMESTEP = 1.0f / 60.0f;
 		bool INTERPOLATION = true;
+		bool DETERMINISTIC = false;
+		bool ASYNC_SIMULATION = false;
 		float CHARACTER_COLLISION_TOLERANCE = 0.05f;
 
 		const uint cMaxBodies = 65536;
@@ -96,6 +103,7 @@ namespace wi::physics
 		const uint cMaxBodyPairs = 65536;
 		const uint cMaxContactConstraints = 65536;
 		const EMotionQuality cMotionQuality = EMotionQuality::LinearCast;
+		const size_t cBroadPhaseOptimizeThreshold = 1024; // OptimizeBroadPhase() after adding at least this many bodies at once
 
 		inline Vec3 cast(const Float3& v) { return Vec3(v.x, v.y, v.z); }
 		inline Vec3 cast(const XMFLOAT3& v) { return Vec3(v.x, v.y, v.z); }
@@ -229,6 +237,83 @@ namespace wi::physics
 			{
 				return clamp(accumulator + dt, 0.0f, TIMESTEP * ACCURACY);
 			}
+
+			// Asynchronous simulation state:
+			//	The step is running on a worker thread after RunPhysicsUpdateSystem() returns, until it's waited on
+			wi::jobsystem::context simulation_ctx;
+			uint32_t async_steps = 0;
+			float async_alpha = 0;
+			wi::vector<std::shared_ptr<void>> async_keepalive; // physics objects can't be destroyed while the step is running
+			wi::vector<void*> async_rigidbodies;
+			wi::vector<void*> async_ragdolls;
+
+			// Rigid bodies are added to and removed from the broadphase in batches once per update:
+			//	This avoids taking broadphase locks per body, and batch insertion builds a balanced tree for the new bodies
+			std::mutex pending_locker;
+			wi::vector<BodyID> pending_add_active;
+			wi::vector<BodyID> pending_add_inactive;
+			wi::vector<BodyID> pending_remove;
+			void QueueAddBody(BodyID bodyID, EActivation activation)
+			{
+				std::scoped_lock lck(pending_locker);
+				if (activation == EActivation::Activate)
+				{
+					pending_add_active.push_back(bodyID);
+				}
+				else
+				{
+					pending_add_inactive.push_back(bodyID);
+				}
+			}
+			void QueueRemoveBody(BodyID bodyID)
+			{
+				BodyInterface& body_interface = physics_system.GetBodyInterface(); // locking version because this can be called from any thread
+				body_interface.SetUserData(bodyID, 0); // the owner is gone, queries must not report it until removal
+				std::scoped_lock lck(pending_locker);
+				if (!body_interface.IsAdded(bodyID))
+				{
+					// It was created and deleted before it could be added:
+					for (auto* pending : { &pending_add_active, &pending_add_inactive })
+					{
+						auto it = std::find(pending->begin(), pending->end(), bodyID);
+						if (it != pending->end())
+						{
+							*it = pending->back();
+							pending->pop_back();
+						}
+					}
+					body_interface.DestroyBody(bodyID);
+					return;
+				}
+				pending_remove.push_back(bodyID);
+			}
+			// Must be called when the physics system is not updating
+			void FlushPendingBodies()
+			{
+				BodyInterface& body_interface = physics_system.GetBodyInterfaceNoLock();
+				std::scoped_lock lck(pending_locker);
+				if (!pending_remove.empty())
+				{
+					body_interface.RemoveBodies(pending_remove.data(), (int)pending_remove.size());
+					body_interface.DestroyBodies(pending_remove.data(), (int)pending_remove.size());
+					pending_remove.clear();
+				}
+				const size_t added_count = pending_add_active.size() + pending_add_inactive.size();
+				auto add_batch = [&](wi::vector<BodyID>& bodies, EActivation activation) {
+					if (bodies.empty())
+						return;
+					BodyInterface::AddState state = body_interface.AddBodiesPrepare(bodies.data(), (int)bodies.size());
+					body_interface.AddBodiesFinalize(bodies.data(), (int)bodies.size(), state, activation);
+					bodies.clear();
+				};
+				add_batch(pending_add_active, EActivation::Activate);
+				add_batch(pending_add_inactive, EActivation::DontActivate);
+				if (added_count >= cBroadPhaseOptimizeThreshold)
+				{
+					// After a large load, the whole broadphase tree is rebuilt instead of spreading it out over multiple updates:
+					physics_system.OptimizeBroadPhase();
+				}
+			}
 		};
 		PhysicsScene& GetPhysicsScene(Scene& scene)
 		{
@@ -246,9 +331,26 @@ namespace wi::physics
 					physics_scene->object_vs_object_layer_filter
 				);
 
+				physics_scene->simulation_ctx.priority = wi::jobsystem::Priority::Low;
 				scene.physics_scene = physics_scene;
 			}
-			return *(PhysicsScene*)scene.physics_scene.get();
+			PhysicsScene& physics_scene = *(PhysicsScene*)scene.physics_scene.get();
+			wi::jobsystem::Wait(physics_scene.simulation_ctx);
+			return physics_scene;
+		}
+		// Returns the physics scene after the asynchronous simulation step is finished, physics state can be accessed after this
+		PhysicsScene& GetPhysicsScene(const std::shared_ptr<void>& physics_scene_ptr)
+		{
+			PhysicsScene& physics_scene = *(PhysicsScene*)physics_scene_ptr.get();
+			wi::jobsystem::Wait(physics_scene.simulation_ctx);
+			return physics_scene;
+		}
+		inline void WaitSimulation(const std::shared_ptr<void>& physics_scene_ptr)
+		{
+			if (physics_scene_ptr != nullptr)
+			{
+				wi::jobsystem::Wait(((PhysicsScene*)physics_scene_ptr.get())->simulation_ctx);
+			}
 		}
 
 		struct RigidBody
@@ -257,6 +359,7 @@ namespace wi::physics
 			Entity entity = INVALID_ENTITY;
 			ShapeRefC shape;
 			BodyID bodyID;
+			uint64_t shape_cache_key = 0; // nonzero if the shape is shared from the shape cache
 
 			// property tracking:
 			float friction = 0;
@@ -294,6 +397,12 @@ namespace wi::physics
 			VehicleConstraint* vehicle_constraint = nullptr;
 			Vec3 prev_wheel_positions[4] = { Vec3::sZero(), Vec3::sZero(), Vec3::sZero(), Vec3::sZero() };
 			Quat prev_wheel_rotations[4] = { Quat::sIdentity(), Quat::sIdentity(), Quat::sIdentity(), Quat::sIdentity() };
+			// wheel state resolved before the asynchronous simulation step, so it can be used while the step is running:
+			uint32_t wheel_mask = 0;
+			Vec3 wheel_right[4] = { Vec3::sAxisX(), Vec3::sAxisX(), Vec3::sAxisX(), Vec3::sAxisX() };
+			Vec3 wheel_up[4] = { Vec3::sAxisY(), Vec3::sAxisY(), Vec3::sAxisY(), Vec3::sAxisY() };
+			Vec3 wheel_positions[4] = { Vec3::sZero(), Vec3::sZero(), Vec3::sZero(), Vec3::sZero() };
+			Quat wheel_rotations[4] = { Quat::sIdentity(), Quat::sIdentity(), Quat::sIdentity(), Quat::sIdentity() };
 
 			// character:
 			Ref<Character> character = nullptr;
@@ -304,15 +413,20 @@ namespace wi::physics
 					return;
 				PhysicsScene* jolt_physics_scene = (PhysicsScene*)physics_scene.get();
 				BodyInterface& body_interface = jolt_physics_scene->physics_system.GetBodyInterface(); // locking version because destructor can be called from any thread
-				body_interface.RemoveBody(bodyID);
 				if (character != nullptr)
 				{
+					body_interface.RemoveBody(bodyID);
 					character = {};
 				}
-				else
+				else if (vehicle_constraint != nullptr)
 				{
+					body_interface.RemoveBody(bodyID);
 					body_interface.DestroyBody(bodyID);
 				}
+				else
+				{
+					jolt_physics_scene->QueueRemoveBody(bodyID);
+				}
 				bodyID = {};
 				if (vehicle_constraint != nullptr)
 				{
@@ -321,6 +435,7 @@ namespace wi::physics
 					vehicle_constraint = nullptr;
 				}
 				shape = nullptr;
+				shape_cache_key = 0;
 			}
 
 			RigidBody()
@@ -411,11 +526,15 @@ namespace wi::physics
 			{
 				physicscomponent.physicsobject = std::make_shared<RigidBody>();
 			}
-			return *(RigidBody*)physicscomponent.physicsobject.get();
+			RigidBody& rb = *(RigidBody*)physicscomponent.physicsobject.get();
+			WaitSimulation(rb.physics_scene);
+			return rb;
 		}
 		const RigidBody& GetRigidBody(const wi::scene::RigidBodyPhysicsComponent& physicscomponent)
 		{
-			return *(RigidBody*)physicscomponent.physicsobject.get();
+			const RigidBody& rb = *(RigidBody*)physicscomponent.physicsobject.get();
+			WaitSimulation(rb.physics_scene);
+			return rb;
 		}
 		SoftBody& GetSoftBody(wi::scene::SoftBodyPhysicsComponent& physicscomponent)
 		{
@@ -423,11 +542,15 @@ namespace wi::physics
 			{
 				physicscomponent.physicsobject = std::make_shared<SoftBody>();
 			}
-			return *(SoftBody*)physicscomponent.physicsobject.get();
+			SoftBody& sb = *(SoftBody*)physicscomponent.physicsobject.get();
+			WaitSimulation(sb.physics_scene);
+			return sb;
 		}
 		const SoftBody& GetSoftBody(const wi::scene::SoftBodyPhysicsComponent& physicscomponent)
 		{
-			return *(SoftBody*)physicscomponent.physicsobject.get();
+			const SoftBody& sb = *(SoftBody*)physicscomponent.physicsobject.get();
+			WaitSimulation(sb.physics_scene);
+			return sb;
 		}
 		Constraint& GetConstraint(wi::scene::PhysicsConstraintComponent& physicscomponent)
 		{
@@ -435,11 +558,15 @@ namespace wi::physics
 			{
 				physicscomponent.physicsobject = std::make_shared<Constraint>();
 			}
-			return *(Constraint*)physicscomponent.physicsobject.get();
+			Constraint& constraint = *(Constraint*)physicscomponent.physicsobject.get();
+			WaitSimulation(constraint.physics_scene);
+			return constraint;
 		}
 		const Constraint& GetConstraint(const wi::scene::PhysicsConstraintComponent& physicscomponent)
 		{
-			return *(Constraint*)physicscomponent.physicsobject.get();
+			const Constraint& constraint = *(Constraint*)physicscomponent.physicsobject.get();
+			WaitSimulation(constraint.physics_scene);
+			return constraint;
 		}
 
 		void AddRigidBody(
@@ -468,6 +595,7 @@ namespace wi::physics
 				// The shape comes from mesh's precomputed shape:
 				const RigidBody& precomputed_rigidbody_with_shape = GetRigidBody(mesh->precomputed_rigidbody_physics_shape);
 				physicsobject.shape = precomputed_rigidbody_with_shape.shape;
+				physicsobject.shape_cache_key = precomputed_rigidbody_with_shape.shape_cache_key;
 			}
 
 			if (physicsobject.shape == nullptr) // shape creation can be called from outside as optimization from threads
@@ -577,10 +705,18 @@ namespace wi::physics
 					return;
 				}
 				physicsobject.bodyID = body->GetID();
-				body_interface.AddBody(physicsobject.bodyID, activation);
-
 				body->SetUserData((uint64_t)&physicsobject);
 
+				if (physicscomponent.IsVehicle())
+				{
+					// The vehicle constraint is created right away, so it is added immediately:
+					body_interface.AddBody(physicsobject.bodyID, activation);
+				}
+				else
+				{
+					physics_scene.QueueAddBody(physicsobject.bodyID, activation);
+				}
+
 				// Vehicle const settings:
 				static constexpr bool	sAntiRollbar = true;
 				static constexpr bool	sLimitedSlipDifferentials = true;
@@ -1196,6 +1332,7 @@ namespace wi::physics
 			Ref<JPH::Ragdoll> ragdoll;
 			bool state_active = false;
 			float scale = 1;
+			uint32_t async_bodypart_mask = 0; // body parts that have transforms, resolved before the asynchronous simulation step
 			Vec3 prev_capsule_position[BODYPART_COUNT] = {};
 			Quat prev_capsule_rotation[BODYPART_COUNT] = {};
 
@@ -1775,6 +1912,391 @@ namespace wi::physics
 			}
 		};
 
+		// Shared collision shapes:
+		//	Shapes are cached by a key hashed from the shape type, parameters, quantized scale and mesh geometry
+		//	Bodies that resolve to the same key share the same immutable Jolt shape instead of cooking it again
+		bool SHAPE_CACHE_ENABLED = true;
+		bool SHAPE_CACHE_SERIALIZATION = false;
+		struct ShapeCacheEntry
+		{
+			ShapeRefC shape;
+			Vec3 bottom_offset = Vec3::sZero();
+			uint32_t unused_sweeps = 0;
+		};
+		struct ShapeCache
+		{
+			std::mutex locker;
+			wi::unordered_map<uint64_t, ShapeCacheEntry> entries;
+			uint32_t sweep_counter = 0;
+
+			bool Find(uint64_t key, ShapeRefC& shape, Vec3& bottom_offset)
+			{
+				std::scoped_lock lck(locker);
+				auto it = entries.find(key);
+				if (it == entries.end())
+					return false;
+				shape = it->second.shape;
+				bottom_offset = it->second.bottom_offset;
+				return true;
+			}
+			// If an other thread already inserted the same key, the existing shape is returned in the parameters
+			void Insert(uint64_t key, ShapeRefC& shape, Vec3& bottom_offset)
+			{
+				std::scoped_lock lck(locker);
+				auto it = entries.find(key);
+				if (it != entries.end())
+				{
+					shape = it->second.shape;
+					bottom_offset = it->second.bottom_offset;
+					return;
+				}
+				ShapeCacheEntry& entry = entries[key];
+				entry.shape = shape;
+				entry.bottom_offset = bottom_offset;
+			}
+			// Shapes that are only referenced by the cache for two consecutive sweeps are released
+			void Sweep()
+			{
+				if (++sweep_counter < 60)
+					return;
+				sweep_counter = 0;
+				std::scoped_lock lck(locker);
+				for (auto it = entries.begin(); it != entries.end();)
+				{
+					if (it->second.shape->GetRefCount() > 1)
+					{
+						it->second.unused_sweeps = 0;
+						++it;
+					}
+					else if (++it->second.unused_sweeps > 1)
+					{
+						it = entries.erase(it);
+					}
+					else
+					{
+						++it;
+					}
+				}
+			}
+			void Clear()
+			{
+				std::scoped_lock lck(locker);
+				entries.clear();
+			}
+		};
+		ShapeCache shape_cache;
+
+		inline uint64_t HashMemory(const void* data, size_t size, uint64_t seed)
+		{
+			const uint8_t* bytes = (const uint8_t*)data;
+			uint64_t hash = seed ^ Hash64(size);
+			while (size >= sizeof(uint64_t))
+			{
+				uint64_t value;
+				std::memcpy(&value, bytes, sizeof(value));
+				hash = Hash64(hash ^ value);
+				bytes += sizeof(value);
+				size -= sizeof(value);
+			}
+			uint64_t tail = 0;
+			std::memcpy(&tail, bytes, size);
+			return Hash64(hash ^ tail);
+		}
+		template<typename T>
+		inline uint64_t HashValue(uint64_t seed, const T& value)
+		{
+			return HashMemory(&value, sizeof(value), seed);
+		}
+		// Drop the low mantissa bits, so that almost equal scales will share the same shape
+		inline float QuantizeScale(float value)
+		{
+			uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			bits &= ~0x3Fu;
+			std::memcpy(&value, &bits, sizeof(bits));
+			return value;
+		}
+		inline XMFLOAT3 QuantizeScale(const XMFLOAT3& value)
+		{
+			return XMFLOAT3(QuantizeScale(value.x), QuantizeScale(value.y), QuantizeScale(value.z));
+		}
+		// Returns 0 when the shape can't be cached
+		uint64_t ComputeShapeCacheKey(
+			const RigidBodyPhysicsComponent& physicscomponent,
+			const XMFLOAT3& scale,
+			const MeshComponent* mesh
+		)
+		{
+			uint64_t key = HashValue(0, physicscomponent.shape);
+			key = HashValue(key, scale);
+			switch (physicscomponent.shape)
+			{
+			case RigidBodyPhysicsComponent::CollisionShape::BOX:
+				key = HashValue(key, physicscomponent.box);
+				break;
+			case RigidBodyPhysicsComponent::CollisionShape::SPHERE:
+				key = HashValue(key, physicscomponent.sphere);
+				break;
+			case RigidBodyPhysicsComponent::CollisionShape::CAPSULE:
+			case RigidBodyPhysicsComponent::CollisionShape::CYLINDER:
+				key = HashValue(key, physicscomponent.capsule);
+				break;
+			case RigidBodyPhysicsComponent::CollisionShape::CONVEX_HULL:
+			case RigidBodyPhysicsComponent::CollisionShape::HEIGHTFIELD:
+				if (mesh == nullptr)
+					return 0;
+				key = HashMemory(mesh->vertex_positions.data(), mesh->vertex_positions.size() * sizeof(XMFLOAT3), key);
+				break;
+			case RigidBodyPhysicsComponent::CollisionShape::TRIANGLE_MESH:
+				if (mesh == nullptr)
+					return 0;
+				else
+				{
+					key = HashMemory(mesh->vertex_positions.data(), mesh->vertex_positions.size() * sizeof(XMFLOAT3), key);
+					uint32_t first_subset = 0;
+					uint32_t last_subset = 0;
+					mesh->GetLODSubsetRange(physicscomponent.mesh_lod, first_subset, last_subset);
+					for (uint32_t subsetIndex = first_subset; subsetIndex < last_subset; ++subsetIndex)
+					{
+						const MeshComponent::MeshSubset& subset = mesh->subsets[subsetIndex];
+						key = HashMemory(mesh->indices.data() + subset.indexOffset, subset.indexCount * sizeof(uint32_t), key);
+					}
+				}
+				break;
+			default:
+				return 0;
+			}
+			return key == 0 ? 1 : key;
+		}
+
+		// Jolt binary streams over memory, used to store cooked shapes in archives:
+		class VectorStreamOut : public StreamOut
+		{
+		public:
+			wi::vector<uint8_t>& data;
+			VectorStreamOut(wi::vector<uint8_t>& data) : data(data) {}
+			void WriteBytes(const void* inData, size_t inNumBytes) override
+			{
+				const uint8_t* src = (const uint8_t*)inData;
+				data.insert(data.end(), src, src + inNumBytes);
+			}
+			bool IsFailed() const override { return false; }
+		};
+		class MemoryStreamIn : public StreamIn
+		{
+		public:
+			const uint8_t* data = nullptr;
+			size_t size = 0;
+			size_t offset = 0;
+			bool failed = false;
+			MemoryStreamIn(const uint8_t* data, size_t size) : data(data), size(size) {}
+			void ReadBytes(void* outData, size_t inNumBytes) override
+			{
+				if (failed || offset + inNumBytes > size)
+				{
+					failed = true;
+					std::memset(outData, 0, inNumBytes);
+					return;
+				}
+				std::memcpy(outData, data + offset, inNumBytes);
+				offset += inNumBytes;
+			}
+			bool IsEOF() const override { return offset >= size; }
+			bool IsFailed() const override { return failed; }
+		};
+
+		// Jolt state recorder that writes into or reads from a memory buffer:
+		class BufferStateRecorder final : public StateRecorder
+		{
+		public:
+			wi::vector<uint8_t>* write_data = nullptr;
+			const uint8_t* read_data = nullptr;
+			size_t read_size = 0;
+			size_t offset = 0;
+			bool failed = false;
+			BufferStateRecorder(wi::vector<uint8_t>& data) : write_data(&data) {}
+			BufferStateRecorder(const uint8_t* data, size_t size) : read_data(data), read_size(size) {}
+			void WriteBytes(const void* inData, size_t inNumBytes) override
+			{
+				const uint8_t* src = (const uint8_t*)inData;
+				write_data->insert(write_data->end(), src, src + inNumBytes);
+			}
+			void ReadBytes(void* outData, size_t inNumBytes) override
+			{
+				if (failed || offset + inNumBytes > read_size)
+				{
+					failed = true;
+					std::memset(outData, 0, inNumBytes);
+					return;
+				}
+				std::memcpy(outData, read_data + offset, inNumBytes);
+				offset += inNumBytes;
+			}
+			bool IsEOF() const override { return offset >= read_size; }
+			bool IsFailed() const override { return failed; }
+		};
+
+		// State deltas are XOR differences where the zero runs are skipped:
+		//	[uint32 zero count][uint32 literal count][literal bytes]...
+		inline void AppendU32(wi::vector<uint8_t>& dst, uint32_t value)
+		{
+			const uint8_t* src = (const uint8_t*)&value;
+			dst.insert(dst.end(), src, src + sizeof(value));
+		}
+		void EncodeStateDelta(const wi::vector<uint8_t>& a, const wi::vector<uint8_t>& b, wi::vector<uint8_t>& dst)
+		{
+			dst.clear();
+			const size_t size = std::max(a.size(), b.size());
+			auto diff = [&](size_t i) -> uint8_t {
+				return (i < a.size() ? a[i] : 0) ^ (i < b.size() ? b[i] : 0);
+			};
+			size_t i = 0;
+			while (i < size)
+			{
+				const size_t zero_begin = i;
+				while (i < size && diff(i) == 0)
+				{
+					i++;
+				}
+				if (i >= size)
+					break;
+
+				// The literal run ends when enough zeroes are found that skipping them is worth a new header:
+				const size_t literal_begin = i;
+				size_t literal_end = i;
+				size_t zero_count = 0;
+				while (i < size)
+				{
+					if (diff(i) == 0)
+					{
+						if (++zero_count >= 8)
+							break;
+					}
+					else
+					{
+						zero_count = 0;
+						literal_end = i + 1;
+					}
+					i++;
+				}
+				i = literal_end;
+
+				AppendU32(dst, uint32_t(literal_begin - zero_begin));
+				AppendU32(dst, uint32_t(literal_end - literal_begin));
+				for (size_t j = literal_begin; j < literal_end; ++j)
+				{
+					dst.push_back(diff(j));
+				}
+			}
+		}
+		// Applies the delta to the state in place, then resizes it to the size of the other state
+		void ApplyStateDelta(wi::vector<uint8_t>& state, const wi::vector<uint8_t>& delta, size_t other_size)
+		{
+			state.resize(std::max(state.size(), other_size));
+			size_t pos = 0;
+			size_t offset = 0;
+			while (offset + sizeof(uint32_t) * 2 <= delta.size())
+			{
+				uint32_t zeroes = 0;
+				uint32_t literals = 0;
+				std::memcpy(&zeroes, delta.data() + offset, sizeof(zeroes));
+				std::memcpy(&literals, delta.data() + offset + sizeof(zeroes), sizeof(literals));
+				offset += sizeof(uint32_t) * 2;
+				pos += zeroes;
+				assert(pos + literals <= state.size());
+				assert(offset + literals <= delta.size());
+				for (uint32_t i = 0; i < literals; ++i)
+				{
+					state[pos + i] ^= delta[offset + i];
+				}
+				pos += literals;
+				offset += literals;
+			}
+			state.resize(other_size);
+		}
+
+		inline uint32_t GetWheelCount(const RigidBodyPhysicsComponent& physicscomponent)
+		{
+			return physicscomponent.vehicle.type == RigidBodyPhysicsComponent::Vehicle::Type::Car ? 4 : 2;
+		}
+		inline Entity GetWheelEntity(const RigidBodyPhysicsComponent& physicscomponent, uint32_t index)
+		{
+			if (physicscomponent.vehicle.type == RigidBodyPhysicsComponent::Vehicle::Type::Car)
+			{
+				const Entity car_wheel_entities[] = {
+					physicscomponent.vehicle.wheel_entity_front_left,
+					physicscomponent.vehicle.wheel_entity_front_right,
+					physicscomponent.vehicle.wheel_entity_rear_left,
+					physicscomponent.vehicle.wheel_entity_rear_right,
+				};
+				return car_wheel_entities[index];
+			}
+			const Entity motor_wheel_entities[] = {
+				physicscomponent.vehicle.wheel_entity_front_left,
+				physicscomponent.vehicle.wheel_entity_rear_left,
+			};
+			return motor_wheel_entities[index];
+		}
+
+		// Performs one fixed timestep simulation step
+		void StepSimulation(PhysicsScene& physics_scene)
+		{
+			//static TempAllocatorImpl temp_allocator(10 * 1024 * 1024);
+			static TempAllocatorMalloc temp_allocator; // 10-100 MB was not enough for large simulation, I don't want to reserve more memory up front
+			static JobSystemThreadPool job_system(cMaxPhysicsJobs, cMaxPhysicsBarriers, thread::hardware_concurrency() - 1);
+			physics_scene.physics_system.Update(TIMESTEP, 1, &temp_allocator, &job_system);
+		}
+
+		// Saves the interpolation source state before the last simulation step of the asynchronous simulation
+		//	Only the physics objects that were gathered before the step are accessed, the scene can't be used here
+		void CapturePreviousStateAsync(PhysicsScene& physics_scene)
+		{
+			BodyInterface& body_interface = physics_scene.physics_system.GetBodyInterfaceNoLock();
+			for (void* ptr : physics_scene.async_rigidbodies)
+			{
+				RigidBody& rb = *(RigidBody*)ptr;
+				if (rb.character != nullptr)
+				{
+					rb.character->PostSimulation(CHARACTER_COLLISION_TOLERANCE);
+				}
+				Mat44 mat = body_interface.GetWorldTransform(rb.bodyID);
+				mat = mat * rb.additionalTransformInverse;
+				rb.prev_position = mat.GetTranslation();
+				rb.prev_rotation = mat.GetQuaternion().Normalized();
+
+				if (rb.vehicle_constraint != nullptr)
+				{
+					for (uint32_t i = 0; i < arraysize(rb.prev_wheel_positions); ++i)
+					{
+						if ((rb.wheel_mask & (1u << i)) == 0)
+							continue;
+						Mat44 wheelmat = rb.vehicle_constraint->GetWheelWorldTransform(i, rb.wheel_right[i], rb.wheel_up[i]);
+						rb.prev_wheel_positions[i] = wheelmat.GetTranslation();
+						rb.prev_wheel_rotations[i] = wheelmat.GetQuaternion();
+					}
+				}
+			}
+			for (void* ptr : physics_scene.async_ragdolls)
+			{
+				Ragdoll& ragdoll = *(Ragdoll*)ptr;
+				int bodypart = 0;
+				for (uint32_t i = 0; i < arraysize(ragdoll.rigidbodies); ++i)
+				{
+					if ((ragdoll.async_bodypart_mask & (1u << i)) == 0)
+						continue;
+					RigidBody& rb = ragdoll.rigidbodies[i];
+					Mat44 mat = body_interface.GetWorldTransform(rb.bodyID);
+					ragdoll.prev_capsule_position[bodypart] = mat.GetTranslation();
+					ragdoll.prev_capsule_rotation[bodypart] = mat.GetQuaternion().Normalized();
+					mat = mat * rb.additionalTransformInverse;
+					mat = mat * rb.restBasis;
+					rb.prev_position = mat.GetTranslation();
+					rb.prev_rotation = mat.GetQuaternion().Normalized();
+					bodypart++;
+				}
+			}
+		}
+
 	}
 	using namespace jolt;
 
@@ -1791,10 +2313,11 @@ namespace wi::physics
 		wilog("wi::physics Initialized [Jolt Physics %d.%d.%d] (%d ms)", JPH_VERSION_MAJOR, JPH_VERSION_MINOR, JPH_VERSION_PATCH, (int)std::round(timer.elapsed()));
 	}
 
-	void CreateRigidBodyShape(
-		wi::scene::RigidBodyPhysicsComponent& physicscomponent,
+	ShapeRefC CookRigidBodyShape(
+		const wi::scene::RigidBodyPhysicsComponent& physicscomponent,
 		const XMFLOAT3& scale_local,
-		const wi::scene::MeshComponent* mesh
+		const wi::scene::MeshComponent* mesh,
+		Vec3& bottom_offset
 	)
 	{
 		ShapeSettings::ShapeResult shape_result;
@@ -1802,8 +2325,6 @@ namespace wi::physics
 		// The default convex radius caused issues when creating small box shape, etc, so I decrease it:
 		const float convexRadius = 0.001f;
 
-		Vec3 bottom_offset = Vec3::sZero();
-
 		switch (physicscomponent.shape)
 		{
 		case RigidBodyPhysicsComponent::CollisionShape::BOX:
@@ -1855,7 +2376,7 @@ namespace wi::physics
 			else
 			{
 				wi::backlog::post("CreateRigidBodyShape failed: convex hull physics requested, but no MeshComponent provided!", wi::backlog::LogLevel::Error);
-				return;
+				return nullptr;
 			}
 			break;
 
@@ -1889,7 +2410,7 @@ namespace wi::physics
 			else
 			{
 				wi::backlog::post("CreateRigidBodyShape failed: triangle mesh physics requested, but no MeshComponent provided!", wi::backlog::LogLevel::Error);
-				return;
+				return nullptr;
 			}
 			break;
 
@@ -1926,7 +2447,7 @@ namespace wi::physics
 			else
 			{
 				wi::backlog::post("CreateRigidBodyShape failed: height field physics requested, but no MeshComponent provided!", wi::backlog::LogLevel::Error);
-				return;
+				return nullptr;
 			}
 			break;
 
@@ -1935,11 +2456,58 @@ namespace wi::physics
 		if (!shape_result.IsValid())
 		{
 			wilog_error("CreateRigidBodyShape failed, shape_result: %s", shape_result.GetError().c_str());
-			return;
+			return nullptr;
 		}
 
+		return shape_result.Get();
+	}
+
+	void CreateRigidBodyShape(
+		wi::scene::RigidBodyPhysicsComponent& physicscomponent,
+		const XMFLOAT3& scale_local,
+		const wi::scene::MeshComponent* mesh
+	)
+	{
 		RigidBody& physicsobject = GetRigidBody(physicscomponent);
-		physicsobject.shape = shape_result.Get();
+		physicsobject.shape = nullptr;
+		physicsobject.shape_cache_key = 0;
+
+		ShapeRefC shape;
+		Vec3 bottom_offset = Vec3::sZero();
+
+		if (SHAPE_CACHE_ENABLED)
+		{
+			// The shape is cooked with the quantized scale, so every body that hits the same cache entry gets the exact same geometry:
+			const XMFLOAT3 scale = QuantizeScale(scale_local);
+			const uint64_t key = ComputeShapeCacheKey(physicscomponent, scale, mesh);
+			if (key != 0 && !shape_cache.Find(key, shape, bottom_offset))
+			{
+				// Cooking is done outside of the lock, if two threads race to the same key, the first inserted shape wins:
+				shape = CookRigidBodyShape(physicscomponent, scale, mesh, bottom_offset);
+				if (shape != nullptr)
+				{
+					shape_cache.Insert(key, shape, bottom_offset);
+				}
+			}
+			else if (key == 0)
+			{
+				shape = CookRigidBodyShape(physicscomponent, scale, mesh, bottom_offset);
+			}
+			if (shape != nullptr && key != 0)
+			{
+				physicsobject.shape_cache_key = key;
+			}
+		}
+		else
+		{
+			shape = CookRigidBodyShape(physicscomponent, scale_local, mesh, bottom_offset);
+		}
+
+		if (shape == nullptr)
+			return;
+
+		// Per body wrappers are not shared, the cached shape is their child:
+		physicsobject.shape = shape;
 
 		if (physicscomponent.IsVehicle())
 		{
@@ -1974,6 +2542,333 @@ namespace wi::physics
 	float GetFrameRate() { return 1.0f / TIMESTEP; }
 	void SetFrameRate(float value) { TIMESTEP = 1.0f / value; }
 
+	bool IsDeterministicEnabled() { return DETERMINISTIC; }
+	void SetDeterministicEnabled(bool value) { DETERMINISTIC = value; }
+
+	bool IsAsyncSimulationEnabled() { return ASYNC_SIMULATION; }
+	void SetAsyncSimulationEnabled(bool value) { ASYNC_SIMULATION = value; }
+
+	bool IsShapeCacheEnabled() { return SHAPE_CACHE_ENABLED; }
+	void SetShapeCacheEnabled(bool value) { SHAPE_CACHE_ENABLED = value; }
+
+	bool IsShapeCacheSerializationEnabled() { return SHAPE_CACHE_SERIALIZATION; }
+	void SetShapeCacheSerializationEnabled(bool value) { SHAPE_CACHE_SERIALIZATION = value; }
+
+	void ClearShapeCache()
+	{
+		shape_cache.Clear();
+	}
+	size_t GetShapeCacheCount()
+	{
+		std::scoped_lock lck(shape_cache.locker);
+		return shape_cache.entries.size();
+	}
+
+	void SerializeShapeCache(wi::scene::Scene& scene, wi::Archive& archive)
+	{
+		if (archive.IsReadMode())
+		{
+			uint32_t count = 0;
+			archive >> count;
+			for (uint32_t i = 0; i < count; ++i)
+			{
+				uint64_t key = 0;
+				XMFLOAT3 bottom_offset;
+				wi::vector<uint8_t> data;
+				archive >> key;
+				archive >> bottom_offset;
+				archive >> data;
+
+				if (!SHAPE_CACHE_ENABLED || key == 0 || data.empty())
+					continue;
+
+				MemoryStreamIn stream(data.data(), data.size());
+				Shape::IDToShapeMap shape_map;
+				Shape::IDToMaterialMap material_map;
+				Shape::ShapeResult result = Shape::sRestoreWithChildren(stream, shape_map, material_map);
+				if (!result.IsValid() || stream.IsFailed())
+				{
+					wilog_warning("SerializeShapeCache: cooked shape could not be restored, it will be created again on demand");
+					continue;
+				}
+				ShapeRefC shape = result.Get();
+				Vec3 offset = cast(bottom_offset);
+				shape_cache.Insert(key, shape, offset);
+			}
+		}
+		else
+		{
+			// Only the mesh based shapes of this scene are written, primitive shapes are cheap to create:
+			wi::unordered_set<uint64_t> keys;
+			auto gather = [&](const RigidBodyPhysicsComponent& physicscomponent) {
+				if (physicscomponent.physicsobject == nullptr)
+					return;
+				switch (physicscomponent.shape)
+				{
+				case RigidBodyPhysicsComponent::CollisionShape::CONVEX_HULL:
+				case RigidBodyPhysicsComponent::CollisionShape::TRIANGLE_MESH:
+				case RigidBodyPhysicsComponent::CollisionShape::HEIGHTFIELD:
+					break;
+				default:
+					return;
+				}
+				const uint64_t key = GetRigidBody(physicscomponent).shape_cache_key;
+				if (key != 0)
+				{
+					keys.insert(key);
+				}
+			};
+			if (SHAPE_CACHE_SERIALIZATION)
+			{
+				for (size_t i = 0; i < scene.rigidbodies.GetCount(); ++i)
+				{
+					gather(scene.rigidbodies[i]);
+				}
+				for (size_t i = 0; i < scene.meshes.GetCount(); ++i)
+				{
+					gather(scene.meshes[i].precomputed_rigidbody_physics_shape);
+				}
+			}
+
+			wi::vector<std::pair<uint64_t, ShapeCacheEntry>> entries;
+			entries.reserve(keys.size());
+			for (uint64_t key : keys)
+			{
+				ShapeCacheEntry entry;
+				if (shape_cache.Find(key, entry.shape, entry.bottom_offset))
+				{
+					entries.emplace_back(key, std::move(entry));
+				}
+			}
+
+			archive << (uint32_t)entries.size();
+			for (auto& x : entries)
+			{
+				wi::vector<uint8_t> data;
+				VectorStreamOut stream(data);
+				Shape::ShapeToIDMap shape_map;
+				Shape::MaterialToIDMap material_map;
+				x.second.shape->SaveWithChildren(stream, shape_map, material_map);
+				archive << x.first;
+				archive << cast(x.second.bottom_offset);
+				archive << data;
+			}
+		}
+	}
+
+	void SaveState(wi::scene::Scene& scene, wi::vector<uint8_t>& buffer, StateFlags flags)
+	{
+		buffer.clear();
+		if (scene.physics_scene == nullptr)
+			return;
+		PhysicsScene& physics_scene = GetPhysicsScene(scene);
+		physics_scene.FlushPendingBodies(); // the saved body list must match what will exist when restoring
+
+		EStateRecorderState state = EStateRecorderState::Global;
+		if (has_flag(flags, StateFlags::BODIES))
+		{
+			state |= EStateRecorderState::Bodies;
+		}
+		if (has_flag(flags, StateFlags::CONTACTS))
+		{
+			state |= EStateRecorderState::Contacts;
+		}
+		if (has_flag(flags, StateFlags::CONSTRAINTS))
+		{
+			state |= EStateRecorderState::Constraints;
+		}
+
+		BufferStateRecorder recorder(buffer);
+		physics_scene.physics_system.SaveState(recorder, state);
+
+		// Engine side state, the interpolation sources:
+		recorder.Write(physics_scene.accumulator);
+		recorder.Write(physics_scene.alpha);
+		uint32_t count = 0;
+		for (size_t i = 0; i < scene.rigidbodies.GetCount(); ++i)
+		{
+			if (scene.rigidbodies[i].physicsobject != nullptr)
+			{
+				count++;
+			}
+		}
+		recorder.Write(count);
+		for (size_t i = 0; i < scene.rigidbodies.GetCount(); ++i)
+		{
+			const RigidBodyPhysicsComponent& physicscomponent = scene.rigidbodies[i];
+			if (physicscomponent.physicsobject == nullptr)
+				continue;
+			const RigidBody& rb = GetRigidBody(physicscomponent);
+			recorder.Write(scene.rigidbodies.GetEntity(i));
+			recorder.Write(rb.prev_position);
+			recorder.Write(rb.prev_rotation);
+		}
+	}
+	bool RestoreState(wi::scene::Scene& scene, const wi::vector<uint8_t>& buffer)
+	{
+		if (buffer.empty() || scene.physics_scene == nullptr)
+			return false;
+		PhysicsScene& physics_scene = GetPhysicsScene(scene);
+		physics_scene.FlushPendingBodies();
+
+		BufferStateRecorder recorder(buffer.data(), buffer.size());
+		if (!physics_scene.physics_system.RestoreState(recorder) || recorder.IsFailed())
+		{
+			wilog_error("wi::physics::RestoreState failed, the physics bodies are not the same as when the state was saved!");
+			return false;
+		}
+
+		recorder.Read(physics_scene.accumulator);
+		recorder.Read(physics_scene.alpha);
+		uint32_t count = 0;
+		recorder.Read(count);
+		for (uint32_t i = 0; i < count && !recorder.IsFailed(); ++i)
+		{
+			Entity entity = INVALID_ENTITY;
+			Vec3 prev_position;
+			Quat prev_rotation;
+			recorder.Read(entity);
+			recorder.Read(prev_position);
+			recorder.Read(prev_rotation);
+			RigidBodyPhysicsComponent* physicscomponent = scene.rigidbodies.GetComponent(entity);
+			if (physicscomponent == nullptr || physicscomponent->physicsobject == nullptr)
+				continue;
+			RigidBody& rb = GetRigidBody(*physicscomponent);
+			rb.prev_position = prev_position;
+			rb.prev_rotation = prev_rotation;
+		}
+		return !recorder.IsFailed();
+	}
+
+	void StateHistory::Init(uint32_t capacity)
+	{
+		entries.clear();
+		entries.resize(std::max(1u, capacity));
+		Clear();
+	}
+	void StateHistory::Clear()
+	{
+		for (auto& entry : entries)
+		{
+			entry.delta.clear();
+		}
+		first = 0;
+		count = 0;
+		newest.clear();
+	}
+	void StateHistory::Record(wi::scene::Scene& scene, uint64_t frame, StateFlags flags)
+	{
+		if (entries.empty())
+		{
+			Init(60);
+		}
+
+		// Recording an older frame than the newest means that the timeline was rewritten:
+		uint32_t keep = count;
+		while (keep > 0 && GetEntry(keep - 1).frame >= frame)
+		{
+			keep--;
+		}
+		Truncate(keep);
+
+		SaveState(scene, scratch, flags);
+
+		if (count == entries.size())
+		{
+			// The oldest state is dropped, its successor's delta is not needed anymore to reach it:
+			first = (first + 1) % (uint32_t)entries.size();
+			count--;
+		}
+		Entry& entry = GetEntry(count);
+		entry.frame = frame;
+		entry.prev_size = newest.size();
+		if (count > 0)
+		{
+			EncodeStateDelta(scratch, newest, entry.delta);
+		}
+		else
+		{
+			entry.delta.clear();
+		}
+		count++;
+		std::swap(newest, scratch);
+	}
+	int StateHistory::FindEntry(uint64_t frame) const
+	{
+		if (count == 0 || frame < GetEntry(0).frame || frame > GetEntry(count - 1).frame)
+			return -1;
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			if (GetEntry(i).frame == frame)
+				return (int)i;
+		}
+		return -1;
+	}
+	void StateHistory::Decode(uint32_t index, wi::vector<uint8_t>& state) const
+	{
+		// Walk back from the newest state, each delta gives the previous state:
+		state = newest;
+		for (uint32_t i = count - 1; i > index; --i)
+		{
+			const Entry& entry = GetEntry(i);
+			ApplyStateDelta(state, entry.delta, entry.prev_size);
+		}
+	}
+	void StateHistory::Truncate(uint32_t new_count)
+	{
+		if (new_count >= count)
+			return;
+		if (new_count == 0)
+		{
+			Clear();
+			return;
+		}
+		Decode(new_count - 1, scratch);
+		std::swap(newest, scratch);
+		for (uint32_t i = new_count; i < count; ++i)
+		{
+			GetEntry(i).delta.clear();
+		}
+		count = new_count;
+	}
+	bool StateHistory::GetState(uint64_t frame, wi::vector<uint8_t>& state) const
+	{
+		const int index = FindEntry(frame);
+		if (index < 0)
+			return false;
+		Decode((uint32_t)index, state);
+		return true;
+	}
+	bool StateHistory::Rewind(wi::scene::Scene& scene, uint64_t frame)
+	{
+		const int index = FindEntry(frame);
+		if (index < 0)
+			return false;
+		Truncate((uint32_t)index + 1);
+		return RestoreState(scene, newest);
+	}
+	bool StateHistory::Contains(uint64_t frame) const
+	{
+		return FindEntry(frame) >= 0;
+	}
+	uint64_t StateHistory::GetOldestFrame() const
+	{
+		return count > 0 ? GetEntry(0).frame : 0;
+	}
+	uint64_t StateHistory::GetNewestFrame() const
+	{
+		return count > 0 ? GetEntry(count - 1).frame : 0;
+	}
+	size_t StateHistory::GetMemorySize() const
+	{
+		size_t size = newest.capacity() + scratch.capacity();
+		for (auto& entry : entries)
+		{
+			size += entry.delta.capacity();
+		}
+		return size;
+	}
+
 	void RunPhysicsUpdateSystem(
 		wi::jobsystem::context& ctx,
 		wi::scene::Scene& scene,
@@ -1985,6 +2880,8 @@ namespace wi::physics
 
 		wi::jobsystem::Wait(ctx);
 
+		shape_cache.Sweep();
+
 		// TODO: without this there are bugs in terrain physics generation
 		scene.RunHierarchyUpdateSystem(ctx);
 		wi::jobsystem::Wait(ctx);
@@ -2058,6 +2955,7 @@ namespace wi::physics
 		});
 
 		wi::jobsystem::Wait(ctx); // wait for rigidbody creations
+		physics_scene.FlushPendingBodies();
 		wi::jobsystem::Dispatch(ctx, (uint32_t)scene.constraints.GetCount(), dispatchGroupSize, [&scene, &physics_scene](wi::jobsystem::JobArgs args) {
 
 			PhysicsConstraintComponent& physicscomponent = scene.constraints[args.jobIndex];
@@ -2606,100 +3504,118 @@ namespace wi::physics
 		physics_scene.activate_all_rigid_bodies = false;
 		
 		// Perform internal simulation step:
+		physics_scene.async_steps = 0;
 		if (IsSimulationEnabled())
 		{
-			//static TempAllocatorImpl temp_allocator(10 * 1024 * 1024);
-			static TempAllocatorMalloc temp_allocator; // 10-100 MB was not enough for large simulation, I don't want to reserve more memory up front
-			static JobSystemThreadPool job_system(cMaxPhysicsJobs, cMaxPhysicsBarriers, thread::hardware_concurrency() - 1);
-
-			physics_scene.accumulator += dt;
-			physics_scene.accumulator = clamp(physics_scene.accumulator, 0.0f, TIMESTEP * ACCURACY);
-			while (physics_scene.accumulator >= TIMESTEP)
+			if (DETERMINISTIC)
+			{
+				// Exactly one fixed step per update, independent of frame time:
+				physics_scene.accumulator = TIMESTEP;
+			}
+			else
 			{
-				const float next_accumulator = physics_scene.accumulator - TIMESTEP;
-				if (IsInterpolationEnabled() && next_accumulator < TIMESTEP)
+				physics_scene.accumulator += dt;
+				physics_scene.accumulator = clamp(physics_scene.accumulator, 0.0f, TIMESTEP * ACCURACY);
+			}
+			if (ASYNC_SIMULATION)
+			{
+				// The steps are only counted here, they will be started at the end of the update, after the results of the previous steps were read back:
+				while (physics_scene.accumulator >= TIMESTEP)
 				{
-					// On the last step, save previous locations, this is only needed for interpolation:
-					//	We don't only save it for dynamic objects that will be interpolated, because on the next frame maybe simulation doesn't run
-					//	but object types can change!
-					wi::jobsystem::Dispatch(ctx, (uint32_t)scene.rigidbodies.GetCount(), dispatchGroupSize, [&scene, &physics_scene](wi::jobsystem::JobArgs args) {
-						RigidBodyPhysicsComponent& physicscomponent = scene.rigidbodies[args.jobIndex];
-						if (physicscomponent.physicsobject == nullptr)
-							return;
-						RigidBody& rb = GetRigidBody(physicscomponent);
-						if (rb.character != nullptr)
-						{
-							rb.character->PostSimulation(CHARACTER_COLLISION_TOLERANCE);
-						}
-						BodyInterface& body_interface = physics_scene.physics_system.GetBodyInterfaceNoLock();
-						Mat44 mat = body_interface.GetWorldTransform(rb.bodyID);
-						mat = mat * rb.additionalTransformInverse;
-						rb.prev_position = mat.GetTranslation();
-						rb.prev_rotation = mat.GetQuaternion().Normalized();
-
-						if (rb.vehicle_constraint != nullptr)
-						{
-							const Entity car_wheel_entities[] = {
-								physicscomponent.vehicle.wheel_entity_front_left,
-								physicscomponent.vehicle.wheel_entity_front_right,
-								physicscomponent.vehicle.wheel_entity_rear_left,
-								physicscomponent.vehicle.wheel_entity_rear_right,
-							};
-							const Entity motor_wheel_entities[] = {
-								physicscomponent.vehicle.wheel_entity_front_left,
-								physicscomponent.vehicle.wheel_entity_rear_left,
-							};
-							const uint32_t count = physicscomponent.vehicle.type == RigidBodyPhysicsComponent::Vehicle::Type::Car ? arraysize(car_wheel_entities) : arraysize(motor_wheel_entities);
-
-							for (uint32_t i = 0; i < count; ++i)
+					physics_scene.accumulator -= TIMESTEP;
+					physics_scene.async_steps++;
+				}
+				physics_scene.async_alpha = DETERMINISTIC ? 1 : physics_scene.accumulator / TIMESTEP;
+			}
+			else
+			{
+				while (physics_scene.accumulator >= TIMESTEP)
+				{
+					const float next_accumulator = physics_scene.accumulator - TIMESTEP;
+					if (IsInterpolationEnabled() && next_accumulator < TIMESTEP)
+					{
+						// On the last step, save previous locations, this is only needed for interpolation:
+						//	We don't only save it for dynamic objects that will be interpolated, because on the next frame maybe simulation doesn't run
+						//	but object types can change!
+						wi::jobsystem::Dispatch(ctx, (uint32_t)scene.rigidbodies.GetCount(), dispatchGroupSize, [&scene, &physics_scene](wi::jobsystem::JobArgs args) {
+							RigidBodyPhysicsComponent& physicscomponent = scene.rigidbodies[args.jobIndex];
+							if (physicscomponent.physicsobject == nullptr)
+								return;
+							RigidBody& rb = GetRigidBody(physicscomponent);
+							if (rb.character != nullptr)
 							{
-								Entity wheel_entity = physicscomponent.vehicle.type == RigidBodyPhysicsComponent::Vehicle::Type::Car ? car_wheel_entities[i] : motor_wheel_entities[i];
-								if (wheel_entity == INVALID_ENTITY)
-									continue;
-
-								TransformComponent* wheel_transform = scene.transforms.GetComponent(wheel_entity);
-								if (wheel_transform != nullptr)
-								{
-									XMFLOAT4X4 localMatrix;
-									XMStoreFloat4x4(&localMatrix, wheel_transform->GetLocalMatrix());
-									Vec3 right = cast(wi::math::GetRight(localMatrix)).Normalized();
-									Vec3 up = cast(wi::math::GetUp(localMatrix)).Normalized();
-									Mat44 wheelmat = rb.vehicle_constraint->GetWheelWorldTransform(i, right, up);
-									rb.prev_wheel_positions[i] = wheelmat.GetTranslation();
-									rb.prev_wheel_rotations[i] = wheelmat.GetQuaternion();
-								}
+								rb.character->PostSimulation(CHARACTER_COLLISION_TOLERANCE);
 							}
-						}
-					});
-					wi::jobsystem::Dispatch(ctx, (uint32_t)scene.humanoids.GetCount(), 1, [&scene, &physics_scene](wi::jobsystem::JobArgs args) {
-						HumanoidComponent& humanoid = scene.humanoids[args.jobIndex];
-						if (humanoid.ragdoll == nullptr)
-							return;
-						Ragdoll& ragdoll = *(Ragdoll*)humanoid.ragdoll.get();
-						BodyInterface& body_interface = physics_scene.physics_system.GetBodyInterfaceNoLock();
-						int bodypart = 0;
-						for (auto& rb : ragdoll.rigidbodies)
-						{
-							TransformComponent* transform = scene.transforms.GetComponent(rb.entity);
-							if (transform == nullptr)
-								continue;
+							BodyInterface& body_interface = physics_scene.physics_system.GetBodyInterfaceNoLock();
 							Mat44 mat = body_interface.GetWorldTransform(rb.bodyID);
-							ragdoll.prev_capsule_position[bodypart] = mat.GetTranslation();
-							ragdoll.prev_capsule_rotation[bodypart] = mat.GetQuaternion().Normalized();
 							mat = mat * rb.additionalTransformInverse;
-							mat = mat * rb.restBasis;
 							rb.prev_position = mat.GetTranslation();
 							rb.prev_rotation = mat.GetQuaternion().Normalized();
-							bodypart++;
-						}
-					});
-					wi::jobsystem::Wait(ctx);
-				}
 
-				physics_scene.physics_system.Update(TIMESTEP, 1, &temp_allocator, &job_system);
-				physics_scene.accumulator = next_accumulator;
+							if (rb.vehicle_constraint != nullptr)
+							{
+								const Entity car_wheel_entities[] = {
+									physicscomponent.vehicle.wheel_entity_front_left,
+									physicscomponent.vehicle.wheel_entity_front_right,
+									physicscomponent.vehicle.wheel_entity_rear_left,
+									physicscomponent.vehicle.wheel_entity_rear_right,
+								};
+								const Entity motor_wheel_entities[] = {
+									physicscomponent.vehicle.wheel_entity_front_left,
+									physicscomponent.vehicle.wheel_entity_rear_left,
+								};
+								const uint32_t count = physicscomponent.vehicle.type == RigidBodyPhysicsComponent::Vehicle::Type::Car ? arraysize(car_wheel_entities) : arraysize(motor_wheel_entities);
+
+								for (uint32_t i = 0; i < count; ++i)
+								{
+									Entity wheel_entity = physicscomponent.vehicle.type == RigidBodyPhysicsComponent::Vehicle::Type::Car ? car_wheel_entities[i] : motor_wheel_entities[i];
+									if (wheel_entity == INVALID_ENTITY)
+										continue;
+
+									TransformComponent* wheel_transform = scene.transforms.GetComponent(wheel_entity);
+									if (wheel_transform != nullptr)
+									{
+										XMFLOAT4X4 localMatrix;
+										XMStoreFloat4x4(&localMatrix, wheel_transform->GetLocalMatrix());
+										Vec3 right = cast(wi::math::GetRight(localMatrix)).Normalized();
+										Vec3 up = cast(wi::math::GetUp(localMatrix)).Normalized();
+										Mat44 wheelmat = rb.vehicle_constraint->GetWheelWorldTransform(i, right, up);
+										rb.prev_wheel_positions[i] = wheelmat.GetTranslation();
+										rb.prev_wheel_rotations[i] = wheelmat.GetQuaternion();
+									}
+								}
+							}
+						});
+						wi::jobsystem::Dispatch(ctx, (uint32_t)scene.humanoids.GetCount(), 1, [&scene, &physics_scene](wi::jobsystem::JobArgs args) {
+							HumanoidComponent& humanoid = scene.humanoids[args.jobIndex];
+							if (humanoid.ragdoll == nullptr)
+								return;
+							Ragdoll& ragdoll = *(Ragdoll*)humanoid.ragdoll.get();
+							BodyInterface& body_interface = physics_scene.physics_system.GetBodyInterfaceNoLock();
+							int bodypart = 0;
+							for (auto& rb : ragdoll.rigidbodies)
+							{
+								TransformComponent* transform = scene.transforms.GetComponent(rb.entity);
+								if (transform == nullptr)
+									continue;
+								Mat44 mat = body_interface.GetWorldTransform(rb.bodyID);
+								ragdoll.prev_capsule_position[bodypart] = mat.GetTranslation();
+								ragdoll.prev_capsule_rotation[bodypart] = mat.GetQuaternion().Normalized();
+								mat = mat * rb.additionalTransformInverse;
+								mat = mat * rb.restBasis;
+								rb.prev_position = mat.GetTranslation();
+								rb.prev_rotation = mat.GetQuaternion().Normalized();
+								bodypart++;
+							}
+						});
+						wi::jobsystem::Wait(ctx);
+					}
+
+					StepSimulation(physics_scene);
+					physics_scene.accumulator = next_accumulator;
+				}
+				physics_scene.alpha = DETERMINISTIC ? 1 : physics_scene.accumulator / TIMESTEP;
 			}
-			physics_scene.alpha = physics_scene.accumulator / TIMESTEP;
 		}
 
 		// Feedback physics objects to system:
@@ -2717,6 +3633,39 @@ namespace wi::physics
 			}
 			BodyInterface& body_interface = physics_scene.physics_system.GetBodyInterfaceNoLock();
 			physicsobject.was_active_prev_frame = body_interface.IsActive(physicsobject.bodyID);
+
+			if (ASYNC_SIMULATION && physicsobject.vehicle_constraint != nullptr)
+			{
+				// Wheel axes are resolved from the scene for the next asynchronous step, and the wheel transforms are computed now,
+				//	because OverrideWehicleWheelTransforms() runs while the next step is already in progress
+				physicsobject.wheel_mask = 0;
+				const uint32_t count = GetWheelCount(physicscomponent);
+				for (uint32_t i = 0; i < count; ++i)
+				{
+					const Entity wheel_entity = GetWheelEntity(physicscomponent, i);
+					if (wheel_entity == INVALID_ENTITY)
+						continue;
+					const TransformComponent* wheel_transform = scene.transforms.GetComponent(wheel_entity);
+					if (wheel_transform == nullptr)
+						continue;
+					XMFLOAT4X4 localMatrix;
+					XMStoreFloat4x4(&localMatrix, wheel_transform->GetLocalMatrix());
+					physicsobject.wheel_right[i] = cast(wi::math::GetRight(localMatrix)).Normalized();
+					physicsobject.wheel_up[i] = cast(wi::math::GetUp(localMatrix)).Normalized();
+					Mat44 wheelmat = physicsobject.vehicle_constraint->GetWheelWorldTransform(i, physicsobject.wheel_right[i], physicsobject.wheel_up[i]);
+					Vec3 wheelpos = wheelmat.GetTranslation();
+					Quat wheelrot = wheelmat.GetQuaternion();
+					if (IsInterpolationEnabled())
+					{
+						wheelpos = wheelpos * physics_scene.alpha + physicsobject.prev_wheel_positions[i] * (1 - physics_scene.alpha);
+						wheelrot = physicsobject.prev_wheel_rotations[i].SLERP(wheelrot, physics_scene.alpha);
+					}
+					physicsobject.wheel_positions[i] = wheelpos;
+					physicsobject.wheel_rotations[i] = wheelrot;
+					physicsobject.wheel_mask |= 1u << i;
+				}
+			}
+
 			if (body_interface.GetMotionType(physicsobject.bodyID) != EMotionType::Dynamic)
 				return;
 
@@ -2920,6 +3869,81 @@ namespace wi::physics
 
 		wi::jobsystem::Wait(ctx);
 
+		if (physics_scene.async_steps > 0)
+		{
+			// Gather everything that the simulation step can access, the scene can be modified while the step is running:
+			physics_scene.async_keepalive.clear();
+			physics_scene.async_rigidbodies.clear();
+			physics_scene.async_ragdolls.clear();
+			for (size_t i = 0; i < scene.rigidbodies.GetCount(); ++i)
+			{
+				const RigidBodyPhysicsComponent& physicscomponent = scene.rigidbodies[i];
+				if (physicscomponent.physicsobject == nullptr)
+					continue;
+				physics_scene.async_keepalive.push_back(physicscomponent.physicsobject);
+				RigidBody& rb = *(RigidBody*)physicscomponent.physicsobject.get();
+				if (!rb.bodyID.IsInvalid())
+				{
+					physics_scene.async_rigidbodies.push_back(&rb);
+				}
+			}
+			for (size_t i = 0; i < scene.softbodies.GetCount(); ++i)
+			{
+				if (scene.softbodies[i].physicsobject != nullptr)
+				{
+					physics_scene.async_keepalive.push_back(scene.softbodies[i].physicsobject);
+				}
+			}
+			for (size_t i = 0; i < scene.constraints.GetCount(); ++i)
+			{
+				if (scene.constraints[i].physicsobject != nullptr)
+				{
+					physics_scene.async_keepalive.push_back(scene.constraints[i].physicsobject);
+				}
+			}
+			for (size_t i = 0; i < scene.humanoids.GetCount(); ++i)
+			{
+				const HumanoidComponent& humanoid = scene.humanoids[i];
+				if (humanoid.ragdoll == nullptr)
+					continue;
+				physics_scene.async_keepalive.push_back(humanoid.ragdoll);
+				Ragdoll& ragdoll = *(Ragdoll*)humanoid.ragdoll.get();
+				ragdoll.async_bodypart_mask = 0;
+				for (uint32_t j = 0; j < arraysize(ragdoll.rigidbodies); ++j)
+				{
+					if (scene.transforms.Contains(ragdoll.rigidbodies[j].entity))
+					{
+						ragdoll.async_bodypart_mask |= 1u << j;
+					}
+				}
+				physics_scene.async_ragdolls.push_back(&ragdoll);
+			}
+
+			// The job holds a reference to the physics scene, so it stays alive until the job is retired, even if the scene is destroyed:
+			const bool interpolation = IsInterpolationEnabled();
+			wi::jobsystem::Execute(physics_scene.simulation_ctx, [physics_scene_ref = scene.physics_scene, interpolation](wi::jobsystem::JobArgs args) {
+				PhysicsScene& physics_scene = *(PhysicsScene*)physics_scene_ref.get();
+				for (uint32_t step = 0; step < physics_scene.async_steps; ++step)
+				{
+					if (interpolation && step == physics_scene.async_steps - 1)
+					{
+						CapturePreviousStateAsync(physics_scene);
+					}
+					StepSimulation(physics_scene);
+				}
+				physics_scene.async_rigidbodies.clear();
+				physics_scene.async_ragdolls.clear();
+				wi::vector<std::shared_ptr<void>> keepalive;
+				std::swap(keepalive, physics_scene.async_keepalive); // objects that were removed from the scene meanwhile are destroyed here
+				keepalive.clear();
+			});
+		}
+		if (ASYNC_SIMULATION && IsSimulationEnabled())
+		{
+			// The results that are read back in the next update will be interpolated by the alpha of their own steps:
+			physics_scene.alpha = physics_scene.async_alpha;
+		}
+
 		wi::profiler::EndRange(range); // Physics
 	}
 
@@ -3297,7 +4321,7 @@ namespace wi::physics
 		if (ragdoll.rigidbodies[bodypart].bodyID.IsInvalid())
 			return;
 		RigidBody& physicsobject = ragdoll.rigidbodies[bodypart];
-		PhysicsScene& physics_scene = *(PhysicsScene*)physicsobject.physics_scene.get();
+		PhysicsScene& physics_scene = GetPhysicsScene(physicsobject.physics_scene);
 		BodyInterface& body_interface = physics_scene.physics_system.GetBodyInterfaceNoLock();
 		body_interface.SetMotionType(physicsobject.bodyID, EMotionType::Dynamic, EActivation::Activate);
 		body_interface.AddImpulse(physicsobject.bodyID, cast(impulse));
@@ -3380,7 +4404,7 @@ namespace wi::physics
 		if (ragdoll.rigidbodies[bodypart].bodyID.IsInvalid())
 			return;
 		RigidBody& physicsobject = ragdoll.rigidbodies[bodypart];
-		PhysicsScene& physics_scene = *(PhysicsScene*)physicsobject.physics_scene.get();
+		PhysicsScene& physics_scene = GetPhysicsScene(physicsobject.physics_scene);
 		BodyInterface& body_interface = physics_scene.physics_system.GetBodyInterfaceNoLock();
 		Vec3 at_world = at_local ? body_interface.GetCenterOfMassTransform(physicsobject.bodyID) * cast(at) : cast(at);
 		body_interface.SetMotionType(physicsobject.bodyID, EMotionType::Dynamic, EActivation::Activate);
@@ -3450,8 +4474,34 @@ namespace wi::physics
 			return;
 		if (!IsSimulationEnabled())
 			return;
-		PhysicsScene& physics_scene = GetPhysicsScene(scene);
 		wi::jobsystem::context ctx;
+		if (ASYNC_SIMULATION)
+		{
+			// The simulation step is running now, so the wheel transforms that were computed in RunPhysicsUpdateSystem() are used without waiting:
+			wi::jobsystem::Dispatch(ctx, (uint32_t)scene.rigidbodies.GetCount(), dispatchGroupSize, [&scene](wi::jobsystem::JobArgs args) {
+				RigidBodyPhysicsComponent& physicscomponent = scene.rigidbodies[args.jobIndex];
+				if (physicscomponent.physicsobject == nullptr)
+					return;
+				const RigidBody& physicsobject = *(RigidBody*)physicscomponent.physicsobject.get();
+				if (physicsobject.vehicle_constraint == nullptr)
+					return;
+				for (uint32_t i = 0; i < arraysize(physicsobject.wheel_positions); ++i)
+				{
+					if ((physicsobject.wheel_mask & (1u << i)) == 0)
+						continue;
+					const Entity wheel_entity = GetWheelEntity(physicscomponent, i);
+					TransformComponent* wheel_transform = scene.transforms.GetComponent(wheel_entity);
+					if (wheel_transform == nullptr)
+						continue;
+					Mat44 wheelmat = Mat44::sRotationTranslation(physicsobject.wheel_rotations[i], physicsobject.wheel_positions[i]) * Mat44::sScale(cast(wheel_transform->GetScale()));
+					wheel_transform->world = cast(wheelmat);
+					scene.RefreshHierarchyTopdownFromParent(wheel_entity);
+				}
+			});
+			wi::jobsystem::Wait(ctx);
+			return;
+		}
+		PhysicsScene& physics_scene = GetPhysicsScene(scene);
 		wi::jobsystem::Dispatch(ctx, (uint32_t)scene.rigidbodies.GetCount(), dispatchGroupSize, [&scene, &physics_scene](wi::jobsystem::JobArgs args) {
 
 			RigidBodyPhysicsComponent& physicscomponent = scene.rigidbodies[args.jobIndex];
@@ -3573,13 +4623,13 @@ namespace wi::physics
 	}
 	void ActivateAllRigidBodies(Scene& scene)
 	{
-		PhysicsScene& physics_scene = *(PhysicsScene*)scene.physics_scene.get();
+		PhysicsScene& physics_scene = GetPhysicsScene(scene.physics_scene);
 		physics_scene.activate_all_rigid_bodies = true;
 	}
 
 	void ResetPhysicsObjects(Scene& scene)
 	{
-		PhysicsScene& physics_scene = *(PhysicsScene*)scene.physics_scene.get();
+		PhysicsScene& physics_scene = GetPhysicsScene(scene.physics_scene);
 		BodyInterface& body_interface = physics_scene.physics_system.GetBodyInterfaceNoLock();
 		BodyIDVector bodies;
 		physics_scene.physics_system.GetBodies(bodies);
@@ -3679,7 +4729,7 @@ namespace wi::physics
 		if (humanoid.ragdoll == nullptr)
 			return;
 		Ragdoll& ragdoll = *(Ragdoll*)humanoid.ragdoll.get();
-		PhysicsScene& physics_scene = *(PhysicsScene*)ragdoll.physics_scene.get();
+		PhysicsScene& physics_scene = GetPhysicsScene(ragdoll.physics_scene);
 		BodyInterface& body_interface = physics_scene.physics_system.GetBodyInterfaceNoLock();
 		ObjectLayer layer = value ? Layers::GHOST : Layers::MOVING;
 		for (auto& rb : ragdoll.rigidbodies)
@@ -3736,7 +4786,7 @@ namespace wi::physics
 		if (scene.physics_scene == nullptr)
 			return result;
 
-		PhysicsScene& physics_scene = *(PhysicsScene*)scene.physics_scene.get();
+		PhysicsScene& physics_scene = GetPhysicsScene(scene.physics_scene);
 
 		const float tmin = clamp(ray.TMin, 0.0f, 1000000.0f);
 		const float tmax = clamp(ray.TMax, 0.0f, 1000000.0f);
@@ -3819,7 +4869,7 @@ namespace wi::physics
 		{
 			if (physics_scene == nullptr || bodyB == nullptr)
 				return;
-			PhysicsScene& physics_scene = *((PhysicsScene*)this->physics_scene.get());
+			PhysicsScene& physics_scene = GetPhysicsScene(this->physics_scene);
 			BodyInterface& body_interface = physics_scene.physics_system.GetBodyInterfaceNoLock();
 			if (bodyA != nullptr)
 			{
@@ -3846,7 +4896,7 @@ namespace wi::physics
 	{
 		if (scene.physics_scene == nullptr)
 			return;
-		PhysicsScene& physics_scene = *((PhysicsScene*)scene.physics_scene.get());
+		PhysicsScene& physics_scene = GetPhysicsScene(scene.physics_scene);
 		BodyInterface& body_interface = physics_scene.physics_system.GetBodyInterfaceNoLock();
 
 		if (op.IsValid())
@@ -0,0 +1,175 @@
+#pragma once
+#include "CommonInclude.h"
+#include "wiJobSystem.h"
+#include "wiVector.h"
+
+#include <algorithm>
+
+// CPU radix sort for arrays of trivially copyable items with 64-bit sort keys
+//	The key is queried from the items with a user function, so items don't need to store it
+//	The sort is stable (LSD), byte passes that wouldn't change the order are skipped
+//	Already sorted input is detected in the histogram pass and not touched
+namespace wi::radixsort
+{
+	static constexpr uint32_t RADIX_PASS_COUNT = 8;
+	static constexpr uint32_t RADIX_BUCKET_COUNT = 256;
+
+	// Sorts count items in ascending order of their keys
+	//	items:		the input array
+	//	temp:		scratch array with the same count as items
+	//	get_key:	function returning uint64_t sort key from an item
+	//	returns the pointer to the sorted array, which is either items or temp
+	template<typename T, typename GetKey>
+	inline T* Sort(T* items, T* temp, size_t count, GetKey get_key)
+	{
+		if (count < 2)
+			return items;
+
+		// All histograms are computed in a single pass:
+		uint32_t histograms[RADIX_PASS_COUNT][RADIX_BUCKET_COUNT] = {};
+		bool sorted = true;
+		uint64_t prev = 0;
+		for (size_t i = 0; i < count; ++i)
+		{
+			const uint64_t key = get_key(items[i]);
+			sorted &= prev <= key;
+			prev = key;
+			for (uint32_t pass = 0; pass < RADIX_PASS_COUNT; ++pass)
+			{
+				histograms[pass][(key >> (pass * 8ull)) & 0xFF]++;
+			}
+		}
+		if (sorted)
+			return items;
+
+		const uint64_t first_key = get_key(items[0]);
+		T* src = items;
+		T* dst = temp;
+		for (uint32_t pass = 0; pass < RADIX_PASS_COUNT; ++pass)
+		{
+			const uint64_t shift = pass * 8ull;
+			uint32_t* histogram = histograms[pass];
+			if (histogram[(first_key >> shift) & 0xFF] == count)
+				continue; // every key has the same byte here
+
+			uint32_t offset = 0;
+			for (uint32_t bucket = 0; bucket < RADIX_BUCKET_COUNT; ++bucket)
+			{
+				const uint32_t bucket_count = histogram[bucket];
+				histogram[bucket] = offset;
+				offset += bucket_count;
+			}
+			for (size_t i = 0; i < count; ++i)
+			{
+				dst[histogram[(get_key(src[i]) >> shift) & 0xFF]++] = src[i];
+			}
+			std::swap(src, dst);
+		}
+		return src;
+	}
+
+	// Same as Sort(), but large arrays are split to chunks that are processed in parallel with the job system
+	//	chunk_size:	the amount of items per job, arrays that fit in one chunk are sorted on the calling thread
+	template<typename T, typename GetKey>
+	inline T* SortParallel(T* items, T* temp, size_t count, GetKey get_key, uint32_t chunk_size = 16384)
+	{
+		const uint32_t chunk_count = uint32_t((count + chunk_size - 1) / chunk_size);
+		if (chunk_count < 2 || wi::jobsystem::GetThreadCount() < 2)
+			return Sort(items, temp, count, get_key);
+
+		// Global histograms, used for detecting sorted input and skipping passes:
+		wi::vector<uint32_t> chunk_histograms(size_t(chunk_count) * RADIX_PASS_COUNT * RADIX_BUCKET_COUNT);
+		wi::vector<uint8_t> chunk_sorted(chunk_count);
+		wi::jobsystem::context ctx;
+		wi::jobsystem::Dispatch(ctx, chunk_count, 1, [&](wi::jobsystem::JobArgs args) {
+			const size_t begin = size_t(args.jobIndex) * chunk_size;
+			const size_t end = std::min(begin + chunk_size, count);
+			uint32_t* histograms = chunk_histograms.data() + size_t(args.jobIndex) * RADIX_PASS_COUNT * RADIX_BUCKET_COUNT;
+			bool sorted = true;
+			uint64_t prev = begin > 0 ? get_key(items[begin - 1]) : 0; // overlapping by one item checks the chunk boundaries too
+			for (size_t i = begin; i < end; ++i)
+			{
+				const uint64_t key = get_key(items[i]);
+				sorted &= prev <= key;
+				prev = key;
+				for (uint32_t pass = 0; pass < RADIX_PASS_COUNT; ++pass)
+				{
+					histograms[pass * RADIX_BUCKET_COUNT + ((key >> (pass * 8ull)) & 0xFF)]++;
+				}
+			}
+			chunk_sorted[args.jobIndex] = sorted ? 1 : 0;
+		});
+		wi::jobsystem::Wait(ctx);
+
+		if (std::all_of(chunk_sorted.begin(), chunk_sorted.end(), [](uint8_t x) { return x != 0; }))
+			return items;
+
+		bool pass_required[RADIX_PASS_COUNT] = {};
+		const uint64_t first_key = get_key(items[0]);
+		for (uint32_t pass = 0; pass < RADIX_PASS_COUNT; ++pass)
+		{
+			const uint32_t bucket = (first_key >> (pass * 8ull)) & 0xFF;
+			uint32_t total = 0;
+			for (uint32_t chunk = 0; chunk < chunk_count; ++chunk)
+			{
+				total += chunk_histograms[(size_t(chunk) * RADIX_PASS_COUNT + pass) * RADIX_BUCKET_COUNT + bucket];
+			}
+			pass_required[pass] = total != count;
+		}
+
+		// Per chunk scatter offsets of the current pass:
+		wi::vector<uint32_t> chunk_offsets(size_t(chunk_count) * RADIX_BUCKET_COUNT);
+
+		T* src = items;
+		T* dst = temp;
+		bool first_pass = true;
+		for (uint32_t pass = 0; pass < RADIX_PASS_COUNT; ++pass)
+		{
+			if (!pass_required[pass])
+				continue;
+			const uint64_t shift = pass * 8ull;
+
+			if (!first_pass)
+			{
+				// The items moved between chunks in the previous scatter, so the chunk histograms are recomputed for this pass:
+				wi::jobsystem::Dispatch(ctx, chunk_count, 1, [&](wi::jobsystem::JobArgs args) {
+					const size_t begin = size_t(args.jobIndex) * chunk_size;
+					const size_t end = std::min(begin + chunk_size, count);
+					uint32_t* histogram = chunk_histograms.data() + (size_t(args.jobIndex) * RADIX_PASS_COUNT + pass) * RADIX_BUCKET_COUNT;
+					std::fill(histogram, histogram + RADIX_BUCKET_COUNT, 0u);
+					for (size_t i = begin; i < end; ++i)
+					{
+						histogram[(get_key(src[i]) >> shift) & 0xFF]++;
+					}
+				});
+				wi::jobsystem::Wait(ctx);
+			}
+			first_pass = false;
+
+			// Bucket major, chunk minor prefix sum keeps the sort stable:
+			uint32_t offset = 0;
+			for (uint32_t bucket = 0; bucket < RADIX_BUCKET_COUNT; ++bucket)
+			{
+				for (uint32_t chunk = 0; chunk < chunk_count; ++chunk)
+				{
+					chunk_offsets[size_t(chunk) * RADIX_BUCKET_COUNT + bucket] = offset;
+					offset += chunk_histograms[(size_t(chunk) * RADIX_PASS_COUNT + pass) * RADIX_BUCKET_COUNT + bucket];
+				}
+			}
+
+			wi::jobsystem::Dispatch(ctx, chunk_count, 1, [&](wi::jobsystem::JobArgs args) {
+				const size_t begin = size_t(args.jobIndex) * chunk_size;
+				const size_t end = std::min(begin + chunk_size, count);
+				uint32_t* offsets = chunk_offsets.data() + size_t(args.jobIndex) * RADIX_BUCKET_COUNT;
+				for (size_t i = begin; i < end; ++i)
+				{
+					dst[offsets[(get_key(src[i]) >> shift) & 0xFF]++] = src[i];
+				}
+			});
+			wi::jobsystem::Wait(ctx);
+
+			std::swap(src, dst);
+		}
+		return src;
+	}
+}
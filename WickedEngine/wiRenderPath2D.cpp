@@ -249,6 +249,7 @@ namespace wi
 		bool stencil_scaled = false;
 
 		device->EventBegin("Layers", cmd);
+		wi::image::BeginBatch(cmd);
 		for (auto& x : layers)
 		{
 			for (auto& y : x.items)
@@ -259,6 +260,7 @@ namespace wi
 					{
 						// Only need a scaled stencil mask if there are any stenciled sprites, and only once is enough before the first one
 						stencil_scaled = true;
+						wi::image::FlushBatch(cmd);
 						wi::renderer::ScaleStencilMask(vp, rtStencilExtracted, cmd);
 					}
 					if (y.videoinstance != nullptr)
@@ -273,6 +275,7 @@ namespace wi
 				}
 			}
 		}
+		wi::image::EndBatch(cmd);
 		device->EventEnd(cmd);
 
 		GetGUI().Render(*this, cmd);
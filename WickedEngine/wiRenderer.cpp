@@ -10,6 +10,7 @@
 #include "wiProfiler.h"
 #include "wiOcean.h"
 #include "wiGPUSortLib.h"
+#include "wiRadixSort.h"
 #include "wiGPUBVH.h"
 #include "wiJobSystem.h"
 #include "wiSpinLock.h"
@@ -197,120 +198,96 @@ Texture texture_detailNoise;
 Texture texture_curlNoise;
 Texture texture_weatherMap;
 
-// Direct reference to a renderable instance:
-struct alignas(16) RenderBatch
+// This is a utility that points to a linear array of render batches:
+struct RenderQueue
 {
-	uint32_t meshIndex;
-	uint32_t instanceIndex;
-	uint16_t distance;
-	uint8_t camera_mask;
-	uint8_t lod_override; // if overriding the base object LOD is needed, specify less than 0xFF in this
-	uint32_t sort_bits; // an additional bitmask for sorting only, it should be used to reduce pipeline changes
+	wi::vector<RenderBatch> batches;
+	wi::vector<RenderBatch> batches_temp; // radix sort scratch memory
 
-	inline void Create(uint32_t meshIndex, uint32_t instanceIndex, float distance, uint32_t sort_bits, uint8_t camera_mask = 0xFF, uint8_t lod_override = 0xFF)
+	// Remembers the last unsorted input and sorted output of a queue that is rebuilt every frame
+	//	If the input didn't change (for example the same static shadow casters are visible), the sorted result is reused
+	struct SortCache
 	{
-		this->meshIndex = meshIndex;
-		this->instanceIndex = instanceIndex;
-		this->distance = XMConvertFloatToHalf(distance);
-		this->sort_bits = sort_bits;
-		this->camera_mask = camera_mask;
-		this->lod_override = lod_override;
-	}
+		wi::vector<RenderBatch> input;
+		wi::vector<RenderBatch> output;
+		uint64_t frame = 0;
+	};
 
-	inline float GetDistance() const
+	inline void init()
 	{
-		return XMConvertHalfToFloat(HALF(distance));
+		batches.clear();
 	}
-	constexpr uint32_t GetMeshIndex() const
+	inline void add(uint32_t meshIndex, uint32_t instanceIndex, float distance, uint32_t sort_bits, uint8_t camera_mask = 0xFF, uint8_t lod_override = 0xFF)
 	{
-		return meshIndex;
+		batches.emplace_back().Create(meshIndex, instanceIndex, distance, sort_bits, camera_mask, lod_override);
 	}
-	constexpr uint32_t GetInstanceIndex() const
+	inline void add(const RenderBatch& batch)
 	{
-		return instanceIndex;
+		batches.push_back(batch);
 	}
-
-	// opaque sorting
-	//	Priority is set to mesh index to have more instancing
-	//	distance is second priority (front to back Z-buffering)
-	constexpr bool operator<(const RenderBatch& other) const
+	inline void sort(bool transparent)
 	{
-		union SortKey
+		if (batches.size() < 128)
 		{
-			struct
+			// Comparison sort is faster for small queues:
+			if (transparent)
 			{
-				// The order of members is important here, it means the sort priority (low to high)!
-				uint64_t distance : 16;
-				uint64_t meshIndex : 16;
-				uint64_t sort_bits : 32;
-			} bits;
-			uint64_t value;
-		};
-		static_assert(sizeof(SortKey) == sizeof(uint64_t));
-		SortKey a = {};
-		a.bits.distance = distance;
-		a.bits.meshIndex = meshIndex;
-		a.bits.sort_bits = sort_bits;
-		SortKey b = {};
-		b.bits.distance = other.distance;
-		b.bits.meshIndex = other.meshIndex;
-		b.bits.sort_bits = other.sort_bits;
-		return a.value < b.value;
-	}
-	// transparent sorting
-	//	Priority is distance for correct alpha blending (back to front rendering)
-	//	mesh index is second priority for instancing
-	constexpr bool operator>(const RenderBatch& other) const
-	{
-		union SortKey
-		{
-			struct
+				std::sort(batches.begin(), batches.end(), std::greater<RenderBatch>());
+			}
+			else
 			{
-				// The order of members is important here, it means the sort priority (low to high)!
-				uint64_t meshIndex : 16;
-				uint64_t sort_bits : 32;
-				uint64_t distance : 16;
-			} bits;
-			uint64_t value;
-		};
-		static_assert(sizeof(SortKey) == sizeof(uint64_t));
-		SortKey a = {};
-		a.bits.distance = distance;
-		a.bits.sort_bits = sort_bits;
-		a.bits.meshIndex = meshIndex;
-		SortKey b = {};
-		b.bits.distance = other.distance;
-		b.bits.sort_bits = other.sort_bits;
-		b.bits.meshIndex = other.meshIndex;
-		return a.value > b.value;
-	}
-};
-static_assert(sizeof(RenderBatch) == 16ull);
-
-// This is a utility that points to a linear array of render batches:
-struct RenderQueue
-{
-	wi::vector<RenderBatch> batches;
+				std::sort(batches.begin(), batches.end(), std::less<RenderBatch>());
+			}
+			return;
+		}
 
-	inline void init()
+		batches_temp.resize(batches.size());
+		RenderBatch* sorted = nullptr;
+		if (transparent)
+		{
+			// descending order by inverting the keys:
+			sorted = wi::radixsort::SortParallel(batches.data(), batches_temp.data(), batches.size(), [](const RenderBatch& batch) {
+				return ~batch.GetSortKeyTransparent();
+			});
+		}
+		else
+		{
+			sorted = wi::radixsort::SortParallel(batches.data(), batches_temp.data(), batches.size(), [](const RenderBatch& batch) {
+				return batch.GetSortKeyOpaque();
+			});
+		}
+		if (sorted != batches.data())
+		{
+			std::swap(batches, batches_temp);
+		}
+	}
+	inline void sort(bool transparent, SortCache& cache, uint64_t frame)
 	{
-		batches.clear();
+		cache.frame = frame;
+		if (cache.input.size() == batches.size() && std::memcmp(cache.input.data(), batches.data(), sizeof(RenderBatch) * batches.size()) == 0)
+		{
+			batches = cache.output;
+			return;
+		}
+		cache.input = batches;
+		sort(transparent);
+		cache.output = batches;
 	}
-	inline void add(uint32_t meshIndex, uint32_t instanceIndex, float distance, uint32_t sort_bits, uint8_t camera_mask = 0xFF, uint8_t lod_override = 0xFF)
+	inline void sort_transparent()
 	{
-		batches.emplace_back().Create(meshIndex, instanceIndex, distance, sort_bits, camera_mask, lod_override);
+		sort(true);
 	}
-	inline void add(const RenderBatch& batch)
+	inline void sort_opaque()
 	{
-		batches.push_back(batch);
+		sort(false);
 	}
-	inline void sort_transparent()
+	inline void sort_transparent(SortCache& cache, uint64_t frame)
 	{
-		std::sort(batches.begin(), batches.end(), std::greater<RenderBatch>());
+		sort(true, cache, frame);
 	}
-	inline void sort_opaque()
+	inline void sort_opaque(SortCache& cache, uint64_t frame)
 	{
-		std::sort(batches.begin(), batches.end(), std::less<RenderBatch>());
+		sort(false, cache, frame);
 	}
 	inline bool empty() const
 	{
@@ -323,6 +300,7 @@ struct RenderQueue
 };
 static thread_local RenderQueue renderQueue;
 static thread_local RenderQueue renderQueue_transparent;
+static thread_local wi::unordered_map<uint64_t, RenderQueue::SortCache> shadowSortCache; // key: light entity and transparency
 
 
 const Sampler* GetSampler(SAMPLERTYPES id)
@@ -5579,7 +5557,7 @@ void UpdateOcean(
 	{
 		auto range = wi::profiler::BeginRangeGPU("Ocean - Simulate", cmd);
 		wi::renderer::BindCommonResources(cmd);
-		vis.scene->ocean.UpdateDisplacementMap(cmd);
+		vis.scene->ocean.UpdateDisplacementMap(vis.scene->time, cmd); // same time as the CPU simulation in Scene::Update()
 		wi::profiler::EndRange(range);
 	}
 }
@@ -6591,6 +6569,7 @@ void DrawShadowmaps(
 		GetOcclusionCullingEnabled();
 
 	const bool shadow_lod_override = IsShadowLODOverrideEnabled();
+	const uint64_t frame = device->GetFrameCount();
 
 	BindCommonResources(cmd);
 
@@ -6636,6 +6615,7 @@ void DrawShadowmaps(
 		if (!shadow)
 			continue;
 		const wi::rectpacker::Rect& shadow_rect = vis.visibleLightShadowRects[lightIndex];
+		const uint64_t shadow_sort_key = uint64_t(vis.scene->lights.GetEntity(lightIndex)) << 1ull;
 
 		renderQueue.init();
 		renderQueue_transparent.init();
@@ -6730,8 +6710,8 @@ void DrawShadowmaps(
 				device->BindViewports(cascade_count, viewports, cmd);
 				device->BindScissorRects(cascade_count, scissors, cmd);
 
-				renderQueue.sort_opaque();
-				renderQueue_transparent.sort_transparent();
+				renderQueue.sort_opaque(shadowSortCache[shadow_sort_key], frame);
+				renderQueue_transparent.sort_transparent(shadowSortCache[shadow_sort_key | 1ull], frame);
 				RenderMeshes(vis, renderQueue, RENDERPASS_SHADOW, FILTER_OPAQUE, cmd, 0, cascade_count);
 				RenderMeshes(vis, renderQueue_transparent, RENDERPASS_SHADOW, FILTER_TRANSPARENT | FILTER_WATER, cmd, 0, cascade_count);
 			}
@@ -6854,8 +6834,8 @@ void DrawShadowmaps(
 				scissor.from_viewport(vp);
 				device->BindScissorRects(1, &scissor, cmd);
 
-				renderQueue.sort_opaque();
-				renderQueue_transparent.sort_transparent();
+				renderQueue.sort_opaque(shadowSortCache[shadow_sort_key], frame);
+				renderQueue_transparent.sort_transparent(shadowSortCache[shadow_sort_key | 1ull], frame);
 				RenderMeshes(vis, renderQueue, RENDERPASS_SHADOW, FILTER_OPAQUE, cmd);
 				RenderMeshes(vis, renderQueue_transparent, RENDERPASS_SHADOW, FILTER_TRANSPARENT | FILTER_WATER, cmd);
 			}
@@ -7004,8 +6984,8 @@ void DrawShadowmaps(
 				device->BindViewports(arraysize(vp), vp, cmd);
 				device->BindScissorRects(arraysize(scissors), scissors, cmd);
 
-				renderQueue.sort_opaque();
-				renderQueue_transparent.sort_transparent();
+				renderQueue.sort_opaque(shadowSortCache[shadow_sort_key], frame);
+				renderQueue_transparent.sort_transparent(shadowSortCache[shadow_sort_key | 1ull], frame);
 				RenderMeshes(vis, renderQueue, RENDERPASS_SHADOW, FILTER_OPAQUE, cmd, 0, camera_count);
 				RenderMeshes(vis, renderQueue_transparent, RENDERPASS_SHADOW, FILTER_TRANSPARENT | FILTER_WATER, cmd, 0, camera_count);
 			}
@@ -7056,6 +7036,19 @@ void DrawShadowmaps(
 		} // terminate switch
 	}
 
+	// Drop cached sort results of lights that didn't render shadows recently:
+	for (auto it = shadowSortCache.begin(); it != shadowSortCache.end();)
+	{
+		if (it->second.frame + 60 < frame)
+		{
+			it = shadowSortCache.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+
 	// Rain blocker:
 	if (vis.scene->weather.rain_amount > 0)
 	{
@@ -71,6 +71,65 @@ namespace wi::renderer
 	//	Note: it will return 16-bit or 32-bit index buffer depending on max_quad_count
 	const wi::graphics::GPUBuffer& GetIndexBufferForQuads(uint32_t max_quad_count);
 
+	// Direct reference to a renderable instance:
+	struct alignas(16) RenderBatch
+	{
+		uint32_t meshIndex;
+		uint32_t instanceIndex;
+		uint16_t distance;
+		uint8_t camera_mask;
+		uint8_t lod_override; // if overriding the base object LOD is needed, specify less than 0xFF in this
+		uint32_t sort_bits; // an additional bitmask for sorting only, it should be used to reduce pipeline changes
+
+		inline void Create(uint32_t meshIndex, uint32_t instanceIndex, float distance, uint32_t sort_bits, uint8_t camera_mask = 0xFF, uint8_t lod_override = 0xFF)
+		{
+			this->meshIndex = meshIndex;
+			this->instanceIndex = instanceIndex;
+			this->distance = XMConvertFloatToHalf(distance);
+			this->sort_bits = sort_bits;
+			this->camera_mask = camera_mask;
+			this->lod_override = lod_override;
+		}
+
+		inline float GetDistance() const
+		{
+			return XMConvertHalfToFloat(HALF(distance));
+		}
+		constexpr uint32_t GetMeshIndex() const
+		{
+			return meshIndex;
+		}
+		constexpr uint32_t GetInstanceIndex() const
+		{
+			return instanceIndex;
+		}
+
+		// opaque sorting
+		//	Priority is set to mesh index to have more instancing
+		//	distance is second priority (front to back Z-buffering)
+		//	The order of fields is important here, it means the sort priority (high to low)!
+		constexpr uint64_t GetSortKeyOpaque() const
+		{
+			return (uint64_t(sort_bits) << 32ull) | (uint64_t(meshIndex & 0xFFFF) << 16ull) | uint64_t(distance);
+		}
+		// transparent sorting
+		//	Priority is distance for correct alpha blending (back to front rendering)
+		//	mesh index is second priority for instancing
+		constexpr uint64_t GetSortKeyTransparent() const
+		{
+			return (uint64_t(distance) << 48ull) | (uint64_t(sort_bits) << 16ull) | uint64_t(meshIndex & 0xFFFF);
+		}
+		constexpr bool operator<(const RenderBatch& other) const
+		{
+			return GetSortKeyOpaque() < other.GetSortKeyOpaque();
+		}
+		constexpr bool operator>(const RenderBatch& other) const
+		{
+			return GetSortKeyTransparent() > other.GetSortKeyTransparent();
+		}
+	};
+	static_assert(sizeof(RenderBatch) == 16ull);
+
 	struct BufferSuballocation
 	{
 		wi::graphics::GPUBuffer alias;
@@ -5,12 +5,16 @@
 #include "wiUnorderedMap.h"
 #include "wiBacklog.h"
 #include "wiJobSystem.h"
+#include "wiTextureCooker.h"
+#include "wiTimer.h"
 
 #include "Utility/stb_image.h"
 #include "Utility/dds.h"
 
 #include <algorithm>
 #include <mutex>
+#include <condition_variable>
+#include <thread>
 #include <unordered_map>
 
 using namespace wi::graphics;
@@ -54,6 +58,26 @@ namespace wi
 		size_t container_fileoffset = 0;
 		uint64_t timestamp = 0;
 
+		// Last known file timestamp and the time it was queried, to avoid querying it on every Load():
+		uint64_t file_timestamp = 0;
+		double file_timestamp_time = 0;
+
+		// Loading state, concurrent loads of the same resource wait for the one in flight instead of loading it again:
+		enum class LoadState
+		{
+			LOADED,
+			LOADING,
+			FAILED,
+		};
+		std::atomic<LoadState> load_state{ LoadState::LOADED };
+		std::mutex load_mutex;
+		std::condition_variable load_condition;
+		std::atomic<std::thread::id> loading_thread; // the thread that is currently loading, it can't wait for its own load
+		resourcemanager::Flags loading_flags = resourcemanager::Flags::NONE; // flags of the load in flight, protected by resourcemanager locker
+		bool full_import_requested = false; // a full import was requested while an IMPORT_DELAY load was in flight, protected by resourcemanager locker
+		wi::jobsystem::context load_io_ctx; // file reading of LoadAsync()
+		wi::jobsystem::context load_decode_ctx; // decoding and GPU resource creation of LoadAsync()
+
 		// Streaming parameters:
 		StreamingTexture streaming_texture;
 		std::atomic<uint32_t> streaming_resolution{ 0 };
@@ -200,6 +224,10 @@ namespace wi
 		static std::mutex locker;
 		static std::unordered_map<std::string, std::weak_ptr<ResourceInternal>> resources;
 		static Mode mode = Mode::NO_EMBEDDING;
+		static std::atomic<float> sound_streaming_threshold{ 30.0f };
+		static std::atomic_bool texture_cooking{ true };
+		static std::atomic<double> timestamp_check_interval{ 1.0 };
+		static wi::Timer timestamp_timer;
 
 		void SetMode(Mode param)
 		{
@@ -326,6 +354,25 @@ namespace wi
 			case DataType::IMAGE:
 			{
 				GraphicsDevice* device = wi::graphics::GetDevice();
+
+				wi::vector<uint8_t> cooked;
+				if (texture_cooking.load() && has_flag(flags, Flags::IMPORT_BLOCK_COMPRESSED) && !has_flag(flags, Flags::IMPORT_COLORGRADINGLUT) && ext.compare("DDS") && ext.compare("HDR"))
+				{
+					// The cooked DDS is loaded instead of the image, but the resource still keeps the original file data:
+					//	The mips are filtered in the stored color space and preserve alpha coverage, like the GPU mip generation
+					wi::texturecooker::CookSettings settings;
+					settings.normalmap = has_flag(flags, Flags::IMPORT_NORMALMAP);
+					settings.srgb = false;
+					settings.preserve_coverage = true;
+					if (wi::texturecooker::CookCached(filedata, filesize, settings, cooked))
+					{
+						filedata = cooked.data();
+						filesize = cooked.size();
+						ext = "DDS";
+						flags &= ~Flags::STREAMING; // streaming would read mips from the original file data
+					}
+				}
+
 				if (!ext.compare("DDS"))
 				{
 					dds::Header header = dds::read_header(filedata, filesize);
@@ -853,7 +900,9 @@ namespace wi
 
 			case DataType::SOUND:
 			{
-				success = wi::audio::CreateSound(filedata, filesize, &resource->sound);
+				// Long sounds are decoded while playing, short ones are decoded once here:
+				const bool streaming = has_flag(flags, Flags::STREAMING) || wi::audio::GetSoundDuration(filedata, filesize) > sound_streaming_threshold.load();
+				success = wi::audio::CreateSound(filedata, filesize, &resource->sound, streaming);
 			}
 			break;
 
@@ -897,112 +946,317 @@ namespace wi
 			return success;
 		}
 
-		Resource Load(
+		// The number of loads that are in progress on the current thread (LoadResourceDirectly() can execute other jobs while waiting)
+		static thread_local uint32_t load_depth = 0;
+
+		// Initializes a new resource that is going to be loaded by the caller
+		static void InitResource(
 			const std::string& name,
 			Flags flags,
 			const uint8_t* filedata,
 			size_t filesize,
 			const std::string& container_filename,
-			size_t container_fileoffset
+			size_t container_fileoffset,
+			uint64_t timestamp,
+			double time,
+			ResourceInternal* resource
 		)
 		{
-			locker.lock();
-			std::weak_ptr<ResourceInternal>& weak_resource = resources[name];
-			std::shared_ptr<ResourceInternal> resource = weak_resource.lock();
-
-			uint64_t timestamp = 0;
-			if(!container_filename.empty())
+			resource->filename = name;
+			resource->file_timestamp = timestamp;
+			resource->file_timestamp_time = time;
+			resource->loading_flags = flags;
+			resource->load_state.store(ResourceInternal::LoadState::LOADING);
+			resource->loading_thread.store(std::this_thread::get_id());
+
+			// Rememeber the streaming file parameters, which is either the resource filename,
+			//	or it can be a specific filename and offset in the case when the file contained multiple resources
+			if (container_filename.empty())
 			{
-				timestamp = wi::helper::FileTimestamp(container_filename);
+				resource->container_filename = name;
 			}
 			else
 			{
-				timestamp = wi::helper::FileTimestamp(name);
+				resource->container_filename = container_filename;
 			}
+			resource->container_filesize = filesize;
+			resource->container_fileoffset = container_fileoffset;
 
-			if (resource == nullptr || resource->timestamp < timestamp)
+			if (filedata != nullptr && resource->filedata.empty() && (has_flag(flags, Flags::IMPORT_RETAIN_FILEDATA) || has_flag(flags, Flags::IMPORT_DELAY)))
 			{
-				resource = std::make_shared<ResourceInternal>();
-				resources[name] = resource;
-				resource->filename = name;
+				// resource was loaded with external filedata, and we want to retain filedata
+				//	this must also happen when using IMPORT_DELAY!
+				resource->filedata.resize(filesize);
+				std::memcpy(resource->filedata.data(), filedata, filesize);
+			}
+		}
 
-				// Rememeber the streaming file parameters, which is either the resource filename,
-				//	or it can be a specific filename and offset in the case when the file contained multiple resources
-				if (container_filename.empty())
-				{
-					resource->container_filename = name;
-				}
-				else
-				{
-					resource->container_filename = container_filename;
-				}
-				resource->container_filesize = filesize;
-				resource->container_fileoffset = container_fileoffset;
+		enum class AcquireResult
+		{
+			LOAD,		// the caller must load the resource
+			IN_FLIGHT,	// the resource is being loaded by someone else
+			LOADED,		// the resource is already loaded
+		};
+		// Finds or creates the resource, and decides who is loading it
+		//	timestamp: receives the file timestamp that the loaded resource will be marked with
+		static AcquireResult AcquireResource(
+			const std::string& name,
+			Flags flags,
+			const uint8_t* filedata,
+			size_t filesize,
+			const std::string& container_filename,
+			size_t container_fileoffset,
+			std::shared_ptr<ResourceInternal>& resource,
+			uint64_t& timestamp
+		)
+		{
+			const std::string& timestamp_filename = container_filename.empty() ? name : container_filename;
 
-				if (filedata != nullptr && resource->filedata.empty() && (has_flag(flags, Flags::IMPORT_RETAIN_FILEDATA) || has_flag(flags, Flags::IMPORT_DELAY)))
+			locker.lock();
+			resource = resources[name].lock();
+			const double time = timestamp_timer.elapsed_seconds();
+			const bool timestamp_check =
+				resource == nullptr ||
+				resource->load_state.load() == ResourceInternal::LoadState::FAILED ||
+				time - resource->file_timestamp_time >= timestamp_check_interval.load();
+			if (timestamp_check)
+			{
+				// The file system is not queried while holding the lock, then the resource is looked up again:
+				locker.unlock();
+				timestamp = wi::helper::FileTimestamp(timestamp_filename);
+				locker.lock();
+				resource = resources[name].lock();
+				if (resource != nullptr && resource->load_state.load() != ResourceInternal::LoadState::LOADING)
 				{
-					// resource was loaded with external filedata, and we want to retain filedata
-					//	this must also happen when using IMPORT_DELAY!
-					resource->filedata.resize(filesize);
-					std::memcpy(resource->filedata.data(), filedata, filesize);
+					resource->file_timestamp = timestamp;
+					resource->file_timestamp_time = time;
 				}
 			}
 			else
 			{
-				if (!has_flag(flags, Flags::IMPORT_DELAY) && has_flag(resource->flags, Flags::IMPORT_DELAY))
-				{
-					// If this is not an IMPORT_DELAY load, but this resource load was incomplete, using IMPORT_DELAY,
-					//	then continue loading it as normal from existing file data and remove IMPORT_DELAY flag from it
-					resource->flags &= ~Flags::IMPORT_DELAY;
-				}
-				else
+				timestamp = resource->file_timestamp;
+			}
+
+			AcquireResult result = AcquireResult::LOAD;
+			if (resource != nullptr && resource->load_state.load() == ResourceInternal::LoadState::LOADING)
+			{
+				result = AcquireResult::IN_FLIGHT;
+				if (!has_flag(flags, Flags::IMPORT_DELAY) && has_flag(resource->loading_flags, Flags::IMPORT_DELAY))
 				{
-					Resource retVal;
-					retVal.internal_state = resource;
-					locker.unlock();
-					return retVal;
+					// The IMPORT_DELAY load in flight will continue with the full import when it finishes:
+					resource->full_import_requested = true;
 				}
 			}
+			else if (resource == nullptr || resource->load_state.load() == ResourceInternal::LoadState::FAILED || resource->timestamp < timestamp)
+			{
+				resource = std::make_shared<ResourceInternal>();
+				resources[name] = resource;
+				InitResource(name, flags, filedata, filesize, container_filename, container_fileoffset, timestamp, time, resource.get());
+			}
+			else if (!has_flag(flags, Flags::IMPORT_DELAY) && has_flag(resource->flags, Flags::IMPORT_DELAY))
+			{
+				// If this is not an IMPORT_DELAY load, but this resource load was incomplete, using IMPORT_DELAY,
+				//	then continue loading it as normal from existing file data and remove IMPORT_DELAY flag from it
+				resource->flags &= ~Flags::IMPORT_DELAY;
+				resource->loading_flags = resource->flags;
+				resource->load_state.store(ResourceInternal::LoadState::LOADING);
+				resource->loading_thread.store(std::this_thread::get_id());
+			}
+			else
+			{
+				result = AcquireResult::LOADED;
+			}
 			locker.unlock();
+			return result;
+		}
+
+		static void FinishLoad(ResourceInternal* resource, bool success)
+		{
+			std::scoped_lock lck(resource->load_mutex);
+			resource->loading_thread.store(std::thread::id());
+			resource->load_state.store(success ? ResourceInternal::LoadState::LOADED : ResourceInternal::LoadState::FAILED);
+			resource->load_condition.notify_all();
+		}
 
-			if (filedata == nullptr || filesize == 0)
+		// Waits for a load in flight, returns true if the resource was loaded successfully
+		//	If the load is in progress up the stack of the current thread (it executes other jobs while waiting inside the load), then it returns false without waiting
+		static bool WaitForLoad(ResourceInternal* resource)
+		{
+			if (resource->load_state.load() == ResourceInternal::LoadState::LOADING)
 			{
-				if (resource->filedata.empty())
-				{
-					if (!wi::helper::FileRead(resource->container_filename, resource->filedata, resource->container_filesize, resource->container_fileoffset))
-					{
-						resource.reset();
-						return Resource();
-					}
-				}
-				filedata = resource->filedata.data();
-				filesize = resource->filedata.size();
+				if (resource->loading_thread.load() == std::this_thread::get_id())
+					return false;
+
+				// Asynchronous loading jobs are helped on this thread, decoding is only launched after file reading:
+				wi::jobsystem::Wait(resource->load_io_ctx);
+				wi::jobsystem::Wait(resource->load_decode_ctx);
+
+				std::unique_lock<std::mutex> lck(resource->load_mutex);
+				resource->load_condition.wait(lck, [resource] { return resource->load_state.load() != ResourceInternal::LoadState::LOADING; });
 			}
+			return resource->load_state.load() == ResourceInternal::LoadState::LOADED;
+		}
 
+		// Reads the file data of an acquired resource if it was not provided
+		static bool ReadResourceFile(ResourceInternal* resource)
+		{
+			if (resource->filedata.empty())
+			{
+				return wi::helper::FileRead(resource->container_filename, resource->filedata, resource->container_filesize, resource->container_fileoffset);
+			}
+			return true;
+		}
+
+		// Creates the resource from file data after it was acquired, and signals the waiting loads
+		static bool ImportResource(
+			const std::string& name,
+			Flags flags,
+			const uint8_t* filedata,
+			size_t filesize,
+			uint64_t timestamp,
+			ResourceInternal* resource
+		)
+		{
 			flags |= resource->flags;
 
 			bool success = false;
 
+			load_depth++;
 			if (has_flag(flags, Flags::IMPORT_DELAY))
 			{
 				success = true;
 			}
 			else
 			{
-				success = LoadResourceDirectly(name, flags, filedata, filesize, resource.get());
+				success = LoadResourceDirectly(name, flags, filedata, filesize, resource);
+			}
+
+			while (true)
+			{
+				// The load is finished while holding the lock, so a full import request can't arrive after it was checked:
+				locker.lock();
+				const bool full_import = success && has_flag(flags, Flags::IMPORT_DELAY) && resource->full_import_requested;
+				resource->full_import_requested = false;
+				if (!full_import)
+				{
+					if (success)
+					{
+						resource->flags = flags;
+						resource->timestamp = timestamp;
+					}
+					FinishLoad(resource, success);
+					locker.unlock();
+					break;
+				}
+				flags &= ~Flags::IMPORT_DELAY;
+				resource->loading_flags = flags;
+				locker.unlock();
+
+				success = LoadResourceDirectly(name, flags, filedata, filesize, resource);
+			}
+			load_depth--;
+
+			return success;
+		}
+
+		Resource Load(
+			const std::string& name,
+			Flags flags,
+			const uint8_t* filedata,
+			size_t filesize,
+			const std::string& container_filename,
+			size_t container_fileoffset
+		)
+		{
+			std::shared_ptr<ResourceInternal> resource;
+			uint64_t timestamp = 0;
+			AcquireResult result = AcquireResource(name, flags, filedata, filesize, container_filename, container_fileoffset, resource, timestamp);
+			while (result == AcquireResult::IN_FLIGHT)
+			{
+				if (load_depth > 0)
+				{
+					// This thread is inside an other load, waiting here could deadlock:
+					//	the load in flight can be up the stack of this thread (a job that loads the same resource was picked up
+					//	while the loading thread waits for the block compression jobs), or it can be waiting for this thread
+					//	So the resource is loaded separately, without sharing it
+					resource = std::make_shared<ResourceInternal>();
+					InitResource(name, flags, filedata, filesize, container_filename, container_fileoffset, timestamp, timestamp_timer.elapsed_seconds(), resource.get());
+					result = AcquireResult::LOAD;
+					break;
+				}
+				if (!WaitForLoad(resource.get()))
+					return Resource();
+				// The finished load could have been an IMPORT_DELAY load, so acquire again:
+				result = AcquireResource(name, flags, filedata, filesize, container_filename, container_fileoffset, resource, timestamp);
 			}
 
-			if (success)
+			if (result == AcquireResult::LOAD)
 			{
-				resource->flags = flags;
-				resource->timestamp = timestamp;
+				if (filedata == nullptr || filesize == 0)
+				{
+					if (!ReadResourceFile(resource.get()))
+					{
+						FinishLoad(resource.get(), false);
+						return Resource();
+					}
+					filedata = resource->filedata.data();
+					filesize = resource->filedata.size();
+				}
 
-				Resource retVal;
-				retVal.internal_state = resource;
-				return retVal;
+				if (!ImportResource(name, flags, filedata, filesize, timestamp, resource.get()))
+					return Resource();
 			}
 
-			return Resource();
+			Resource retVal;
+			retVal.internal_state = resource;
+			return retVal;
+		}
+
+		Resource LoadAsync(
+			const std::string& name,
+			Flags flags,
+			wi::jobsystem::Priority priority
+		)
+		{
+			std::shared_ptr<ResourceInternal> resource;
+			uint64_t timestamp = 0;
+			AcquireResult result = AcquireResource(name, flags, nullptr, ~0ull, "", 0, resource, timestamp);
+
+			if (result == AcquireResult::LOAD)
+			{
+				// The file is read on the streaming thread, so disk access doesn't occupy the decoding threads:
+				resource->load_io_ctx.priority = wi::jobsystem::Priority::Streaming;
+				resource->load_decode_ctx.priority = priority;
+				resource->loading_thread.store(std::thread::id()); // the caller is not loading it, the decoding job will be
+				wi::jobsystem::Execute(resource->load_io_ctx, [name, flags, timestamp, resource](wi::jobsystem::JobArgs args) {
+					if (!ReadResourceFile(resource.get()))
+					{
+						wi::backlog::post("[resourcemanager] LoadAsync failed to read file: " + name, wi::backlog::LogLevel::Error);
+						FinishLoad(resource.get(), false);
+						return;
+					}
+					wi::jobsystem::Execute(resource->load_decode_ctx, [name, flags, timestamp, resource](wi::jobsystem::JobArgs args) {
+						resource->loading_thread.store(std::this_thread::get_id());
+						ImportResource(name, flags, resource->filedata.data(), resource->filedata.size(), timestamp, resource.get());
+					});
+				});
+			}
+
+			Resource retVal;
+			retVal.internal_state = resource;
+			return retVal;
+		}
+
+		bool IsLoading(const Resource& resource)
+		{
+			const ResourceInternal* resourceinternal = (const ResourceInternal*)resource.internal_state.get();
+			return resourceinternal != nullptr && resourceinternal->load_state.load() == ResourceInternal::LoadState::LOADING;
+		}
+
+		bool Wait(const Resource& resource)
+		{
+			ResourceInternal* resourceinternal = (ResourceInternal*)resource.internal_state.get();
+			return resourceinternal != nullptr && WaitForLoad(resourceinternal);
 		}
 
 		bool Contains(const std::string& name)
@@ -1051,6 +1305,35 @@ namespace wi
 			return streaming_threshold;
 		}
 
+		void SetSoundStreamingThreshold(float seconds)
+		{
+			sound_streaming_threshold.store(seconds);
+		}
+
+		float GetSoundStreamingThreshold()
+		{
+			return sound_streaming_threshold.load();
+		}
+
+		void SetTimestampCheckInterval(float seconds)
+		{
+			timestamp_check_interval.store(seconds);
+		}
+
+		float GetTimestampCheckInterval()
+		{
+			return (float)timestamp_check_interval.load();
+		}
+
+		void SetTextureCookingEnabled(bool value)
+		{
+			texture_cooking.store(value);
+		}
+		bool IsTextureCookingEnabled()
+		{
+			return texture_cooking.load();
+		}
+
 		void UpdateStreamingResources(float dt)
 		{
 			// If any streaming replacement requests arrived, replace the resources here (main thread):
@@ -1071,7 +1354,7 @@ namespace wi
 			{
 				std::weak_ptr<ResourceInternal>& weak_resource = x.second;
 				std::shared_ptr<ResourceInternal> resource = weak_resource.lock();
-				if (resource != nullptr && resource->texture.IsValid() && has_flag(resource->flags, Flags::STREAMING))
+				if (resource != nullptr && resource->load_state.load() == ResourceInternal::LoadState::LOADED && resource->texture.IsValid() && has_flag(resource->flags, Flags::STREAMING))
 				{
 					const TextureDesc& desc = resource->texture.desc;
 					const float mip_offset = float(resource->streaming_texture.mip_count - desc.mip_levels);
@@ -1128,7 +1411,7 @@ namespace wi
 			{
 				std::weak_ptr<ResourceInternal>& weak_resource = x.second;
 				std::shared_ptr<ResourceInternal> resource = weak_resource.lock();
-				if (resource != nullptr && resource->texture.IsValid() && resource->streaming_texture.mip_count > 1)
+				if (resource != nullptr && resource->load_state.load() == ResourceInternal::LoadState::LOADED && resource->texture.IsValid() && resource->streaming_texture.mip_count > 1)
 				{
 					streaming_texture_jobs.push_back(resource);
 				}
@@ -1261,7 +1544,7 @@ namespace wi
 			{
 				const std::string& name = x.first;
 				auto resourceinternal = x.second.lock();
-				if (resourceinternal == nullptr)
+				if (resourceinternal == nullptr || resourceinternal->load_state.load() != ResourceInternal::LoadState::LOADED)
 					continue;
 
 				uint64_t timestamp = wi::helper::FileTimestamp(resourceinternal->filename);
@@ -1278,7 +1561,7 @@ namespace wi
 			for (auto& x : resources)
 			{
 				auto resourceinternal = x.second.lock();
-				if (resourceinternal == nullptr)
+				if (resourceinternal == nullptr || resourceinternal->load_state.load() != ResourceInternal::LoadState::LOADED)
 					continue;
 
 				uint64_t timestamp = wi::helper::FileTimestamp(resourceinternal->filename);
@@ -79,6 +79,7 @@ namespace wi
 		};
 
 		// Load a resource
+		//	If the same resource is already being loaded on an other thread, this waits for that load instead of loading it again
 		//	name : file name of resource
 		//	flags : specify flags that modify behaviour (optional)
 		//	filedata : pointer to file data, if file was loaded manually (optional)
@@ -93,6 +94,24 @@ namespace wi
 			const std::string& container_filename = "",
 			size_t container_fileoffset = 0
 		);
+		// Load a resource asynchronously
+		//	The file is read on the streaming thread, then it is decoded with the specified job priority
+		//	The returned resource can't be used until IsLoading() returns false, or Wait() returns true
+		//	Loads of the same resource that are requested while it is in flight will not load it again, but wait for the same load
+		//	name : file name of resource
+		//	flags : specify flags that modify behaviour (optional)
+		//	priority : job priority of decoding and creating the resource (optional)
+		Resource LoadAsync(
+			const std::string& name,
+			Flags flags = Flags::NONE,
+			wi::jobsystem::Priority priority = wi::jobsystem::Priority::Low
+		);
+		// Check if a resource is still being loaded
+		bool IsLoading(const Resource& resource);
+		// Wait until the resource is loaded, returns true if it was loaded successfully
+		//	The current thread helps executing the loading jobs while waiting
+		//	Returns false without waiting if the resource is being loaded up the stack of the current thread (from a job that was picked up by the loading thread)
+		bool Wait(const Resource& resource);
 		// Check if a resource is currently loaded
 		bool Contains(const std::string& name);
 		// Invalidate all resources
@@ -104,6 +123,21 @@ namespace wi
 		void SetStreamingMemoryThreshold(float value);
 		float GetStreamingMemoryThreshold();
 
+		// Sounds that are longer than this duration in seconds will be streamed while playing instead of decoding them when loading (default: 30)
+		//	Sounds loaded with the Flags::STREAMING flag are always streamed if their format supports it
+		void SetSoundStreamingThreshold(float seconds);
+		float GetSoundStreamingThreshold();
+
+		// Load() checks if the file was modified at most once during this interval in seconds for each resource (default: 1)
+		//	CheckResourcesOutdated() and ReloadOutdatedResources() always check the files
+		void SetTimestampCheckInterval(float seconds);
+		float GetTimestampCheckInterval();
+
+		// Images loaded with Flags::IMPORT_BLOCK_COMPRESSED are cooked on the CPU with wi::texturecooker and cached as DDS files (default: true)
+		//	Later loads use the cached DDS file instead of decoding the image and compressing it on the GPU
+		void SetTextureCookingEnabled(bool value);
+		bool IsTextureCookingEnabled();
+
 		// Update all streaming resources, call it once per frame on the main thread
 		//	Launching or finalizing background streaming jobs is attempted here
 		void UpdateStreamingResources(float dt);
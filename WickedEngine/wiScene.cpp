@@ -38,6 +38,9 @@ namespace wi::scene
 		this->dt = dt;
 		time += dt;
 
+		// Components marked as changed from this point will be reported with a new version:
+		wi::ecs::AdvanceChangeVersion();
+
 		wi::jobsystem::context ctx;
 
 		UpdateHumanoidFacings();
@@ -373,6 +376,8 @@ namespace wi::scene
 
 		WaitBuildTopDownHierarchy();
 
+		RunMeshMaterialUpdateSystem(ctx);
+
 		RunProceduralAnimationUpdateSystem(ctx);
 
 		wi::physics::OverrideWehicleWheelTransforms(*this);
@@ -383,6 +388,26 @@ namespace wi::scene
 
 		wi::jobsystem::Wait(ctx); // dependencies
 
+		// Skinning matrices are final now, skinned mesh caches will be recomputed when they are queried next time:
+		skinning_version++;
+		if (!skinned_mesh_caches.empty())
+		{
+			std::scoped_lock lck(skinned_mesh_caches_locker);
+			for (auto it = skinned_mesh_caches.begin(); it != skinned_mesh_caches.end();)
+			{
+				// Caches of removed meshes and meshes that were not queried for a while are freed:
+				const uint64_t version = it->second->version.load(std::memory_order_relaxed);
+				if (!meshes.Contains(it->first) || version == ~0ull || version + 60 < skinning_version)
+				{
+					it = skinned_mesh_caches.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+		}
+
 		RunObjectUpdateSystem(ctx);
 
 		RunCameraUpdateSystem(ctx);
@@ -973,6 +998,7 @@ namespace wi::scene
 		TLAS = RaytracingAccelerationStructure();
 		BVH.Clear();
 		waterRipples.clear();
+		skinned_mesh_caches.clear();
 
 		surfelgi = {};
 		ddgi = {};
@@ -1108,6 +1134,16 @@ namespace wi::scene
 	{
 		wi::Timer timer;
 
+		const wi::vector<Entity> roots = InstantiateBatch(prefab, { wi::math::IDENTITY_MATRIX }, attached);
+
+		wilog("Scene::Instantiate took %.2f ms", timer.elapsed_milliseconds());
+
+		return roots.empty() ? INVALID_ENTITY : roots.front();
+	}
+	Entity Scene::InstantiateSerialized(Scene& prefab, bool attached, const XMFLOAT4X4& matrix)
+	{
+		const bool identity = std::memcmp(&matrix, &wi::math::IDENTITY_MATRIX, sizeof(matrix)) == 0;
+
 		// Duplicate prefab into tmp scene
 		//	Note: we directly use componentLibrary.Serialize instead of serializing whole scene
 		//	Because prefab scene's resources are already in memory, and we don't need to handle them
@@ -1137,7 +1173,12 @@ namespace wi::scene
 		{
 			// Create root entity
 			rootEntity = CreateEntity();
-			tmp.transforms.Create(rootEntity);
+			TransformComponent& root_transform = tmp.transforms.Create(rootEntity);
+			if (!identity)
+			{
+				root_transform.MatrixTransform(matrix);
+				root_transform.UpdateTransform();
+			}
 			tmp.layers.Create(rootEntity).layerMask = ~0;
 
 			// Parent all unparented transforms to new root entity
@@ -1152,15 +1193,346 @@ namespace wi::scene
 
 			tmp.RunHierarchyUpdateSystem(seri.ctx);
 		}
+		else if (!identity)
+		{
+			wi::jobsystem::Wait(seri.ctx);
+
+			// Transform all unparented transforms
+			for (size_t i = 0; i < tmp.transforms.GetCount(); ++i)
+			{
+				if (!tmp.hierarchy.Contains(tmp.transforms.GetEntity(i)))
+				{
+					tmp.transforms[i].MatrixTransform(matrix);
+				}
+			}
+
+			tmp.RunHierarchyUpdateSystem(seri.ctx);
+		}
 
 		wi::jobsystem::Wait(seri.ctx); // wait for completion of component serializations background threads here
 
 		Merge(tmp);
 
-		wilog("Scene::Instantiate took %.2f ms", timer.elapsed_milliseconds());
-
 		return rootEntity;
 	}
+	wi::vector<Entity> Scene::InstantiateBatch(Scene& prefab, const wi::vector<XMFLOAT4X4>& matrices, bool attached)
+	{
+		wi::vector<Entity> roots;
+		if (matrices.empty())
+			return roots;
+
+		// The clone table of the prefab is only rebuilt when its component managers changed structurally:
+		prefab.locker.lock();
+		const uint64_t structure_hash = prefab.GetStructureHash();
+		if (prefab.prefab_clone_table == nullptr || prefab.prefab_clone_table->structure_hash != structure_hash)
+		{
+			wi::unordered_set<Entity> all_entities;
+			prefab.FindAllEntities(all_entities);
+			wi::vector<Entity> entities(all_entities.begin(), all_entities.end());
+			std::sort(entities.begin(), entities.end());
+			auto rebuilt = std::make_shared<CloneTable>();
+			prefab.BuildCloneTable(*rebuilt, entities);
+			prefab.prefab_clone_table = std::move(rebuilt);
+		}
+		const std::shared_ptr<const CloneTable> table_snapshot = prefab.prefab_clone_table;
+		prefab.locker.unlock();
+		const CloneTable& table = *table_snapshot;
+
+		if (!table.cloneable)
+		{
+			for (const XMFLOAT4X4& matrix : matrices)
+			{
+				Entity root = InstantiateSerialized(prefab, attached, matrix);
+				if (attached)
+				{
+					roots.push_back(root);
+				}
+			}
+			return roots;
+		}
+
+		const uint32_t copies = (uint32_t)matrices.size();
+		const size_t entity_count = table.entities.size();
+		wi::vector<Entity> new_entities;
+		CloneEntities(prefab, table, copies, true, new_entities);
+
+		for (uint32_t copy = 0; copy < copies; ++copy)
+		{
+			const XMFLOAT4X4& matrix = matrices[copy];
+			const bool identity = std::memcmp(&matrix, &wi::math::IDENTITY_MATRIX, sizeof(matrix)) == 0;
+			if (attached)
+			{
+				Entity root = CreateEntity();
+				roots.push_back(root);
+				TransformComponent& root_transform = transforms.Create(root);
+				if (!identity)
+				{
+					root_transform.MatrixTransform(matrix);
+				}
+				root_transform.UpdateTransform();
+				layers.Create(root).layerMask = ~0;
+
+				for (uint32_t slot : table.root_slots)
+				{
+					hierarchy.Create(new_entities[copy * entity_count + slot]).parentID = root;
+				}
+			}
+			else if (!identity)
+			{
+				for (uint32_t slot : table.root_slots)
+				{
+					transforms.GetComponent(new_entities[copy * entity_count + slot])->MatrixTransform(matrix);
+				}
+			}
+		}
+
+		// World matrices of the copies are computed right away, in the same way as the hierarchy update system:
+		wi::jobsystem::context ctx;
+		wi::jobsystem::Dispatch(ctx, (uint32_t)new_entities.size(), small_subtask_groupsize, [&](wi::jobsystem::JobArgs args) {
+			Entity entity = new_entities[args.jobIndex];
+			TransformComponent* transform = transforms.GetComponent(entity);
+			if (transform == nullptr)
+				return;
+			XMMATRIX W = transform->GetLocalMatrix();
+			const HierarchyComponent* hier = hierarchy.GetComponent(entity);
+			while (hier != nullptr)
+			{
+				const TransformComponent* transform_parent = transforms.GetComponent(hier->parentID);
+				if (transform_parent != nullptr)
+				{
+					W *= transform_parent->GetLocalMatrix();
+				}
+				hier = hierarchy.GetComponent(hier->parentID);
+			}
+			XMStoreFloat4x4(&transform->world, W);
+		});
+		wi::jobsystem::Wait(ctx);
+
+		return roots;
+	}
+	uint64_t Scene::GetStructureHash() const
+	{
+		size_t hash = 0;
+		for (auto& entry : componentLibrary.entries)
+		{
+			wi::helper::hash_combine(hash, entry.second.component_manager->GetStructureVersion());
+		}
+		return (uint64_t)hash;
+	}
+	void Scene::BuildCloneTable(CloneTable& table, const wi::vector<Entity>& entities) const
+	{
+		table.entities = entities;
+		table.entity_slots.clear();
+		table.entity_slots.reserve(entities.size());
+		for (size_t i = 0; i < entities.size(); ++i)
+		{
+			table.entity_slots[entities[i]] = (uint32_t)i;
+		}
+
+		// The order must match CloneEntities():
+		const ComponentManager_Interface* managers[CloneTable::MANAGER_COUNT] = {
+			&names,
+			&layers,
+			&transforms,
+			&hierarchy,
+			&materials,
+			&meshes,
+			&objects,
+			&rigidbodies,
+			&lights,
+			&forces,
+			&decals,
+			&colliders,
+			&metadatas,
+		};
+		for (uint32_t i = 0; i < CloneTable::MANAGER_COUNT; ++i)
+		{
+			const ComponentManager_Interface& manager = *managers[i];
+			wi::vector<CloneTable::Source>& sources = table.sources[i];
+			sources.clear();
+			if (manager.GetCount() <= entities.size())
+			{
+				for (size_t j = 0; j < manager.GetCount(); ++j)
+				{
+					auto it = table.entity_slots.find(manager.GetEntity(j));
+					if (it != table.entity_slots.end())
+					{
+						sources.push_back({ (uint32_t)j, it->second });
+					}
+				}
+			}
+			else
+			{
+				for (size_t j = 0; j < entities.size(); ++j)
+				{
+					const size_t index = manager.GetIndex(entities[j]);
+					if (index != ~0ull)
+					{
+						sources.push_back({ (uint32_t)index, (uint32_t)j });
+					}
+				}
+			}
+		}
+
+		// Any other component type prevents direct copy:
+		table.cloneable = true;
+		for (auto& entry : componentLibrary.entries)
+		{
+			const ComponentManager_Interface* manager = entry.second.component_manager.get();
+			if (std::find(std::begin(managers), std::end(managers), manager) != std::end(managers))
+				continue;
+			if (manager->GetCount() == 0)
+				continue;
+			for (Entity entity : entities)
+			{
+				if (manager->Contains(entity))
+				{
+					table.cloneable = false;
+					break;
+				}
+			}
+			if (!table.cloneable)
+				break;
+		}
+
+		table.root_slots.clear();
+		for (size_t i = 0; i < entities.size(); ++i)
+		{
+			if (!transforms.Contains(entities[i]))
+				continue;
+			const HierarchyComponent* hier = hierarchy.GetComponent(entities[i]);
+			if (hier == nullptr || table.entity_slots.count(hier->parentID) == 0)
+			{
+				table.root_slots.push_back((uint32_t)i);
+			}
+		}
+
+		table.structure_hash = GetStructureHash();
+	}
+	// Appends copies of the source components to the destination manager, src and dst can be the same manager
+	template<typename T, typename Fixup>
+	static void CloneComponents(const ComponentManager<T>& src, ComponentManager<T>& dst, const wi::vector<Scene::CloneTable::Source>& sources, uint32_t copies, const wi::vector<Entity>& new_entities, Fixup fixup)
+	{
+		if (sources.empty())
+			return;
+		const size_t entity_count = new_entities.size() / copies;
+		dst.Reserve(dst.GetCount() + sources.size() * copies); // no reallocation below, so the source can't be invalidated when src == dst
+		for (uint32_t copy = 0; copy < copies; ++copy)
+		{
+			for (const Scene::CloneTable::Source& source : sources)
+			{
+				T& component = dst.Create(new_entities[copy * entity_count + source.entity_slot]);
+				component = src[source.component_index];
+				fixup(component, copy);
+			}
+		}
+	}
+	void Scene::CloneEntities(const Scene& src, const CloneTable& table, uint32_t copies, bool remap_references, wi::vector<Entity>& new_entities)
+	{
+		const size_t entity_count = table.entities.size();
+		new_entities.resize(entity_count * copies);
+		for (Entity& entity : new_entities)
+		{
+			entity = CreateEntity();
+		}
+
+		auto remap = [&](Entity& entity, uint32_t copy) {
+			if (entity == INVALID_ENTITY)
+				return;
+			auto it = table.entity_slots.find(entity);
+			if (it != table.entity_slots.end())
+			{
+				entity = new_entities[copy * entity_count + it->second];
+			}
+		};
+		auto remap_reference = [&](Entity& entity, uint32_t copy) {
+			if (remap_references)
+			{
+				remap(entity, copy);
+			}
+		};
+		auto no_fixup = [](auto& component, uint32_t copy) {};
+
+		// Every component manager is copied on a separate thread, the order of sources must match BuildCloneTable():
+		wi::jobsystem::context ctx;
+		wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
+			CloneComponents(src.names, names, table.sources[0], copies, new_entities, no_fixup);
+		});
+		wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
+			CloneComponents(src.layers, layers, table.sources[1], copies, new_entities, no_fixup);
+		});
+		wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
+			CloneComponents(src.transforms, transforms, table.sources[2], copies, new_entities, no_fixup);
+		});
+		wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
+			CloneComponents(src.hierarchy, hierarchy, table.sources[3], copies, new_entities, [&](HierarchyComponent& hier, uint32_t copy) {
+				remap(hier.parentID, copy);
+			});
+		});
+		wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
+			CloneComponents(src.materials, materials, table.sources[4], copies, new_entities, [&](MaterialComponent& material, uint32_t copy) {
+				remap_reference(material.cameraSource, copy);
+			});
+		});
+		wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
+			CloneComponents(src.meshes, meshes, table.sources[5], copies, new_entities, [&](MeshComponent& mesh, uint32_t copy) {
+				for (MeshComponent::MeshSubset& subset : mesh.subsets)
+				{
+					remap_reference(subset.materialID, copy);
+				}
+				remap_reference(mesh.armatureID, copy);
+				if (mesh.IsSkinned() || !mesh.morph_targets.empty() || mesh.IsDynamic())
+				{
+					// Vertex data that is modified per mesh needs separate GPU buffers, static GPU data is shared with the source
+					mesh.CreateRenderData();
+				}
+				else
+				{
+					// Acceleration structures are built per mesh by the renderer, so they can't be shared
+					mesh.BLASes.clear();
+					mesh.BLAS_state = MeshComponent::BLAS_STATE_NEEDS_REBUILD;
+				}
+			});
+		});
+		wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
+			CloneComponents(src.objects, objects, table.sources[6], copies, new_entities, [&](ObjectComponent& object, uint32_t copy) {
+				remap_reference(object.meshID, copy);
+				object.wetmap = {};
+				object.lightmap_render = {};
+				if (object.IsLightmapRenderRequested())
+				{
+					object.lightmap = {}; // the lightmap will be rendered separately for the copy
+				}
+			});
+		});
+		wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
+			CloneComponents(src.rigidbodies, rigidbodies, table.sources[7], copies, new_entities, [&](RigidBodyPhysicsComponent& rigidbody, uint32_t copy) {
+				rigidbody.physicsobject = nullptr;
+				remap_reference(rigidbody.vehicle.wheel_entity_front_left, copy);
+				remap_reference(rigidbody.vehicle.wheel_entity_front_right, copy);
+				remap_reference(rigidbody.vehicle.wheel_entity_rear_left, copy);
+				remap_reference(rigidbody.vehicle.wheel_entity_rear_right, copy);
+			});
+		});
+		wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
+			CloneComponents(src.lights, lights, table.sources[8], copies, new_entities, [&](LightComponent& light, uint32_t copy) {
+				remap_reference(light.cameraSource, copy);
+			});
+		});
+		wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
+			CloneComponents(src.forces, forces, table.sources[9], copies, new_entities, no_fixup);
+		});
+		wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
+			CloneComponents(src.decals, decals, table.sources[10], copies, new_entities, no_fixup);
+		});
+		wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
+			CloneComponents(src.colliders, colliders, table.sources[11], copies, new_entities, no_fixup);
+		});
+		wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
+			CloneComponents(src.metadatas, metadatas, table.sources[12], copies, new_entities, no_fixup);
+		});
+		wi::jobsystem::Wait(ctx);
+	}
 	void Scene::FindAllEntities(wi::unordered_set<wi::ecs::Entity>& entities) const
 	{
 		for (auto& entry : componentLibrary.entries)
@@ -1171,57 +1543,269 @@ namespace wi::scene
 
 	void Scene::Entity_Remove(Entity entity, bool recursive, bool keep_sorted)
 	{
+		Entity_RemoveBatch({ entity }, recursive, keep_sorted);
+	}
+	void Scene::Entity_RemoveBatch(const wi::vector<Entity>& entities, bool recursive, bool keep_sorted)
+	{
+		wi::unordered_set<Entity> visited;
+		wi::vector<Entity> entities_to_remove;
+		entities_to_remove.reserve(entities.size());
+		for (Entity entity : entities)
+		{
+			if (entity != INVALID_ENTITY && visited.insert(entity).second)
+			{
+				entities_to_remove.push_back(entity);
+			}
+		}
+		if (entities_to_remove.empty())
+			return;
+
 		if (recursive)
 		{
-			wi::vector<Entity> entities_to_remove;
-			for (size_t i = 0; i < hierarchy.GetCount(); ++i)
+			// The parents of the removed roots will need to forget them:
+			wi::vector<Entity> root_parents;
+			for (Entity entity : entities_to_remove)
 			{
-				const HierarchyComponent& hier = hierarchy[i];
-				if (hier.parentID == entity)
+				const HierarchyComponent* hier = hierarchy.GetComponent(entity);
+				if (hier != nullptr)
 				{
-					Entity child = hierarchy.GetEntity(i);
-					entities_to_remove.push_back(child);
+					root_parents.push_back(hier->parentID);
 				}
 			}
-			for (auto& child : entities_to_remove)
+
+			GatherDescendants(entities_to_remove, visited);
+
+			for (Entity parent : root_parents)
 			{
-				Entity_Remove(child);
+				auto it = topdown_hierarchy.find(parent);
+				if (it != topdown_hierarchy.end())
+				{
+					wi::vector<Entity>& children = it->second;
+					children.erase(std::remove_if(children.begin(), children.end(), [&](Entity child) { return visited.count(child) > 0; }), children.end());
+				}
 			}
 		}
 
+		wi::vector<ComponentManager_Interface*> component_managers;
+		component_managers.reserve(componentLibrary.entries.size());
 		for (auto& entry : componentLibrary.entries)
 		{
-			if (keep_sorted)
+			component_managers.push_back(entry.second.component_manager.get());
+		}
+
+		if (entities_to_remove.size() < 64)
+		{
+			for (ComponentManager_Interface* component_manager : component_managers)
+			{
+				component_manager->Remove_Batch(entities_to_remove, keep_sorted);
+			}
+		}
+		else
+		{
+			// Component managers are independent, so they can be processed in parallel:
+			wi::jobsystem::context ctx;
+			wi::jobsystem::Dispatch(ctx, (uint32_t)component_managers.size(), 1, [&](wi::jobsystem::JobArgs args) {
+				component_managers[args.jobIndex]->Remove_Batch(entities_to_remove, keep_sorted);
+			});
+			wi::jobsystem::Wait(ctx);
+		}
+
+		for (Entity entity : entities_to_remove)
+		{
+			topdown_hierarchy.erase(entity);
+		}
+		if (recursive)
+		{
+			// The top-down hierarchy was kept up to date with the removal:
+			topdown_hierarchy_version = hierarchy.GetStructureVersion();
+		}
+	}
+	// Matches str to a pattern where '*' matches any sequence of characters and '?' matches one character
+	static bool name_pattern_match(const char* str, const char* pattern)
+	{
+		const char* star = nullptr;
+		const char* retry = nullptr;
+		while (*str)
+		{
+			if (*pattern == '*')
+			{
+				star = pattern++;
+				retry = str;
+			}
+			else if (*pattern == '?' || *pattern == *str)
+			{
+				str++;
+				pattern++;
+			}
+			else if (star != nullptr)
 			{
-				entry.second.component_manager->Remove_KeepSorted(entity);
+				// backtrack: the last star consumes one more character
+				pattern = star + 1;
+				str = ++retry;
 			}
 			else
 			{
-				entry.second.component_manager->Remove(entity);
+				return false;
 			}
-
-			if (topdown_hierarchy.count(entity))
+		}
+		while (*pattern == '*')
+		{
+			pattern++;
+		}
+		return *pattern == 0;
+	}
+	void Scene::UpdateNameIndex(bool sorted)
+	{
+		if (name_index.structure_version != names.GetStructureVersion())
+		{
+			name_index.structure_version = names.GetStructureVersion();
+			name_index.sorted_valid = false;
+			name_index.buckets.clear();
+			std::hash<std::string> hasher;
+			for (size_t i = 0; i < names.GetCount(); ++i)
+			{
+				name_index.buckets[hasher(names[i].name)].push_back(uint32_t(i));
+			}
+		}
+		if (sorted && !name_index.sorted_valid)
+		{
+			name_index.sorted_valid = true;
+			name_index.sorted.resize(names.GetCount());
+			for (size_t i = 0; i < name_index.sorted.size(); ++i)
 			{
-				topdown_hierarchy.erase(entity);
+				name_index.sorted[i] = uint32_t(i);
 			}
+			std::sort(name_index.sorted.begin(), name_index.sorted.end(), [&](uint32_t a, uint32_t b) {
+				return names[a].name < names[b].name;
+			});
 		}
 	}
 	Entity Scene::Entity_FindByName(const std::string& name, Entity ancestor)
 	{
-		for (size_t i = 0; i < names.GetCount(); ++i)
+		std::scoped_lock lck(name_index.locker);
+		UpdateNameIndex();
+		auto it = name_index.buckets.find(std::hash<std::string>()(name));
+		if (it == name_index.buckets.end())
+			return INVALID_ENTITY;
+		for (uint32_t index : it->second)
+		{
+			if (!(names[index] == name))
+				continue; // hash collision
+			Entity entity = names.GetEntity(index);
+			if (ancestor != INVALID_ENTITY && !Entity_IsDescendant(entity, ancestor))
+				continue;
+			return entity;
+		}
+		return INVALID_ENTITY;
+	}
+	void Scene::Entity_FindAllByName(const std::string& name, wi::vector<Entity>& entities, Entity ancestor)
+	{
+		std::scoped_lock lck(name_index.locker);
+		UpdateNameIndex();
+		auto it = name_index.buckets.find(std::hash<std::string>()(name));
+		if (it == name_index.buckets.end())
+			return;
+		for (uint32_t index : it->second)
+		{
+			if (!(names[index] == name))
+				continue; // hash collision
+			Entity entity = names.GetEntity(index);
+			if (ancestor != INVALID_ENTITY && !Entity_IsDescendant(entity, ancestor))
+				continue;
+			entities.push_back(entity);
+		}
+	}
+	void Scene::Entity_FindByNamePrefix(const std::string& prefix, wi::vector<Entity>& entities, Entity ancestor)
+	{
+		Entity_FindByNamePattern(prefix + "*", entities, ancestor);
+	}
+	void Scene::Entity_FindByNamePattern(const std::string& pattern, wi::vector<Entity>& entities, Entity ancestor)
+	{
+		const size_t wildcard = pattern.find_first_of("*?");
+		if (wildcard == std::string::npos)
+		{
+			Entity_FindAllByName(pattern, entities, ancestor);
+			return;
+		}
+
+		std::scoped_lock lck(name_index.locker);
+		UpdateNameIndex(true);
+
+		// The names that can match are in the sorted range that starts with the literal part before the first wildcard:
+		const char* prefix = pattern.c_str();
+		auto it = std::lower_bound(name_index.sorted.begin(), name_index.sorted.end(), wildcard, [&](uint32_t index, size_t length) {
+			return names[index].name.compare(0, length, prefix, length) < 0;
+		});
+		for (; it != name_index.sorted.end(); ++it)
 		{
-			if (names[i] == name)
+			const std::string& name = names[*it].name;
+			if (name.compare(0, wildcard, prefix, wildcard) != 0)
+				break;
+			if (!name_pattern_match(name.c_str() + wildcard, prefix + wildcard))
+				continue;
+			Entity entity = names.GetEntity(*it);
+			if (ancestor != INVALID_ENTITY && !Entity_IsDescendant(entity, ancestor))
+				continue;
+			entities.push_back(entity);
+		}
+	}
+	void Scene::Entity_SetName(Entity entity, const std::string& name)
+	{
+		std::scoped_lock lck(name_index.locker);
+		const bool index_valid = name_index.structure_version == names.GetStructureVersion();
+		std::hash<std::string> hasher;
+
+		size_t index = names.GetIndex(entity);
+		if (index == ~0ull)
+		{
+			index = names.GetCount();
+			names.Create(entity).name = name;
+		}
+		else
+		{
+			NameComponent& component = names[index];
+			if (component == name)
+				return;
+			if (index_valid)
 			{
-				Entity entity = names.GetEntity(i);
-				if (ancestor != INVALID_ENTITY && !Entity_IsDescendant(entity, ancestor))
-					continue;
-				return entity;
+				auto it = name_index.buckets.find(hasher(component.name));
+				if (it != name_index.buckets.end())
+				{
+					wi::vector<uint32_t>& bucket = it->second;
+					bucket.erase(std::find(bucket.begin(), bucket.end(), uint32_t(index)));
+					if (bucket.empty())
+					{
+						name_index.buckets.erase(it);
+					}
+				}
 			}
+			component.name = name;
+		}
+
+		if (index_valid)
+		{
+			wi::vector<uint32_t>& bucket = name_index.buckets[hasher(name)];
+			bucket.insert(std::upper_bound(bucket.begin(), bucket.end(), uint32_t(index)), uint32_t(index));
+			name_index.structure_version = names.GetStructureVersion(); // the Create() above only appended to names
+			name_index.sorted_valid = false;
 		}
-		return INVALID_ENTITY;
 	}
 	Entity Scene::Entity_Duplicate(Entity entity)
 	{
+		wi::vector<Entity> entities = { entity };
+		wi::unordered_set<Entity> visited = { entity };
+		GatherDescendants(entities, visited);
+
+		// Direct copy of the components if possible, entity references are kept like in the serialized path below:
+		CloneTable table;
+		BuildCloneTable(table, entities);
+		if (table.cloneable)
+		{
+			wi::vector<Entity> new_entities;
+			CloneEntities(*this, table, 1, false, new_entities);
+			return new_entities.front();
+		}
+
 		wi::Archive archive;
 		EntitySerializer seri;
 
@@ -1252,7 +1836,7 @@ namespace wi::scene
 	{
 		Entity entity = CreateEntity();
 
-		names.Create(entity) = name;
+		Entity_SetName(entity, name);
 
 		transforms.Create(entity);
 
@@ -1264,7 +1848,7 @@ namespace wi::scene
 	{
 		Entity entity = CreateEntity();
 
-		names.Create(entity) = name;
+		Entity_SetName(entity, name);
 
 		materials.Create(entity);
 
@@ -1276,7 +1860,7 @@ namespace wi::scene
 	{
 		Entity entity = CreateEntity();
 
-		names.Create(entity) = name;
+		Entity_SetName(entity, name);
 
 		layers.Create(entity);
 
@@ -1292,7 +1876,7 @@ namespace wi::scene
 	{
 		Entity entity = CreateEntity();
 
-		names.Create(entity) = name;
+		Entity_SetName(entity, name);
 
 		meshes.Create(entity);
 
@@ -1310,7 +1894,7 @@ namespace wi::scene
 	{
 		Entity entity = CreateEntity();
 
-		names.Create(entity) = name;
+		Entity_SetName(entity, name);
 
 		layers.Create(entity);
 
@@ -1335,7 +1919,7 @@ namespace wi::scene
 	{
 		Entity entity = CreateEntity();
 
-		names.Create(entity) = name;
+		Entity_SetName(entity, name);
 
 		layers.Create(entity);
 
@@ -1354,7 +1938,7 @@ namespace wi::scene
 	{
 		Entity entity = CreateEntity();
 
-		names.Create(entity) = name;
+		Entity_SetName(entity, name);
 
 		layers.Create(entity);
 
@@ -1374,7 +1958,7 @@ namespace wi::scene
 	{
 		Entity entity = CreateEntity();
 
-		names.Create(entity) = name;
+		Entity_SetName(entity, name);
 
 		layers.Create(entity);
 
@@ -1396,7 +1980,7 @@ namespace wi::scene
 	{
 		Entity entity = CreateEntity();
 
-		names.Create(entity) = name;
+		Entity_SetName(entity, name);
 
 		layers.Create(entity);
 
@@ -1414,7 +1998,7 @@ namespace wi::scene
 	{
 		Entity entity = CreateEntity();
 
-		names.Create(entity) = name;
+		Entity_SetName(entity, name);
 
 		emitters.Create(entity).count = 10;
 
@@ -1433,7 +2017,7 @@ namespace wi::scene
 	{
 		Entity entity = CreateEntity();
 
-		names.Create(entity) = name;
+		Entity_SetName(entity, name);
 
 		hairs.Create(entity);
 
@@ -1453,7 +2037,7 @@ namespace wi::scene
 	{
 		Entity entity = CreateEntity();
 
-		names.Create(entity) = name;
+		Entity_SetName(entity, name);
 
 		if (!filename.empty())
 		{
@@ -1477,7 +2061,7 @@ namespace wi::scene
 	{
 		Entity entity = CreateEntity();
 
-		names.Create(entity) = name;
+		Entity_SetName(entity, name);
 
 		if (!filename.empty())
 		{
@@ -1500,7 +2084,7 @@ namespace wi::scene
 
 		if (!name.empty())
 		{
-			names.Create(entity) = name;
+			Entity_SetName(entity, name);
 		}
 
 		layers.Create(entity);
@@ -1644,7 +2228,7 @@ namespace wi::scene
 
 		if (!name.empty())
 		{
-			names.Create(entity) = name;
+			Entity_SetName(entity, name);
 		}
 
 		layers.Create(entity);
@@ -1706,7 +2290,7 @@ namespace wi::scene
 
 		if (!name.empty())
 		{
-			names.Create(entity) = name;
+			Entity_SetName(entity, name);
 		}
 
 		layers.Create(entity);
@@ -1787,7 +2371,7 @@ namespace wi::scene
 
 		if (!name.empty())
 		{
-			names.Create(entity) = name;
+			Entity_SetName(entity, name);
 		}
 
 		layers.Create(entity);
@@ -2788,19 +3372,20 @@ namespace wi::scene
 	}
 	void Scene::RunHierarchyUpdateSystem(wi::jobsystem::context& ctx)
 	{
-		wi::jobsystem::Dispatch(ctx, (uint32_t)hierarchy.GetCount(), small_subtask_groupsize, [&](wi::jobsystem::JobArgs args) {
+		hierarchy_join.Update(hierarchy, transforms, layers);
 
-			HierarchyComponent& hier = hierarchy[args.jobIndex];
-			Entity entity = hierarchy.GetEntity(args.jobIndex);
+		wi::jobsystem::Dispatch(ctx, (uint32_t)hierarchy_join.GetCount(), small_subtask_groupsize, [&](wi::jobsystem::JobArgs args) {
 
-			TransformComponent* transform_child = transforms.GetComponent(entity);
+			HierarchyComponent& hier = hierarchy_join.GetPrimary(args.jobIndex);
+
+			TransformComponent* transform_child = hierarchy_join.GetComponent<0>(args.jobIndex);
 			XMMATRIX worldmatrix;
 			if (transform_child != nullptr)
 			{
 				worldmatrix = transform_child->GetLocalMatrix();
 			}
 
-			LayerComponent* layer_child = layers.GetComponent(entity);
+			LayerComponent* layer_child = hierarchy_join.GetComponent<1>(args.jobIndex);
 			if (layer_child != nullptr)
 			{
 				layer_child->propagationMask = ~0u; // clear propagation mask to full
@@ -2948,7 +3533,7 @@ namespace wi::scene
 				int mouth = expression_mastering.presets[(int)expression_mastering.talking_phoneme];
 				ExpressionComponent::Expression& expression = expression_mastering.expressions[mouth];
 
-				if (voice_playing)
+				if (voice_playing && !wi::audio::IsStreaming(&sound->soundResource.GetSound())) // streaming sounds don't have samples in memory
 				{
 					// Take voice sample from audio:
 					wi::audio::SampleInfo info = wi::audio::GetSampleInfo(&sound->soundResource.GetSound());
@@ -3887,6 +4472,24 @@ namespace wi::scene
 			}
 		});
 	}
+	// Sorting hints of objects, the material part is gathered per mesh LOD and the object part is added in the object update:
+	union ObjectSortBits
+	{
+		struct
+		{
+			uint32_t shadertype : 6; // max 64 shader types
+			uint32_t blendmode : 3; // max 8 blendmodes
+			uint32_t doublesided : 1;	// bool
+			uint32_t tessellation : 1;	// bool
+			uint32_t alphatest : 1;		// bool
+			uint32_t customshader : 8;
+			uint32_t sort_priority : 4;
+			uint32_t unused : 8;
+		} bits;
+		uint32_t value;
+	};
+	static_assert(sizeof(ObjectSortBits) == sizeof(uint32_t));
+
 	void Scene::RunMeshUpdateSystem(wi::jobsystem::context& ctx)
 	{
 		wi::jobsystem::Dispatch(ctx, (uint32_t)meshes.GetCount(), small_subtask_groupsize, [&](wi::jobsystem::JobArgs args) {
@@ -4080,6 +4683,48 @@ namespace wi::scene
 
 		});
 	}
+	void Scene::RunMeshMaterialUpdateSystem(wi::jobsystem::context& ctx)
+	{
+		// Material properties per LOD, these are used by every object instance of this mesh
+		//	This must run after the material update system finished, because it reads the material flags
+		wi::jobsystem::Dispatch(ctx, (uint32_t)meshes.GetCount(), small_subtask_groupsize, [&](wi::jobsystem::JobArgs args) {
+			MeshComponent& mesh = meshes[args.jobIndex];
+
+			const uint32_t lod_count = mesh.GetLODCount();
+			mesh.lod_material_infos.resize(lod_count);
+			for (uint32_t lod = 0; lod < lod_count; ++lod)
+			{
+				MeshComponent::LODMaterialInfo& info = mesh.lod_material_infos[lod];
+				info = {};
+				ObjectSortBits sort_bits = {};
+				uint32_t first_subset = 0;
+				uint32_t last_subset = 0;
+				mesh.GetLODSubsetRange(lod, first_subset, last_subset);
+				for (uint32_t subsetIndex = first_subset; subsetIndex < last_subset; ++subsetIndex)
+				{
+					const MaterialComponent* material = materials.GetComponent(mesh.subsets[subsetIndex].materialID);
+					if (material == nullptr)
+						continue;
+
+					info.filterMask |= material->GetFilterMask();
+					info.planar_reflection |= material->HasPlanarReflection();
+					info.mesh_blend |= material->GetMeshBlend() > 0;
+
+					sort_bits.bits.shadertype |= 1 << material->shaderType;
+					sort_bits.bits.blendmode |= 1 << material->GetBlendMode();
+					sort_bits.bits.doublesided |= material->IsDoubleSided();
+					sort_bits.bits.alphatest |= material->IsAlphaTestEnabled();
+
+					int customshader = material->GetCustomShaderID();
+					if (customshader >= 0)
+					{
+						sort_bits.bits.customshader |= 1 << customshader;
+					}
+				}
+				info.sort_bits = sort_bits.value;
+			}
+		});
+	}
 	void Scene::RunMaterialUpdateSystem(wi::jobsystem::context& ctx)
 	{
 		wi::jobsystem::Dispatch(ctx, (uint32_t)materials.GetCount(), small_subtask_groupsize, [&](wi::jobsystem::JobArgs args) {
@@ -4330,6 +4975,8 @@ namespace wi::scene
 
 		parallel_bounds.clear();
 		parallel_bounds.resize((size_t)wi::jobsystem::DispatchGroupCount((uint32_t)objects.GetCount(), small_subtask_groupsize));
+
+		object_join.Update(objects, transforms, layers);
 		
 		wi::jobsystem::Dispatch(ctx, (uint32_t)objects.GetCount(), small_subtask_groupsize, [&](wi::jobsystem::JobArgs args) {
 
@@ -4359,7 +5006,7 @@ namespace wi::scene
 			}
 			occlusion_result.occlusionQueries[queryheap_idx] = -1; // invalidate query
 
-			const LayerComponent* layer = layers.GetComponent(entity);
+			const LayerComponent* layer = object_join.GetComponent<1>(args.jobIndex);
 			uint32_t layerMask;
 			if (layer == nullptr)
 			{
@@ -4378,10 +5025,15 @@ namespace wi::scene
 			object.fadeDistance = object.draw_distance;
 			object.mesh_blend_required = false;
 
-			if (object.meshID != INVALID_ENTITY && meshes.Contains(object.meshID) && transforms.Contains(entity))
+			// The mesh index from the previous update is verified first, the hash lookup is only needed when it moved:
+			if (object.meshID != INVALID_ENTITY && (object.mesh_index >= meshes.GetCount() || meshes.GetEntity(object.mesh_index) != object.meshID))
+			{
+				object.mesh_index = meshes.Contains(object.meshID) ? (uint32_t)meshes.GetIndex(object.meshID) : ~0u;
+			}
+			const uint32_t transform_index = object_join.GetIndex<0>(args.jobIndex);
+
+			if (object.meshID != INVALID_ENTITY && object.mesh_index != ~0u && transform_index != object_join.INVALID_INDEX)
 			{
-				// These will only be valid for a single frame:
-				object.mesh_index = (uint32_t)meshes.GetIndex(object.meshID);
 				const MeshComponent& mesh = meshes[object.mesh_index];
 
 				if (object.IsWetmapEnabled() && !object.wetmap.IsValid())
@@ -4399,10 +5051,28 @@ namespace wi::scene
 					object.wetmap = {};
 				}
 
-				const TransformComponent& transform = *transforms.GetComponent(entity);
+				const TransformComponent& transform = transforms[transform_index];
 
 				XMMATRIX W = XMLoadFloat4x4(&transform.world);
-				aabb = mesh.aabb.transform(W);
+
+				SoftBodyPhysicsComponent* softbody = softbodies.GetCount() > 0 ? softbodies.GetComponent(object.meshID) : nullptr;
+
+				// Static object fast path: if the object didn't move and the mesh bounds didn't change, the bounds and scale are reused
+				const bool cacheable = softbody == nullptr && !mesh.IsSkinned() && !mesh.IsDynamic();
+				const bool cached =
+					cacheable &&
+					object.cached_object_index == args.jobIndex &&
+					std::memcmp(&object.cached_world, &transform.world, sizeof(transform.world)) == 0 &&
+					std::memcmp(&object.cached_mesh_aabb._min, &mesh.aabb._min, sizeof(mesh.aabb._min)) == 0 &&
+					std::memcmp(&object.cached_mesh_aabb._max, &mesh.aabb._max, sizeof(mesh.aabb._max)) == 0;
+				if (cached)
+				{
+					aabb = object.cached_aabb;
+				}
+				else
+				{
+					aabb = mesh.aabb.transform(W);
+				}
 
 				if (mesh.IsSkinned() || mesh.IsDynamic())
 				{
@@ -4414,13 +5084,12 @@ namespace wi::scene
 					}
 				}
 
-				ImpostorComponent* impostor = impostors.GetComponent(object.meshID);
+				const ImpostorComponent* impostor = impostors.GetCount() > 0 ? impostors.GetComponent(object.meshID) : nullptr;
 				if (impostor != nullptr)
 				{
 					object.fadeDistance = std::min(object.fadeDistance, impostor->swapInDistance);
 				}
 
-				SoftBodyPhysicsComponent* softbody = softbodies.GetComponent(object.meshID);
 				if (softbody != nullptr)
 				{
 					if (wi::physics::IsEnabled())
@@ -4451,23 +5120,7 @@ namespace wi::scene
 					object.lod = ComputeObjectLODForView(object, aabb, mesh, camera.GetViewProjection());
 				}
 
-				union SortBits
-				{
-					struct
-					{
-						uint32_t shadertype : 6; // max 64 shader types
-						uint32_t blendmode : 3; // max 8 blendmodes
-						uint32_t doublesided : 1;	// bool
-						uint32_t tessellation : 1;	// bool
-						uint32_t alphatest : 1;		// bool
-						uint32_t customshader : 8;
-						uint32_t sort_priority : 4;
-						uint32_t unused : 8;
-					} bits;
-					uint32_t value;
-				} sort_bits;
-				static_assert(sizeof(SortBits) == sizeof(uint32_t));
-
+				ObjectSortBits sort_bits = {};
 				sort_bits.bits.tessellation = mesh.GetTessellationFactor() > 0;
 				sort_bits.bits.doublesided = mesh.IsDoubleSided();
 				sort_bits.bits.sort_priority = object.sort_priority;
@@ -4475,36 +5128,13 @@ namespace wi::scene
 				uint32_t first_subset = 0;
 				uint32_t last_subset = 0;
 				mesh.GetLODSubsetRange(object.lod, first_subset, last_subset);
-				for (uint32_t subsetIndex = first_subset; subsetIndex < last_subset; ++subsetIndex)
+				if (!mesh.lod_material_infos.empty())
 				{
-					const MeshComponent::MeshSubset& subset = mesh.subsets[subsetIndex];
-					const MaterialComponent* material = materials.GetComponent(subset.materialID);
-
-					if (material != nullptr)
-					{
-						object.filterMaskDynamic |= material->GetFilterMask();
-
-						if (material->HasPlanarReflection())
-						{
-							object.SetRequestPlanarReflection(true);
-						}
-
-						if (material->GetMeshBlend() > 0)
-						{
-							object.mesh_blend_required = true;
-						}
-
-						sort_bits.bits.shadertype |= 1 << material->shaderType;
-						sort_bits.bits.blendmode |= 1 << material->GetBlendMode();
-						sort_bits.bits.doublesided |= material->IsDoubleSided();
-						sort_bits.bits.alphatest |= material->IsAlphaTestEnabled();
-
-						int customshader = material->GetCustomShaderID();
-						if (customshader >= 0)
-						{
-							sort_bits.bits.customshader |= 1 << customshader;
-						}
-					}
+					const MeshComponent::LODMaterialInfo& info = mesh.lod_material_infos[std::min(uint32_t(object.lod), uint32_t(mesh.lod_material_infos.size() - 1))];
+					object.filterMaskDynamic |= info.filterMask;
+					object.SetRequestPlanarReflection(info.planar_reflection);
+					object.mesh_blend_required = info.mesh_blend;
+					sort_bits.value |= info.sort_bits;
 				}
 
 				object.sort_bits = sort_bits.value;
@@ -4533,9 +5163,17 @@ namespace wi::scene
 				inst.transform.Create(worldMatrix);
 				inst.transformPrev.Create(worldMatrixPrev);
 
-				XMVECTOR S, R, T;
-				XMMatrixDecompose(&S, &R, &T, W);
-				float size = std::max(XMVectorGetX(S), std::max(XMVectorGetY(S), XMVectorGetZ(S)));
+				if (!cached)
+				{
+					XMVECTOR S, R, T;
+					XMMatrixDecompose(&S, &R, &T, W);
+					object.cached_size = std::max(XMVectorGetX(S), std::max(XMVectorGetY(S), XMVectorGetZ(S)));
+					object.cached_world = transform.world;
+					object.cached_mesh_aabb = mesh.aabb;
+					object.cached_aabb = aabb;
+					object.cached_object_index = cacheable ? args.jobIndex : ~0u;
+				}
+				const float size = object.cached_size;
 
 				if (object.lightmap.IsValid())
 				{
@@ -5181,7 +5819,7 @@ namespace wi::scene
 			weather = weathers[0];
 			weather.most_important_light_index = ~0;
 
-			if (weather.IsOceanEnabled() && !ocean.IsValid())
+			if (weather.IsOceanEnabled() && !ocean.IsCreated())
 			{
 				OceanRegenerate();
 			}
@@ -5211,9 +5849,10 @@ namespace wi::scene
 			ocean.occlusionQueries[queryheap_idx] = -1; // invalidate query
 		}
 
-		if (ocean.IsValid())
+		if (ocean.IsCreated())
 		{
 			ocean.params = weather.oceanParameters;
+			ocean.UpdateDisplacementMapCPU(time);
 		}
 
 		if (weather.rain_amount > 0)
@@ -5359,18 +5998,24 @@ namespace wi::scene
 	}
 	void Scene::RunSoundUpdateSystem(wi::jobsystem::context& ctx)
 	{
-		wi::audio::SoundInstance3D instance3D;
-		instance3D.listenerPos = camera.Eye;
-		instance3D.listenerUp = camera.Up;
-		instance3D.listenerFront = camera.At;
+		wi::audio::SoundInstance3D listener3D;
+		listener3D.listenerPos = camera.Eye;
+		listener3D.listenerUp = camera.Up;
+		listener3D.listenerFront = camera.At;
+
+		const size_t sound_count = sounds.GetCount();
+		wi::vector<wi::audio::SoundInstance*> instances(sound_count);
+		wi::vector<wi::audio::SoundInstance3D> instances3D(sound_count, listener3D);
+		wi::vector<const wi::audio::SoundInstance3D*> instances3D_ptr(sound_count);
 
-		for (size_t i = 0; i < sounds.GetCount(); ++i)
+		for (size_t i = 0; i < sound_count; ++i)
 		{
 			SoundComponent& sound = sounds[i];
 
 			if (!sound.soundinstance.IsValid() && sound.soundResource.IsValid())
 			{
 				sound.soundinstance.SetLooped(sound.IsLooped());
+				sound.soundinstance.SetVirtualizable(true); // scene sounds share the real voice budget
 				wi::audio::CreateSoundInstance(&sound.soundResource.GetSound(), &sound.soundinstance);
 			}
 
@@ -5380,10 +6025,11 @@ namespace wi::scene
 				const TransformComponent* transform = transforms.GetComponent(entity);
 				if (transform != nullptr)
 				{
+					wi::audio::SoundInstance3D& instance3D = instances3D[i];
 					instance3D.emitterPos = transform->GetPosition();
 					instance3D.emitterFront = transform->GetForward();
 					instance3D.emitterUp = transform->GetUp();
-					wi::audio::Update3D(&sound.soundinstance, instance3D);
+					instances3D_ptr[i] = &instance3D;
 				}
 			}
 			if (sound.IsPlaying())
@@ -5395,7 +6041,11 @@ namespace wi::scene
 				wi::audio::Stop(&sound.soundinstance);
 			}
 			wi::audio::SetVolume(sound.volume, &sound.soundinstance);
+			instances[i] = &sound.soundinstance;
 		}
+
+		// Virtualization and 3D effects of all scene sounds are updated together, so the most audible ones get the real voices:
+		wi::audio::UpdateVoices(instances.data(), instances3D_ptr.data(), sound_count);
 	}
 	void Scene::RunVideoUpdateSystem(wi::jobsystem::context& ctx)
 	{
@@ -5527,6 +6177,107 @@ namespace wi::scene
 			aabb_fonts[args.jobIndex] = font.GetAABB();
 		});
 	}
+	void Scene::CapsuleGrid::Build(const wi::vector<Capsule>& capsules)
+	{
+		const uint32_t count = (uint32_t)capsules.size();
+		cell_ranges.resize(count);
+
+		cell_size = 0.001f;
+		for (const Capsule& capsule : capsules)
+		{
+			const AABB aabb = capsule.getAABB();
+			cell_size = std::max(cell_size, std::max(aabb._max.x - aabb._min.x, aabb._max.z - aabb._min.z));
+		}
+		const float cell_size_rcp = 1.0f / cell_size;
+
+		uint32_t slot_count = 64;
+		while (slot_count < count * 2)
+		{
+			slot_count <<= 1;
+		}
+		slot_mask = slot_count - 1;
+
+		wi::jobsystem::context ctx;
+		wi::jobsystem::Dispatch(ctx, count, 256, [&](wi::jobsystem::JobArgs args) {
+			const AABB aabb = capsules[args.jobIndex].getAABB();
+			auto cell = [cell_size_rcp](float value) {
+				return int(clamp(std::floor(value * cell_size_rcp), -1e9f, 1e9f));
+			};
+			cell_ranges[args.jobIndex] = XMINT4(cell(aabb._min.x), cell(aabb._min.z), cell(aabb._max.x), cell(aabb._max.z));
+		});
+		wi::jobsystem::Wait(ctx);
+
+		auto slot = [this](int x, int z) {
+			return (uint32_t(x) * 73856093u ^ uint32_t(z) * 19349663u) & slot_mask;
+		};
+
+		// Counting sort by hash slot:
+		slot_offsets.clear();
+		slot_offsets.resize(slot_count + 1);
+		for (const XMINT4& range : cell_ranges)
+		{
+			for (int z = range.y; z <= range.w; ++z)
+			{
+				for (int x = range.x; x <= range.z; ++x)
+				{
+					slot_offsets[slot(x, z)]++;
+				}
+			}
+		}
+		uint32_t offset = 0;
+		for (uint32_t i = 0; i < slot_count; ++i)
+		{
+			offset += slot_offsets[i];
+			slot_offsets[i] = offset; // end of slot, it will be decremented to the start while filling
+		}
+		slot_offsets[slot_count] = offset;
+		capsule_indices.resize(offset);
+		for (uint32_t i = 0; i < count; ++i)
+		{
+			const XMINT4& range = cell_ranges[i];
+			for (int z = range.y; z <= range.w; ++z)
+			{
+				for (int x = range.x; x <= range.z; ++x)
+				{
+					capsule_indices[--slot_offsets[slot(x, z)]] = i;
+				}
+			}
+		}
+	}
+	void Scene::CapsuleGrid::Query(const AABB& aabb, wi::vector<uint32_t>& candidates) const
+	{
+		candidates.clear();
+		if (capsule_indices.empty())
+			return;
+
+		const float cell_size_rcp = 1.0f / cell_size;
+		auto cell = [cell_size_rcp](float value) {
+			return int(clamp(std::floor(value * cell_size_rcp), -1e9f, 1e9f));
+		};
+		const XMINT4 range = XMINT4(cell(aabb._min.x), cell(aabb._min.z), cell(aabb._max.x), cell(aabb._max.z));
+
+		if (uint64_t(range.z - range.x + 1) * uint64_t(range.w - range.y + 1) > uint64_t(slot_mask))
+		{
+			// The query covers more cells than there are slots, every capsule is a candidate:
+			candidates.insert(candidates.end(), capsule_indices.begin(), capsule_indices.end());
+		}
+		else
+		{
+			for (int z = range.y; z <= range.w; ++z)
+			{
+				for (int x = range.x; x <= range.z; ++x)
+				{
+					const uint32_t slot = (uint32_t(x) * 73856093u ^ uint32_t(z) * 19349663u) & slot_mask;
+					candidates.insert(candidates.end(), capsule_indices.begin() + slot_offsets[slot], capsule_indices.begin() + slot_offsets[slot + 1]);
+				}
+			}
+		}
+
+		// Candidates are visited in index order, to get the same first hit as testing every capsule:
+		std::sort(candidates.begin(), candidates.end());
+		candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+	}
+
 	void Scene::RunCharacterUpdateSystem(wi::jobsystem::context& ctx)
 	{
 		if (dt == 0)
@@ -5547,6 +6298,7 @@ namespace wi::scene
 			}
 			character_capsules[i] = characters[i].GetCapsule();
 		}
+		character_grid.Build(character_capsules);
 
 		wi::jobsystem::Dispatch(ctx, (uint32_t)characters.GetCount(), 1, [&](wi::jobsystem::JobArgs args) {
 			CharacterComponent& character = characters[args.jobIndex];
@@ -5733,7 +6485,9 @@ namespace wi::scene
 						XMFLOAT3 incident_position = XMFLOAT3(0, 0, 0);
 						XMFLOAT3 incident_normal = XMFLOAT3(0, 0, 0);
 						float penetration_depth = 0;
-						for (size_t i = 0; i < character_capsules.size(); ++i)
+						static thread_local wi::vector<uint32_t> candidates;
+						character_grid.Query(capsule.getAABB(), candidates);
+						for (uint32_t i : candidates)
 						{
 							if (i == args.jobIndex)
 								continue;
@@ -6210,6 +6964,134 @@ namespace wi::scene
 		wi::jobsystem::Wait(ctx);
 	}
 
+	const Scene::SkinnedMeshCache* Scene::GetSkinnedMeshCache(Entity meshID, const MeshComponent& mesh, const SoftBodyPhysicsComponent* softbody, const ArmatureComponent* armature) const
+	{
+		const wi::vector<ShaderTransform>* boneData = nullptr;
+		if (softbody != nullptr && !softbody->boneData.empty())
+		{
+			boneData = &softbody->boneData;
+		}
+		else if (armature != nullptr && !armature->boneData.empty())
+		{
+			boneData = &armature->boneData;
+		}
+		if (boneData == nullptr || mesh.vertex_positions.empty())
+			return nullptr;
+
+		SkinnedMeshCache* cache = nullptr;
+		{
+			std::scoped_lock lck(skinned_mesh_caches_locker);
+			std::unique_ptr<SkinnedMeshCache>& entry = skinned_mesh_caches[meshID];
+			if (entry == nullptr)
+			{
+				entry = std::make_unique<SkinnedMeshCache>();
+			}
+			cache = entry.get();
+		}
+		if (cache->version.load(std::memory_order_acquire) == skinning_version)
+			return cache;
+
+		// The updating thread will wait for jobs, which could be other queries of the same mesh on this thread,
+		//	so instead of blocking, the other queries fall back to skinning their vertices individually meanwhile
+		std::unique_lock<std::mutex> lck(cache->locker, std::try_to_lock);
+		if (!lck.owns_lock())
+			return nullptr;
+		if (cache->version.load(std::memory_order_relaxed) == skinning_version)
+			return cache;
+
+		const uint32_t vertexCount = (uint32_t)mesh.vertex_positions.size();
+		const uint32_t influence_div4 = mesh.GetBoneInfluenceDiv4();
+		const ShaderTransform* bones = boneData->data();
+		const bool rebuild = cache->positions.size() != mesh.vertex_positions.size() || cache->index_count != (uint32_t)mesh.indices.size();
+		cache->positions.resize(vertexCount);
+		cache->index_count = (uint32_t)mesh.indices.size();
+
+		// Skinning: the bone matrix rows are blended by the weights first, so each vertex is transformed only once
+		static constexpr uint32_t skinning_group_size = 1024;
+		wi::jobsystem::context ctx;
+		wi::jobsystem::Dispatch(ctx, (vertexCount + skinning_group_size - 1) / skinning_group_size, 1, [&](wi::jobsystem::JobArgs args) {
+			const uint32_t begin = args.jobIndex * skinning_group_size;
+			const uint32_t end = std::min(begin + skinning_group_size, vertexCount);
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				const XMVECTOR P = XMVectorSetW(XMLoadFloat3(&mesh.vertex_positions[i]), 1);
+				XMVECTOR R0 = XMVectorZero();
+				XMVECTOR R1 = XMVectorZero();
+				XMVECTOR R2 = XMVectorZero();
+				for (uint32_t influence = 0; influence < influence_div4; ++influence)
+				{
+					const XMUINT4& ind = influence == 0 ? mesh.vertex_boneindices[i] : mesh.vertex_boneindices2[i];
+					const XMFLOAT4& wei = influence == 0 ? mesh.vertex_boneweights[i] : mesh.vertex_boneweights2[i];
+					const uint32_t bone_indices[] = { ind.x, ind.y, ind.z, ind.w };
+					const float bone_weights[] = { wei.x, wei.y, wei.z, wei.w };
+					for (uint32_t j = 0; j < arraysize(bone_indices); ++j)
+					{
+						const ShaderTransform& bone = bones[bone_indices[j]];
+						const XMVECTOR W = XMVectorReplicate(bone_weights[j]);
+						R0 = XMVectorMultiplyAdd(XMLoadFloat4(&bone.mat0), W, R0);
+						R1 = XMVectorMultiplyAdd(XMLoadFloat4(&bone.mat1), W, R1);
+						R2 = XMVectorMultiplyAdd(XMLoadFloat4(&bone.mat2), W, R2);
+					}
+				}
+				const XMVECTOR XY = XMVectorMergeXY(XMVector4Dot(R0, P), XMVector4Dot(R1, P));
+				XMStoreFloat3(&cache->positions[i], XMVectorPermute<0, 1, 4, 5>(XY, XMVector4Dot(R2, P)));
+			}
+		});
+		wi::jobsystem::Wait(ctx);
+
+		auto compute_leaf_aabb = [&](uint32_t subsetIndex, uint32_t triangleIndex) {
+			const uint32_t indexOffset = mesh.subsets[subsetIndex].indexOffset;
+			const XMFLOAT3& p0 = cache->positions[mesh.indices[indexOffset + triangleIndex * 3 + 0]];
+			const XMFLOAT3& p1 = cache->positions[mesh.indices[indexOffset + triangleIndex * 3 + 1]];
+			const XMFLOAT3& p2 = cache->positions[mesh.indices[indexOffset + triangleIndex * 3 + 2]];
+			AABB aabb = AABB(wi::math::Min(p0, wi::math::Min(p1, p2)), wi::math::Max(p0, wi::math::Max(p1, p2)));
+			aabb.layerMask = triangleIndex;
+			aabb.userdata = subsetIndex;
+			return aabb;
+		};
+
+		if (rebuild || !cache->bvh.IsValid())
+		{
+			// Same leaf layout as MeshComponent::BuildBVH(), so the queries can use either of them:
+			cache->bvh_leaf_aabbs.clear();
+			uint32_t first_subset = 0;
+			uint32_t last_subset = 0;
+			mesh.GetLODSubsetRange(0, first_subset, last_subset);
+			for (uint32_t subsetIndex = first_subset; subsetIndex < last_subset; ++subsetIndex)
+			{
+				const uint32_t triangleCount = mesh.subsets[subsetIndex].indexCount / 3;
+				for (uint32_t triangleIndex = 0; triangleIndex < triangleCount; ++triangleIndex)
+				{
+					cache->bvh_leaf_aabbs.push_back(compute_leaf_aabb(subsetIndex, triangleIndex));
+				}
+			}
+			cache->bvh = {};
+			cache->bvh.Build(cache->bvh_leaf_aabbs.data(), (uint32_t)cache->bvh_leaf_aabbs.size());
+		}
+		else
+		{
+			// Refit:
+			const uint32_t leafCount = (uint32_t)cache->bvh_leaf_aabbs.size();
+			wi::jobsystem::Dispatch(ctx, leafCount, skinning_group_size, [&](wi::jobsystem::JobArgs args) {
+				AABB& leaf = cache->bvh_leaf_aabbs[args.jobIndex];
+				leaf = compute_leaf_aabb(leaf.userdata, leaf.layerMask);
+			});
+			wi::jobsystem::Wait(ctx);
+			cache->bvh.Update(cache->bvh_leaf_aabbs.data(), leafCount);
+		}
+
+		cache->version.store(skinning_version, std::memory_order_release);
+		return cache;
+	}
+
+	// Skinned position of a vertex for the intersection queries, from the skinned mesh cache if it's available
+	inline XMVECTOR SkinnedPosition(const Scene::SkinnedMeshCache* skinned, const MeshComponent& mesh, const wi::vector<ShaderTransform>& boneData, uint32_t index)
+	{
+		if (skinned != nullptr)
+			return XMLoadFloat3(&skinned->positions[index]);
+		return SkinVertex(mesh, boneData, index);
+	}
+
 	Scene::RayIntersectionResult Scene::Intersects(const Ray& ray, uint32_t filterMask, uint32_t layerMask, uint32_t lod) const
 	{
 		RayIntersectionResult result;
@@ -6294,6 +7176,9 @@ namespace wi::scene
 				const XMVECTOR rayOrigin_local = XMVector3Transform(rayOrigin, objectMat_Inverse);
 				const XMVECTOR rayDirection_local = XMVector3Normalize(XMVector3TransformNormal(rayDirection, objectMat_Inverse));
 				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				const SkinnedMeshCache* skinned = GetSkinnedMeshCache(object.meshID, *mesh, softbody, armature);
+				const wi::BVH& bvh = skinned != nullptr ? skinned->bvh : mesh->bvh;
+				const AABB* bvh_leaf_aabbs = skinned != nullptr ? skinned->bvh_leaf_aabbs.data() : mesh->bvh_leaf_aabbs.data();
 
 				auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex)
 				{
@@ -6306,15 +7191,15 @@ namespace wi::scene
 					XMVECTOR p2;
 					if (softbody != nullptr && !softbody->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *softbody, i0);
-						p1 = SkinVertex(*mesh, *softbody, i1);
-						p2 = SkinVertex(*mesh, *softbody, i2);
+						p0 = SkinnedPosition(skinned, *mesh, softbody->boneData, i0);
+						p1 = SkinnedPosition(skinned, *mesh, softbody->boneData, i1);
+						p2 = SkinnedPosition(skinned, *mesh, softbody->boneData, i2);
 					}
 					else if (armature != nullptr && !armature->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *armature, i0);
-						p1 = SkinVertex(*mesh, *armature, i1);
-						p2 = SkinVertex(*mesh, *armature, i2);
+						p0 = SkinnedPosition(skinned, *mesh, armature->boneData, i0);
+						p1 = SkinnedPosition(skinned, *mesh, armature->boneData, i1);
+						p2 = SkinnedPosition(skinned, *mesh, armature->boneData, i2);
 					}
 					else
 					{
@@ -6392,12 +7277,12 @@ namespace wi::scene
 					}
 				};
 
-				if (mesh->bvh.IsValid())
+				if (bvh.IsValid())
 				{
 					Ray ray_local = Ray(rayOrigin_local, rayDirection_local);
 
-					mesh->bvh.Intersects(ray_local, 0, [&](uint32_t index) {
-						const AABB& leaf = mesh->bvh_leaf_aabbs[index];
+					bvh.Intersects(ray_local, 0, [&](uint32_t index) {
+						const AABB& leaf = bvh_leaf_aabbs[index];
 						const uint32_t triangleIndex = leaf.layerMask;
 						const uint32_t subsetIndex = leaf.userdata;
 						const MeshComponent::MeshSubset& subset = mesh->subsets[subsetIndex];
@@ -6555,6 +7440,9 @@ namespace wi::scene
 				const XMVECTOR rayOrigin_local = XMVector3Transform(rayOrigin, objectMat_Inverse);
 				const XMVECTOR rayDirection_local = XMVector3Normalize(XMVector3TransformNormal(rayDirection, objectMat_Inverse));
 				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				const SkinnedMeshCache* skinned = GetSkinnedMeshCache(object.meshID, *mesh, softbody, armature);
+				const wi::BVH& bvh = skinned != nullptr ? skinned->bvh : mesh->bvh;
+				const AABB* bvh_leaf_aabbs = skinned != nullptr ? skinned->bvh_leaf_aabbs.data() : mesh->bvh_leaf_aabbs.data();
 
 				auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex)
 				{
@@ -6567,15 +7455,15 @@ namespace wi::scene
 					XMVECTOR p2;
 					if (softbody != nullptr && !softbody->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *softbody, i0);
-						p1 = SkinVertex(*mesh, *softbody, i1);
-						p2 = SkinVertex(*mesh, *softbody, i2);
+						p0 = SkinnedPosition(skinned, *mesh, softbody->boneData, i0);
+						p1 = SkinnedPosition(skinned, *mesh, softbody->boneData, i1);
+						p2 = SkinnedPosition(skinned, *mesh, softbody->boneData, i2);
 					}
 					else if (armature != nullptr && !armature->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *armature, i0);
-						p1 = SkinVertex(*mesh, *armature, i1);
-						p2 = SkinVertex(*mesh, *armature, i2);
+						p0 = SkinnedPosition(skinned, *mesh, armature->boneData, i0);
+						p1 = SkinnedPosition(skinned, *mesh, armature->boneData, i1);
+						p2 = SkinnedPosition(skinned, *mesh, armature->boneData, i2);
 					}
 					else
 					{
@@ -6655,12 +7543,12 @@ namespace wi::scene
 					}
 				};
 
-				if (mesh->bvh.IsValid())
+				if (bvh.IsValid())
 				{
 					Ray ray_local = Ray(rayOrigin_local, rayDirection_local);
 
-					mesh->bvh.Intersects(ray_local, 0, [&](uint32_t index) {
-						const AABB& leaf = mesh->bvh_leaf_aabbs[index];
+					bvh.Intersects(ray_local, 0, [&](uint32_t index) {
+						const AABB& leaf = bvh_leaf_aabbs[index];
 						const uint32_t triangleIndex = leaf.layerMask;
 						const uint32_t subsetIndex = leaf.userdata;
 						const MeshComponent::MeshSubset& subset = mesh->subsets[subsetIndex];
@@ -6810,6 +7698,9 @@ namespace wi::scene
 				const XMVECTOR rayOrigin_local = XMVector3Transform(rayOrigin, objectMat_Inverse);
 				const XMVECTOR rayDirection_local = XMVector3Normalize(XMVector3TransformNormal(rayDirection, objectMat_Inverse));
 				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				const SkinnedMeshCache* skinned = GetSkinnedMeshCache(object.meshID, *mesh, softbody, armature);
+				const wi::BVH& bvh = skinned != nullptr ? skinned->bvh : mesh->bvh;
+				const AABB* bvh_leaf_aabbs = skinned != nullptr ? skinned->bvh_leaf_aabbs.data() : mesh->bvh_leaf_aabbs.data();
 
 				auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex)
 				{
@@ -6822,15 +7713,15 @@ namespace wi::scene
 					XMVECTOR p2;
 					if (softbody != nullptr && !softbody->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *softbody, i0);
-						p1 = SkinVertex(*mesh, *softbody, i1);
-						p2 = SkinVertex(*mesh, *softbody, i2);
+						p0 = SkinnedPosition(skinned, *mesh, softbody->boneData, i0);
+						p1 = SkinnedPosition(skinned, *mesh, softbody->boneData, i1);
+						p2 = SkinnedPosition(skinned, *mesh, softbody->boneData, i2);
 					}
 					else if (armature != nullptr && !armature->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *armature, i0);
-						p1 = SkinVertex(*mesh, *armature, i1);
-						p2 = SkinVertex(*mesh, *armature, i2);
+						p0 = SkinnedPosition(skinned, *mesh, armature->boneData, i0);
+						p1 = SkinnedPosition(skinned, *mesh, armature->boneData, i1);
+						p2 = SkinnedPosition(skinned, *mesh, armature->boneData, i2);
 					}
 					else
 					{
@@ -6857,12 +7748,12 @@ namespace wi::scene
 					return false;
 				};
 
-				if (mesh->bvh.IsValid())
+				if (bvh.IsValid())
 				{
 					Ray ray_local = Ray(rayOrigin_local, rayDirection_local);
 
-					mesh->bvh.IntersectsFirst(ray_local, [&](uint32_t index) {
-						const AABB& leaf = mesh->bvh_leaf_aabbs[index];
+					bvh.IntersectsFirst(ray_local, [&](uint32_t index) {
+						const AABB& leaf = bvh_leaf_aabbs[index];
 						const uint32_t triangleIndex = leaf.layerMask;
 						const uint32_t subsetIndex = leaf.userdata;
 						const MeshComponent::MeshSubset& subset = mesh->subsets[subsetIndex];
@@ -7009,6 +7900,9 @@ namespace wi::scene
 				const XMMATRIX objectMatPrev = XMLoadFloat4x4(&matrix_objects_prev[objectIndex]);
 				const XMMATRIX objectMatInverse = XMMatrixInverse(nullptr, objectMat);
 				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				const SkinnedMeshCache* skinned = GetSkinnedMeshCache(object.meshID, *mesh, softbody, armature);
+				const wi::BVH& bvh = skinned != nullptr ? skinned->bvh : mesh->bvh;
+				const AABB* bvh_leaf_aabbs = skinned != nullptr ? skinned->bvh_leaf_aabbs.data() : mesh->bvh_leaf_aabbs.data();
 
 				auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex, bool doubleSided)
 				{
@@ -7021,15 +7915,15 @@ namespace wi::scene
 					XMVECTOR p2;
 					if (softbody != nullptr && !softbody->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *softbody, i0);
-						p1 = SkinVertex(*mesh, *softbody, i1);
-						p2 = SkinVertex(*mesh, *softbody, i2);
+						p0 = SkinnedPosition(skinned, *mesh, softbody->boneData, i0);
+						p1 = SkinnedPosition(skinned, *mesh, softbody->boneData, i1);
+						p2 = SkinnedPosition(skinned, *mesh, softbody->boneData, i2);
 					}
 					else if (armature != nullptr && !armature->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *armature, i0);
-						p1 = SkinVertex(*mesh, *armature, i1);
-						p2 = SkinVertex(*mesh, *armature, i2);
+						p0 = SkinnedPosition(skinned, *mesh, armature->boneData, i0);
+						p1 = SkinnedPosition(skinned, *mesh, armature->boneData, i1);
+						p2 = SkinnedPosition(skinned, *mesh, armature->boneData, i2);
 						p0 = XMVector3Transform(p0, objectMat);
 						p1 = XMVector3Transform(p1, objectMat);
 						p2 = XMVector3Transform(p2, objectMat);
@@ -7160,7 +8054,7 @@ namespace wi::scene
 					}
 				};
 
-				if (mesh->bvh.IsValid())
+				if (bvh.IsValid())
 				{
 					XMFLOAT3 center_local;
 					float radius_local;
@@ -7168,8 +8062,8 @@ namespace wi::scene
 					XMStoreFloat(&radius_local, XMVector3Length(XMVector3TransformNormal(XMLoadFloat(&sphere.radius), objectMatInverse)));
 					Sphere sphere_local = Sphere(center_local, radius_local);
 
-					mesh->bvh.Intersects(sphere_local, 0, [&](uint32_t index) {
-						const AABB& leaf = mesh->bvh_leaf_aabbs[index];
+					bvh.Intersects(sphere_local, 0, [&](uint32_t index) {
+						const AABB& leaf = bvh_leaf_aabbs[index];
 						const uint32_t triangleIndex = leaf.layerMask;
 						const uint32_t subsetIndex = leaf.userdata;
 						const MeshComponent::MeshSubset& subset = mesh->subsets[subsetIndex];
@@ -7316,6 +8210,9 @@ namespace wi::scene
 				const XMMATRIX objectMatPrev = XMLoadFloat4x4(&matrix_objects_prev[objectIndex]);
 				const XMMATRIX objectMatInverse = XMMatrixInverse(nullptr, objectMat);
 				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				const SkinnedMeshCache* skinned = GetSkinnedMeshCache(object.meshID, *mesh, softbody, armature);
+				const wi::BVH& bvh = skinned != nullptr ? skinned->bvh : mesh->bvh;
+				const AABB* bvh_leaf_aabbs = skinned != nullptr ? skinned->bvh_leaf_aabbs.data() : mesh->bvh_leaf_aabbs.data();
 
 				auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex, bool doubleSided)
 				{
@@ -7328,15 +8225,15 @@ namespace wi::scene
 					XMVECTOR p2;
 					if (softbody != nullptr && !softbody->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *softbody, i0);
-						p1 = SkinVertex(*mesh, *softbody, i1);
-						p2 = SkinVertex(*mesh, *softbody, i2);
+						p0 = SkinnedPosition(skinned, *mesh, softbody->boneData, i0);
+						p1 = SkinnedPosition(skinned, *mesh, softbody->boneData, i1);
+						p2 = SkinnedPosition(skinned, *mesh, softbody->boneData, i2);
 					}
 					else if (armature != nullptr && !armature->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *armature, i0);
-						p1 = SkinVertex(*mesh, *armature, i1);
-						p2 = SkinVertex(*mesh, *armature, i2);
+						p0 = SkinnedPosition(skinned, *mesh, armature->boneData, i0);
+						p1 = SkinnedPosition(skinned, *mesh, armature->boneData, i1);
+						p2 = SkinnedPosition(skinned, *mesh, armature->boneData, i2);
 						p0 = XMVector3Transform(p0, objectMat);
 						p1 = XMVector3Transform(p1, objectMat);
 						p2 = XMVector3Transform(p2, objectMat);
@@ -7470,7 +8367,7 @@ namespace wi::scene
 					}
 				};
 
-				if (mesh->bvh.IsValid())
+				if (bvh.IsValid())
 				{
 					XMFLOAT3 center_local;
 					float radius_local;
@@ -7478,8 +8375,8 @@ namespace wi::scene
 					XMStoreFloat(&radius_local, XMVector3Length(XMVector3TransformNormal(XMLoadFloat(&sphere.radius), objectMatInverse)));
 					Sphere sphere_local = Sphere(center_local, radius_local);
 
-					mesh->bvh.Intersects(sphere_local, 0, [&](uint32_t index) {
-						const AABB& leaf = mesh->bvh_leaf_aabbs[index];
+					bvh.Intersects(sphere_local, 0, [&](uint32_t index) {
+						const AABB& leaf = bvh_leaf_aabbs[index];
 						const uint32_t triangleIndex = leaf.layerMask;
 						const uint32_t subsetIndex = leaf.userdata;
 						const MeshComponent::MeshSubset& subset = mesh->subsets[subsetIndex];
@@ -7634,6 +8531,9 @@ namespace wi::scene
 				const XMMATRIX objectMat = XMLoadFloat4x4(&matrix_objects[objectIndex]);
 				const XMMATRIX objectMatPrev = XMLoadFloat4x4(&matrix_objects_prev[objectIndex]);
 				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				const SkinnedMeshCache* skinned = GetSkinnedMeshCache(object.meshID, *mesh, softbody, armature);
+				const wi::BVH& bvh = skinned != nullptr ? skinned->bvh : mesh->bvh;
+				const AABB* bvh_leaf_aabbs = skinned != nullptr ? skinned->bvh_leaf_aabbs.data() : mesh->bvh_leaf_aabbs.data();
 				const XMMATRIX objectMat_Inverse = XMMatrixInverse(nullptr, objectMat);
 				
 				auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex, bool doubleSided)
@@ -7647,15 +8547,15 @@ namespace wi::scene
 					XMVECTOR p2;
 					if (softbody != nullptr && !softbody->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *softbody, i0);
-						p1 = SkinVertex(*mesh, *softbody, i1);
-						p2 = SkinVertex(*mesh, *softbody, i2);
+						p0 = SkinnedPosition(skinned, *mesh, softbody->boneData, i0);
+						p1 = SkinnedPosition(skinned, *mesh, softbody->boneData, i1);
+						p2 = SkinnedPosition(skinned, *mesh, softbody->boneData, i2);
 					}
 					else if (armature != nullptr && !armature->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *armature, i0);
-						p1 = SkinVertex(*mesh, *armature, i1);
-						p2 = SkinVertex(*mesh, *armature, i2);
+						p0 = SkinnedPosition(skinned, *mesh, armature->boneData, i0);
+						p1 = SkinnedPosition(skinned, *mesh, armature->boneData, i1);
+						p2 = SkinnedPosition(skinned, *mesh, armature->boneData, i2);
 						p0 = XMVector3Transform(p0, objectMat);
 						p1 = XMVector3Transform(p1, objectMat);
 						p2 = XMVector3Transform(p2, objectMat);
@@ -7898,7 +8798,7 @@ namespace wi::scene
 					}
 				};
 
-				if (mesh->bvh.IsValid())
+				if (bvh.IsValid())
 				{
 					XMFLOAT3 base_local;
 					XMFLOAT3 tip_local;
@@ -7908,8 +8808,8 @@ namespace wi::scene
 					XMStoreFloat(&radius_local, XMVector3Length(XMVector3TransformNormal(XMLoadFloat(&capsule.radius), objectMat_Inverse)));
 					AABB capsule_local_aabb = Capsule(base_local, tip_local, radius_local).getAABB();
 
-					mesh->bvh.Intersects(capsule_local_aabb, 0, [&](uint32_t index){
-						const AABB& leaf = mesh->bvh_leaf_aabbs[index];
+					bvh.Intersects(capsule_local_aabb, 0, [&](uint32_t index){
+						const AABB& leaf = bvh_leaf_aabbs[index];
 						const uint32_t triangleIndex = leaf.layerMask;
 						const uint32_t subsetIndex = leaf.userdata;
 						const MeshComponent::MeshSubset& subset = mesh->subsets[subsetIndex];
@@ -8063,6 +8963,9 @@ namespace wi::scene
 				const XMMATRIX objectMat = XMLoadFloat4x4(&matrix_objects[objectIndex]);
 				const XMMATRIX objectMatPrev = XMLoadFloat4x4(&matrix_objects_prev[objectIndex]);
 				const ArmatureComponent* armature = mesh->IsSkinned() ? armatures.GetComponent(mesh->armatureID) : nullptr;
+				const SkinnedMeshCache* skinned = GetSkinnedMeshCache(object.meshID, *mesh, softbody, armature);
+				const wi::BVH& bvh = skinned != nullptr ? skinned->bvh : mesh->bvh;
+				const AABB* bvh_leaf_aabbs = skinned != nullptr ? skinned->bvh_leaf_aabbs.data() : mesh->bvh_leaf_aabbs.data();
 				const XMMATRIX objectMat_Inverse = XMMatrixInverse(nullptr, objectMat);
 
 				auto intersect_triangle = [&](uint32_t subsetIndex, uint32_t indexOffset, uint32_t triangleIndex, bool doubleSided)
@@ -8076,15 +8979,15 @@ namespace wi::scene
 					XMVECTOR p2;
 					if (softbody != nullptr && !softbody->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *softbody, i0);
-						p1 = SkinVertex(*mesh, *softbody, i1);
-						p2 = SkinVertex(*mesh, *softbody, i2);
+						p0 = SkinnedPosition(skinned, *mesh, softbody->boneData, i0);
+						p1 = SkinnedPosition(skinned, *mesh, softbody->boneData, i1);
+						p2 = SkinnedPosition(skinned, *mesh, softbody->boneData, i2);
 					}
 					else if (armature != nullptr && !armature->boneData.empty())
 					{
-						p0 = SkinVertex(*mesh, *armature, i0);
-						p1 = SkinVertex(*mesh, *armature, i1);
-						p2 = SkinVertex(*mesh, *armature, i2);
+						p0 = SkinnedPosition(skinned, *mesh, armature->boneData, i0);
+						p1 = SkinnedPosition(skinned, *mesh, armature->boneData, i1);
+						p2 = SkinnedPosition(skinned, *mesh, armature->boneData, i2);
 						p0 = XMVector3Transform(p0, objectMat);
 						p1 = XMVector3Transform(p1, objectMat);
 						p2 = XMVector3Transform(p2, objectMat);
@@ -8331,7 +9234,7 @@ namespace wi::scene
 					}
 				};
 
-				if (mesh->bvh.IsValid())
+				if (bvh.IsValid())
 				{
 					XMFLOAT3 base_local;
 					XMFLOAT3 tip_local;
@@ -8341,8 +9244,8 @@ namespace wi::scene
 					XMStoreFloat(&radius_local, XMVector3Length(XMVector3TransformNormal(XMLoadFloat(&capsule.radius), objectMat_Inverse)));
 					AABB capsule_local_aabb = Capsule(base_local, tip_local, radius_local).getAABB();
 
-					mesh->bvh.Intersects(capsule_local_aabb, 0, [&](uint32_t index) {
-						const AABB& leaf = mesh->bvh_leaf_aabbs[index];
+					bvh.Intersects(capsule_local_aabb, 0, [&](uint32_t index) {
+						const AABB& leaf = bvh_leaf_aabbs[index];
 						const uint32_t triangleIndex = leaf.layerMask;
 						const uint32_t subsetIndex = leaf.userdata;
 						const MeshComponent::MeshSubset& subset = mesh->subsets[subsetIndex];
@@ -8651,10 +9554,19 @@ namespace wi::scene
 
 	XMFLOAT3 Scene::GetOceanPosAt(const XMFLOAT3& worldPosition) const
 	{
-		if (!ocean.IsValid())
+		if (!ocean.IsCreated())
 			return worldPosition;
 		return ocean.GetDisplacedPosition(worldPosition);
 	}
+	void Scene::GetOceanPosAt(const XMFLOAT3* worldPositions, XMFLOAT3* results, size_t count) const
+	{
+		if (!ocean.IsCreated())
+		{
+			std::copy(worldPositions, worldPositions + count, results);
+			return;
+		}
+		ocean.GetDisplacedPositions(worldPositions, results, count);
+	}
 
 	uint32_t Scene::ComputeObjectLODForView(const ObjectComponent& object, const AABB& aabb, const MeshComponent& mesh, const XMMATRIX& ViewProjection) const
 	{
@@ -9072,6 +9984,7 @@ namespace wi::scene
 	void Scene::StartBuildTopDownHierarchy()
 	{
 		WaitBuildTopDownHierarchy();
+		topdown_hierarchy_version = hierarchy.GetStructureVersion();
 		wi::jobsystem::Execute(topdown_hierarchy_workload, [&](wi::jobsystem::JobArgs args) {
 			for (auto& x : topdown_hierarchy)
 			{
@@ -9089,6 +10002,31 @@ namespace wi::scene
 	{
 		wi::jobsystem::Wait(topdown_hierarchy_workload);
 	}
+	void Scene::GatherDescendants(wi::vector<Entity>& entities, wi::unordered_set<Entity>& visited)
+	{
+		WaitBuildTopDownHierarchy();
+		if (topdown_hierarchy_version != hierarchy.GetStructureVersion())
+		{
+			// The hierarchy changed since the last build, so it is rebuilt here:
+			StartBuildTopDownHierarchy();
+			WaitBuildTopDownHierarchy();
+		}
+
+		// Breadth first, this only visits the gathered entities:
+		for (size_t i = 0; i < entities.size(); ++i)
+		{
+			auto it = topdown_hierarchy.find(entities[i]);
+			if (it == topdown_hierarchy.end())
+				continue;
+			for (Entity child : it->second)
+			{
+				if (visited.insert(child).second)
+				{
+					entities.push_back(child);
+				}
+			}
+		}
+	}
 	void Scene::RefreshHierarchyTopdownFromParent(wi::ecs::Entity entity)
 	{
 		auto it = topdown_hierarchy.find(entity);
@@ -9454,15 +10392,8 @@ namespace wi::scene
 				)
 			{
 				Entity entity = transforms.GetEntity(i);
-				if (names.Contains(entity))
-				{
-					NameComponent* namecomponent = names.GetComponent(entity);
-					namecomponent->name += "_nanfix";
-				}
-				else
-				{
-					names.Create(entity).name += "_nanfix";
-				}
+				const NameComponent* namecomponent = names.GetComponent(entity);
+				Entity_SetName(entity, (namecomponent == nullptr ? std::string() : namecomponent->name) + "_nanfix");
 				wilog_warning("NAN was detected in transform, it will be cleared and name will be postfixed with _nanfix! Entity ID: %llu , name = %s", (unsigned long long)entity, names.GetComponent(entity)->name.c_str());
 				transform.ClearTransform();
 			}
@@ -13,11 +13,13 @@
 #include "wiTerrain.h"
 #include "wiBVH.h"
 #include "wiUnorderedSet.h"
+#include "wiUnorderedMap.h"
 #include "wiVoxelGrid.h"
 #include "wiPathQuery.h"
 
 #include <string>
 #include <memory>
+#include <mutex>
 
 namespace wi::scene
 {
@@ -47,8 +49,8 @@ namespace wi::scene
 		wi::ecs::ComponentManager<AnimationDataComponent>& animation_datas = componentLibrary.Register<AnimationDataComponent>("wi::scene::Scene::animation_datas");
 		wi::ecs::ComponentManager<EmittedParticleSystem>& emitters = componentLibrary.Register<EmittedParticleSystem>("wi::scene::Scene::emitters", 2); // version = 2
 		wi::ecs::ComponentManager<HairParticleSystem>& hairs = componentLibrary.Register<HairParticleSystem>("wi::scene::Scene::hairs", 3); // version = 3
-		wi::ecs::ComponentManager<WeatherComponent>& weathers = componentLibrary.Register<WeatherComponent>("wi::scene::Scene::weathers", 6); // version = 6
-		wi::ecs::ComponentManager<SoundComponent>& sounds = componentLibrary.Register<SoundComponent>("wi::scene::Scene::sounds", 1); // version = 1
+		wi::ecs::ComponentManager<WeatherComponent>& weathers = componentLibrary.Register<WeatherComponent>("wi::scene::Scene::weathers", 7); // version = 7
+		wi::ecs::ComponentManager<SoundComponent>& sounds = componentLibrary.Register<SoundComponent>("wi::scene::Scene::sounds", 2); // version = 2
 		wi::ecs::ComponentManager<VideoComponent>& videos = componentLibrary.Register<VideoComponent>("wi::scene::Scene::videos", 1); // version = 1
 		wi::ecs::ComponentManager<InverseKinematicsComponent>& inverse_kinematics = componentLibrary.Register<InverseKinematicsComponent>("wi::scene::Scene::inverse_kinematics");
 		wi::ecs::ComponentManager<SpringComponent>& springs = componentLibrary.Register<SpringComponent>("wi::scene::Scene::springs", 1); // version = 1
@@ -89,10 +91,64 @@ namespace wi::scene
 		bool IsAccelerationStructureUpdateRequested() const { return acceleration_structure_update_requested; }
 		bool IsLightmapUpdateRequested() const { return lightmap_request_allocator.load() > 0; }
 		wi::Archive optimized_instatiation_data;
+
+		// Entities and their components that can be cloned by copying the components directly, without serialization:
+		struct CloneTable
+		{
+			static constexpr uint32_t MANAGER_COUNT = 13; // the component managers that support direct copy, see CloneEntities()
+			struct Source
+			{
+				uint32_t component_index = 0; // index in the source component manager
+				uint32_t entity_slot = 0; // index of the entity in the entities array
+			};
+			uint64_t structure_hash = 0; // structure versions of the source component managers that the table was built from
+			bool cloneable = false; // false if there are components that can't be copied directly
+			wi::vector<wi::ecs::Entity> entities;
+			wi::unordered_map<wi::ecs::Entity, uint32_t> entity_slots; // remap table: source entity -> index in entities
+			wi::vector<uint32_t> root_slots; // entities that have a transform, but no parent within the table
+			wi::vector<Source> sources[MANAGER_COUNT];
+		};
+		std::shared_ptr<const CloneTable> prefab_clone_table; // used when this scene is instantiated as a prefab, it is replaced instead of modified when rebuilt, so instantiations in progress keep using their own
 		wi::vector<wi::primitive::Capsule> character_capsules;
+
+		// Uniform spatial hash of capsules on the horizontal plane, it is the broadphase of character-to-character collisions
+		//	Every capsule is inserted into the cells that its AABB overlaps, the cell size is the largest capsule extent
+		//	so a capsule usually covers at most 2x2 cells. Distinct cells can share a hash slot, which only adds false candidates
+		struct CapsuleGrid
+		{
+			float cell_size = 1;
+			uint32_t slot_mask = 0;
+			wi::vector<XMINT4> cell_ranges; // per capsule: min cell x, min cell z, max cell x, max cell z
+			wi::vector<uint32_t> slot_offsets; // per hash slot: start position in capsule_indices, plus one end position
+			wi::vector<uint32_t> capsule_indices; // capsule indices ordered by hash slot
+
+			// Rebuilds the grid, cell ranges are computed in parallel
+			void Build(const wi::vector<wi::primitive::Capsule>& capsules);
+			// Gathers the indices of capsules that are in the same cells as the AABB, sorted ascending and without duplicates
+			void Query(const wi::primitive::AABB& aabb, wi::vector<uint32_t>& candidates) const;
+		} character_grid;
+
+		// Cached component index joins of systems, rebuilt only when the component managers change structurally:
+		wi::ecs::ComponentJoin<HierarchyComponent, TransformComponent, LayerComponent> hierarchy_join;
+		wi::ecs::ComponentJoin<ObjectComponent, TransformComponent, LayerComponent> object_join;
 		wi::vector<wi::primitive::Sphere> character_dedicated_shadows;
 		wi::unordered_map<wi::ecs::Entity, wi::vector<wi::ecs::Entity>> topdown_hierarchy; // managed by BuildTopDownHierarchy() in every Update(), allows parent->children traversal
 		wi::jobsystem::context topdown_hierarchy_workload;
+		uint64_t topdown_hierarchy_version = 0; // structure version of the hierarchy manager that topdown_hierarchy was built from
+
+		// Name -> entities lookup of the names component manager, used by Entity_FindByName() and the other name queries
+		//	It is rebuilt lazily after structural changes of names (remove, merge, serialization)
+		//	Entity_SetName() and the Entity_Create...() functions update it in place, existing entities must be renamed with Entity_SetName()
+		struct NameIndex
+		{
+			wi::unordered_map<size_t, wi::vector<uint32_t>> buckets; // name hash -> component indices in names, ascending
+			wi::vector<uint32_t> sorted; // component indices in names ordered by name, built on demand for prefix queries
+			bool sorted_valid = false;
+			uint64_t structure_version = ~0ull; // structure version of names that the index was built from
+			wi::SpinLock locker;
+		} name_index;
+		// Brings name_index up to date, name_index.locker must be held
+		void UpdateNameIndex(bool sorted = false);
 		uint32_t cpu_gpu_mapped_resource_index = 0;
 
 		// AABB culling streams:
@@ -283,6 +339,25 @@ namespace wi::scene
 		wi::jobsystem::context collider_bvh_workload;
 		void CountCPUandGPUColliders();
 
+		// Skinned mesh CPU intersection cache:
+		//	Skinned vertex positions and a BVH over them are computed on demand by intersection queries, and reused until the skinning changes
+		//	The BVH is built once and only refitted after that, so its structure is the one from the first queried pose
+		struct SkinnedMeshCache
+		{
+			std::atomic<uint64_t> version{ ~0ull };
+			std::mutex locker;
+			uint32_t index_count = 0;
+			wi::vector<XMFLOAT3> positions;
+			wi::vector<wi::primitive::AABB> bvh_leaf_aabbs;
+			wi::BVH bvh;
+		};
+		mutable std::mutex skinned_mesh_caches_locker;
+		mutable wi::unordered_map<wi::ecs::Entity, std::unique_ptr<SkinnedMeshCache>> skinned_mesh_caches;
+		uint64_t skinning_version = 0; // incremented when the skinning matrices were updated, this invalidates the skinned mesh caches
+		// Returns the up to date skinned mesh cache for CPU intersection queries
+		//	returns nullptr if the mesh is not skinned, or if an other thread is currently updating the cache
+		const SkinnedMeshCache* GetSkinnedMeshCache(wi::ecs::Entity meshID, const MeshComponent& mesh, const SoftBodyPhysicsComponent* softbody, const ArmatureComponent* armature) const;
+
 		// Ocean GPU state:
 		wi::Ocean ocean;
 		void OceanRegenerate() { ocean.Create(weather.oceanParameters); }
@@ -316,6 +391,8 @@ namespace wi::scene
 
 		void StartBuildTopDownHierarchy();
 		void WaitBuildTopDownHierarchy() const;
+		// Appends all descendants of the entities to the entities array with the help of topdown_hierarchy, visited set is used to avoid duplicates
+		void GatherDescendants(wi::vector<wi::ecs::Entity>& entities, wi::unordered_set<wi::ecs::Entity>& visited);
 		void RefreshHierarchyTopdownFromParent(wi::ecs::Entity entity);
 
 		// Update all components by a given timestep (in seconds):
@@ -334,6 +411,24 @@ namespace wi::scene
 		//	attached	: if true, everything from prefab will be attached to a root entity
 		//	returns new root entity if attached is set to true, otherwise returns INVALID_ENTITY
 		virtual wi::ecs::Entity Instantiate(Scene& prefab, bool attached = false);
+		// Create multiple copies of prefab and add them into this by copying the components directly instead of serializing them.
+		//	prefab		: source scene to be copied from
+		//	matrices	: one copy is created for each matrix, which is the world transform of the copy
+		//	attached	: if true, each copy will be attached to its own root entity, otherwise the matrix is applied to the unparented transforms of the copy
+		//	returns the root entities of the copies if attached is set to true
+		//	Prefabs with components that need deserialization (armatures, sounds, particle systems, etc.) fall back to InstantiateSerialized() for each copy
+		wi::vector<wi::ecs::Entity> InstantiateBatch(Scene& prefab, const wi::vector<XMFLOAT4X4>& matrices, bool attached = true);
+		// Create a copy of prefab by serialization and merge it into this, the matrix is applied like in InstantiateBatch()
+		wi::ecs::Entity InstantiateSerialized(Scene& prefab, bool attached, const XMFLOAT4X4& matrix = wi::math::IDENTITY_MATRIX);
+		// Fills a clone table with the given entities of this scene
+		void BuildCloneTable(CloneTable& table, const wi::vector<wi::ecs::Entity>& entities) const;
+		// Creates copies of the entities of a clone table of src scene (src can be this scene)
+		//	copies				: number of copies
+		//	remap_references	: if true, entity references within the components are remapped to the copies, otherwise only the hierarchy is remapped
+		//	new_entities		: receives the new entities, copy by copy in the order of table.entities
+		void CloneEntities(const Scene& src, const CloneTable& table, uint32_t copies, bool remap_references, wi::vector<wi::ecs::Entity>& new_entities);
+		// Returns the combined structure version of all component managers
+		uint64_t GetStructureHash() const;
 		// Finds all entities in the scene that have any components attached
 		void FindAllEntities(wi::unordered_set<wi::ecs::Entity>& entities) const;
 
@@ -341,9 +436,26 @@ namespace wi::scene
 		//	recursive	: also removes children if true
 		//	keep_sorted	: remove all components while keeping sorted order (slow)
 		void Entity_Remove(wi::ecs::Entity entity, bool recursive = true, bool keep_sorted = false);
+		// Removes (deletes) multiple entities from the scene at once:
+		//	recursive	: also removes children if true, the subtrees are gathered from the top-down hierarchy
+		//	keep_sorted	: remove all components while keeping sorted order, each component manager is compacted in one pass
+		//	The component managers are processed in parallel when there are many entities
+		void Entity_RemoveBatch(const wi::vector<wi::ecs::Entity>& entities, bool recursive = true, bool keep_sorted = false);
 		// Finds the first entity by the name (if it exists, otherwise returns INVALID_ENTITY):
 		//	ancestor : you can specify an ancestor entity if you only want to find entities that are descendants of ancestor entity
 		wi::ecs::Entity Entity_FindByName(const std::string& name, wi::ecs::Entity ancestor = wi::ecs::INVALID_ENTITY);
+		// Finds all entities with the name and appends them to the entities array:
+		//	ancestor : you can specify an ancestor entity if you only want to find entities that are descendants of ancestor entity
+		void Entity_FindAllByName(const std::string& name, wi::vector<wi::ecs::Entity>& entities, wi::ecs::Entity ancestor = wi::ecs::INVALID_ENTITY);
+		// Finds all entities whose name starts with prefix and appends them to the entities array, ordered by name:
+		//	ancestor : you can specify an ancestor entity if you only want to find entities that are descendants of ancestor entity
+		void Entity_FindByNamePrefix(const std::string& prefix, wi::vector<wi::ecs::Entity>& entities, wi::ecs::Entity ancestor = wi::ecs::INVALID_ENTITY);
+		// Finds all entities whose name matches a glob pattern and appends them to the entities array, ordered by name:
+		//	pattern	 : '*' matches any sequence of characters, '?' matches one character, for example "hand_*_bone?"
+		//	ancestor : you can specify an ancestor entity if you only want to find entities that are descendants of ancestor entity
+		void Entity_FindByNamePattern(const std::string& pattern, wi::vector<wi::ecs::Entity>& entities, wi::ecs::Entity ancestor = wi::ecs::INVALID_ENTITY);
+		// Sets the name of an entity, the NameComponent is created if it doesn't exist yet. The name index is updated in place.
+		void Entity_SetName(wi::ecs::Entity entity, const std::string& name);
 		// Duplicates all of an entity's components and creates a new entity with them (recursively keeps hierarchy):
 		wi::ecs::Entity Entity_Duplicate(wi::ecs::Entity entity);
 		// Check whether entity is a descendant of ancestor
@@ -469,6 +581,7 @@ namespace wi::scene
 		void RunProceduralAnimationUpdateSystem(wi::jobsystem::context& ctx);
 		void RunArmatureUpdateSystem(wi::jobsystem::context& ctx);
 		void RunMeshUpdateSystem(wi::jobsystem::context& ctx);
+		void RunMeshMaterialUpdateSystem(wi::jobsystem::context& ctx);
 		void RunMaterialUpdateSystem(wi::jobsystem::context& ctx);
 		void RunImpostorUpdateSystem(wi::jobsystem::context& ctx);
 		void RunObjectUpdateSystem(wi::jobsystem::context& ctx);
@@ -591,8 +704,11 @@ namespace wi::scene
 		// Returns the approximate position on the ocean surface seen from a position in world space.
 		//	If current weather doesn't have ocean enabled, returns the world position itself.
 		//	The result position is approximate because it involves reading back from GPU to the CPU, so the result can be delayed compared to the current GPU simulation.
+		//	If the CPU ocean simulation is enabled (OceanParameters::cpu_simulation_dim, or no graphics device), the result is not delayed but contains less wave detail.
 		//	Note that the input position to this function will be taken on the XZ plane and modified by the displacement map's XZ value, and the Y (vertical) position will be taken from the ocean water height and displacement map only.
 		XMFLOAT3 GetOceanPosAt(const XMFLOAT3& worldPosition) const;
+		// Same as above, for many positions at once:
+		void GetOceanPosAt(const XMFLOAT3* worldPositions, XMFLOAT3* results, size_t count) const;
 
 		// Computes the LOD for an object AABB for a given view projection matrix
 		uint32_t ComputeObjectLODForView(const ObjectComponent& object, const wi::primitive::AABB& aabb, const MeshComponent& mesh, const XMMATRIX& ViewProjection) const;
@@ -1136,7 +1136,7 @@ int Scene_BindLua::Component_CreateName(lua_State* L)
 		Entity entity = (Entity)wi::lua::SGetLongLong(L, 1);
 
 		NameComponent& component = scene->names.Create(entity);
-		Luna<NameComponent_BindLua>::push(L, &component);
+		Luna<NameComponent_BindLua>::push(L, scene, entity, &component);
 		return 1;
 	}
 	else
@@ -1601,7 +1601,7 @@ int Scene_BindLua::Component_GetName(lua_State* L)
 			return 0;
 		}
 
-		Luna<NameComponent_BindLua>::push(L, component);
+		Luna<NameComponent_BindLua>::push(L, scene, entity, component);
 		return 1;
 	}
 	else
@@ -2233,7 +2233,7 @@ int Scene_BindLua::Component_GetNameArray(lua_State* L)
 	int newTable = lua_gettop(L);
 	for (size_t i = 0; i < scene->names.GetCount(); ++i)
 	{
-		Luna<NameComponent_BindLua>::push(L, &scene->names[i]);
+		Luna<NameComponent_BindLua>::push(L, scene, scene->names.GetEntity(i), &scene->names[i]);
 		lua_rawseti(L, newTable, lua_Integer(i + 1));
 	}
 	return 1;
@@ -3785,7 +3785,14 @@ int NameComponent_BindLua::SetName(lua_State* L)
 	if (argc > 0)
 	{
 		std::string name = wi::lua::SGetString(L, 1);
-		*component = name;
+		if (scene != nullptr)
+		{
+			scene->Entity_SetName(entity, name);
+		}
+		else
+		{
+			*component = name;
+		}
 	}
 	else
 	{
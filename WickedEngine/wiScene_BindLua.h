@@ -279,12 +279,15 @@ namespace wi::lua::scene
 		wi::scene::NameComponent owning;
 	public:
 		wi::scene::NameComponent* component = nullptr;
+		wi::scene::Scene* scene = nullptr; // if the component is in a scene, it is renamed through the scene, to keep its name index valid
+		wi::ecs::Entity entity = wi::ecs::INVALID_ENTITY;
 
 		inline static constexpr char className[] = "NameComponent";
 		static Luna<NameComponent_BindLua>::FunctionType methods[];
 		static Luna<NameComponent_BindLua>::PropertyType properties[];
 
 		NameComponent_BindLua(wi::scene::NameComponent* component) :component(component) {}
+		NameComponent_BindLua(wi::scene::Scene* scene, wi::ecs::Entity entity, wi::scene::NameComponent* component) :component(component), scene(scene), entity(entity) {}
 		NameComponent_BindLua(lua_State* L) : component(&owning) {}
 
 		int SetName(lua_State* L);
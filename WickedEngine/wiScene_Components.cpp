@@ -31,7 +31,6 @@ using namespace wi::primitive;
 namespace wi::scene
 {
 
-
 	XMFLOAT3 TransformComponent::GetPosition() const
 	{
 		return wi::math::GetPosition(world);
@@ -765,6 +765,16 @@ namespace wi::scene
 
 		wi::vector<wi::graphics::RaytracingAccelerationStructure> BLASes; // one BLAS per LOD
 
+		// Material properties combined for all subsets of a LOD, so objects don't need to look up materials one by one:
+		struct LODMaterialInfo
+		{
+			uint32_t filterMask = 0;
+			uint32_t sort_bits = 0; // material part of ObjectComponent::sort_bits
+			bool planar_reflection = false;
+			bool mesh_blend = false;
+		};
+		wi::vector<LODMaterialInfo> lod_material_infos; // one per LOD, valid for a single frame
+
 		wi::vector<wi::primitive::AABB> bvh_leaf_aabbs;
 		wi::BVH bvh;
 
@@ -1196,6 +1206,14 @@ namespace wi::scene
 		uint32_t mesh_index = ~0u;
 		uint32_t sort_bits = 0;
 
+		// Static object cache: while the object stays at the same index with the same world matrix and mesh bounds,
+		//	the object update reuses these instead of recomputing them and looking up the components again
+		XMFLOAT4X4 cached_world = wi::math::IDENTITY_MATRIX;
+		wi::primitive::AABB cached_mesh_aabb;
+		wi::primitive::AABB cached_aabb;
+		float cached_size = 0;
+		uint32_t cached_object_index = ~0u;
+
 		constexpr void SetRenderable(bool value) { if (value) { _flags |= RENDERABLE; } else { _flags &= ~RENDERABLE; } }
 		constexpr void SetCastShadow(bool value) { if (value) { _flags |= CAST_SHADOW; } else { _flags &= ~CAST_SHADOW; } }
 		constexpr void SetDynamic(bool value) { if (value) { _flags |= DYNAMIC; } else { _flags &= ~DYNAMIC; } }
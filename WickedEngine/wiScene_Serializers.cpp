@@ -1,4 +1,5 @@
 #include "wiScene.h"
+#include "wiPhysics.h"
 #include "wiResourceManager.h"
 #include "wiArchive.h"
 #include "wiRandom.h"
@@ -1872,6 +1873,10 @@ namespace wi::scene
 			{
 				archive >> oceanParameters.extinctionColor;
 			}
+			if (seri.GetVersion() >= 7)
+			{
+				archive >> oceanParameters.cpu_simulation_dim;
+			}
 		}
 		else
 		{
@@ -2096,6 +2101,10 @@ namespace wi::scene
 			{
 				archive << oceanParameters.extinctionColor;
 			}
+			if (seri.GetVersion() >= 7)
+			{
+				archive << oceanParameters.cpu_simulation_dim;
+			}
 		}
 	}
 	void SoundComponent::Serialize(wi::Archive& archive, EntitySerializer& seri)
@@ -2116,6 +2125,10 @@ namespace wi::scene
 				archive >> soundinstance.loop_begin;
 				archive >> soundinstance.loop_length;
 			}
+			if (seri.GetVersion() >= 2)
+			{
+				archive >> soundinstance.priority;
+			}
 
 			wi::jobsystem::Execute(seri.ctx, [&](wi::jobsystem::JobArgs args) {
 				if (!filename.empty())
@@ -2144,6 +2157,10 @@ namespace wi::scene
 				archive << soundinstance.loop_begin;
 				archive << soundinstance.loop_length;
 			}
+			if (seri.GetVersion() >= 2)
+			{
+				archive << soundinstance.priority;
+			}
 		}
 	}
 	void VideoComponent::Serialize(wi::Archive& archive, EntitySerializer& seri)
@@ -2748,6 +2765,10 @@ namespace wi::scene
 		{
 			ddgi.Serialize(archive);
 		}
+		if (archive.GetVersion() >= 94)
+		{
+			wi::physics::SerializeShapeCache(*this, archive);
+		}
 
 #ifdef _DEBUG
 		FixupNans();
@@ -6,6 +6,7 @@
 #include "wiUnorderedSet.h"
 
 #include <mutex>
+#include <atomic>
 
 #ifdef PLATFORM_WINDOWS_DESKTOP
 #define SHADERCOMPILER_ENABLED
@@ -50,6 +51,7 @@ namespace wi::shadercompiler
 	struct InternalState_DXC
 	{
 		DxcCreateInstanceProc DxcCreateInstance = nullptr;
+		std::string version;
 
 		InternalState_DXC(const std::string& modifier = "")
 		{
@@ -75,6 +77,18 @@ namespace wi::shadercompiler
 					uint32_t major = 0;
 					hr = info->GetVersion(&major, &minor);
 					assert(SUCCEEDED(hr));
+					version = std::to_string(major) + "." + std::to_string(minor);
+					ComPtr<IDxcVersionInfo2> info2;
+					if (SUCCEEDED(dxcCompiler->QueryInterface(IID_PPV_ARGS(&info2))))
+					{
+						uint32_t commit_count = 0;
+						char* commit_hash = nullptr;
+						if (SUCCEEDED(info2->GetCommitInfo(&commit_count, &commit_hash)) && commit_hash != nullptr)
+						{
+							version += std::string(".") + std::to_string(commit_count) + "." + commit_hash;
+							CoTaskMemFree(commit_hash);
+						}
+					}
 					wi::backlog::post("wi::shadercompiler: loaded " + library + " (version: " + std::to_string(major) + "." + std::to_string(minor) + ")");
 				}
 			}
@@ -99,7 +113,8 @@ namespace wi::shadercompiler
 		return internal_state;
 	}
 
-	void Compile_DXCompiler(const CompilerInput& input, CompilerOutput& output)
+	// If preprocessed is not null, only the preprocessor is run and its output is written there
+	void Compile_DXCompiler(const CompilerInput& input, CompilerOutput& output, wi::vector<uint8_t>* preprocessed = nullptr)
 	{
 		InternalState_DXC& compiler_internal = input.format == ShaderFormat::HLSL6_XS ? dxc_compiler_xs() : dxc_compiler();
 		if (compiler_internal.DxcCreateInstance == nullptr)
@@ -425,6 +440,11 @@ namespace wi::shadercompiler
 		}
 #endif // SHADERCOMPILER_XBOX_INCLUDED
 
+		if (preprocessed != nullptr)
+		{
+			args.push_back(L"-P");
+		}
+
 		// Entry point parameter:
 		std::wstring wentry;
 		wi::helper::StringConvert(input.entrypoint, wentry);
@@ -515,6 +535,19 @@ namespace wi::shadercompiler
 			return;
 		}
 
+		if (preprocessed != nullptr)
+		{
+			ComPtr<IDxcBlobUtf8> pHLSL = nullptr;
+			hr = pResults->GetOutput(DXC_OUT_HLSL, IID_PPV_ARGS(&pHLSL), nullptr);
+			if (SUCCEEDED(hr) && pHLSL != nullptr)
+			{
+				output.dependencies.push_back(input.shadersourcefilename);
+				const uint8_t* text = (const uint8_t*)pHLSL->GetStringPointer();
+				preprocessed->assign(text, text + pHLSL->GetStringLength());
+			}
+			return;
+		}
+
 		ComPtr<IDxcBlob> pShader = nullptr;
 		hr = pResults->GetOutput(DXC_OUT_OBJECT, IID_PPV_ARGS(&pShader), nullptr);
 		assert(SUCCEEDED(hr));
@@ -707,11 +740,170 @@ namespace wi::shadercompiler
 	}
 #endif // SHADERCOMPILER_ENABLED_D3DCOMPILER
 
+	// 128-bit content hash, made from two different 64-bit hashes
+	struct ContentHash
+	{
+		uint64_t fnv = 0xcbf29ce484222325ull;
+		size_t combined = 0;
+
+		void add(const void* data, size_t size)
+		{
+			const uint8_t* bytes = (const uint8_t*)data;
+			for (size_t i = 0; i < size; ++i)
+			{
+				fnv ^= bytes[i];
+				fnv *= 0x100000001b3ull;
+				wi::helper::hash_combine(combined, bytes[i]);
+			}
+		}
+		void add(const std::string& str)
+		{
+			add(str.c_str(), str.length() + 1); // including terminator, so that concatenated strings can't alias
+		}
+		std::string str() const
+		{
+			char text[33] = {};
+			snprintf(text, arraysize(text), "%016llx%016llx", (unsigned long long)fnv, (unsigned long long)combined);
+			return text;
+		}
+	};
+
+	std::string cache_directory;
+	std::mutex cache_locker;
+	std::atomic<uint32_t> cache_hits{ 0 };
+	std::atomic<uint32_t> cache_misses{ 0 };
+	std::atomic<uint32_t> cache_shared{ 0 };
+	constexpr const char* shadercacheextension = "wishadercache";
+
+	// Returns empty string if the shader can't be cached
+	//	The dependencies of the shader are also returned, as they are found by the preprocessor
+	std::string ComputeCacheKey(const CompilerInput& input, wi::vector<std::string>& dependencies)
+	{
+		std::string compiler_version;
+		wi::vector<uint8_t> preprocessed;
+
+		switch (input.format)
+		{
+		default:
+			break;
+
+#ifdef SHADERCOMPILER_ENABLED_DXCOMPILER
+		case ShaderFormat::HLSL6:
+		case ShaderFormat::SPIRV:
+		case ShaderFormat::HLSL6_XS:
+			{
+				compiler_version = input.format == ShaderFormat::HLSL6_XS ? dxc_compiler_xs().version : dxc_compiler().version;
+				CompilerOutput output;
+				Compile_DXCompiler(input, output, &preprocessed);
+				dependencies = std::move(output.dependencies);
+			}
+			break;
+#endif // SHADERCOMPILER_ENABLED_DXCOMPILER
+		}
+
+		if (compiler_version.empty() || preprocessed.empty())
+			return {};
+
+		ContentHash hash;
+		hash.add(compiler_version);
+		hash.add(&input.format, sizeof(input.format));
+		hash.add(&input.stage, sizeof(input.stage));
+		hash.add(&input.minshadermodel, sizeof(input.minshadermodel));
+		hash.add(&input.flags, sizeof(input.flags));
+		hash.add(input.entrypoint);
+		for (auto& x : input.defines)
+		{
+			hash.add(x);
+		}
+
+		// Line markers and empty lines are not hashed, so edits in included files that don't affect the code (eg. comments) keep the key:
+		size_t line_start = 0;
+		while (line_start < preprocessed.size())
+		{
+			size_t line_end = line_start;
+			while (line_end < preprocessed.size() && preprocessed[line_end] != '\n')
+			{
+				line_end++;
+			}
+			const char* line = (const char*)preprocessed.data() + line_start;
+			const size_t length = line_end - line_start;
+			const bool line_marker = (length > 5 && std::strncmp(line, "#line", 5) == 0) || (length > 2 && line[0] == '#' && line[1] == ' ');
+			bool empty = true;
+			for (size_t i = 0; i < length && empty; ++i)
+			{
+				empty = std::isspace((unsigned char)line[i]) != 0;
+			}
+			if (!line_marker && !empty)
+			{
+				hash.add(line, length);
+				hash.add("\n", 1);
+			}
+			line_start = line_end + 1;
+		}
+
+		return hash.str();
+	}
+	bool LoadFromCache(const std::string& key, CompilerOutput& output)
+	{
+		std::scoped_lock lock(cache_locker);
+		wi::Archive archive(cache_directory + key + "." + shadercacheextension);
+		if (!archive.IsOpen())
+			return false;
+		std::string binaryname;
+		archive >> binaryname;
+		archive >> output.shaderhash;
+		archive >> output.error_message;
+
+		auto data = std::make_shared<wi::vector<uint8_t>>();
+		if (!wi::helper::FileRead(cache_directory + binaryname, *data))
+			return false;
+		output.shaderdata = data->data();
+		output.shadersize = data->size();
+		output.internal_state = data;
+		return true;
+	}
+	void StoreToCache(const std::string& key, const CompilerOutput& output)
+	{
+		ContentHash hash;
+		hash.add(output.shaderdata, output.shadersize);
+		const std::string binaryname = hash.str() + ".cso";
+
+		std::scoped_lock lock(cache_locker);
+		wi::helper::DirectoryCreate(cache_directory);
+		if (wi::helper::FileExists(cache_directory + binaryname))
+		{
+			cache_shared.fetch_add(1);
+		}
+		else if (!wi::helper::FileWrite(cache_directory + binaryname, output.shaderdata, output.shadersize))
+		{
+			return;
+		}
+		wi::Archive archive(cache_directory + key + "." + shadercacheextension, false);
+		if (archive.IsOpen())
+		{
+			archive << binaryname;
+			archive << output.shaderhash;
+			archive << output.error_message;
+		}
+	}
+
 	void Compile(const CompilerInput& input, CompilerOutput& output)
 	{
 		output = CompilerOutput();
 
 #ifdef SHADERCOMPILER_ENABLED
+		std::string cachekey;
+		if (!cache_directory.empty())
+		{
+			cachekey = ComputeCacheKey(input, output.dependencies);
+			if (!cachekey.empty() && LoadFromCache(cachekey, output))
+			{
+				cache_hits.fetch_add(1);
+				return;
+			}
+			output.dependencies.clear(); // the compiler will report them again
+		}
+
 		switch (input.format)
 		{
 		default:
@@ -738,6 +930,12 @@ namespace wi::shadercompiler
 #endif // SHADERCOMPILER_PS5_INCLUDED
 
 		}
+
+		if (!cachekey.empty() && output.IsValid())
+		{
+			cache_misses.fetch_add(1);
+			StoreToCache(cachekey, output);
+		}
 #endif // SHADERCOMPILER_ENABLED
 	}
 
@@ -839,4 +1037,25 @@ namespace wi::shadercompiler
 #endif // SHADERCOMPILER_ENABLED
 		return false;
 	}
+
+	void SetCacheDirectory(const std::string& directory)
+	{
+		cache_directory = directory;
+		if (!cache_directory.empty() && cache_directory.back() != '/' && cache_directory.back() != '\\')
+		{
+			cache_directory += "/";
+		}
+	}
+	const std::string& GetCacheDirectory()
+	{
+		return cache_directory;
+	}
+	CacheStatistics GetCacheStatistics()
+	{
+		CacheStatistics statistics;
+		statistics.hits = cache_hits.load();
+		statistics.misses = cache_misses.load();
+		statistics.shared = cache_shared.load();
+		return statistics;
+	}
 }
@@ -45,6 +45,21 @@ namespace wi::shadercompiler
 	void RegisterShader(const std::string& shaderfilename);
 	size_t GetRegisteredShaderCount();
 	bool CheckRegisteredShadersOutdated();
+
+	// Persistent, content addressed cache used by Compile():
+	//	The cache key is the hash of the preprocessed source, defines, target format and compiler version
+	//	Shader binaries are stored by the hash of their content, so permutations with identical output share them
+	//	Empty directory disables the cache (default). Currently only the formats compiled with DXCompiler are cached
+	void SetCacheDirectory(const std::string& directory);
+	const std::string& GetCacheDirectory();
+
+	struct CacheStatistics
+	{
+		uint32_t hits = 0;
+		uint32_t misses = 0;
+		uint32_t shared = 0; // misses that produced an already cached shader binary
+	};
+	CacheStatistics GetCacheStatistics();
 }
 
 template<>
@@ -183,6 +183,57 @@ namespace wi::terrain
 		wi::jobsystem::context workload;
 		std::atomic_bool cancelled{ false };
 		wi::vector<SplineComponent> splines;
+
+		// Persistent chunk cache:
+		std::string cache_directory; // empty if cache is disabled
+		size_t cache_signature = 0; // hash of all the parameters that affect generated heights
+
+		static constexpr uint32_t cache_magic = 0x43545721; // "!WTC"
+		static constexpr uint32_t cache_version = 1;
+		struct CacheHeader
+		{
+			uint32_t magic = cache_magic;
+			uint32_t version = cache_version;
+			uint64_t signature = 0;
+			Chunk chunk;
+			uint64_t size = 0; // uncompressed data size
+		};
+
+		std::string cache_path(const Chunk& chunk) const
+		{
+			char name[64] = {};
+			snprintf(name, arraysize(name), "%016llx_%d_%d.witerrainchunk", (unsigned long long)cache_signature, chunk.x, chunk.z);
+			return cache_directory + name;
+		}
+		bool cache_load(const Chunk& chunk, void* data, size_t size) const
+		{
+			wi::vector<uint8_t> filedata;
+			if (!wi::helper::FileRead(cache_path(chunk), filedata) || filedata.size() < sizeof(CacheHeader))
+				return false;
+			CacheHeader header;
+			std::memcpy(&header, filedata.data(), sizeof(header));
+			if (header.magic != cache_magic || header.version != cache_version || header.signature != cache_signature || !(header.chunk == chunk) || header.size != size)
+				return false;
+			wi::vector<uint8_t> decompressed;
+			if (!wi::helper::Decompress(filedata.data() + sizeof(header), filedata.size() - sizeof(header), decompressed) || decompressed.size() != size)
+				return false;
+			std::memcpy(data, decompressed.data(), size);
+			return true;
+		}
+		void cache_save(const Chunk& chunk, const void* data, size_t size) const
+		{
+			wi::vector<uint8_t> filedata(sizeof(CacheHeader));
+			CacheHeader header;
+			header.signature = cache_signature;
+			header.chunk = chunk;
+			header.size = size;
+			std::memcpy(filedata.data(), &header, sizeof(header));
+			wi::vector<uint8_t> compressed;
+			if (!wi::helper::Compress((const uint8_t*)data, size, compressed))
+				return;
+			filedata.insert(filedata.end(), compressed.begin(), compressed.end());
+			wi::helper::FileWrite(cache_path(chunk), filedata.data(), filedata.size());
+		}
 	};
 
 	wi::jobsystem::context virtual_texture_ctx;
@@ -474,6 +525,44 @@ namespace wi::terrain
 			modifier->Seed(seed);
 		}
 
+		// Hash everything that affects generated heights, cached chunks from different parameters will not be used:
+		size_t signature = 0;
+		wi::helper::hash_combine(signature, seed);
+		wi::helper::hash_combine(signature, chunk_scale);
+		wi::helper::hash_combine(signature, bottomLevel);
+		wi::helper::hash_combine(signature, topLevel);
+		for (auto& modifier : modifiers)
+		{
+			wi::helper::hash_combine(signature, (uint32_t)modifier->type);
+			wi::helper::hash_combine(signature, (uint32_t)modifier->blend);
+			wi::helper::hash_combine(signature, modifier->weight);
+			wi::helper::hash_combine(signature, modifier->frequency);
+			switch (modifier->type)
+			{
+			case Modifier::Type::Perlin:
+				wi::helper::hash_combine(signature, ((PerlinModifier*)modifier.get())->octaves);
+				break;
+			case Modifier::Type::Voronoi:
+				wi::helper::hash_combine(signature, ((VoronoiModifier*)modifier.get())->fade);
+				wi::helper::hash_combine(signature, ((VoronoiModifier*)modifier.get())->shape);
+				wi::helper::hash_combine(signature, ((VoronoiModifier*)modifier.get())->falloff);
+				wi::helper::hash_combine(signature, ((VoronoiModifier*)modifier.get())->perturbation);
+				break;
+			case Modifier::Type::Heightmap:
+			{
+				const HeightmapModifier* heightmap = (HeightmapModifier*)modifier.get();
+				wi::helper::hash_combine(signature, heightmap->amount);
+				wi::helper::hash_combine(signature, heightmap->width);
+				wi::helper::hash_combine(signature, heightmap->height);
+				wi::helper::hash_combine(signature, std::string_view((const char*)heightmap->data.data(), heightmap->data.size()));
+			}
+			break;
+			default:
+				break;
+			}
+		}
+		generator->cache_signature = signature;
+
 		// Add some nice weather and lighting if there are no weathers in the scene yet:
 		bool created_terrain_weather = false;
 		if (scene->weathers.GetCount() == 0)
@@ -884,6 +973,20 @@ namespace wi::terrain
 			device->SetName(&chunk_buffer, "wi::terrain::Terrain::chunk_buffer");
 		}
 
+		generator->cache_directory.clear();
+		if (!generation_cache_directory.empty())
+		{
+			generator->cache_directory = generation_cache_directory;
+			if (generator->cache_directory.back() != '/' && generator->cache_directory.back() != '\\')
+			{
+				generator->cache_directory += '/';
+			}
+			if (!wi::helper::DirectoryExists(generator->cache_directory))
+			{
+				wi::helper::DirectoryCreate(generator->cache_directory);
+			}
+		}
+
 		// Start the generation on a background thread and keep it running until the next frame
 		generator->cancelled.store(false);
 		generator->workload.priority = wi::jobsystem::Priority::Low;
@@ -904,254 +1007,291 @@ namespace wi::terrain
 			wi::Timer timer;
 			bool generated_something = false;
 
-			auto request_chunk = [&](int offset_x, int offset_z)
+			// Creates the entities and components of a new chunk
+			//	This modifies the generator scene and the chunks container, so it must not run in parallel
+			auto create_chunk = [&](const Chunk& chunk)
 			{
-				Chunk chunk = center_chunk;
-				chunk.x += offset_x;
-				chunk.z += offset_z;
-				auto it = chunks.find(chunk);
-				if (it == chunks.end() || it->second.entity == INVALID_ENTITY)
-				{
-					// Generate a new chunk:
-					ChunkData& chunk_data = chunks[chunk];
-
-					chunk_data.entity = generator->scene.Entity_CreateObject("chunk_" + std::to_string(chunk.x) + "_" + std::to_string(chunk.z));
-					ObjectComponent& object = *generator->scene.objects.GetComponent(chunk_data.entity);
-					object.lod_bias = lod_bias;
-					object.filterMask |= wi::enums::FILTER_NAVIGATION_MESH;
-					object.filterMask |= wi::enums::FILTER_TERRAIN;
-					generator->scene.Component_Attach(chunk_data.entity, chunkGroupEntity);
-
-					TransformComponent& transform = *generator->scene.transforms.GetComponent(chunk_data.entity);
-					transform.ClearTransform();
-					chunk_data.position = XMFLOAT3(float(chunk.x * (chunk_width - 1)) * chunk_scale, 0, float(chunk.z * (chunk_width - 1)) * chunk_scale);
-					transform.Translate(chunk_data.position);
-					transform.UpdateTransform();
-
-					MaterialComponent& material = generator->scene.materials.Create(chunk_data.entity);
-					// material params will be 1 because they will be created from only texture maps
-					//	because region materials are blended together into one texture
-					material.SetInternal();
-					material.SetRoughness(1);
-					material.SetMetalness(1);
-					material.SetReflectance(1);
-					material.SetEmissiveStrength(100);
-
-					MeshComponent& mesh = generator->scene.meshes.Create(chunk_data.entity);
-					mesh.SetQuantizedPositionsDisabled(true); // connecting meshes quantization is not correct because mismatching AABBs
-					object.meshID = chunk_data.entity;
-					mesh.indices = chunk_indices().indices;
-					for (auto& lod : chunk_indices().lods)
-					{
-						mesh.subsets.emplace_back();
-						mesh.subsets.back().materialID = chunk_data.entity;
-						mesh.subsets.back().indexCount = lod.indexCount;
-						mesh.subsets.back().indexOffset = lod.indexOffset;
-					}
-					mesh.subsets_per_lod = 1;
-					mesh.vertex_positions.resize(vertexCount);
-					mesh.vertex_normals.resize(vertexCount);
-					mesh.vertex_tangents.resize(vertexCount);
-					mesh.vertex_uvset_0.resize(vertexCount);
+				ChunkData& chunk_data = chunks[chunk];
 
-					chunk_data.blendmap_layers.resize(4);
-					for (auto& x : chunk_data.blendmap_layers)
-					{
-						x.pixels.resize(vertexCount);
-					}
+				chunk_data.entity = generator->scene.Entity_CreateObject("chunk_" + std::to_string(chunk.x) + "_" + std::to_string(chunk.z));
+				ObjectComponent& object = *generator->scene.objects.GetComponent(chunk_data.entity);
+				object.lod_bias = lod_bias;
+				object.filterMask |= wi::enums::FILTER_NAVIGATION_MESH;
+				object.filterMask |= wi::enums::FILTER_TERRAIN;
+				generator->scene.Component_Attach(chunk_data.entity, chunkGroupEntity);
+
+				TransformComponent& transform = *generator->scene.transforms.GetComponent(chunk_data.entity);
+				transform.ClearTransform();
+				chunk_data.position = XMFLOAT3(float(chunk.x * (chunk_width - 1)) * chunk_scale, 0, float(chunk.z * (chunk_width - 1)) * chunk_scale);
+				transform.Translate(chunk_data.position);
+				transform.UpdateTransform();
+
+				MaterialComponent& material = generator->scene.materials.Create(chunk_data.entity);
+				// material params will be 1 because they will be created from only texture maps
+				//	because region materials are blended together into one texture
+				material.SetInternal();
+				material.SetRoughness(1);
+				material.SetMetalness(1);
+				material.SetReflectance(1);
+				material.SetEmissiveStrength(100);
+
+				MeshComponent& mesh = generator->scene.meshes.Create(chunk_data.entity);
+				mesh.SetQuantizedPositionsDisabled(true); // connecting meshes quantization is not correct because mismatching AABBs
+				object.meshID = chunk_data.entity;
+				mesh.indices = chunk_indices().indices;
+				for (auto& lod : chunk_indices().lods)
+				{
+					mesh.subsets.emplace_back();
+					mesh.subsets.back().materialID = chunk_data.entity;
+					mesh.subsets.back().indexCount = lod.indexCount;
+					mesh.subsets.back().indexOffset = lod.indexOffset;
+				}
+				mesh.subsets_per_lod = 1;
+				mesh.vertex_positions.resize(vertexCount);
+				mesh.vertex_normals.resize(vertexCount);
+				mesh.vertex_tangents.resize(vertexCount);
+				mesh.vertex_uvset_0.resize(vertexCount);
+
+				chunk_data.blendmap_layers.resize(4);
+				for (auto& x : chunk_data.blendmap_layers)
+				{
+					x.pixels.resize(vertexCount);
+				}
 
-					chunk_data.spline_blendmap_layers.resize(splineMaterialEntities.size());
-					for (auto& x : chunk_data.spline_blendmap_layers)
-					{
-						x.pixels.resize(vertexCount);
-					}
+				chunk_data.spline_blendmap_layers.resize(splineMaterialEntities.size());
+				for (auto& x : chunk_data.spline_blendmap_layers)
+				{
+					x.pixels.resize(vertexCount);
+				}
 
-					chunk_data.mesh_vertex_positions = mesh.vertex_positions.data();
+				chunk_data.mesh_vertex_positions = mesh.vertex_positions.data();
 
-					chunk_data.heightmap_data.resize(vertexCount);
+				chunk_data.heightmap_data.resize(vertexCount);
+			};
 
-					wi::HairParticleSystem grass = grass_properties;
-					grass.vertex_lengths.resize(vertexCount);
-					std::atomic<uint32_t> grass_valid_vertex_count{ 0 };
+			// Computes the vertices, blendmaps, grass and render data of a chunk that was created by create_chunk()
+			//	This only modifies the chunk's own data, so multiple chunks can be computed in parallel
+			auto compute_chunk = [&](const Chunk& chunk, ChunkData& chunk_data)
+			{
+				ObjectComponent& object = *generator->scene.objects.GetComponent(chunk_data.entity);
+				MeshComponent& mesh = *generator->scene.meshes.GetComponent(chunk_data.entity);
+				const TransformComponent& transform = *generator->scene.transforms.GetComponent(chunk_data.entity);
 
-					// Shadow casting will only be enabled for sloped terrain chunks:
-					std::atomic_bool slope_cast_shadow;
-					slope_cast_shadow.store(false);
+				wi::HairParticleSystem grass = grass_properties;
+				grass.vertex_lengths.resize(vertexCount);
+				std::atomic<uint32_t> grass_valid_vertex_count{ 0 };
 
-					// Do a parallel for loop over all the chunk's vertices and compute their properties:
-					wi::jobsystem::context ctx;
-					ctx.priority = wi::jobsystem::Priority::Low;
+				// Shadow casting will only be enabled for sloped terrain chunks:
+				std::atomic_bool slope_cast_shadow;
+				slope_cast_shadow.store(false);
 
-					// Preload height grid with padding, because neighbors will need to be accessed to determine slopes:
-					constexpr int chunk_width_padded = chunk_width + 1;
-					constexpr uint32_t vertexCount_padded = chunk_width_padded * chunk_width_padded;
-					float heights_padded[chunk_width_padded][chunk_width_padded];
-					const XMVECTOR UP = XMVectorSet(0, 1, 0, 0);
-					wi::jobsystem::Dispatch(ctx, vertexCount_padded, chunk_width_padded * 4, [&](wi::jobsystem::JobArgs args) {
-						const uint32_t index = args.jobIndex;
-						const XMUINT2 coord = XMUINT2(index % chunk_width_padded, index / chunk_width_padded);
-						const float x = (float(coord.x) - chunk_half_width) * chunk_scale;
-						const float z = (float(coord.y) - chunk_half_width) * chunk_scale;
+				// Do a parallel for loop over all the chunk's vertices and compute their properties:
+				wi::jobsystem::context ctx;
+				ctx.priority = wi::jobsystem::Priority::Low;
 
-						float height = 0;
-						const XMFLOAT2 world_pos = XMFLOAT2(chunk_data.position.x + x, chunk_data.position.z + z);
-						for (auto& modifier : modifiers)
+				// Preload height grid with padding, because neighbors will need to be accessed to determine slopes:
+				constexpr int chunk_width_padded = chunk_width + 1;
+				float heights_padded[chunk_width_padded][chunk_width_padded];
+				const XMVECTOR UP = XMVectorSet(0, 1, 0, 0);
+
+				// Chunks that are not affected by splines can be loaded from the persistent cache instead of evaluating the modifiers:
+				bool cache_enabled = !generator->cache_directory.empty();
+				if (cache_enabled)
+				{
+					wi::primitive::AABB chunk_aabb;
+					chunk_aabb._min = XMFLOAT3(chunk_data.position.x - chunk_half_width * chunk_scale, 0, chunk_data.position.z - chunk_half_width * chunk_scale);
+					chunk_aabb._max = XMFLOAT3(chunk_data.position.x + (chunk_half_width + 1) * chunk_scale, 0, chunk_data.position.z + (chunk_half_width + 1) * chunk_scale);
+					for (auto& spline : generator->splines)
+					{
+						if (spline.aabb.intersects(chunk_aabb))
 						{
-							modifier->Apply(world_pos, height);
+							cache_enabled = false;
+							break;
 						}
-						height = lerp(bottomLevel, topLevel, height);
-
-						const bool is_real_vertex = coord.x < chunk_width && coord.y < chunk_width;
-						const uint32_t real_index = coord.x + coord.y * chunk_width;
-
-						// Apply splines to height only:
-						const XMVECTOR P = XMVectorSet(world_pos.x, -100000, world_pos.y, 0);
-						int splinematerialcnt = -1;
-						for (size_t j = 0; j < generator->splines.size(); ++j)
+					}
+				}
+				if (!cache_enabled || !generator->cache_load(chunk, heights_padded, sizeof(heights_padded)))
+				{
+					// Each job computes one row of the padded grid, so that modifiers can be evaluated in batches:
+					wi::jobsystem::Dispatch(ctx, chunk_width_padded, 1, [&](wi::jobsystem::JobArgs args) {
+						const uint32_t row = args.jobIndex;
+						const float z = (float(row) - chunk_half_width) * chunk_scale;
+
+						XMFLOAT2 world_positions[chunk_width_padded];
+						float heights[chunk_width_padded];
+						for (uint32_t column = 0; column < chunk_width_padded; ++column)
 						{
-							const SplineComponent& spline = generator->splines[j];
-							if (spline.materialEntity != INVALID_ENTITY)
-								splinematerialcnt++;
-							if (!spline.aabb.intersects(P))
-								continue;
-							XMVECTOR S = spline.TraceSplinePlane(P, UP, 4);
-							S = spline.ClosestPointOnSpline(S, 4);
-							const float splineheight = XMVectorGetY(S);
-							const float splinedist = wi::math::Distance(XMVectorSetY(P, splineheight), S);
-							const float splinefactor = 1.0f - smoothstep(0.0f, 1.0f, saturate(splinedist * sqr(spline.terrain_modifier_amount)));
-							if (is_real_vertex && spline.materialEntity != INVALID_ENTITY)
-							{
-								chunk_data.spline_blendmap_layers[splinematerialcnt].pixels[real_index] = uint8_t(smoothstep(clamp(spline.terrain_texture_falloff, 0.0f, 0.999f), 1.0f, splinefactor) * 255);
-							}
-							height = lerp(height, splineheight - spline.terrain_pushdown, splinefactor);
+							const float x = (float(column) - chunk_half_width) * chunk_scale;
+							world_positions[column] = XMFLOAT2(chunk_data.position.x + x, chunk_data.position.z + z);
 						}
+						ComputeHeights(world_positions, heights, chunk_width_padded);
 
-						heights_padded[coord.x][coord.y] = height;
-					});
-					wi::jobsystem::Wait(ctx);
-
-					wi::jobsystem::Dispatch(ctx, vertexCount, chunk_width * 4, [&](wi::jobsystem::JobArgs args) {
-						const uint32_t index = args.jobIndex;
-						const XMUINT2 coord = XMUINT2(index % chunk_width, index / chunk_width);
-						const float x = (float(coord.x) - chunk_half_width) * chunk_scale;
-						const float z = (float(coord.y) - chunk_half_width) * chunk_scale;
-						const float height = heights_padded[coord.x][coord.y];
-						const XMVECTOR corners[3] = {
-							XMVectorSet(chunk_data.position.x + x, height, chunk_data.position.z + z, 0),
-							XMVectorSet(chunk_data.position.x + x + 1, heights_padded[coord.x + 1][coord.y], chunk_data.position.z + z, 0),
-							XMVectorSet(chunk_data.position.x + x, heights_padded[coord.x][coord.y + 1], chunk_data.position.z + z + 1, 0),
-						};
-						const XMVECTOR T = XMVectorSubtract(corners[1], corners[2]);
-						const XMVECTOR B = XMVectorSubtract(corners[0], corners[1]);
-						const XMVECTOR N = XMVector3Normalize(XMVector3Cross(T, B));
-						XMFLOAT3 normal;
-						XMStoreFloat3(&normal, N);
-
-						const float slope_amount = 1.0f - saturate(normal.y);
-						if (slope_amount > 0.1f)
-							slope_cast_shadow.store(true);
-
-						float region_base = 1;
-						float region_slope = region1 == 0 ? 1 : smoothstep(0.0f, region1, slope_amount);
-						float region_low_altitude = region2 == 0 ? 1 : smoothstep(0.0f, region2, wi::math::InverseLerp(0, bottomLevel, height));
-						float region_high_altitude = region3 == 0 ? 1 : smoothstep(0.0f, region3, wi::math::InverseLerp(0, topLevel, height));
-
-						region_low_altitude = saturate(region_low_altitude - region_slope);
-						region_high_altitude = saturate(region_high_altitude - region_slope);
-
-						XMFLOAT4 materialBlendWeights(region_base, region_slope, region_low_altitude, region_high_altitude);
-
-						chunk_data.blendmap_layers[0].pixels[index] = uint8_t(materialBlendWeights.x * 255);
-						chunk_data.blendmap_layers[1].pixels[index] = uint8_t(materialBlendWeights.y * 255);
-						chunk_data.blendmap_layers[2].pixels[index] = uint8_t(materialBlendWeights.z * 255);
-						chunk_data.blendmap_layers[3].pixels[index] = uint8_t(materialBlendWeights.w * 255);
-
-						// Normalize after store, blending shader wants unnormalized!
-						weight_norm(materialBlendWeights);
-
-						mesh.vertex_positions[index] = XMFLOAT3(x, height, z);
-						mesh.vertex_normals[index] = normal;
-						XMStoreFloat4(&mesh.vertex_tangents[index], T);
-						mesh.vertex_tangents[index].w = 1;
-						const XMFLOAT2 uv = XMFLOAT2(x * chunk_scale_rcp * chunk_width_rcp + 0.5f, z * chunk_scale_rcp * chunk_width_rcp + 0.5f);
-						mesh.vertex_uvset_0[index] = uv;
-
-						XMFLOAT3 vertex_pos(chunk_data.position.x + x, height, chunk_data.position.z + z);
-
-						float spline_factor = 0;
-						if (!chunk_data.spline_blendmap_layers.empty())
+						for (uint32_t column = 0; column < chunk_width_padded; ++column)
 						{
-							for (auto& y : chunk_data.spline_blendmap_layers)
+							const XMUINT2 coord = XMUINT2(column, row);
+							const XMFLOAT2& world_pos = world_positions[column];
+							float height = heights[column];
+
+							const bool is_real_vertex = coord.x < chunk_width && coord.y < chunk_width;
+							const uint32_t real_index = coord.x + coord.y * chunk_width;
+
+							// Apply splines to height only:
+							const XMVECTOR P = XMVectorSet(world_pos.x, -100000, world_pos.y, 0);
+							int splinematerialcnt = -1;
+							for (size_t j = 0; j < generator->splines.size(); ++j)
 							{
-								spline_factor += float(y.pixels[index]) / 255.0f;
+								const SplineComponent& spline = generator->splines[j];
+								if (spline.materialEntity != INVALID_ENTITY)
+									splinematerialcnt++;
+								if (!spline.aabb.intersects(P))
+									continue;
+								XMVECTOR S = spline.TraceSplinePlane(P, UP, 4);
+								S = spline.ClosestPointOnSpline(S, 4);
+								const float splineheight = XMVectorGetY(S);
+								const float splinedist = wi::math::Distance(XMVectorSetY(P, splineheight), S);
+								const float splinefactor = 1.0f - smoothstep(0.0f, 1.0f, saturate(splinedist * sqr(spline.terrain_modifier_amount)));
+								if (is_real_vertex && spline.materialEntity != INVALID_ENTITY)
+								{
+									chunk_data.spline_blendmap_layers[splinematerialcnt].pixels[real_index] = uint8_t(smoothstep(clamp(spline.terrain_texture_falloff, 0.0f, 0.999f), 1.0f, splinefactor) * 255);
+								}
+								height = lerp(height, splineheight - spline.terrain_pushdown, splinefactor);
 							}
-							spline_factor /= float(chunk_data.spline_blendmap_layers.size());
-						}
 
-						const float grass_noise_frequency = 0.1f;
-						const float grass_noise = perlin_noise.compute(vertex_pos.x * grass_noise_frequency, vertex_pos.y * grass_noise_frequency, vertex_pos.z * grass_noise_frequency) * 0.5f + 0.5f;
-						const float region_grass = std::pow(materialBlendWeights.x * (1 - materialBlendWeights.w), 8.0f) * grass_noise * (1 - saturate(spline_factor));
-						if (region_grass > 0.1f)
-						{
-							grass_valid_vertex_count.fetch_add(1);
-							grass.vertex_lengths[index] = region_grass;
+							heights_padded[coord.x][coord.y] = height;
 						}
-						else
-						{
-							grass.vertex_lengths[index] = 0;
-						}
-						chunk_data.heightmap_data[index] = uint16_t(inverse_lerp(bottomLevel, topLevel, height) * 65535);
-					});
-					wi::jobsystem::Wait(ctx); // wait until chunk's vertex buffer is fully generated
-
-					object.SetCastShadow(slope_cast_shadow.load());
-					mesh.SetDoubleSidedShadow(slope_cast_shadow.load());
-
-					wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
-						mesh.CreateRenderData();
-						chunk_data.sphere.center = mesh.aabb.getCenter();
-						chunk_data.sphere.center.x += chunk_data.position.x;
-						chunk_data.sphere.center.y += chunk_data.position.y;
-						chunk_data.sphere.center.z += chunk_data.position.z;
-						chunk_data.sphere.radius = mesh.aabb.getRadius();
-						mesh.SetBVHEnabled(true);
 					});
+					wi::jobsystem::Wait(ctx);
 
-					// If there were any vertices in this chunk that could be valid for grass, store the grass particle system:
-					if (grass_valid_vertex_count.load() > 0)
+					if (cache_enabled)
 					{
-						chunk_data.grass = std::move(grass); // the grass will be added to the scene later, only when the chunk is close to the camera (center chunk's neighbors)
-						chunk_data.grass.meshID = chunk_data.entity;
-						chunk_data.grass.strandCount = uint32_t(grass_valid_vertex_count.load() * 3 * chunk_scale * chunk_scale); // chunk_scale * chunk_scale : grass density increases with squared amount with chunk scale (x*z)
-						chunk_data.grass.CreateFromMesh(mesh);
+						generator->cache_save(chunk, heights_padded, sizeof(heights_padded));
 					}
+				}
 
-					// Create the textures for virtual texture update:
-					CreateChunkRegionTexture(chunk_data);
+				wi::jobsystem::Dispatch(ctx, vertexCount, chunk_width * 4, [&](wi::jobsystem::JobArgs args) {
+					const uint32_t index = args.jobIndex;
+					const XMUINT2 coord = XMUINT2(index % chunk_width, index / chunk_width);
+					const float x = (float(coord.x) - chunk_half_width) * chunk_scale;
+					const float z = (float(coord.y) - chunk_half_width) * chunk_scale;
+					const float height = heights_padded[coord.x][coord.y];
+					const XMVECTOR corners[3] = {
+						XMVectorSet(chunk_data.position.x + x, height, chunk_data.position.z + z, 0),
+						XMVectorSet(chunk_data.position.x + x + 1, heights_padded[coord.x + 1][coord.y], chunk_data.position.z + z, 0),
+						XMVectorSet(chunk_data.position.x + x, heights_padded[coord.x][coord.y + 1], chunk_data.position.z + z + 1, 0),
+					};
+					const XMVECTOR T = XMVectorSubtract(corners[1], corners[2]);
+					const XMVECTOR B = XMVectorSubtract(corners[0], corners[1]);
+					const XMVECTOR N = XMVector3Normalize(XMVector3Cross(T, B));
+					XMFLOAT3 normal;
+					XMStoreFloat3(&normal, N);
+
+					const float slope_amount = 1.0f - saturate(normal.y);
+					if (slope_amount > 0.1f)
+						slope_cast_shadow.store(true);
+
+					float region_base = 1;
+					float region_slope = region1 == 0 ? 1 : smoothstep(0.0f, region1, slope_amount);
+					float region_low_altitude = region2 == 0 ? 1 : smoothstep(0.0f, region2, wi::math::InverseLerp(0, bottomLevel, height));
+					float region_high_altitude = region3 == 0 ? 1 : smoothstep(0.0f, region3, wi::math::InverseLerp(0, topLevel, height));
+
+					region_low_altitude = saturate(region_low_altitude - region_slope);
+					region_high_altitude = saturate(region_high_altitude - region_slope);
+
+					XMFLOAT4 materialBlendWeights(region_base, region_slope, region_low_altitude, region_high_altitude);
+
+					chunk_data.blendmap_layers[0].pixels[index] = uint8_t(materialBlendWeights.x * 255);
+					chunk_data.blendmap_layers[1].pixels[index] = uint8_t(materialBlendWeights.y * 255);
+					chunk_data.blendmap_layers[2].pixels[index] = uint8_t(materialBlendWeights.z * 255);
+					chunk_data.blendmap_layers[3].pixels[index] = uint8_t(materialBlendWeights.w * 255);
+
+					// Normalize after store, blending shader wants unnormalized!
+					weight_norm(materialBlendWeights);
+
+					mesh.vertex_positions[index] = XMFLOAT3(x, height, z);
+					mesh.vertex_normals[index] = normal;
+					XMStoreFloat4(&mesh.vertex_tangents[index], T);
+					mesh.vertex_tangents[index].w = 1;
+					const XMFLOAT2 uv = XMFLOAT2(x * chunk_scale_rcp * chunk_width_rcp + 0.5f, z * chunk_scale_rcp * chunk_width_rcp + 0.5f);
+					mesh.vertex_uvset_0[index] = uv;
+
+					XMFLOAT3 vertex_pos(chunk_data.position.x + x, height, chunk_data.position.z + z);
+
+					float spline_factor = 0;
+					if (!chunk_data.spline_blendmap_layers.empty())
+					{
+						for (auto& y : chunk_data.spline_blendmap_layers)
+						{
+							spline_factor += float(y.pixels[index]) / 255.0f;
+						}
+						spline_factor /= float(chunk_data.spline_blendmap_layers.size());
+					}
 
-					if (IsPhysicsEnabled())
+					const float grass_noise_frequency = 0.1f;
+					const float grass_noise = perlin_noise.compute(vertex_pos.x * grass_noise_frequency, vertex_pos.y * grass_noise_frequency, vertex_pos.z * grass_noise_frequency) * 0.5f + 0.5f;
+					const float region_grass = std::pow(materialBlendWeights.x * (1 - materialBlendWeights.w), 8.0f) * grass_noise * (1 - saturate(spline_factor));
+					if (region_grass > 0.1f)
 					{
-						// Precompute the physics shape here on separate thread, because computing shape for triangle mesh would be slow on main thread:
-						//	Note that this is mesh.precomputed_rigidbody_physics_shape and not a component in scene.rigidbodies, so this only contains the shape, not the simulated rigid bodies
-						RigidBodyPhysicsComponent& newrigidbody = mesh.precomputed_rigidbody_physics_shape;
-						newrigidbody.shape = RigidBodyPhysicsComponent::HEIGHTFIELD;
-						newrigidbody.mass = 0; // terrain chunks are static
-						newrigidbody.friction = 0.8f;
-						//newrigidbody.mesh_lod = 2;
-						wi::physics::CreateRigidBodyShape(newrigidbody, transform.scale_local, &mesh);
+						grass_valid_vertex_count.fetch_add(1);
+						grass.vertex_lengths[index] = region_grass;
 					}
+					else
+					{
+						grass.vertex_lengths[index] = 0;
+					}
+					chunk_data.heightmap_data[index] = uint16_t(inverse_lerp(bottomLevel, topLevel, height) * 65535);
+				});
+				wi::jobsystem::Wait(ctx); // wait until chunk's vertex buffer is fully generated
+
+				object.SetCastShadow(slope_cast_shadow.load());
+				mesh.SetDoubleSidedShadow(slope_cast_shadow.load());
+
+				wi::jobsystem::Execute(ctx, [&](wi::jobsystem::JobArgs args) {
+					mesh.CreateRenderData();
+					chunk_data.sphere.center = mesh.aabb.getCenter();
+					chunk_data.sphere.center.x += chunk_data.position.x;
+					chunk_data.sphere.center.y += chunk_data.position.y;
+					chunk_data.sphere.center.z += chunk_data.position.z;
+					chunk_data.sphere.radius = mesh.aabb.getRadius();
+					mesh.SetBVHEnabled(true);
+				});
+
+				// If there were any vertices in this chunk that could be valid for grass, store the grass particle system:
+				if (grass_valid_vertex_count.load() > 0)
+				{
+					chunk_data.grass = std::move(grass); // the grass will be added to the scene later, only when the chunk is close to the camera (center chunk's neighbors)
+					chunk_data.grass.meshID = chunk_data.entity;
+					chunk_data.grass.strandCount = uint32_t(grass_valid_vertex_count.load() * 3 * chunk_scale * chunk_scale); // chunk_scale * chunk_scale : grass density increases with squared amount with chunk scale (x*z)
+					chunk_data.grass.CreateFromMesh(mesh);
+				}
 
-					wi::jobsystem::Wait(ctx); // wait until mesh.CreateRenderData() async task finishes
+				// Create the textures for virtual texture update:
+				CreateChunkRegionTexture(chunk_data);
 
-					generated_something = true;
+				if (IsPhysicsEnabled())
+				{
+					// Precompute the physics shape here on separate thread, because computing shape for triangle mesh would be slow on main thread:
+					//	Note that this is mesh.precomputed_rigidbody_physics_shape and not a component in scene.rigidbodies, so this only contains the shape, not the simulated rigid bodies
+					RigidBodyPhysicsComponent& newrigidbody = mesh.precomputed_rigidbody_physics_shape;
+					newrigidbody.shape = RigidBodyPhysicsComponent::HEIGHTFIELD;
+					newrigidbody.mass = 0; // terrain chunks are static
+					newrigidbody.friction = 0.8f;
+					//newrigidbody.mesh_lod = 2;
+					wi::physics::CreateRigidBodyShape(newrigidbody, transform.scale_local, &mesh);
 				}
 
+				wi::jobsystem::Wait(ctx); // wait until mesh.CreateRenderData() async task finishes
+			};
+
+			// Places grass and props on an already generated chunk
+			//	This modifies the generator scene, so it must not run in parallel
+			auto populate_chunk = [&](const Chunk& chunk)
+			{
 				const int dist = std::max(std::abs(center_chunk.x - chunk.x), std::abs(center_chunk.z - chunk.z));
 
 				// Grass patch placement:
 				if (dist <= grass_chunk_dist && IsGrassEnabled())
 				{
-					it = chunks.find(chunk);
+					auto it = chunks.find(chunk);
 					if (it != chunks.end() && it->second.entity != INVALID_ENTITY)
 					{
 						ChunkData& chunk_data = it->second;
@@ -1176,7 +1316,7 @@ namespace wi::terrain
 				// Prop placement:
 				if (dist <= prop_generation)
 				{
-					it = chunks.find(chunk);
+					auto it = chunks.find(chunk);
 					if (it != chunks.end() && it->second.entity != INVALID_ENTITY)
 					{
 						ChunkData& chunk_data = it->second;
@@ -1289,19 +1429,18 @@ namespace wi::terrain
 						}
 					}
 				}
-
-				if (generated_something && timer.elapsed_milliseconds() > generation_time_budget_milliseconds)
-				{
-					generator->cancelled.store(true);
-				}
-
 			};
 
-			// generate center chunk first:
+			// The chunks are requested in distance priority order: center chunk first, then neighbor chunks in outward spiral
+			wi::vector<Chunk> requests;
+			auto request_chunk = [&](int offset_x, int offset_z)
+			{
+				Chunk chunk = center_chunk;
+				chunk.x += offset_x;
+				chunk.z += offset_z;
+				requests.push_back(chunk);
+			};
 			request_chunk(0, 0);
-			if (generator->cancelled.load()) return;
-
-			// then generate neighbor chunks in outward spiral:
 			for (int growth = 0; growth < generation; ++growth)
 			{
 				const int side = 2 * (growth + 1);
@@ -1310,29 +1449,93 @@ namespace wi::terrain
 				for (int i = 0; i < side; ++i)
 				{
 					request_chunk(x, z);
-					if (generator->cancelled.load()) return;
 					x++;
 				}
 				for (int i = 0; i < side; ++i)
 				{
 					request_chunk(x, z);
-					if (generator->cancelled.load()) return;
 					z++;
 				}
 				for (int i = 0; i < side; ++i)
 				{
 					request_chunk(x, z);
-					if (generator->cancelled.load()) return;
 					x--;
 				}
 				for (int i = 0; i < side; ++i)
 				{
 					request_chunk(x, z);
-					if (generator->cancelled.load()) return;
 					z--;
 				}
 			}
 
+			const size_t parallel_chunks = (size_t)std::max(1, generation_parallel_chunks);
+			wi::vector<Chunk> batch;
+			wi::vector<uint8_t> batch_completed;
+			size_t next_request = 0;
+			while (next_request < requests.size())
+			{
+				if (generator->cancelled.load())
+					return;
+
+				// Walk the requests in order until enough new chunks are found that will be generated together:
+				const size_t first_request = next_request;
+				batch.clear();
+				while (next_request < requests.size() && batch.size() < parallel_chunks)
+				{
+					const Chunk& chunk = requests[next_request++];
+					auto it = chunks.find(chunk);
+					if (it == chunks.end() || it->second.entity == INVALID_ENTITY)
+					{
+						create_chunk(chunk);
+						batch.push_back(chunk);
+					}
+				}
+
+				if (!batch.empty())
+				{
+					batch_completed.clear();
+					batch_completed.resize(batch.size());
+
+					// The chunks container is not modified while the batch is computed, so chunk data references remain valid:
+					wi::jobsystem::context batch_ctx;
+					batch_ctx.priority = wi::jobsystem::Priority::Low;
+					wi::jobsystem::Dispatch(batch_ctx, (uint32_t)batch.size(), 1, [&](wi::jobsystem::JobArgs args) {
+						if (generator->cancelled.load())
+							return; // cancellation is checked for each chunk, so a large batch can exit early
+						const Chunk& chunk = batch[args.jobIndex];
+						compute_chunk(chunk, chunks.find(chunk)->second);
+						batch_completed[args.jobIndex] = 1;
+					});
+					wi::jobsystem::Wait(batch_ctx);
+
+					for (size_t i = 0; i < batch.size(); ++i)
+					{
+						if (batch_completed[i])
+						{
+							generated_something = true;
+							continue;
+						}
+						// Chunks that were cancelled before being computed are removed, they will be requested again by the next generation:
+						auto it = chunks.find(batch[i]);
+						generator->scene.Entity_Remove(it->second.entity);
+						chunks.erase(it);
+					}
+				}
+
+				if (generator->cancelled.load())
+					return;
+
+				for (size_t i = first_request; i < next_request; ++i)
+				{
+					populate_chunk(requests[i]);
+				}
+
+				if (generated_something && timer.elapsed_milliseconds() > generation_time_budget_milliseconds)
+				{
+					generator->cancelled.store(true);
+				}
+			}
+
 			});
 
 	}
@@ -2069,6 +2272,19 @@ namespace wi::terrain
 		device->EventEnd(cmd);
 	}
 
+	void Terrain::ComputeHeights(const XMFLOAT2* world_positions, float* heights, size_t count) const
+	{
+		std::fill(heights, heights + count, 0.0f);
+		for (auto& modifier : modifiers)
+		{
+			modifier->ApplyBatch(world_positions, heights, count);
+		}
+		for (size_t i = 0; i < count; ++i)
+		{
+			heights[i] = lerp(bottomLevel, topLevel, heights[i]);
+		}
+	}
+
 	ShaderTerrain Terrain::GetShaderTerrain() const
 	{
 		GraphicsDevice* device = GetDevice();
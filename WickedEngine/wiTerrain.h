@@ -293,6 +293,8 @@ namespace wi::terrain
 
 		// For generating scene on a background thread:
 		float generation_time_budget_milliseconds = 8; // after this much time, the generation thread will start to exit. This can help avoid a very long running, resource consuming and slow cancellation generation
+		int generation_parallel_chunks = 4; // how many new chunks can be generated at the same time
+		std::string generation_cache_directory; // if not empty, generated chunk heights will be stored in this directory and reused by later generations with the same parameters
 		std::shared_ptr<Generator> generator;
 
 		wi::vector<VirtualTexture*> virtual_textures_in_use;
@@ -354,6 +356,10 @@ namespace wi::terrain
 
 		ShaderTerrain GetShaderTerrain() const;
 
+		// Computes the terrain heights in world space from the modifiers at multiple world space XZ positions at once
+		//	Splines are not taken into account
+		void ComputeHeights(const XMFLOAT2* world_positions, float* heights, size_t count) const;
+
 		void InvalidateProps();
 
 		void Serialize(wi::Archive& archive, wi::ecs::EntitySerializer& seri);
@@ -389,6 +395,14 @@ namespace wi::terrain
 
 		virtual void Seed(uint32_t seed) {}
 		virtual void Apply(const XMFLOAT2& world_pos, float& height) = 0;
+		// Applies the modifier to multiple positions at once, results match calling Apply() for each of them
+		virtual void ApplyBatch(const XMFLOAT2* world_positions, float* heights, size_t count)
+		{
+			for (size_t i = 0; i < count; ++i)
+			{
+				Apply(world_positions[i], heights[i]);
+			}
+		}
 		constexpr void Blend(float& height, float value)
 		{
 			switch (blend)
@@ -405,6 +419,23 @@ namespace wi::terrain
 				break;
 			}
 		}
+		// Loads up to 4 positions scaled by frequency into SoA vectors, missing lanes are filled by repeating the last position
+		//	returns the number of valid lanes
+		inline size_t LoadBatch(const XMFLOAT2* world_positions, size_t count, XMVECTOR& x, XMVECTOR& y) const
+		{
+			const size_t valid = std::min(count, size_t(4));
+			XMFLOAT4A px, py;
+			for (size_t i = 0; i < 4; ++i)
+			{
+				const XMFLOAT2& p = world_positions[std::min(i, valid - 1)];
+				(&px.x)[i] = p.x;
+				(&py.x)[i] = p.y;
+			}
+			const XMVECTOR F = XMVectorReplicate(frequency);
+			x = XMVectorMultiply(XMLoadFloat4A(&px), F);
+			y = XMVectorMultiply(XMLoadFloat4A(&py), F);
+			return valid;
+		}
 	};
 	struct PerlinModifier : public Modifier
 	{
@@ -425,6 +456,21 @@ namespace wi::terrain
 			p.y *= frequency;
 			Blend(height, perlin_noise.compute(p.x, p.y, 0, octaves) * 0.5f + 0.5f);
 		}
+		void ApplyBatch(const XMFLOAT2* world_positions, float* heights, size_t count) override
+		{
+			const XMVECTOR half = XMVectorReplicate(0.5f);
+			for (size_t i = 0; i < count; i += 4)
+			{
+				XMVECTOR x, y;
+				const size_t valid = LoadBatch(world_positions + i, count - i, x, y);
+				XMFLOAT4A values;
+				XMStoreFloat4A(&values, XMVectorAdd(XMVectorMultiply(perlin_noise.compute(x, y, XMVectorZero(), octaves), half), half));
+				for (size_t j = 0; j < valid; ++j)
+				{
+					Blend(heights[i + j], (&values.x)[j]);
+				}
+			}
+		}
 	};
 	struct VoronoiModifier : public Modifier
 	{
@@ -456,6 +502,32 @@ namespace wi::terrain
 			float weight = std::pow(1 - saturate((res.distance - shape) * fade), std::max(0.0001f, falloff));
 			Blend(height, weight);
 		}
+		void ApplyBatch(const XMFLOAT2* world_positions, float* heights, size_t count) override
+		{
+			for (size_t i = 0; i < count; i += 4)
+			{
+				XMVECTOR x, y;
+				const size_t valid = LoadBatch(world_positions + i, count - i, x, y);
+				if (perturbation > 0)
+				{
+					XMFLOAT4A angle;
+					XMStoreFloat4A(&angle, XMVectorMultiply(perlin_noise.compute(x, y, XMVectorZero(), 6), XMVectorReplicate(XM_2PI)));
+					const XMVECTOR S = XMVectorSet(std::sin(angle.x), std::sin(angle.y), std::sin(angle.z), std::sin(angle.w));
+					const XMVECTOR C = XMVectorSet(std::cos(angle.x), std::cos(angle.y), std::cos(angle.z), std::cos(angle.w));
+					const XMVECTOR P = XMVectorReplicate(perturbation);
+					x = XMVectorAdd(x, XMVectorMultiply(S, P));
+					y = XMVectorAdd(y, XMVectorMultiply(C, P));
+				}
+				wi::noise::voronoi::Result4 res = wi::noise::voronoi::compute(x, y, (float)seed);
+				XMFLOAT4A distance;
+				XMStoreFloat4A(&distance, res.distance);
+				for (size_t j = 0; j < valid; ++j)
+				{
+					float weight = std::pow(1 - saturate(((&distance.x)[j] - shape) * fade), std::max(0.0001f, falloff));
+					Blend(heights[i + j], weight);
+				}
+			}
+		}
 	};
 	struct HeightmapModifier : public Modifier
 	{
@@ -487,6 +559,48 @@ namespace wi::terrain
 				Blend(height, value * amount);
 			}
 		}
+		void ApplyBatch(const XMFLOAT2* world_positions, float* heights, size_t count) override
+		{
+			const bool format_8bit = data.size() == this->width * this->height * sizeof(uint8_t);
+			const bool format_16bit = data.size() == this->width * this->height * sizeof(uint16_t);
+			const XMVECTOR W = XMVectorReplicate(float(this->width));
+			const XMVECTOR H = XMVectorReplicate(float(this->height));
+			const XMVECTOR half = XMVectorReplicate(0.5f);
+			for (size_t i = 0; i < count; i += 4)
+			{
+				XMVECTOR x, y;
+				const size_t valid = LoadBatch(world_positions + i, count - i, x, y);
+				x = XMVectorAdd(x, XMVectorMultiply(W, half));
+				y = XMVectorAdd(y, XMVectorMultiply(H, half));
+				const XMVECTOR inside = XMVectorAndInt(
+					XMVectorAndInt(XMVectorGreaterOrEqual(x, XMVectorZero()), XMVectorLess(x, W)),
+					XMVectorAndInt(XMVectorGreaterOrEqual(y, XMVectorZero()), XMVectorLess(y, H))
+				);
+				const int inside_mask = _mm_movemask_ps(inside);
+				if (inside_mask == 0)
+					continue;
+				alignas(16) int32_t px[4];
+				alignas(16) int32_t py[4];
+				_mm_store_si128((__m128i*)px, _mm_cvttps_epi32(x));
+				_mm_store_si128((__m128i*)py, _mm_cvttps_epi32(y));
+				for (size_t j = 0; j < valid; ++j)
+				{
+					if ((inside_mask & (1 << j)) == 0)
+						continue;
+					const int idx = px[j] + py[j] * this->width;
+					float value = 0;
+					if (format_8bit)
+					{
+						value = ((float)data[idx] / 255.0f);
+					}
+					else if (format_16bit)
+					{
+						value = ((float)((uint16_t*)data.data())[idx] / 65535.0f);
+					}
+					Blend(heights[i + j], value * amount);
+				}
+			}
+		}
 	};
 
 }
@@ -0,0 +1,963 @@
+#include "wiTextureCooker.h"
+#include "wiHelper.h"
+#include "wiJobSystem.h"
+#include "wiMath.h"
+#include "wiBacklog.h"
+#include "wiTimer.h"
+
+#include "Utility/stb_image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <mutex>
+
+using namespace wi::graphics;
+
+namespace wi::texturecooker
+{
+	static constexpr uint32_t COOKER_VERSION = 2; // increment when the output changes, this invalidates the cache
+	static constexpr uint32_t BLOCK_SIZE = 4;
+
+	struct SRGBTables
+	{
+		float to_linear[256];
+		static constexpr uint32_t TO_SRGB_COUNT = 16384;
+		uint8_t to_srgb[TO_SRGB_COUNT];
+
+		SRGBTables()
+		{
+			for (uint32_t i = 0; i < arraysize(to_linear); ++i)
+			{
+				const float c = i / 255.0f;
+				to_linear[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+			}
+			for (uint32_t i = 0; i < TO_SRGB_COUNT; ++i)
+			{
+				const float c = (i + 0.5f) / TO_SRGB_COUNT;
+				const float s = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+				to_srgb[i] = (uint8_t)std::min(255.0f, s * 255.0f + 0.5f);
+			}
+		}
+	};
+	static const SRGBTables& srgb_tables()
+	{
+		static SRGBTables tables;
+		return tables;
+	}
+	inline float SRGBToLinear(float c)
+	{
+		return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+	}
+	inline uint8_t LinearToSRGB8(float c)
+	{
+		const uint32_t index = (uint32_t)std::min(float(SRGBTables::TO_SRGB_COUNT - 1), std::max(0.0f, c * SRGBTables::TO_SRGB_COUNT));
+		return srgb_tables().to_srgb[index];
+	}
+	inline uint8_t UNORM8(float c)
+	{
+		return (uint8_t)std::min(255.0f, std::max(0.0f, c * 255.0f + 0.5f));
+	}
+
+	struct Image
+	{
+		uint32_t width = 0;
+		uint32_t height = 0;
+		wi::vector<XMFLOAT4A> pixels;
+	};
+
+	inline float BesselI0(float x)
+	{
+		float sum = 1;
+		float term = 1;
+		const float y = x * x * 0.25f;
+		for (int k = 1; k < 32; ++k)
+		{
+			term *= y / float(k * k);
+			sum += term;
+			if (term < sum * 1e-8f)
+				break;
+		}
+		return sum;
+	}
+	inline float Sinc(float x)
+	{
+		if (std::abs(x) < 1e-5f)
+			return 1;
+		x *= XM_PI;
+		return std::sin(x) / x;
+	}
+
+	// The filter taps of one axis, for every destination pixel
+	struct FilterTaps
+	{
+		wi::vector<uint32_t> offsets; // first tap of destination pixel, offsets[i + 1] - offsets[i] is the tap count
+		wi::vector<uint32_t> indices;
+		wi::vector<float> weights;
+	};
+	static void ComputeFilterTaps(uint32_t src_size, uint32_t dst_size, MipFilter filter, FilterTaps& taps)
+	{
+		static constexpr float kaiser_width = 3; // destination pixels
+		static constexpr float kaiser_alpha = 4;
+		const float kaiser_norm = 1.0f / BesselI0(kaiser_alpha);
+
+		const float support = filter == MipFilter::KAISER ? kaiser_width : 0.5f;
+		const float scale = float(src_size) / float(dst_size);
+		const float radius = support * scale;
+
+		taps.offsets.resize(dst_size + 1);
+		taps.indices.clear();
+		taps.weights.clear();
+		for (uint32_t i = 0; i < dst_size; ++i)
+		{
+			taps.offsets[i] = (uint32_t)taps.indices.size();
+			const float center = (i + 0.5f) * scale;
+			const int first = (int)std::floor(center - radius);
+			const int last = (int)std::ceil(center + radius);
+			float sum = 0;
+			for (int j = first; j <= last; ++j)
+			{
+				const float t = (j + 0.5f - center) / scale;
+				float weight = 0;
+				if (filter == MipFilter::KAISER)
+				{
+					if (std::abs(t) < kaiser_width)
+					{
+						const float r = t / kaiser_width;
+						weight = Sinc(t) * BesselI0(kaiser_alpha * std::sqrt(std::max(0.0f, 1 - r * r))) * kaiser_norm;
+					}
+				}
+				else
+				{
+					weight = std::abs(t) <= 0.5f ? 1.0f : 0.0f;
+				}
+				if (std::abs(weight) < 1e-6f)
+					continue;
+				taps.indices.push_back((uint32_t)std::clamp(j, 0, int(src_size) - 1)); // clamp to edge
+				taps.weights.push_back(weight);
+				sum += weight;
+			}
+			const float inv_sum = sum != 0 ? 1.0f / sum : 0.0f;
+			for (size_t t = taps.offsets[i]; t < taps.weights.size(); ++t)
+			{
+				taps.weights[t] *= inv_sum;
+			}
+		}
+		taps.offsets[dst_size] = (uint32_t)taps.indices.size();
+	}
+
+	// Separable resampling to the next mip level, the rows are processed in parallel
+	//	alpha_weighted: color is weighted by alpha, so transparent areas don't bleed into the opaque ones
+	//	 areas that become fully transparent keep the unweighted color, for seamless transitions when alpha is not used
+	static void Downsample(const Image& src, Image& dst, MipFilter filter, bool normalmap, bool alpha_weighted)
+	{
+		FilterTaps taps_x;
+		FilterTaps taps_y;
+		ComputeFilterTaps(src.width, dst.width, filter, taps_x);
+		ComputeFilterTaps(src.height, dst.height, filter, taps_y);
+
+		wi::vector<XMFLOAT4A> temp(size_t(dst.width) * size_t(src.height));
+		wi::vector<XMFLOAT4A> temp_weighted(alpha_weighted ? temp.size() : 0);
+		dst.pixels.resize(size_t(dst.width) * size_t(dst.height));
+
+		wi::jobsystem::context ctx;
+		wi::jobsystem::Dispatch(ctx, src.height, 16, [&](wi::jobsystem::JobArgs args) {
+			const XMFLOAT4A* src_row = src.pixels.data() + size_t(args.jobIndex) * src.width;
+			const size_t dst_row = size_t(args.jobIndex) * dst.width;
+			for (uint32_t x = 0; x < dst.width; ++x)
+			{
+				XMVECTOR sum = XMVectorZero();
+				XMVECTOR sum_weighted = XMVectorZero();
+				for (uint32_t t = taps_x.offsets[x]; t < taps_x.offsets[x + 1]; ++t)
+				{
+					const XMVECTOR color = XMLoadFloat4A(src_row + taps_x.indices[t]);
+					const XMVECTOR weight = XMVectorReplicate(taps_x.weights[t]);
+					sum = XMVectorMultiplyAdd(color, weight, sum);
+					if (alpha_weighted)
+					{
+						// premultiplied color, alpha stays the same:
+						const XMVECTOR premultiplied = XMVectorSelect(color, XMVectorMultiply(color, XMVectorSplatW(color)), g_XMSelect1110);
+						sum_weighted = XMVectorMultiplyAdd(premultiplied, weight, sum_weighted);
+					}
+				}
+				XMStoreFloat4A(temp.data() + dst_row + x, sum);
+				if (alpha_weighted)
+				{
+					XMStoreFloat4A(temp_weighted.data() + dst_row + x, sum_weighted);
+				}
+			}
+		});
+		wi::jobsystem::Wait(ctx);
+
+		// Negative filter lobes can overshoot, so the result is clamped to the valid range:
+		const XMVECTOR range_min = normalmap ? XMVectorReplicate(-1) : XMVectorZero();
+		const XMVECTOR range_max = XMVectorReplicate(1);
+		wi::jobsystem::Dispatch(ctx, dst.height, 16, [&](wi::jobsystem::JobArgs args) {
+			const uint32_t y = args.jobIndex;
+			XMFLOAT4A* dst_row = dst.pixels.data() + size_t(y) * dst.width;
+			for (uint32_t x = 0; x < dst.width; ++x)
+			{
+				XMVECTOR sum = XMVectorZero();
+				XMVECTOR sum_weighted = XMVectorZero();
+				for (uint32_t t = taps_y.offsets[y]; t < taps_y.offsets[y + 1]; ++t)
+				{
+					const size_t index = size_t(taps_y.indices[t]) * dst.width + x;
+					const XMVECTOR weight = XMVectorReplicate(taps_y.weights[t]);
+					sum = XMVectorMultiplyAdd(XMLoadFloat4A(temp.data() + index), weight, sum);
+					if (alpha_weighted)
+					{
+						sum_weighted = XMVectorMultiplyAdd(XMLoadFloat4A(temp_weighted.data() + index), weight, sum_weighted);
+					}
+				}
+				if (alpha_weighted)
+				{
+					const float alpha = XMVectorGetW(sum_weighted);
+					if (alpha > 1.0f / 255.0f)
+					{
+						sum = XMVectorSelect(sum, XMVectorScale(sum_weighted, 1.0f / alpha), g_XMSelect1110);
+					}
+				}
+				sum = XMVectorClamp(sum, range_min, range_max);
+				if (normalmap)
+				{
+					// Filtered normals become shorter, they are renormalized:
+					const XMVECTOR n = XMVector3Normalize(sum);
+					sum = XMVectorSelect(sum, n, g_XMSelect1110);
+					if (XMVectorGetX(XMVector3LengthSq(n)) == 0)
+					{
+						sum = XMVectorSet(0, 0, 1, XMVectorGetW(sum));
+					}
+				}
+				XMStoreFloat4A(dst_row + x, sum);
+			}
+		});
+		wi::jobsystem::Wait(ctx);
+	}
+
+	// The fraction of pixels that pass the alpha test with alpha scaled by the specified value
+	static float ComputeAlphaCoverage(const Image& image, float alpha_reference, float scale)
+	{
+		size_t count = 0;
+		for (const XMFLOAT4A& color : image.pixels)
+		{
+			count += color.w * scale >= alpha_reference ? 1 : 0;
+		}
+		return image.pixels.empty() ? 0 : float(count) / float(image.pixels.size());
+	}
+
+	// Scales the alpha of a mip level, so the same fraction of pixels pass the alpha test as in the top level
+	//	Without this, alpha tested surfaces (foliage, fences) get thinner in the smaller mips, and they can disappear in the distance
+	static void PreserveAlphaCoverage(Image& image, float alpha_reference, float coverage)
+	{
+		float scale_min = 0;
+		float scale_max = 4;
+		float scale = 1;
+		for (int i = 0; i < 10; ++i)
+		{
+			const float current = ComputeAlphaCoverage(image, alpha_reference, scale);
+			if (current < coverage)
+			{
+				scale_min = scale;
+			}
+			else if (current > coverage)
+			{
+				scale_max = scale;
+			}
+			else
+			{
+				break;
+			}
+			scale = (scale_min + scale_max) * 0.5f;
+		}
+		for (XMFLOAT4A& color : image.pixels)
+		{
+			color.w = wi::math::saturate(color.w * scale);
+		}
+	}
+
+	struct Block
+	{
+		uint8_t rgba[16][4];
+	};
+
+	inline uint32_t ColorDistance(const int a[3], const int b[3])
+	{
+		const int dr = a[0] - b[0];
+		const int dg = a[1] - b[1];
+		const int db = a[2] - b[2];
+		return uint32_t(dr * dr + dg * dg + db * db);
+	}
+
+	// Principal axis of the first channel_count channels with power iteration
+	template<int channel_count>
+	static void PrincipalAxis(const Block& block, float mean[channel_count], float axis[channel_count])
+	{
+		float minimum[channel_count];
+		float maximum[channel_count];
+		for (int c = 0; c < channel_count; ++c)
+		{
+			mean[c] = 0;
+			minimum[c] = 255;
+			maximum[c] = 0;
+		}
+		for (int i = 0; i < 16; ++i)
+		{
+			for (int c = 0; c < channel_count; ++c)
+			{
+				const float v = block.rgba[i][c];
+				mean[c] += v;
+				minimum[c] = std::min(minimum[c], v);
+				maximum[c] = std::max(maximum[c], v);
+			}
+		}
+		float covariance[channel_count][channel_count] = {};
+		for (int c = 0; c < channel_count; ++c)
+		{
+			mean[c] /= 16.0f;
+		}
+		for (int i = 0; i < 16; ++i)
+		{
+			float d[channel_count];
+			for (int c = 0; c < channel_count; ++c)
+			{
+				d[c] = block.rgba[i][c] - mean[c];
+			}
+			for (int a = 0; a < channel_count; ++a)
+			{
+				for (int b = 0; b < channel_count; ++b)
+				{
+					covariance[a][b] += d[a] * d[b];
+				}
+			}
+		}
+		for (int c = 0; c < channel_count; ++c)
+		{
+			axis[c] = maximum[c] - minimum[c];
+		}
+		for (int iteration = 0; iteration < 8; ++iteration)
+		{
+			float next[channel_count] = {};
+			float length = 0;
+			for (int a = 0; a < channel_count; ++a)
+			{
+				for (int b = 0; b < channel_count; ++b)
+				{
+					next[a] += covariance[a][b] * axis[b];
+				}
+				length = std::max(length, std::abs(next[a]));
+			}
+			if (length < 1e-6f)
+				break;
+			for (int c = 0; c < channel_count; ++c)
+			{
+				axis[c] = next[c] / length;
+			}
+		}
+		float length = 0;
+		for (int c = 0; c < channel_count; ++c)
+		{
+			length += axis[c] * axis[c];
+		}
+		length = std::sqrt(length);
+		for (int c = 0; c < channel_count; ++c)
+		{
+			axis[c] = length > 1e-6f ? axis[c] / length : 0.0f;
+		}
+	}
+
+	// Endpoints at the extents of the pixels projected on the principal axis
+	template<int channel_count>
+	static void InitialEndpoints(const Block& block, float e0[channel_count], float e1[channel_count])
+	{
+		float mean[channel_count];
+		float axis[channel_count];
+		PrincipalAxis<channel_count>(block, mean, axis);
+		float min_projection = 0;
+		float max_projection = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			float projection = 0;
+			for (int c = 0; c < channel_count; ++c)
+			{
+				projection += (block.rgba[i][c] - mean[c]) * axis[c];
+			}
+			min_projection = std::min(min_projection, projection);
+			max_projection = std::max(max_projection, projection);
+		}
+		for (int c = 0; c < channel_count; ++c)
+		{
+			e0[c] = std::clamp(mean[c] + axis[c] * max_projection, 0.0f, 255.0f);
+			e1[c] = std::clamp(mean[c] + axis[c] * min_projection, 0.0f, 255.0f);
+		}
+	}
+
+	// Least squares endpoints for the given interpolation weights of e0 per pixel, returns false if the system is degenerate
+	template<int channel_count>
+	static bool RefitEndpoints(const Block& block, const float weights[16], float e0[channel_count], float e1[channel_count])
+	{
+		float aa = 0, ab = 0, bb = 0;
+		float ax[channel_count] = {};
+		float bx[channel_count] = {};
+		for (int i = 0; i < 16; ++i)
+		{
+			const float a = weights[i];
+			const float b = 1 - a;
+			aa += a * a;
+			ab += a * b;
+			bb += b * b;
+			for (int c = 0; c < channel_count; ++c)
+			{
+				ax[c] += a * block.rgba[i][c];
+				bx[c] += b * block.rgba[i][c];
+			}
+		}
+		const float det = aa * bb - ab * ab;
+		if (std::abs(det) < 1e-6f)
+			return false;
+		const float inv_det = 1.0f / det;
+		for (int c = 0; c < channel_count; ++c)
+		{
+			e0[c] = std::clamp((ax[c] * bb - bx[c] * ab) * inv_det, 0.0f, 255.0f);
+			e1[c] = std::clamp((bx[c] * aa - ax[c] * ab) * inv_det, 0.0f, 255.0f);
+		}
+		return true;
+	}
+
+	inline uint16_t PackRGB565(const float rgb[3])
+	{
+		const uint32_t r = (uint32_t)std::clamp(rgb[0] * 31.0f / 255.0f + 0.5f, 0.0f, 31.0f);
+		const uint32_t g = (uint32_t)std::clamp(rgb[1] * 63.0f / 255.0f + 0.5f, 0.0f, 63.0f);
+		const uint32_t b = (uint32_t)std::clamp(rgb[2] * 31.0f / 255.0f + 0.5f, 0.0f, 31.0f);
+		return uint16_t((r << 11) | (g << 5) | b);
+	}
+	inline void UnpackRGB565(uint16_t value, int rgb[3])
+	{
+		const int r = (value >> 11) & 31;
+		const int g = (value >> 5) & 63;
+		const int b = value & 31;
+		rgb[0] = (r << 3) | (r >> 2);
+		rgb[1] = (g << 2) | (g >> 4);
+		rgb[2] = (b << 3) | (b >> 2);
+	}
+
+	// Four color palette indices for two 565 endpoints, returns the error
+	static uint32_t FitColorIndices(const Block& block, uint16_t c0, uint16_t c1, uint8_t indices[16])
+	{
+		int palette[4][3];
+		UnpackRGB565(c0, palette[0]);
+		UnpackRGB565(c1, palette[1]);
+		for (int c = 0; c < 3; ++c)
+		{
+			palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+			palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+		uint32_t error = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			const int color[3] = { block.rgba[i][0], block.rgba[i][1], block.rgba[i][2] };
+			uint32_t best = ~0u;
+			for (uint8_t p = 0; p < 4; ++p)
+			{
+				const uint32_t distance = ColorDistance(color, palette[p]);
+				if (distance < best)
+				{
+					best = distance;
+					indices[i] = p;
+				}
+			}
+			error += best;
+		}
+		return error;
+	}
+
+	// BC1 color block, also used in BC3. Always uses the four color mode
+	static void EncodeColorBlock(const Block& block, uint8_t* dst)
+	{
+		float e0[3];
+		float e1[3];
+		InitialEndpoints<3>(block, e0, e1);
+
+		uint16_t best_c0 = 0;
+		uint16_t best_c1 = 0;
+		uint8_t best_indices[16] = {};
+		uint32_t best_error = ~0u;
+		for (int iteration = 0; iteration < 3; ++iteration)
+		{
+			const uint16_t c0 = PackRGB565(e0);
+			const uint16_t c1 = PackRGB565(e1);
+			uint8_t indices[16];
+			const uint32_t error = FitColorIndices(block, c0, c1, indices);
+			if (error < best_error)
+			{
+				best_error = error;
+				best_c0 = c0;
+				best_c1 = c1;
+				std::memcpy(best_indices, indices, sizeof(indices));
+			}
+			if (error == 0)
+				break;
+			static constexpr float palette_weights[4] = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+			float weights[16];
+			for (int i = 0; i < 16; ++i)
+			{
+				weights[i] = palette_weights[indices[i]];
+			}
+			if (!RefitEndpoints<3>(block, weights, e0, e1))
+				break;
+		}
+
+		// Four color mode requires c0 > c1, swapping the endpoints swaps the palette entries 0-1 and 2-3:
+		uint32_t index_bits = 0;
+		if (best_c0 < best_c1)
+		{
+			std::swap(best_c0, best_c1);
+			for (int i = 0; i < 16; ++i)
+			{
+				best_indices[i] ^= 1;
+			}
+		}
+		if (best_c0 != best_c1)
+		{
+			for (int i = 0; i < 16; ++i)
+			{
+				index_bits |= uint32_t(best_indices[i]) << (i * 2);
+			}
+		}
+		std::memcpy(dst + 0, &best_c0, sizeof(best_c0));
+		std::memcpy(dst + 2, &best_c1, sizeof(best_c1));
+		std::memcpy(dst + 4, &index_bits, sizeof(index_bits));
+	}
+
+	// BC4 single channel block in eight value mode, used for BC3 alpha and BC5 too
+	static void EncodeChannelBlock(const Block& block, int channel, uint8_t* dst)
+	{
+		int minimum = 255;
+		int maximum = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			minimum = std::min(minimum, (int)block.rgba[i][channel]);
+			maximum = std::max(maximum, (int)block.rgba[i][channel]);
+		}
+		dst[0] = (uint8_t)maximum;
+		dst[1] = (uint8_t)minimum;
+		uint64_t index_bits = 0;
+		if (maximum > minimum)
+		{
+			int palette[8];
+			palette[0] = maximum;
+			palette[1] = minimum;
+			for (int p = 1; p < 7; ++p)
+			{
+				palette[p + 1] = ((7 - p) * maximum + p * minimum) / 7;
+			}
+			for (int i = 0; i < 16; ++i)
+			{
+				const int value = block.rgba[i][channel];
+				int best = 256;
+				uint64_t best_index = 0;
+				for (int p = 0; p < 8; ++p)
+				{
+					const int distance = std::abs(value - palette[p]);
+					if (distance < best)
+					{
+						best = distance;
+						best_index = p;
+					}
+				}
+				index_bits |= best_index << (i * 3);
+			}
+		}
+		for (int i = 0; i < 6; ++i)
+		{
+			dst[2 + i] = uint8_t(index_bits >> (i * 8));
+		}
+	}
+
+	// BC7 block in mode 6: one subset, RGBA endpoints with 7 bits + unique p-bit, 4-bit indices
+	static constexpr int bc7_weights4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+	inline void QuantizeBC7Endpoint(const float value[4], int quantized[4], int& pbit)
+	{
+		float best_error = FLT_MAX;
+		for (int p = 0; p < 2; ++p)
+		{
+			int q[4];
+			float error = 0;
+			for (int c = 0; c < 4; ++c)
+			{
+				q[c] = std::clamp(int((value[c] - p) * 0.5f + 0.5f), 0, 127);
+				const float d = float((q[c] << 1) | p) - value[c];
+				error += d * d;
+			}
+			if (error < best_error)
+			{
+				best_error = error;
+				pbit = p;
+				std::memcpy(quantized, q, sizeof(q));
+			}
+		}
+	}
+	static uint32_t FitBC7Indices(const Block& block, const int e0[4], const int e1[4], uint8_t indices[16])
+	{
+		int palette[16][4];
+		for (int p = 0; p < 16; ++p)
+		{
+			for (int c = 0; c < 4; ++c)
+			{
+				palette[p][c] = ((64 - bc7_weights4[p]) * e0[c] + bc7_weights4[p] * e1[c] + 32) >> 6;
+			}
+		}
+		uint32_t error = 0;
+		for (int i = 0; i < 16; ++i)
+		{
+			uint32_t best = ~0u;
+			for (uint8_t p = 0; p < 16; ++p)
+			{
+				uint32_t distance = 0;
+				for (int c = 0; c < 4; ++c)
+				{
+					const int d = int(block.rgba[i][c]) - palette[p][c];
+					distance += uint32_t(d * d);
+				}
+				if (distance < best)
+				{
+					best = distance;
+					indices[i] = p;
+				}
+			}
+			error += best;
+		}
+		return error;
+	}
+	struct BitWriter
+	{
+		uint64_t bits[2] = {};
+		uint32_t pos = 0;
+		void write(uint32_t value, uint32_t count)
+		{
+			for (uint32_t i = 0; i < count; ++i, ++pos)
+			{
+				bits[pos / 64] |= uint64_t((value >> i) & 1) << (pos % 64);
+			}
+		}
+	};
+	static void EncodeBC7Block(const Block& block, uint8_t* dst)
+	{
+		float e0[4];
+		float e1[4];
+		InitialEndpoints<4>(block, e0, e1);
+
+		int best_q0[4] = {};
+		int best_q1[4] = {};
+		int best_p0 = 0;
+		int best_p1 = 0;
+		uint8_t best_indices[16] = {};
+		uint32_t best_error = ~0u;
+		for (int iteration = 0; iteration < 3; ++iteration)
+		{
+			int q0[4], q1[4], p0, p1;
+			QuantizeBC7Endpoint(e0, q0, p0);
+			QuantizeBC7Endpoint(e1, q1, p1);
+			int full0[4], full1[4];
+			for (int c = 0; c < 4; ++c)
+			{
+				full0[c] = (q0[c] << 1) | p0;
+				full1[c] = (q1[c] << 1) | p1;
+			}
+			uint8_t indices[16];
+			const uint32_t error = FitBC7Indices(block, full0, full1, indices);
+			if (error < best_error)
+			{
+				best_error = error;
+				std::memcpy(best_q0, q0, sizeof(q0));
+				std::memcpy(best_q1, q1, sizeof(q1));
+				best_p0 = p0;
+				best_p1 = p1;
+				std::memcpy(best_indices, indices, sizeof(indices));
+			}
+			if (error == 0)
+				break;
+			float weights[16];
+			for (int i = 0; i < 16; ++i)
+			{
+				weights[i] = (64 - bc7_weights4[indices[i]]) / 64.0f;
+			}
+			if (!RefitEndpoints<4>(block, weights, e0, e1))
+				break;
+		}
+
+		// The most significant index bit of the first pixel is implicitly zero, the endpoints are swapped if needed:
+		if (best_indices[0] & 8)
+		{
+			std::swap(best_q0, best_q1);
+			std::swap(best_p0, best_p1);
+			for (int i = 0; i < 16; ++i)
+			{
+				best_indices[i] = 15 - best_indices[i];
+			}
+		}
+
+		BitWriter writer;
+		writer.write(1 << 6, 7); // mode 6
+		for (int c = 0; c < 4; ++c)
+		{
+			writer.write(best_q0[c], 7);
+			writer.write(best_q1[c], 7);
+		}
+		writer.write(best_p0, 1);
+		writer.write(best_p1, 1);
+		writer.write(best_indices[0], 3);
+		for (int i = 1; i < 16; ++i)
+		{
+			writer.write(best_indices[i], 4);
+		}
+		std::memcpy(dst, writer.bits, sizeof(writer.bits));
+	}
+
+	void CompressBlocks(const uint8_t* rgba, uint32_t width, uint32_t height, Format format, uint8_t* dst)
+	{
+		const uint32_t blocks_x = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		const uint32_t blocks_y = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+		const uint32_t block_stride = GetFormatStride(format);
+
+		wi::jobsystem::context ctx;
+		wi::jobsystem::Dispatch(ctx, blocks_x * blocks_y, 64, [&](wi::jobsystem::JobArgs args) {
+			const uint32_t bx = args.jobIndex % blocks_x;
+			const uint32_t by = args.jobIndex / blocks_x;
+			Block block;
+			for (uint32_t y = 0; y < BLOCK_SIZE; ++y)
+			{
+				const uint32_t py = std::min(by * BLOCK_SIZE + y, height - 1);
+				for (uint32_t x = 0; x < BLOCK_SIZE; ++x)
+				{
+					const uint32_t px = std::min(bx * BLOCK_SIZE + x, width - 1);
+					std::memcpy(block.rgba[y * BLOCK_SIZE + x], rgba + (size_t(py) * width + px) * 4, 4);
+				}
+			}
+			uint8_t* block_dst = dst + size_t(args.jobIndex) * block_stride;
+			switch (format)
+			{
+			case Format::BC1_UNORM:
+			case Format::BC1_UNORM_SRGB:
+				EncodeColorBlock(block, block_dst);
+				break;
+			case Format::BC3_UNORM:
+			case Format::BC3_UNORM_SRGB:
+				EncodeChannelBlock(block, 3, block_dst);
+				EncodeColorBlock(block, block_dst + 8);
+				break;
+			case Format::BC4_UNORM:
+				EncodeChannelBlock(block, 0, block_dst);
+				break;
+			case Format::BC5_UNORM:
+				EncodeChannelBlock(block, 0, block_dst);
+				EncodeChannelBlock(block, 1, block_dst + 8);
+				break;
+			case Format::BC7_UNORM:
+			case Format::BC7_UNORM_SRGB:
+				EncodeBC7Block(block, block_dst);
+				break;
+			default:
+				assert(0); // not supported
+				break;
+			}
+		});
+		wi::jobsystem::Wait(ctx);
+	}
+
+	bool Cook(const uint8_t* filedata, size_t filesize, const CookSettings& settings, wi::vector<uint8_t>& dds)
+	{
+		int width = 0, height = 0, channels = 0;
+		const bool is_16bit = stbi_is_16_bit_from_memory(filedata, (int)filesize) != 0;
+		void* decoded = is_16bit ?
+			(void*)stbi_load_16_from_memory(filedata, (int)filesize, &width, &height, &channels, 4) :
+			(void*)stbi_load_from_memory(filedata, (int)filesize, &width, &height, &channels, 4);
+		if (decoded == nullptr)
+			return false;
+
+		Format format = settings.format;
+		if (format == Format::UNKNOWN)
+		{
+			if (settings.normalmap)
+			{
+				format = Format::BC5_UNORM;
+			}
+			else if (channels == 1)
+			{
+				format = Format::BC4_UNORM;
+			}
+			else if (channels == 3)
+			{
+				format = Format::BC1_UNORM;
+			}
+			else
+			{
+				format = Format::BC7_UNORM; // grayscale + alpha is expanded to RGBA too, because DDS can't store the swizzle
+			}
+		}
+		const bool srgb = settings.srgb && !settings.normalmap && channels != 1;
+		const bool has_alpha_channel = !settings.normalmap && (channels == 2 || channels == 4);
+
+		// The top level is padded to block size by repeating the edge pixels:
+		Image image;
+		image.width = align((uint32_t)width, BLOCK_SIZE);
+		image.height = align((uint32_t)height, BLOCK_SIZE);
+		image.pixels.resize(size_t(image.width) * size_t(image.height));
+		const SRGBTables& tables = srgb_tables();
+		wi::jobsystem::context ctx;
+		wi::jobsystem::Dispatch(ctx, image.height, 16, [&](wi::jobsystem::JobArgs args) {
+			const uint32_t y = args.jobIndex;
+			const uint32_t sy = std::min(y, uint32_t(height - 1));
+			for (uint32_t x = 0; x < image.width; ++x)
+			{
+				const size_t src_index = (size_t(sy) * width + std::min(x, uint32_t(width - 1))) * 4;
+				float color[4];
+				for (int c = 0; c < 4; ++c)
+				{
+					if (is_16bit)
+					{
+						color[c] = ((const uint16_t*)decoded)[src_index + c] / 65535.0f;
+						if (srgb && c < 3)
+						{
+							color[c] = SRGBToLinear(color[c]);
+						}
+					}
+					else
+					{
+						const uint8_t value = ((const uint8_t*)decoded)[src_index + c];
+						color[c] = srgb && c < 3 ? tables.to_linear[value] : value / 255.0f;
+					}
+				}
+				XMVECTOR v = XMLoadFloat4((const XMFLOAT4*)color);
+				if (settings.normalmap)
+				{
+					v = XMVectorSelect(v, XMVectorMultiplyAdd(v, XMVectorReplicate(2), XMVectorReplicate(-1)), g_XMSelect1110);
+				}
+				XMStoreFloat4A(&image.pixels[size_t(y) * image.width + x], v);
+			}
+		});
+		wi::jobsystem::Wait(ctx);
+		stbi_image_free(decoded);
+
+		// Alpha is only taken into account when there are transparent pixels:
+		bool alpha_weighted = false;
+		if (has_alpha_channel)
+		{
+			for (const XMFLOAT4A& color : image.pixels)
+			{
+				if (color.w < 1)
+				{
+					alpha_weighted = true;
+					break;
+				}
+			}
+		}
+		const bool preserve_coverage = alpha_weighted && settings.preserve_coverage;
+		const float coverage = preserve_coverage ? ComputeAlphaCoverage(image, settings.alpha_reference, 1) : 0;
+
+		TextureDesc desc;
+		desc.width = image.width;
+		desc.height = image.height;
+		desc.format = format;
+		desc.mip_levels = settings.mips ? GetMipCount(desc.width, desc.height, 1, BLOCK_SIZE) : 1;
+
+		wi::vector<uint8_t> texturedata(ComputeTextureMemorySizeInBytes(desc));
+		wi::vector<uint8_t> rgba8;
+		Image next;
+		size_t offset = 0;
+		for (uint32_t mip = 0; mip < desc.mip_levels; ++mip)
+		{
+			if (mip > 0)
+			{
+				next.width = std::max(1u, desc.width >> mip);
+				next.height = std::max(1u, desc.height >> mip);
+				Downsample(image, next, settings.mip_filter, settings.normalmap, alpha_weighted);
+				if (preserve_coverage)
+				{
+					PreserveAlphaCoverage(next, settings.alpha_reference, coverage);
+				}
+				std::swap(image, next);
+			}
+
+			rgba8.resize(image.pixels.size() * 4);
+			wi::jobsystem::Dispatch(ctx, image.height, 16, [&](wi::jobsystem::JobArgs args) {
+				const size_t row = size_t(args.jobIndex) * image.width;
+				for (size_t i = row; i < row + image.width; ++i)
+				{
+					const XMFLOAT4A& color = image.pixels[i];
+					uint8_t* dst = rgba8.data() + i * 4;
+					if (settings.normalmap)
+					{
+						dst[0] = UNORM8(color.x * 0.5f + 0.5f);
+						dst[1] = UNORM8(color.y * 0.5f + 0.5f);
+						dst[2] = UNORM8(color.z * 0.5f + 0.5f);
+					}
+					else if (srgb)
+					{
+						dst[0] = LinearToSRGB8(color.x);
+						dst[1] = LinearToSRGB8(color.y);
+						dst[2] = LinearToSRGB8(color.z);
+					}
+					else
+					{
+						dst[0] = UNORM8(color.x);
+						dst[1] = UNORM8(color.y);
+						dst[2] = UNORM8(color.z);
+					}
+					dst[3] = UNORM8(color.w);
+				}
+			});
+			wi::jobsystem::Wait(ctx);
+
+			CompressBlocks(rgba8.data(), image.width, image.height, format, texturedata.data() + offset);
+			const uint32_t blocks_x = (image.width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			const uint32_t blocks_y = (image.height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+			offset += size_t(blocks_x) * size_t(blocks_y) * GetFormatStride(format);
+		}
+		assert(offset == texturedata.size());
+
+		return wi::helper::saveTextureToMemoryFile(texturedata, desc, "DDS", dds);
+	}
+
+	std::string GetCacheDirectory()
+	{
+		return wi::helper::GetCacheDirectoryPath() + "/WickedEngine/textures/";
+	}
+
+	bool CookCached(const uint8_t* filedata, size_t filesize, const CookSettings& settings, wi::vector<uint8_t>& dds)
+	{
+		size_t hash = wi::helper::HashByteData(filedata, filesize);
+		wi::helper::hash_combine(hash, filesize);
+		wi::helper::hash_combine(hash, COOKER_VERSION);
+		wi::helper::hash_combine(hash, (uint32_t)settings.format);
+		wi::helper::hash_combine(hash, (uint32_t)settings.mip_filter);
+		wi::helper::hash_combine(hash, settings.srgb);
+		wi::helper::hash_combine(hash, settings.normalmap);
+		wi::helper::hash_combine(hash, settings.mips);
+		wi::helper::hash_combine(hash, settings.preserve_coverage);
+		wi::helper::hash_combine(hash, settings.alpha_reference);
+		char name[32] = {};
+		snprintf(name, arraysize(name), "%016llx.dds", (unsigned long long)hash);
+		const std::string directory = GetCacheDirectory();
+		const std::string filename = directory + name;
+
+		// The same texture can be cooked by multiple threads, the cache files are accessed with locking:
+		static std::mutex locker;
+		{
+			std::scoped_lock lock(locker);
+			if (wi::helper::FileExists(filename) && wi::helper::FileRead(filename, dds))
+			{
+				return true;
+			}
+		}
+
+		wi::Timer timer;
+		if (!Cook(filedata, filesize, settings, dds))
+			return false;
+		wi::backlog::post("wi::texturecooker: cooked " + filename + " in " + std::to_string(int(timer.elapsed_milliseconds())) + " ms");
+
+		std::scoped_lock lock(locker);
+		wi::helper::DirectoryCreate(directory);
+		wi::helper::FileWrite(filename, dds.data(), dds.size());
+		return true;
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include "CommonInclude.h"
+#include "wiGraphics.h"
+#include "wiVector.h"
+
+#include <string>
+
+// CPU texture cooking: mip generation and block compression without using the GPU
+//	The result is DDS file data that can be loaded like any other DDS texture, so it also works in headless applications
+namespace wi::texturecooker
+{
+	enum class MipFilter
+	{
+		BOX,	// average of 2x2 pixels, fastest
+		KAISER,	// Kaiser windowed sinc, keeps mips sharper
+	};
+
+	struct CookSettings
+	{
+		// BC1, BC3, BC4, BC5 or BC7
+		//	UNKNOWN: chosen from the image: normal maps use BC5, single channel images BC4, RGB images BC1, images with alpha BC7
+		wi::graphics::Format format = wi::graphics::Format::UNKNOWN;
+		MipFilter mip_filter = MipFilter::KAISER;
+		bool srgb = false; // color is filtered in linear space, enable it for sRGB color textures (not used for single channel images and normal maps)
+		bool normalmap = false; // normal vectors are renormalized in every mip, only XY is stored
+		bool mips = true; // generate full mip chain
+		bool preserve_coverage = true; // mips keep the same alpha tested coverage as the top level, color is weighted by alpha (only for images with transparency)
+		float alpha_reference = 0.5f; // alpha test reference value for preserve_coverage
+	};
+
+	// Decodes an image file (png, jpg, tga, bmp, etc.) and cooks it into DDS file data
+	bool Cook(const uint8_t* filedata, size_t filesize, const CookSettings& settings, wi::vector<uint8_t>& dds);
+
+	// Same as Cook(), but the result is stored in and reused from the cache directory
+	//	The cache is keyed by the hash of the file data and the settings, so it doesn't need to be invalidated
+	bool CookCached(const uint8_t* filedata, size_t filesize, const CookSettings& settings, wi::vector<uint8_t>& dds);
+
+	// The directory of the cached DDS files, inside wi::helper::GetCacheDirectoryPath()
+	std::string GetCacheDirectory();
+
+	// Block compress an RGBA8 image into BC1, BC3, BC4, BC5 or BC7 blocks
+	//	The image doesn't need to be block aligned, edge pixels are repeated to fill partial blocks
+	//	dst must have space for all blocks (GetFormatStride(format) bytes per 4x4 pixel block)
+	//	The work is distributed with the job system
+	void CompressBlocks(const uint8_t* rgba, uint32_t width, uint32_t height, wi::graphics::Format format, uint8_t* dst);
+}